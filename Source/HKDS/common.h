@@ -937,6 +937,43 @@ HKDS_CPLUSPLUS_ENABLED_START
 #	define HKDS_SYSTEM_AVX_INTRINSICS
 #endif
 
+/*==============================================================================
+    Run-time SIMD Dispatch
+==============================================================================*/
+
+/*!
+* \def HKDS_RUNTIME_DISPATCH_DISABLED
+* \brief Disables run-time selection of the parallel Keccak kernels (user-modifiable).
+* When disabled, the kernels are chosen by the compile-time instruction set alone.
+*/
+/*#define HKDS_RUNTIME_DISPATCH_DISABLED */
+
+#if !defined(HKDS_RUNTIME_DISPATCH_DISABLED) && defined(__GNUC__) && defined(__x86_64__)
+  /*!
+   * \def HKDS_SYSTEM_RUNTIME_DISPATCH
+   * \brief Defined when the AVX2 and AVX512 Keccak kernels are compiled with per-function target attributes,
+   * and selected at load time from the processor's cpuid features (GCC and Clang, x86-64).
+   */
+#	define HKDS_SYSTEM_RUNTIME_DISPATCH
+#endif
+
+/*!
+* \def HKDS_TARGET_AVX2
+* \brief Compiles a function for the AVX2 instruction set when run-time dispatch is enabled.
+*/
+
+/*!
+* \def HKDS_TARGET_AVX512
+* \brief Compiles a function for the AVX512F instruction set when run-time dispatch is enabled.
+*/
+#if defined(HKDS_SYSTEM_RUNTIME_DISPATCH)
+#	define HKDS_TARGET_AVX2 __attribute__((target("avx2")))
+#	define HKDS_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#	define HKDS_TARGET_AVX2
+#	define HKDS_TARGET_AVX512
+#endif
+
 /*==============================================================================
     Assembly and SIMD Alignment Macros
 ==============================================================================*/
@@ -1024,6 +1061,120 @@ HKDS_CPLUSPLUS_ENABLED_START
  */
 #define HKDS_STATUS_FAILURE -1LL
 
+/*==============================================================================
+    Atomic Operations
+==============================================================================*/
+
+/*!
+ * \typedef hkds_atomic_size
+ * \brief A size counter that is only accessed with the hkds_atomic functions.
+ *
+ * \details
+ * The atomic functions use the Interlocked intrinsics with MSVC, which does not accept C11 atomics without
+ * the /experimental:c11atomics switch, and the __atomic builtins with GCC-compatible compilers.
+ */
+typedef volatile size_t hkds_atomic_size;
+
+/**
+ * \brief Load a counter with acquire ordering.
+ *
+ * \param target [in] The counter.
+ * \return The counter value.
+ */
+static inline size_t hkds_atomic_load(const hkds_atomic_size* target)
+{
+#if defined(HKDS_SYSTEM_COMPILER_MSC)
+#	if defined(_WIN64)
+	return (size_t)_InterlockedCompareExchange64((volatile __int64*)target, 0, 0);
+#	else
+	return (size_t)_InterlockedCompareExchange((volatile long*)target, 0, 0);
+#	endif
+#else
+	return __atomic_load_n(target, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/**
+ * \brief Store a counter with release ordering.
+ *
+ * \param target [out] The counter.
+ * \param value [in] The new counter value.
+ */
+static inline void hkds_atomic_store(hkds_atomic_size* target, size_t value)
+{
+#if defined(HKDS_SYSTEM_COMPILER_MSC)
+#	if defined(_WIN64)
+	(void)_InterlockedExchange64((volatile __int64*)target, (__int64)value);
+#	else
+	(void)_InterlockedExchange((volatile long*)target, (long)value);
+#	endif
+#else
+	__atomic_store_n(target, value, __ATOMIC_RELEASE);
+#endif
+}
+
+/**
+ * \brief Replace a counter if it holds the expected value.
+ *
+ * \param target [in,out] The counter.
+ * \param expected [in,out] The expected value; receives the current value if the exchange fails.
+ * \param desired [in] The new counter value.
+ * \return Returns true if the counter was replaced.
+ */
+static inline bool hkds_atomic_compare_exchange(hkds_atomic_size* target, size_t* expected, size_t desired)
+{
+	size_t prev;
+	bool res;
+
+#if defined(HKDS_SYSTEM_COMPILER_MSC)
+#	if defined(_WIN64)
+	prev = (size_t)_InterlockedCompareExchange64((volatile __int64*)target, (__int64)desired, (__int64)*expected);
+#	else
+	prev = (size_t)_InterlockedCompareExchange((volatile long*)target, (long)desired, (long)*expected);
+#	endif
+#else
+	prev = *expected;
+	(void)__atomic_compare_exchange_n(target, &prev, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+
+	res = (prev == *expected);
+	*expected = prev;
+
+	return res;
+}
+
+/**
+ * \brief Add to a counter.
+ *
+ * \param target [in,out] The counter.
+ * \param value [in] The value to add.
+ * \return The counter value before the addition.
+ */
+static inline size_t hkds_atomic_fetch_add(hkds_atomic_size* target, size_t value)
+{
+#if defined(HKDS_SYSTEM_COMPILER_MSC)
+#	if defined(_WIN64)
+	return (size_t)_InterlockedExchangeAdd64((volatile __int64*)target, (__int64)value);
+#	else
+	return (size_t)_InterlockedExchangeAdd((volatile long*)target, (long)value);
+#	endif
+#else
+	return __atomic_fetch_add(target, value, __ATOMIC_ACQ_REL);
+#endif
+}
+
+/**
+ * \brief Subtract from a counter.
+ *
+ * \param target [in,out] The counter.
+ * \param value [in] The value to subtract.
+ * \return The counter value before the subtraction.
+ */
+static inline size_t hkds_atomic_fetch_sub(hkds_atomic_size* target, size_t value)
+{
+	return hkds_atomic_fetch_add(target, (size_t)0U - value);
+}
+
 /*==============================================================================
     User Modifiable Values and Cryptographic Parameter Sets
 ==============================================================================*/
@@ -102,7 +102,7 @@
  * - **Client Module (hkds_client.h/.c):** Contains functions for key management, message encryption, and token handling on the client side.
  * - **Server Module (hkds_server.h/.c):** Implements key derivation, token generation, and message decryption for the server.
  * - **Configuration Module (hkds_config.h):** Defines protocol parameters, key sizes, and mode settings.
- * - **Queue Module (hkds_queue.h/.c):** Implements message queuing for asynchronous operations.
+ * - **Queue Module (hkds_queue.h/.c):** Implements a lock-free message queue, in single or multiple producer mode, for asynchronous operations.
  * - **Benchmark Module (hkds_benchmark.h/.c):** Provides performance benchmarking for cryptographic primitives and protocol operations.
  * - **Test Module (hkds_test.h/.c):** Contains comprehensive tests for functional correctness and performance.
  *
@@ -0,0 +1,556 @@
+#if !defined(_POSIX_C_SOURCE) && !defined(_WIN32)
+	/* required for the sched_yield declaration in strict C11 builds */
+#	define _POSIX_C_SOURCE 200809L
+#endif
+#include "hkds_async.h"
+#include "hkds_pool.h"
+#include "utils.h"
+#include <stdlib.h>
+
+#if defined(HKDS_SYSTEM_OS_WINDOWS)
+#	if !defined(WIN32_LEAN_AND_MEAN)
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	include <Windows.h>
+#else
+#	include <sched.h>
+#endif
+
+/*!
+ * \def HKDS_ASYNC_MIN_DEPTH
+ * \brief The smallest engine depth; one full group of every operation.
+ */
+#define HKDS_ASYNC_MIN_DEPTH HKDS_CACHX8_DEPTH
+
+/*!
+ * \def HKDS_ASYNC_JOB_SHIFT
+ * \brief The bit position of the operation in a dispatched job index; the low bits hold the group size.
+ */
+#define HKDS_ASYNC_JOB_SHIFT 4U
+
+/*!
+ * \def HKDS_ASYNC_SPIN_LIMIT
+ * \brief The number of doubling pause rounds a worker spends on a slot before it yields the processor.
+ */
+#define HKDS_ASYNC_SPIN_LIMIT 6U
+
+typedef struct
+{
+	hkds_atomic_size* sequence;						/* the per-slot sequence numbers */
+	uint8_t* slots;									/* the element storage */
+	size_t stride;									/* the element size */
+	size_t mask;									/* the slot count minus one */
+	hkds_atomic_size head;								/* the next position to read */
+	hkds_atomic_size tail;								/* the next position to write */
+} hkds_async_ring;
+
+struct hkds_async_context
+{
+	hkds_async_ring submissions[hkds_async_operation_count];	/* the per-operation submission rings */
+	hkds_async_ring completions;								/* the completion ring */
+	hkds_atomic_size pushed[hkds_async_operation_count];			/* the number of requests written to each submission ring */
+	hkds_atomic_size reserved[hkds_async_operation_count];		/* the number of requests claimed by dispatched groups */
+	hkds_atomic_size inflight;										/* the number of requests not yet collected */
+	hkds_server_x8_state state;									/* the template server state */
+	hkds_thread_pool pool;										/* the worker pool */
+	size_t datalen;												/* the decrypt-verify MAC data length */
+};
+
+/* bounded multi-producer multi-consumer ring */
+
+static bool hkds_async_ring_initialize(hkds_async_ring* ring, size_t depth, size_t stride)
+{
+	bool res;
+
+	res = false;
+	ring->sequence = (hkds_atomic_size*)malloc(depth * sizeof(hkds_atomic_size));
+	ring->slots = (uint8_t*)malloc(depth * stride);
+	ring->stride = stride;
+	ring->mask = depth - 1U;
+	hkds_atomic_store(&ring->head, 0U);
+	hkds_atomic_store(&ring->tail, 0U);
+
+	if (ring->sequence != NULL && ring->slots != NULL)
+	{
+		/* a slot is writable at position p when its sequence equals p, and readable when it equals p + 1 */
+		for (size_t i = 0U; i < depth; ++i)
+		{
+			hkds_atomic_store(&ring->sequence[i], i);
+		}
+
+		res = true;
+	}
+
+	return res;
+}
+
+static void hkds_async_ring_dispose(hkds_async_ring* ring)
+{
+	if (ring->sequence != NULL)
+	{
+		free((void*)ring->sequence);
+		ring->sequence = NULL;
+	}
+
+	if (ring->slots != NULL)
+	{
+		utils_memory_secure_erase(ring->slots, (ring->mask + 1U) * ring->stride);
+		free(ring->slots);
+		ring->slots = NULL;
+	}
+}
+
+static bool hkds_async_ring_push(hkds_async_ring* ring, const void* element)
+{
+	size_t pos;
+	size_t seq;
+	bool res;
+
+	res = false;
+	pos = hkds_atomic_load(&ring->tail);
+
+	for (;;)
+	{
+		seq = hkds_atomic_load(&ring->sequence[pos & ring->mask]);
+
+		if (seq == pos)
+		{
+			/* the slot is free; claim the position */
+			if (hkds_atomic_compare_exchange(&ring->tail, &pos, pos + 1U) == true)
+			{
+				utils_memory_copy(ring->slots + ((pos & ring->mask) * ring->stride), element, ring->stride);
+				hkds_atomic_store(&ring->sequence[pos & ring->mask], pos + 1U);
+				res = true;
+				break;
+			}
+		}
+		else if (seq < pos)
+		{
+			/* the slot still holds an unread element; the ring is full */
+			break;
+		}
+		else
+		{
+			pos = hkds_atomic_load(&ring->tail);
+		}
+	}
+
+	return res;
+}
+
+static bool hkds_async_ring_pop(hkds_async_ring* ring, void* element)
+{
+	size_t pos;
+	size_t seq;
+	bool res;
+
+	res = false;
+	pos = hkds_atomic_load(&ring->head);
+
+	for (;;)
+	{
+		seq = hkds_atomic_load(&ring->sequence[pos & ring->mask]);
+
+		if (seq == pos + 1U)
+		{
+			/* the slot is published; claim the position */
+			if (hkds_atomic_compare_exchange(&ring->head, &pos, pos + 1U) == true)
+			{
+				utils_memory_copy(element, ring->slots + ((pos & ring->mask) * ring->stride), ring->stride);
+				hkds_atomic_store(&ring->sequence[pos & ring->mask], pos + ring->mask + 1U);
+				res = true;
+				break;
+			}
+		}
+		else if (seq < pos + 1U)
+		{
+			/* the slot has not been published; the ring is empty */
+			break;
+		}
+		else
+		{
+			pos = hkds_atomic_load(&ring->head);
+		}
+	}
+
+	return res;
+}
+
+/* slot wait backoff */
+
+static void hkds_async_pause(void)
+{
+#if defined(HKDS_SYSTEM_OS_WINDOWS)
+	YieldProcessor();
+#elif (defined(HKDS_SYSTEM_COMPILER_GCC) || defined(HKDS_SYSTEM_COMPILER_CLANG)) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_ia32_pause();
+#elif (defined(HKDS_SYSTEM_COMPILER_GCC) || defined(HKDS_SYSTEM_COMPILER_CLANG)) && (defined(__aarch64__) || defined(__arm__))
+	__asm__ __volatile__("yield");
+#endif
+}
+
+static void hkds_async_backoff(size_t* spins)
+{
+	if (*spins < HKDS_ASYNC_SPIN_LIMIT)
+	{
+		/* the other thread is most likely running; pause for a doubling, bounded number of cycles */
+		for (size_t i = 0U; i < ((size_t)1U << *spins); ++i)
+		{
+			hkds_async_pause();
+		}
+
+		++(*spins);
+	}
+	else
+	{
+		/* the other thread may have been descheduled in the middle of its write; give up the core */
+#if defined(HKDS_SYSTEM_OS_WINDOWS)
+		SwitchToThread();
+#else
+		sched_yield();
+#endif
+	}
+}
+
+/* group processing */
+
+static size_t hkds_async_reserve(hkds_async_context* ctx, size_t op, size_t minimum)
+{
+	size_t avail;
+	size_t pushed;
+	size_t reserved;
+	size_t res;
+
+	res = 0U;
+	reserved = hkds_atomic_load(&ctx->reserved[op]);
+
+	/* claim up to a full group of the requests that have been written and not yet claimed */
+	for (;;)
+	{
+		pushed = hkds_atomic_load(&ctx->pushed[op]);
+		avail = pushed - reserved;
+
+		if (avail < minimum || avail == 0U)
+		{
+			break;
+		}
+
+		res = (avail < HKDS_CACHX8_DEPTH) ? avail : HKDS_CACHX8_DEPTH;
+
+		if (hkds_atomic_compare_exchange(&ctx->reserved[op], &reserved, reserved + res) == true)
+		{
+			break;
+		}
+
+		res = 0U;
+	}
+
+	return res;
+}
+
+static void hkds_async_process(void* context, size_t index)
+{
+	hkds_async_context* ctx = (hkds_async_context*)context;
+	hkds_async_request req[HKDS_CACHX8_DEPTH];
+	hkds_async_completion cmp[HKDS_CACHX8_DEPTH] = { 0U };
+	const uint8_t* pksn[HKDS_CACHX8_DEPTH] = { NULL };
+	const uint8_t* pmsg[HKDS_CACHX8_DEPTH] = { NULL };
+	const uint8_t* pdat[HKDS_CACHX8_DEPTH] = { NULL };
+	uint8_t* pout[HKDS_CACHX8_DEPTH] = { NULL };
+	bool valid[HKDS_CACHX8_DEPTH] = { false };
+	size_t glen;
+	size_t spins;
+	size_t op;
+	size_t i;
+
+	op = index >> HKDS_ASYNC_JOB_SHIFT;
+	glen = index & ((1U << HKDS_ASYNC_JOB_SHIFT) - 1U);
+
+	/* the group's requests were claimed before dispatch; a claimed request may still be in the middle of its write */
+	for (i = 0U; i < glen; ++i)
+	{
+		spins = 0U;
+
+		while (hkds_async_ring_pop(&ctx->submissions[op], &req[i]) == false)
+		{
+			hkds_async_backoff(&spins);
+		}
+
+		cmp[i].cookie = req[i].cookie;
+		cmp[i].operation = req[i].operation;
+		pksn[i] = req[i].ksn;
+		pmsg[i] = req[i].message;
+		pdat[i] = req[i].data;
+		pout[i] = cmp[i].output;
+	}
+
+	if (op == (size_t)hkds_async_decrypt)
+	{
+		/* a group holds at least one request, so the batch cannot fail */
+		hkds_server_decrypt_batch(&ctx->state, glen, pksn, pmsg, pout);
+
+		for (i = 0U; i < glen; ++i)
+		{
+			cmp[i].outlen = HKDS_MESSAGE_SIZE;
+			cmp[i].valid = true;
+		}
+	}
+	else if (op == (size_t)hkds_async_decrypt_verify)
+	{
+		hkds_server_decrypt_verify_batch(&ctx->state, glen, pksn, pmsg, pdat, ctx->datalen, pout, valid);
+
+		for (i = 0U; i < glen; ++i)
+		{
+			cmp[i].outlen = (valid[i] == true) ? HKDS_MESSAGE_SIZE : 0U;
+			cmp[i].valid = valid[i];
+		}
+	}
+	else
+	{
+		hkds_server_x8_state gstate;
+		uint8_t etok[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE + HKDS_TAG_SIZE];
+
+		/* the unused lanes of a partial group repeat its first request, and their output is discarded */
+		gstate = ctx->state;
+
+		for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			utils_memory_copy(gstate.ksn[i], req[(i < glen) ? i : 0U].ksn, HKDS_KSN_SIZE);
+		}
+
+		hkds_server_encrypt_token_x8(&gstate, etok);
+
+		for (i = 0U; i < glen; ++i)
+		{
+			utils_memory_copy(cmp[i].output, etok[i], HKDS_STK_SIZE + HKDS_TAG_SIZE);
+			cmp[i].outlen = HKDS_STK_SIZE + HKDS_TAG_SIZE;
+			cmp[i].valid = true;
+		}
+	}
+
+	/* the in-flight bound guarantees space in the completion ring */
+	for (i = 0U; i < glen; ++i)
+	{
+		spins = 0U;
+
+		while (hkds_async_ring_push(&ctx->completions, &cmp[i]) == false)
+		{
+			hkds_async_backoff(&spins);
+		}
+	}
+
+	utils_memory_secure_erase(req, sizeof(req));
+	utils_memory_secure_erase(cmp, sizeof(cmp));
+}
+
+static void hkds_async_dispatch(hkds_async_context* ctx, size_t op, size_t glen)
+{
+	size_t index;
+
+	index = (op << HKDS_ASYNC_JOB_SHIFT) | glen;
+
+	/* if the worker queues are full, the submitting thread processes the group */
+	if (hkds_pool_submit(&ctx->pool, &hkds_async_process, ctx, index) == false)
+	{
+		hkds_async_process(ctx, index);
+	}
+}
+
+bool hkds_async_initialize(hkds_async_engine* engine, hkds_master_key* mdk, size_t depth, size_t threads, size_t datalen)
+{
+	HKDS_ASSERT(engine != NULL);
+	HKDS_ASSERT(mdk != NULL);
+	HKDS_ASSERT(datalen <= HKDS_MESSAGE_SIZE);
+
+	hkds_async_context* ctx;
+	size_t dlen;
+	size_t i;
+	bool res;
+
+	res = false;
+
+	if (engine != NULL && mdk != NULL && datalen <= HKDS_MESSAGE_SIZE)
+	{
+		engine->context = NULL;
+		engine->depth = 0U;
+		dlen = HKDS_ASYNC_MIN_DEPTH;
+
+		while (dlen < depth)
+		{
+			dlen <<= 1U;
+		}
+
+		ctx = (hkds_async_context*)malloc(sizeof(hkds_async_context));
+
+		if (ctx != NULL)
+		{
+			utils_memory_clear(ctx, sizeof(hkds_async_context));
+			res = true;
+
+			/* each ring holds the full in-flight bound, so a write to any ring cannot fail */
+			for (i = 0U; i < (size_t)hkds_async_operation_count; ++i)
+			{
+				res = (hkds_async_ring_initialize(&ctx->submissions[i], dlen, sizeof(hkds_async_request)) == true && res == true);
+				hkds_atomic_store(&ctx->pushed[i], 0U);
+				hkds_atomic_store(&ctx->reserved[i], 0U);
+			}
+
+			res = (hkds_async_ring_initialize(&ctx->completions, dlen, sizeof(hkds_async_completion)) == true && res == true);
+			hkds_atomic_store(&ctx->inflight, 0U);
+			ctx->state.mdk = mdk;
+			ctx->datalen = datalen;
+
+			if (res == true)
+			{
+				res = hkds_pool_initialize(&ctx->pool, threads);
+			}
+
+			if (res == true)
+			{
+				engine->context = ctx;
+				engine->depth = dlen;
+			}
+			else
+			{
+				for (i = 0U; i < (size_t)hkds_async_operation_count; ++i)
+				{
+					hkds_async_ring_dispose(&ctx->submissions[i]);
+				}
+
+				hkds_async_ring_dispose(&ctx->completions);
+				free(ctx);
+			}
+		}
+	}
+
+	return res;
+}
+
+void hkds_async_destroy(hkds_async_engine* engine)
+{
+	HKDS_ASSERT(engine != NULL);
+
+	hkds_async_context* ctx;
+
+	if (engine != NULL && engine->context != NULL)
+	{
+		ctx = engine->context;
+
+		/* process the waiting requests, then join the workers once the queued groups are drained */
+		hkds_async_flush(engine);
+		hkds_pool_destroy(&ctx->pool);
+
+		for (size_t i = 0U; i < (size_t)hkds_async_operation_count; ++i)
+		{
+			hkds_async_ring_dispose(&ctx->submissions[i]);
+		}
+
+		hkds_async_ring_dispose(&ctx->completions);
+		free(ctx);
+
+		engine->context = NULL;
+		engine->depth = 0U;
+	}
+}
+
+bool hkds_async_submit(hkds_async_engine* engine, const hkds_async_request* request)
+{
+	HKDS_ASSERT(engine != NULL);
+	HKDS_ASSERT(request != NULL);
+
+	hkds_async_context* ctx;
+	size_t inflight;
+	size_t op;
+	bool res;
+
+	res = false;
+
+	if (engine != NULL && engine->context != NULL && request != NULL &&
+		(size_t)request->operation < (size_t)hkds_async_operation_count)
+	{
+		ctx = engine->context;
+		op = (size_t)request->operation;
+		inflight = hkds_atomic_load(&ctx->inflight);
+
+		/* admit the request only while the in-flight count is below the ring depth */
+		while (inflight < engine->depth && res == false)
+		{
+			res = hkds_atomic_compare_exchange(&ctx->inflight, &inflight, inflight + 1U);
+		}
+
+		if (res == true)
+		{
+			hkds_async_ring_push(&ctx->submissions[op], request);
+			hkds_atomic_fetch_add(&ctx->pushed[op], 1U);
+
+			if (hkds_async_reserve(ctx, op, HKDS_CACHX8_DEPTH) == HKDS_CACHX8_DEPTH)
+			{
+				hkds_async_dispatch(ctx, op, HKDS_CACHX8_DEPTH);
+			}
+		}
+	}
+
+	return res;
+}
+
+void hkds_async_flush(hkds_async_engine* engine)
+{
+	HKDS_ASSERT(engine != NULL);
+
+	size_t glen;
+
+	if (engine != NULL && engine->context != NULL)
+	{
+		for (size_t i = 0U; i < (size_t)hkds_async_operation_count; ++i)
+		{
+			glen = hkds_async_reserve(engine->context, i, 1U);
+
+			while (glen != 0U)
+			{
+				hkds_async_dispatch(engine->context, i, glen);
+				glen = hkds_async_reserve(engine->context, i, 1U);
+			}
+		}
+	}
+}
+
+size_t hkds_async_complete(hkds_async_engine* engine, hkds_async_completion* completions, size_t count)
+{
+	HKDS_ASSERT(engine != NULL);
+	HKDS_ASSERT(completions != NULL);
+
+	size_t res;
+
+	res = 0U;
+
+	if (engine != NULL && engine->context != NULL && completions != NULL)
+	{
+		while (res < count && hkds_async_ring_pop(&engine->context->completions, &completions[res]) == true)
+		{
+			++res;
+		}
+
+		if (res != 0U)
+		{
+			hkds_atomic_fetch_sub(&engine->context->inflight, res);
+		}
+	}
+
+	return res;
+}
+
+size_t hkds_async_inflight(const hkds_async_engine* engine)
+{
+	HKDS_ASSERT(engine != NULL);
+
+	size_t res;
+
+	res = 0U;
+
+	if (engine != NULL && engine->context != NULL)
+	{
+		res = hkds_atomic_load(&engine->context->inflight);
+	}
+
+	return res;
+}
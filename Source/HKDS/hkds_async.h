@@ -0,0 +1,204 @@
+/* 2021-2026 Quantum Resistant Cryptographic Solutions Corporation
+ * All Rights Reserved.
+ *
+ * NOTICE:
+ * This software and all accompanying materials are the exclusive property of
+ * Quantum Resistant Cryptographic Solutions Corporation (QRCS). The intellectual
+ * and technical concepts contained herein are proprietary to QRCS and are
+ * protected under applicable Canadian, U.S., and international copyright,
+ * patent, and trade secret laws.
+ *
+ * CRYPTOGRAPHIC ALGORITHMS AND IMPLEMENTATIONS:
+ * - This software includes implementations of cryptographic primitives and
+ *   algorithms that are standardized or in the public domain, such as AES
+ *   and SHA-3, which are not proprietary to QRCS.
+ * - This software also includes cryptographic primitives, constructions, and
+ *   algorithms designed by QRCS, including but not limited to RCS, SCB, CSX, QMAC, and
+ *   related components, which are proprietary to QRCS.
+ * - All source code, implementations, protocol compositions, optimizations,
+ *   parameter selections, and engineering work contained in this software are
+ *   original works of QRCS and are protected under this license.
+ *
+ * LICENSE AND USE RESTRICTIONS:
+ * - This software is licensed under the Quantum Resistant Cryptographic Solutions
+ *   Public Research and Evaluation License (QRCS-PREL), 2025-2026.
+ * - Permission is granted solely for non-commercial evaluation, academic research,
+ *   cryptographic analysis, interoperability testing, and feasibility assessment.
+ * - Commercial use, production deployment, commercial redistribution, or
+ *   integration into products or services is strictly prohibited without a
+ *   separate written license agreement executed with QRCS.
+ * - Licensing and authorized distribution are solely at the discretion of QRCS.
+ *
+ * EXPERIMENTAL CRYPTOGRAPHY NOTICE:
+ * Portions of this software may include experimental, novel, or evolving
+ * cryptographic designs. Use of this software is entirely at the user's risk.
+ *
+ * DISCLAIMER:
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE, SECURITY, OR NON-INFRINGEMENT. QRCS DISCLAIMS ALL
+ * LIABILITY FOR ANY DIRECT, INDIRECT, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING FROM THE USE OR MISUSE OF THIS SOFTWARE.
+ *
+ * FULL LICENSE:
+ * This software is subject to the Quantum Resistant Cryptographic Solutions
+ * Public Research and Evaluation License (QRCS-PREL), 2025-2026. The complete license terms
+ * are provided in the accompanying LICENSE file or at https://www.qrcscorp.ca.
+ *
+ * Written by: John G. Underhill
+ * Contact: contact@qrcscorp.ca
+ */
+
+#ifndef HKDS_ASYNC_H
+#define HKDS_ASYNC_H
+
+#include "common.h"
+#include "hkds_config.h"
+#include "hkds_server.h"
+
+/**
+ * \file hkds_async.h
+ * \brief This file contains the HKDS asynchronous server engine definitions.
+ *
+ * \details
+ * This header defines an asynchronous submit and complete interface to the server functions, modelled on a
+ * submission and completion ring pair. A network thread submits decrypt, decrypt-verify, and encrypt-token
+ * requests, each tagged with a caller cookie, and returns to receiving; the engine's worker threads coalesce the
+ * submissions into x8 groups, run the vectorized server functions, and post the results to a completion ring,
+ * where they are collected with their cookies.
+ *
+ * The engine:
+ * - Copies each request into its submission ring, so the caller's receive buffers can be reused immediately.
+ * - Keeps one submission ring per operation, and dispatches a group to a worker as soon as eight requests of the same
+ *   operation are waiting; a partial group is dispatched when the engine is flushed.
+ * - Decrypts and verifies through the batch API, so requests from the same device epoch share a derivation.
+ * - Bounds the number of requests in flight to the ring depth; a submission fails when the bound is reached, until
+ *   completions are collected.
+ * - Uses lock-free rings, so any number of threads may submit requests and collect completions concurrently.
+ *
+ * The engine uses only the master key set; derivation caches are not attached, since they are not synchronized.
+ */
+
+/*!
+ * \def HKDS_ASYNC_OUTPUT_SIZE
+ * \brief The byte size of a completion output; the largest result, an encrypted token with its MAC tag.
+ */
+#define HKDS_ASYNC_OUTPUT_SIZE (HKDS_STK_SIZE + HKDS_TAG_SIZE)
+
+/*! \enum hkds_async_operation
+ * \brief The asynchronous server operations.
+ */
+typedef enum hkds_async_operation
+{
+    hkds_async_decrypt = 0x00U,         /*!< Decrypt a client message */
+    hkds_async_decrypt_verify = 0x01U,  /*!< Verify and decrypt an authenticated client message */
+    hkds_async_encrypt_token = 0x02U,   /*!< Encrypt a token for a client */
+    hkds_async_operation_count = 0x03U  /*!< The number of operations */
+} hkds_async_operation;
+
+/*!
+ * \struct hkds_async_request
+ * \brief An asynchronous server request.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    uint64_t cookie;                                    /*!< The caller cookie returned with the completion */
+    hkds_async_operation operation;                     /*!< The requested operation */
+    uint8_t ksn[HKDS_KSN_SIZE];                         /*!< The client's key serial number */
+    uint8_t message[HKDS_MESSAGE_SIZE + HKDS_TAG_SIZE]; /*!< The cipher-text, and the MAC tag of a decrypt-verify request; unused for a token request */
+    uint8_t data[HKDS_MESSAGE_SIZE];                    /*!< The additional MAC data of a decrypt-verify request */
+} hkds_async_request;
+
+/*!
+ * \struct hkds_async_completion
+ * \brief An asynchronous server completion.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    uint64_t cookie;                            /*!< The cookie of the completed request */
+    hkds_async_operation operation;             /*!< The completed operation */
+    uint8_t output[HKDS_ASYNC_OUTPUT_SIZE];     /*!< The plaintext message, or the encrypted token and its MAC tag */
+    size_t outlen;                              /*!< The number of valid output bytes */
+    bool valid;                                 /*!< False if a decrypt-verify request failed authentication */
+} hkds_async_completion;
+
+/*!
+ * \struct hkds_async_context
+ * \brief The internal engine state; the rings, counters, and worker pool.
+ */
+typedef struct hkds_async_context hkds_async_context;
+
+/*!
+ * \struct hkds_async_engine
+ * \brief Contains an HKDS asynchronous server engine.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    hkds_async_context* context;    /*!< The internal engine state */
+    size_t depth;                   /*!< The maximum number of requests in flight */
+} hkds_async_engine;
+
+/**
+ * \brief Initialize an asynchronous server engine and start its workers.
+ *
+ * \param engine [out] Pointer to the engine.
+ * \param mdk [in] Pointer to the master key set; must remain valid for the life of the engine.
+ * \param depth [in] The maximum number of requests in flight; rounded up to a power of two, and at least eight.
+ * \param threads [in] The number of worker threads; zero selects the number of online processors.
+ * \param datalen [in] The additional MAC data length of every decrypt-verify request; at most \c HKDS_MESSAGE_SIZE bytes.
+ * \return Returns true if the engine was initialized.
+ */
+HKDS_EXPORT_API bool hkds_async_initialize(hkds_async_engine* engine, hkds_master_key* mdk, size_t depth, size_t threads, size_t datalen);
+
+/**
+ * \brief Destroy an asynchronous server engine.
+ *
+ * \details
+ * Waiting requests are processed and the workers are joined; completions that were not collected are discarded.
+ *
+ * \param engine [in/out] Pointer to the engine.
+ */
+HKDS_EXPORT_API void hkds_async_destroy(hkds_async_engine* engine);
+
+/**
+ * \brief Submit a request to the engine.
+ *
+ * \details
+ * The request is copied, and a group is dispatched to the workers if it completes a group of eight waiting
+ * requests of the same operation.
+ *
+ * \param engine [in] Pointer to the engine.
+ * \param request [in] Pointer to the request.
+ * \return Returns false if the engine has the maximum number of requests in flight, or the operation is unknown.
+ */
+HKDS_EXPORT_API bool hkds_async_submit(hkds_async_engine* engine, const hkds_async_request* request);
+
+/**
+ * \brief Dispatch every waiting request, including partial groups.
+ *
+ * \param engine [in] Pointer to the engine.
+ */
+HKDS_EXPORT_API void hkds_async_flush(hkds_async_engine* engine);
+
+/**
+ * \brief Collect completed requests without blocking.
+ *
+ * \param engine [in] Pointer to the engine.
+ * \param completions [out] The array receiving the completions.
+ * \param count [in] The number of elements in the completions array.
+ * \return Returns the number of completions written.
+ */
+HKDS_EXPORT_API size_t hkds_async_complete(hkds_async_engine* engine, hkds_async_completion* completions, size_t count);
+
+/**
+ * \brief Get the number of requests in flight.
+ *
+ * \details
+ * A request is in flight from its submission until its completion has been collected.
+ *
+ * \param engine [in] Pointer to the engine.
+ * \return Returns the number of requests in flight.
+ */
+HKDS_EXPORT_API size_t hkds_async_inflight(const hkds_async_engine* engine);
+
+#endif
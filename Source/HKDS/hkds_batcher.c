@@ -0,0 +1,203 @@
+#include "hkds_batcher.h"
+#include "utils.h"
+
+static void hkds_batcher_decrypt_scalar(const hkds_batcher_state* batcher, const uint8_t* const* ksn, const uint8_t* const* ciphertext,
+	uint8_t plaintext[][HKDS_MESSAGE_SIZE], size_t count)
+{
+	hkds_server_state ss;
+
+	/* the scalar path serves a small partial group one request at a time */
+	for (size_t i = 0U; i < count; ++i)
+	{
+		hkds_server_initialize_state(&ss, batcher->server->mdk, ksn[i]);
+		hkds_server_set_edk_table(&ss, batcher->server->edktable);
+		hkds_server_set_token_memo(&ss, batcher->server->tokenmemo);
+		hkds_server_decrypt_message(&ss, ciphertext[i], plaintext[i]);
+	}
+
+	utils_memory_secure_erase((uint8_t*)&ss, sizeof(ss));
+}
+
+static size_t hkds_batcher_dispatch(hkds_batcher_state* batcher, size_t count, hkds_batcher_path path)
+{
+	uint8_t pln[HKDS_CACHX64_SIZE][HKDS_MESSAGE_SIZE];
+	const uint8_t* pksn[HKDS_CACHX64_SIZE];
+	const uint8_t* pcpt[HKDS_CACHX64_SIZE];
+	uint8_t* ppln[HKDS_CACHX64_SIZE];
+	hkds_queue_view view;
+	size_t res;
+
+	res = 0U;
+
+	if (hkds_message_queue_acquire(batcher->queue, &view, count) == true)
+	{
+		/* the requests are read in place from the queue slots */
+		hkds_message_queue_view_pointers(&view, 0U, pksn);
+		hkds_message_queue_view_pointers(&view, HKDS_KSN_SIZE, pcpt);
+
+		for (size_t i = 0U; i < count; ++i)
+		{
+			ppln[i] = pln[i];
+		}
+
+		if (path == hkds_batcher_path_scalar)
+		{
+			hkds_batcher_decrypt_scalar(batcher, pksn, pcpt, pln, count);
+		}
+		else
+		{
+			hkds_server_decrypt_batch(batcher->server, count, pksn, pcpt, ppln);
+		}
+
+		batcher->complete(batcher->context, pksn, (const uint8_t (*)[HKDS_MESSAGE_SIZE])pln, count);
+		utils_memory_secure_erase((uint8_t*)pln, count * HKDS_MESSAGE_SIZE);
+		hkds_message_queue_release(batcher->queue, &view);
+		++batcher->dispatches[path];
+		res = count;
+	}
+
+	return res;
+}
+
+bool hkds_batcher_initialize(hkds_batcher_state* batcher, hkds_message_queue_state* queue, const hkds_server_x8_state* server,
+	hkds_batcher_complete complete, void* context)
+{
+	HKDS_ASSERT(batcher != NULL);
+	HKDS_ASSERT(queue != NULL);
+	HKDS_ASSERT(server != NULL);
+	HKDS_ASSERT(complete != NULL);
+
+	bool res;
+
+	res = false;
+
+	if (batcher != NULL && queue != NULL && server != NULL && server->mdk != NULL && complete != NULL)
+	{
+		if (queue->state.depth >= HKDS_CACHX64_SIZE && queue->state.width >= HKDS_BATCHER_ITEM_SIZE)
+		{
+			batcher->queue = queue;
+			batcher->server = server;
+			batcher->complete = complete;
+			batcher->context = context;
+			batcher->budget = HKDS_BATCHER_DEFAULT_BUDGET;
+			batcher->scalarlimit = HKDS_BATCHER_DEFAULT_SCALAR_LIMIT;
+			utils_memory_clear((uint8_t*)batcher->dispatches, sizeof(batcher->dispatches));
+			res = true;
+		}
+	}
+
+	return res;
+}
+
+void hkds_batcher_set_budget(hkds_batcher_state* batcher, uint64_t budget, size_t scalarlimit)
+{
+	HKDS_ASSERT(batcher != NULL);
+	HKDS_ASSERT(scalarlimit < HKDS_CACHX8_DEPTH);
+
+	if (batcher != NULL)
+	{
+		batcher->budget = budget;
+		batcher->scalarlimit = (scalarlimit < HKDS_CACHX8_DEPTH) ? scalarlimit : HKDS_CACHX8_DEPTH - 1U;
+	}
+}
+
+bool hkds_batcher_submit(hkds_batcher_state* batcher, const uint8_t* ksn, const uint8_t* ciphertext, uint64_t now)
+{
+	HKDS_ASSERT(batcher != NULL);
+	HKDS_ASSERT(ksn != NULL);
+	HKDS_ASSERT(ciphertext != NULL);
+
+	uint8_t item[HKDS_BATCHER_ITEM_SIZE];
+	bool res;
+
+	res = false;
+
+	if (batcher != NULL && ksn != NULL && ciphertext != NULL)
+	{
+		utils_memory_copy(item, ksn, HKDS_KSN_SIZE);
+		utils_memory_copy(item + HKDS_KSN_SIZE, ciphertext, HKDS_MESSAGE_SIZE);
+		/* the slot tag carries the arrival time */
+		res = hkds_message_queue_push_tagged(batcher->queue, item, sizeof(item), now);
+		utils_memory_secure_erase(item, sizeof(item));
+	}
+
+	return res;
+}
+
+size_t hkds_batcher_poll(hkds_batcher_state* batcher, uint64_t now)
+{
+	HKDS_ASSERT(batcher != NULL);
+
+	hkds_batcher_path path;
+	uint64_t arrival;
+	size_t count;
+	size_t dlen;
+	size_t res;
+
+	res = 0U;
+
+	if (batcher != NULL)
+	{
+		while (res < batcher->queue->state.depth)
+		{
+			count = hkds_message_queue_count(batcher->queue);
+
+			if (count >= HKDS_CACHX64_SIZE)
+			{
+				count = HKDS_CACHX64_SIZE;
+				path = hkds_batcher_path_x64;
+			}
+			else if (count >= HKDS_CACHX8_DEPTH)
+			{
+				count &= ~(size_t)(HKDS_CACHX8_DEPTH - 1U);
+				path = hkds_batcher_path_x8;
+			}
+			else if (count != 0U && hkds_message_queue_peek_tag(batcher->queue, &arrival) == true &&
+				(batcher->budget == 0U || (now >= arrival && now - arrival >= batcher->budget)))
+			{
+				/* the oldest request has used its budget; the partial group is dispatched */
+				path = (count <= batcher->scalarlimit) ? hkds_batcher_path_scalar : hkds_batcher_path_partial;
+			}
+			else
+			{
+				break;
+			}
+
+			dlen = hkds_batcher_dispatch(batcher, count, path);
+
+			if (dlen == 0U)
+			{
+				/* the counted items have been reserved but not yet published */
+				break;
+			}
+
+			res += dlen;
+		}
+	}
+
+	return res;
+}
+
+uint64_t hkds_batcher_deadline(const hkds_batcher_state* batcher, uint64_t now)
+{
+	HKDS_ASSERT(batcher != NULL);
+
+	uint64_t arrival;
+	uint64_t res;
+
+	res = UINT64_MAX;
+
+	if (batcher != NULL && hkds_message_queue_peek_tag(batcher->queue, &arrival) == true)
+	{
+		if (hkds_message_queue_count(batcher->queue) >= HKDS_CACHX8_DEPTH || now >= arrival + batcher->budget)
+		{
+			res = 0U;
+		}
+		else
+		{
+			res = (arrival + batcher->budget) - now;
+		}
+	}
+
+	return res;
+}
@@ -0,0 +1,195 @@
+/* 2021-2026 Quantum Resistant Cryptographic Solutions Corporation
+ * All Rights Reserved.
+ *
+ * NOTICE:
+ * This software and all accompanying materials are the exclusive property of
+ * Quantum Resistant Cryptographic Solutions Corporation (QRCS). The intellectual
+ * and technical concepts contained herein are proprietary to QRCS and are
+ * protected under applicable Canadian, U.S., and international copyright,
+ * patent, and trade secret laws.
+ *
+ * CRYPTOGRAPHIC ALGORITHMS AND IMPLEMENTATIONS:
+ * - This software includes implementations of cryptographic primitives and
+ *   algorithms that are standardized or in the public domain, such as AES
+ *   and SHA-3, which are not proprietary to QRCS.
+ * - This software also includes cryptographic primitives, constructions, and
+ *   algorithms designed by QRCS, including but not limited to RCS, SCB, CSX, QMAC, and
+ *   related components, which are proprietary to QRCS.
+ * - All source code, implementations, protocol compositions, optimizations,
+ *   parameter selections, and engineering work contained in this software are
+ *   original works of QRCS and are protected under this license.
+ *
+ * LICENSE AND USE RESTRICTIONS:
+ * - This software is licensed under the Quantum Resistant Cryptographic Solutions
+ *   Public Research and Evaluation License (QRCS-PREL), 2025-2026.
+ * - Permission is granted solely for non-commercial evaluation, academic research,
+ *   cryptographic analysis, interoperability testing, and feasibility assessment.
+ * - Commercial use, production deployment, commercial redistribution, or
+ *   integration into products or services is strictly prohibited without a
+ *   separate written license agreement executed with QRCS.
+ * - Licensing and authorized distribution are solely at the discretion of QRCS.
+ *
+ * EXPERIMENTAL CRYPTOGRAPHY NOTICE:
+ * Portions of this software may include experimental, novel, or evolving
+ * cryptographic designs. Use of this software is entirely at the user's risk.
+ *
+ * DISCLAIMER:
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE, SECURITY, OR NON-INFRINGEMENT. QRCS DISCLAIMS ALL
+ * LIABILITY FOR ANY DIRECT, INDIRECT, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING FROM THE USE OR MISUSE OF THIS SOFTWARE.
+ *
+ * FULL LICENSE:
+ * This software is subject to the Quantum Resistant Cryptographic Solutions
+ * Public Research and Evaluation License (QRCS-PREL), 2025-2026. The complete license terms
+ * are provided in the accompanying LICENSE file or at https://www.qrcscorp.ca.
+ *
+ * Written by: John G. Underhill
+ * Contact: contact@qrcscorp.ca
+ */
+
+#ifndef HKDS_BATCHER_H
+#define HKDS_BATCHER_H
+
+#include "common.h"
+#include "hkds_config.h"
+#include "hkds_queue.h"
+#include "hkds_server.h"
+
+/**
+ * \file hkds_batcher.h
+ * \brief This file contains the HKDS adaptive batch scheduler definitions.
+ *
+ * \details
+ * This header defines a batch scheduler that sits between a message queue of client requests and the server
+ * decryption functions, and decides when, and at what width, the queued requests are decrypted. Each request is
+ * stamped with its arrival time when it is submitted. A poll of the scheduler:
+ * - Dispatches 64 requests to the batch function as soon as they are queued, so the eight x8 groups can be spread
+ *   across the attached thread pool.
+ * - Otherwise dispatches the queued requests in whole groups of eight as soon as one group is complete.
+ * - Dispatches the remaining partial group once the oldest request has waited for the latency budget; a partial
+ *   group larger than the scalar limit runs on the x8 kernels with its unused lanes masked, and a smaller one is
+ *   decrypted with the scalar functions.
+ *
+ * Under load, requests arrive faster than groups complete and every request is decrypted in a full group, while at
+ * low load no request waits longer than the budget plus the polling interval.
+ * The decrypted messages are passed to a completion callback with the key serial numbers of their requests, which are
+ * read in place from the queue slots.
+ *
+ * The queue may have any number of producers, but the scheduler must be its only consumer.
+ */
+
+/*!
+ * \def HKDS_BATCHER_ITEM_SIZE
+ * \brief The byte size of a queued request; the client's key serial number followed by the cipher-text.
+ */
+#define HKDS_BATCHER_ITEM_SIZE (HKDS_KSN_SIZE + HKDS_MESSAGE_SIZE)
+
+/*!
+ * \def HKDS_BATCHER_DEFAULT_BUDGET
+ * \brief The default latency budget in microseconds.
+ */
+#define HKDS_BATCHER_DEFAULT_BUDGET 500U
+
+/*!
+ * \def HKDS_BATCHER_DEFAULT_SCALAR_LIMIT
+ * \brief The default largest partial group decrypted with the scalar functions.
+ */
+#define HKDS_BATCHER_DEFAULT_SCALAR_LIMIT 2U
+
+/*! \enum hkds_batcher_path
+ * \brief The decryption paths chosen by the scheduler.
+ */
+typedef enum hkds_batcher_path
+{
+    hkds_batcher_path_scalar = 0x00U,   /*!< A small partial group, decrypted one request at a time */
+    hkds_batcher_path_partial = 0x01U,  /*!< A partial group on the x8 kernels with masked lanes */
+    hkds_batcher_path_x8 = 0x02U,       /*!< One or more full groups of eight */
+    hkds_batcher_path_x64 = 0x03U,      /*!< Eight full groups */
+    hkds_batcher_path_count = 0x04U     /*!< The number of paths */
+} hkds_batcher_path;
+
+/*!
+ * \typedef hkds_batcher_complete
+ * \brief The completion callback; receives the key serial numbers and the decrypted messages of a dispatch.
+ *
+ * The key serial number pointers refer to the queue slots and the messages to scheduler memory; both are erased
+ * when the callback returns.
+ */
+typedef void (*hkds_batcher_complete)(void* context, const uint8_t* const* ksn, const uint8_t plaintext[][HKDS_MESSAGE_SIZE], size_t count);
+
+/*!
+ * \struct hkds_batcher_state
+ * \brief Contains the batch scheduler state.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    hkds_message_queue_state* queue;                /*!< The request queue; items are \c HKDS_BATCHER_ITEM_SIZE bytes wide */
+    const hkds_server_x8_state* server;             /*!< The template server state; supplies the master key set, caches, and pool */
+    hkds_batcher_complete complete;                 /*!< The completion callback */
+    void* context;                                  /*!< The caller context passed to the callback */
+    uint64_t budget;                                /*!< The latency budget of a request in microseconds */
+    size_t scalarlimit;                             /*!< The largest partial group decrypted with the scalar functions */
+    uint64_t dispatches[hkds_batcher_path_count];   /*!< The number of dispatches on each path */
+} hkds_batcher_state;
+
+/**
+ * \brief Initialize a batch scheduler.
+ *
+ * \param batcher [out] Pointer to the scheduler state.
+ * \param queue [in] Pointer to an initialized request queue, at least 64 items deep and \c HKDS_BATCHER_ITEM_SIZE bytes wide.
+ * \param server [in] Pointer to the template server state; its KSN array is not used.
+ * \param complete [in] The completion callback.
+ * \param context [in] The [optional] caller context passed to the callback.
+ * \return Returns false if the queue is too small or narrow, or a parameter is missing.
+ */
+HKDS_EXPORT_API bool hkds_batcher_initialize(hkds_batcher_state* batcher, hkds_message_queue_state* queue, const hkds_server_x8_state* server,
+    hkds_batcher_complete complete, void* context);
+
+/**
+ * \brief Set the latency budget and the scalar limit.
+ *
+ * \param batcher [in,out] Pointer to the scheduler state.
+ * \param budget [in] The longest time a request may wait for a full group, in microseconds; zero dispatches at every poll.
+ * \param scalarlimit [in] The largest partial group decrypted with the scalar functions; at most seven.
+ */
+HKDS_EXPORT_API void hkds_batcher_set_budget(hkds_batcher_state* batcher, uint64_t budget, size_t scalarlimit);
+
+/**
+ * \brief Queue a client request, stamped with its arrival time.
+ *
+ * \param batcher [in] Pointer to the scheduler state.
+ * \param ksn [in] The client's key serial number.
+ * \param ciphertext [in] The encrypted message.
+ * \param now [in] The current monotonic time in microseconds.
+ * \return Returns false if the queue is full.
+ */
+HKDS_EXPORT_API bool hkds_batcher_submit(hkds_batcher_state* batcher, const uint8_t* ksn, const uint8_t* ciphertext, uint64_t now);
+
+/**
+ * \brief Dispatch every group that is ready.
+ *
+ * \details
+ * Full groups are dispatched first; a partial group is dispatched if its oldest request has waited for the budget.
+ * A poll processes at most one queue depth of requests, so a stream of arrivals cannot hold the caller indefinitely.
+ *
+ * \param batcher [in,out] Pointer to the scheduler state.
+ * \param now [in] The current monotonic time in microseconds.
+ * \return Returns the number of requests decrypted.
+ */
+HKDS_EXPORT_API size_t hkds_batcher_poll(hkds_batcher_state* batcher, uint64_t now);
+
+/**
+ * \brief Get the time until the oldest queued request reaches its budget.
+ *
+ * \details
+ * An event loop can use the result as its wait timeout, so a partial group is dispatched on time.
+ *
+ * \param batcher [in] Pointer to the scheduler state.
+ * \param now [in] The current monotonic time in microseconds.
+ * \return Returns the remaining time in microseconds, zero if a group is ready, or \c UINT64_MAX if the queue is empty.
+ */
+HKDS_EXPORT_API uint64_t hkds_batcher_deadline(const hkds_batcher_state* batcher, uint64_t now);
+
+#endif
@@ -0,0 +1,706 @@
+#include "hkds_cache.h"
+#include "utils.h"
+
+/*!
+ * \def HKDS_CACHE_ALIGNMENT
+ * \brief The internal memory alignment constant.
+ */
+#define HKDS_CACHE_ALIGNMENT 64U
+
+/*!
+ * \def HKDS_CACHE_LOAD_FACTOR
+ * \brief The number of index slots allocated per cache entry.
+ */
+#define HKDS_CACHE_LOAD_FACTOR 2U
+
+/* open-addressed index */
+
+static uint64_t hkds_cache_mix(uint64_t x)
+{
+	/* 64-bit finalization mixer */
+	x ^= x >> 30U;
+	x *= 0xBF58476D1CE4E5B9ULL;
+	x ^= x >> 27U;
+	x *= 0x94D049BB133111EBULL;
+	x ^= x >> 31U;
+
+	return x;
+}
+
+static size_t hkds_cache_index_home(const hkds_cache_index* index, const uint8_t* did, uint32_t epoch)
+{
+	uint64_t h;
+
+	h = hkds_cache_mix(index->seed ^ utils_integer_le8to64(did));
+	h = hkds_cache_mix(h ^ (((uint64_t)utils_integer_be8to32(did + sizeof(uint64_t)) << 32U) | (uint64_t)epoch));
+
+	return (size_t)h & index->mask;
+}
+
+static size_t hkds_cache_index_size(size_t capacity)
+{
+	size_t slen;
+
+	slen = 1U;
+
+	while (slen < capacity * HKDS_CACHE_LOAD_FACTOR)
+	{
+		slen <<= 1U;
+	}
+
+	return slen;
+}
+
+static const hkds_cache_key* hkds_cache_index_key(const void* entries, size_t stride, uint32_t sval)
+{
+	/* every entry type begins with its cache key */
+	return (const hkds_cache_key*)((const uint8_t*)entries + (((size_t)sval - 1U) * stride));
+}
+
+static bool hkds_cache_index_initialize(hkds_cache_index* index, size_t capacity)
+{
+	uint8_t seed[sizeof(uint64_t)] = { 0U };
+	size_t slen;
+	bool res;
+
+	res = false;
+
+	if (utils_seed_generate(seed, sizeof(seed)) == true)
+	{
+		slen = hkds_cache_index_size(capacity);
+		index->slots = (uint32_t*)utils_memory_aligned_alloc(HKDS_CACHE_ALIGNMENT, slen * sizeof(uint32_t));
+
+		if (index->slots != NULL)
+		{
+			utils_memory_clear(index->slots, slen * sizeof(uint32_t));
+			index->mask = slen - 1U;
+			index->seed = utils_integer_le8to64(seed);
+			res = true;
+		}
+	}
+
+	utils_memory_secure_erase(seed, sizeof(seed));
+
+	return res;
+}
+
+static void hkds_cache_index_dispose(hkds_cache_index* index)
+{
+	if (index->slots != NULL)
+	{
+		utils_memory_clear(index->slots, (index->mask + 1U) * sizeof(uint32_t));
+		utils_memory_aligned_free(index->slots);
+	}
+
+	utils_memory_secure_erase(index, sizeof(hkds_cache_index));
+}
+
+static size_t hkds_cache_index_locate(const hkds_cache_index* index, const void* entries, size_t stride, const uint8_t* did, uint32_t epoch)
+{
+	const hkds_cache_key* key;
+	size_t pos;
+	uint32_t sval;
+
+	pos = hkds_cache_index_home(index, did, epoch);
+
+	/* linear probe until the key or an empty slot is found */
+	while (true)
+	{
+		sval = index->slots[pos];
+
+		if (sval == 0U)
+		{
+			break;
+		}
+
+		key = hkds_cache_index_key(entries, stride, sval);
+
+		if (key->epoch == epoch && utils_memory_are_equal(key->did, did, HKDS_DID_SIZE) == true)
+		{
+			break;
+		}
+
+		pos = (pos + 1U) & index->mask;
+	}
+
+	return pos;
+}
+
+static void hkds_cache_index_remove(hkds_cache_index* index, const void* entries, size_t stride, size_t pos)
+{
+	const hkds_cache_key* key;
+	size_t home;
+	size_t next;
+
+	index->slots[pos] = 0U;
+	next = (pos + 1U) & index->mask;
+
+	/* backward-shift the following probe run so no tombstones are required */
+	while (index->slots[next] != 0U)
+	{
+		key = hkds_cache_index_key(entries, stride, index->slots[next]);
+		home = hkds_cache_index_home(index, key->did, key->epoch);
+
+		if (((next - home) & index->mask) >= ((next - pos) & index->mask))
+		{
+			index->slots[pos] = index->slots[next];
+			index->slots[next] = 0U;
+			pos = next;
+		}
+
+		next = (next + 1U) & index->mask;
+	}
+}
+
+/* keystream cache */
+
+static size_t hkds_keystream_cache_evict(hkds_keystream_cache* cache)
+{
+	const hkds_keystream_entry* entry;
+	size_t eidx;
+
+	/* advance the clock hand, clearing reference bits, until an unreferenced entry is found */
+	while (cache->entries[cache->hand].referenced == true)
+	{
+		cache->entries[cache->hand].referenced = false;
+		cache->hand = (cache->hand + 1U) % cache->capacity;
+	}
+
+	eidx = cache->hand;
+	cache->hand = (cache->hand + 1U) % cache->capacity;
+
+	entry = &cache->entries[eidx];
+	hkds_cache_index_remove(&cache->index, cache->entries, sizeof(hkds_keystream_entry),
+		hkds_cache_index_locate(&cache->index, cache->entries, sizeof(hkds_keystream_entry), entry->key.did, entry->key.epoch));
+	utils_memory_secure_erase(&cache->entries[eidx], sizeof(hkds_keystream_entry));
+
+	return eidx;
+}
+
+bool hkds_keystream_cache_initialize(hkds_keystream_cache* cache, const uint8_t* kid, size_t maxmem)
+{
+	HKDS_ASSERT(cache != NULL);
+	HKDS_ASSERT(kid != NULL);
+
+	size_t capacity;
+	bool res;
+
+	res = false;
+
+	if (cache != NULL && kid != NULL)
+	{
+		utils_memory_clear(cache, sizeof(hkds_keystream_cache));
+		capacity = maxmem / (sizeof(hkds_keystream_entry) + (HKDS_CACHE_LOAD_FACTOR * sizeof(uint32_t)));
+
+		/* the index stores entry positions in 32 bits */
+		if (capacity > UINT32_MAX / HKDS_CACHE_LOAD_FACTOR)
+		{
+			capacity = UINT32_MAX / HKDS_CACHE_LOAD_FACTOR;
+		}
+
+		/* shrink until the power-of-two index also fits the ceiling */
+		while (capacity != 0U && (capacity * sizeof(hkds_keystream_entry)) + (hkds_cache_index_size(capacity) * sizeof(uint32_t)) > maxmem)
+		{
+			--capacity;
+		}
+
+		if (capacity != 0U)
+		{
+			cache->entries = (hkds_keystream_entry*)utils_memory_aligned_alloc(HKDS_CACHE_ALIGNMENT, capacity * sizeof(hkds_keystream_entry));
+
+			if (cache->entries != NULL && hkds_cache_index_initialize(&cache->index, capacity) == true)
+			{
+				utils_memory_clear(cache->entries, capacity * sizeof(hkds_keystream_entry));
+				utils_memory_copy(cache->kid, kid, HKDS_KID_SIZE);
+				cache->capacity = capacity;
+				res = true;
+			}
+			else
+			{
+				hkds_keystream_cache_destroy(cache);
+			}
+		}
+	}
+
+	return res;
+}
+
+void hkds_keystream_cache_destroy(hkds_keystream_cache* cache)
+{
+	HKDS_ASSERT(cache != NULL);
+
+	if (cache != NULL)
+	{
+		if (cache->entries != NULL)
+		{
+			utils_memory_secure_erase(cache->entries, cache->capacity * sizeof(hkds_keystream_entry));
+			utils_memory_aligned_free(cache->entries);
+		}
+
+		hkds_cache_index_dispose(&cache->index);
+		utils_memory_secure_erase(cache, sizeof(hkds_keystream_cache));
+	}
+}
+
+void hkds_keystream_cache_clear(hkds_keystream_cache* cache)
+{
+	HKDS_ASSERT(cache != NULL);
+
+	if (cache != NULL && cache->entries != NULL && cache->index.slots != NULL)
+	{
+		utils_memory_secure_erase(cache->entries, cache->capacity * sizeof(hkds_keystream_entry));
+		utils_memory_clear(cache->index.slots, (cache->index.mask + 1U) * sizeof(uint32_t));
+		cache->count = 0U;
+		cache->hand = 0U;
+	}
+}
+
+hkds_keystream_entry* hkds_keystream_cache_find(hkds_keystream_cache* cache, const uint8_t* did, uint32_t epoch)
+{
+	HKDS_ASSERT(cache != NULL);
+	HKDS_ASSERT(did != NULL);
+
+	hkds_keystream_entry* entry;
+	size_t pos;
+
+	entry = NULL;
+
+	if (cache != NULL && cache->index.slots != NULL && did != NULL)
+	{
+		pos = hkds_cache_index_locate(&cache->index, cache->entries, sizeof(hkds_keystream_entry), did, epoch);
+
+		if (cache->index.slots[pos] != 0U)
+		{
+			entry = &cache->entries[cache->index.slots[pos] - 1U];
+			entry->referenced = true;
+			++cache->hits;
+		}
+		else
+		{
+			++cache->misses;
+		}
+	}
+
+	return entry;
+}
+
+hkds_keystream_entry* hkds_keystream_cache_insert(hkds_keystream_cache* cache, const uint8_t* did, uint32_t epoch, const uint8_t* key, size_t keylen)
+{
+	HKDS_ASSERT(cache != NULL);
+	HKDS_ASSERT(did != NULL);
+	HKDS_ASSERT(key != NULL);
+
+	hkds_keystream_entry* entry;
+	size_t eidx;
+	size_t pos;
+
+	entry = NULL;
+
+	if (cache != NULL && cache->entries != NULL && did != NULL && key != NULL)
+	{
+		pos = hkds_cache_index_locate(&cache->index, cache->entries, sizeof(hkds_keystream_entry), did, epoch);
+
+		if (cache->index.slots[pos] != 0U)
+		{
+			/* the epoch is already cached; re-key it in place */
+			eidx = (size_t)cache->index.slots[pos] - 1U;
+			utils_memory_secure_erase(&cache->entries[eidx], sizeof(hkds_keystream_entry));
+		}
+		else
+		{
+			if (cache->count < cache->capacity)
+			{
+				eidx = cache->count;
+				++cache->count;
+			}
+			else
+			{
+				eidx = hkds_keystream_cache_evict(cache);
+				/* eviction may have shifted the probe run */
+				pos = hkds_cache_index_locate(&cache->index, cache->entries, sizeof(hkds_keystream_entry), did, epoch);
+			}
+
+			cache->index.slots[pos] = (uint32_t)(eidx + 1U);
+		}
+
+		entry = &cache->entries[eidx];
+		utils_memory_copy(entry->key.did, did, HKDS_DID_SIZE);
+		entry->key.epoch = epoch;
+		entry->nblocks = 0U;
+		entry->referenced = false;
+
+#if defined(HKDS_SHAKE_128)
+		hkds_shake_initialize(&entry->kstate, hkds_keccak_rate_128, key, keylen);
+#elif defined(HKDS_SHAKE_256)
+		hkds_shake_initialize(&entry->kstate, hkds_keccak_rate_256, key, keylen);
+#else
+		hkds_shake_initialize(&entry->kstate, hkds_keccak_rate_512, key, keylen);
+#endif
+	}
+
+	return entry;
+}
+
+bool hkds_keystream_cache_extract(hkds_keystream_entry* entry, size_t offset, uint8_t* output, size_t outlen)
+{
+	HKDS_ASSERT(entry != NULL);
+	HKDS_ASSERT(output != NULL);
+
+	size_t nblocks;
+	bool res;
+
+	res = false;
+
+	if (entry != NULL && output != NULL && offset + outlen <= HKDS_KEYSTREAM_CACHE_SIZE)
+	{
+		/* squeeze only the blocks not yet generated */
+		nblocks = (offset + outlen + HKDS_PRF_RATE - 1U) / HKDS_PRF_RATE;
+
+		if (nblocks > entry->nblocks)
+		{
+#if defined(HKDS_SHAKE_128)
+			hkds_shake_squeezeblocks(&entry->kstate, hkds_keccak_rate_128, entry->skey + (entry->nblocks * HKDS_PRF_RATE), nblocks - entry->nblocks);
+#elif defined(HKDS_SHAKE_256)
+			hkds_shake_squeezeblocks(&entry->kstate, hkds_keccak_rate_256, entry->skey + (entry->nblocks * HKDS_PRF_RATE), nblocks - entry->nblocks);
+#else
+			hkds_shake_squeezeblocks(&entry->kstate, hkds_keccak_rate_512, entry->skey + (entry->nblocks * HKDS_PRF_RATE), nblocks - entry->nblocks);
+#endif
+			entry->nblocks = nblocks;
+		}
+
+		utils_memory_copy(output, entry->skey + offset, outlen);
+		res = true;
+	}
+
+	return res;
+}
+
+/* embedded device key table */
+
+bool hkds_edk_table_initialize(hkds_edk_table* table, const uint8_t* kid, size_t capacity)
+{
+	HKDS_ASSERT(table != NULL);
+	HKDS_ASSERT(kid != NULL);
+	HKDS_ASSERT(capacity != 0U);
+
+	bool res;
+
+	res = false;
+
+	if (table != NULL && kid != NULL && capacity != 0U && capacity <= UINT32_MAX / HKDS_CACHE_LOAD_FACTOR)
+	{
+		utils_memory_clear(table, sizeof(hkds_edk_table));
+		table->entries = (hkds_edk_entry*)utils_memory_aligned_alloc(HKDS_CACHE_ALIGNMENT, capacity * sizeof(hkds_edk_entry));
+
+		if (table->entries != NULL && hkds_cache_index_initialize(&table->index, capacity) == true)
+		{
+			utils_memory_clear(table->entries, capacity * sizeof(hkds_edk_entry));
+			utils_memory_copy(table->kid, kid, HKDS_KID_SIZE);
+			table->capacity = capacity;
+			res = true;
+		}
+		else
+		{
+			hkds_edk_table_destroy(table);
+		}
+	}
+
+	return res;
+}
+
+void hkds_edk_table_destroy(hkds_edk_table* table)
+{
+	HKDS_ASSERT(table != NULL);
+
+	if (table != NULL)
+	{
+		if (table->entries != NULL)
+		{
+			utils_memory_secure_erase(table->entries, table->capacity * sizeof(hkds_edk_entry));
+			utils_memory_aligned_free(table->entries);
+		}
+
+		hkds_cache_index_dispose(&table->index);
+		utils_memory_secure_erase(table, sizeof(hkds_edk_table));
+	}
+}
+
+void hkds_edk_table_clear(hkds_edk_table* table)
+{
+	HKDS_ASSERT(table != NULL);
+
+	if (table != NULL && table->entries != NULL && table->index.slots != NULL)
+	{
+		utils_memory_secure_erase(table->entries, table->capacity * sizeof(hkds_edk_entry));
+		utils_memory_clear(table->index.slots, (table->index.mask + 1U) * sizeof(uint32_t));
+		table->count = 0U;
+	}
+}
+
+const uint8_t* hkds_edk_table_find(const hkds_edk_table* table, const uint8_t* did)
+{
+	HKDS_ASSERT(table != NULL);
+	HKDS_ASSERT(did != NULL);
+
+	const uint8_t* edk;
+	size_t pos;
+
+	edk = NULL;
+
+	if (table != NULL && table->index.slots != NULL && did != NULL)
+	{
+		pos = hkds_cache_index_locate(&table->index, table->entries, sizeof(hkds_edk_entry), did, 0U);
+
+		if (table->index.slots[pos] != 0U)
+		{
+			edk = table->entries[table->index.slots[pos] - 1U].edk;
+		}
+	}
+
+	return edk;
+}
+
+bool hkds_edk_table_insert(hkds_edk_table* table, const uint8_t* did, const uint8_t* edk)
+{
+	HKDS_ASSERT(table != NULL);
+	HKDS_ASSERT(did != NULL);
+	HKDS_ASSERT(edk != NULL);
+
+	hkds_edk_entry* entry;
+	size_t pos;
+	bool res;
+
+	res = false;
+
+	if (table != NULL && table->entries != NULL && did != NULL && edk != NULL)
+	{
+		pos = hkds_cache_index_locate(&table->index, table->entries, sizeof(hkds_edk_entry), did, 0U);
+		entry = NULL;
+
+		if (table->index.slots[pos] != 0U)
+		{
+			entry = &table->entries[table->index.slots[pos] - 1U];
+		}
+		else if (table->count < table->capacity)
+		{
+			entry = &table->entries[table->count];
+			utils_memory_copy(entry->key.did, did, HKDS_DID_SIZE);
+			entry->key.epoch = 0U;
+			++table->count;
+			table->index.slots[pos] = (uint32_t)table->count;
+		}
+
+		if (entry != NULL)
+		{
+			utils_memory_copy(entry->edk, edk, HKDS_EDK_SIZE);
+			res = true;
+		}
+	}
+
+	return res;
+}
+
+/* epoch token memo */
+
+static void hkds_token_memo_remove(hkds_token_memo* memo, size_t eidx)
+{
+	const hkds_token_entry* entry;
+
+	entry = &memo->entries[eidx];
+
+	if (entry->used == true)
+	{
+		hkds_cache_index_remove(&memo->index, memo->entries, sizeof(hkds_token_entry),
+			hkds_cache_index_locate(&memo->index, memo->entries, sizeof(hkds_token_entry), entry->key.did, entry->key.epoch));
+		utils_memory_secure_erase(&memo->entries[eidx], sizeof(hkds_token_entry));
+		--memo->count;
+	}
+}
+
+static bool hkds_token_memo_expired(const hkds_token_memo* memo, const hkds_token_entry* entry, uint64_t now)
+{
+	return (memo->ttl != 0U && now >= entry->expiry);
+}
+
+bool hkds_token_memo_initialize(hkds_token_memo* memo, const uint8_t* kid, size_t capacity, uint64_t ttl)
+{
+	HKDS_ASSERT(memo != NULL);
+	HKDS_ASSERT(kid != NULL);
+	HKDS_ASSERT(capacity != 0U);
+
+	bool res;
+
+	res = false;
+
+	if (memo != NULL && kid != NULL && capacity != 0U && capacity <= UINT32_MAX / HKDS_CACHE_LOAD_FACTOR)
+	{
+		utils_memory_clear(memo, sizeof(hkds_token_memo));
+		memo->entries = (hkds_token_entry*)utils_memory_aligned_alloc(HKDS_CACHE_ALIGNMENT, capacity * sizeof(hkds_token_entry));
+
+		if (memo->entries != NULL && hkds_cache_index_initialize(&memo->index, capacity) == true)
+		{
+			utils_memory_clear(memo->entries, capacity * sizeof(hkds_token_entry));
+			utils_memory_copy(memo->kid, kid, HKDS_KID_SIZE);
+			memo->capacity = capacity;
+			memo->ttl = ttl * 1000U;
+			res = true;
+		}
+		else
+		{
+			hkds_token_memo_destroy(memo);
+		}
+	}
+
+	return res;
+}
+
+void hkds_token_memo_destroy(hkds_token_memo* memo)
+{
+	HKDS_ASSERT(memo != NULL);
+
+	if (memo != NULL)
+	{
+		if (memo->entries != NULL)
+		{
+			utils_memory_secure_erase(memo->entries, memo->capacity * sizeof(hkds_token_entry));
+			utils_memory_aligned_free(memo->entries);
+		}
+
+		hkds_cache_index_dispose(&memo->index);
+		utils_memory_secure_erase(memo, sizeof(hkds_token_memo));
+	}
+}
+
+void hkds_token_memo_clear(hkds_token_memo* memo)
+{
+	HKDS_ASSERT(memo != NULL);
+
+	if (memo != NULL && memo->entries != NULL && memo->index.slots != NULL)
+	{
+		utils_memory_secure_erase(memo->entries, memo->capacity * sizeof(hkds_token_entry));
+		utils_memory_clear(memo->index.slots, (memo->index.mask + 1U) * sizeof(uint32_t));
+		memo->count = 0U;
+		memo->hand = 0U;
+	}
+}
+
+bool hkds_token_memo_find(hkds_token_memo* memo, const uint8_t* did, uint32_t epoch, uint8_t* token)
+{
+	HKDS_ASSERT(memo != NULL);
+	HKDS_ASSERT(did != NULL);
+	HKDS_ASSERT(token != NULL);
+
+	const hkds_token_entry* entry;
+	size_t pos;
+	bool res;
+
+	res = false;
+
+	if (memo != NULL && memo->index.slots != NULL && did != NULL && token != NULL)
+	{
+		pos = hkds_cache_index_locate(&memo->index, memo->entries, sizeof(hkds_token_entry), did, epoch);
+
+		if (memo->index.slots[pos] != 0U)
+		{
+			entry = &memo->entries[memo->index.slots[pos] - 1U];
+
+			if (hkds_token_memo_expired(memo, entry, utils_time_monotonic()) == false)
+			{
+				utils_memory_copy(token, entry->token, HKDS_STK_SIZE);
+				res = true;
+			}
+			else
+			{
+				hkds_token_memo_remove(memo, (size_t)memo->index.slots[pos] - 1U);
+			}
+		}
+
+		if (res == true)
+		{
+			++memo->hits;
+		}
+		else
+		{
+			++memo->misses;
+		}
+	}
+
+	return res;
+}
+
+bool hkds_token_memo_insert(hkds_token_memo* memo, const uint8_t* did, uint32_t epoch, const uint8_t* token)
+{
+	HKDS_ASSERT(memo != NULL);
+	HKDS_ASSERT(did != NULL);
+	HKDS_ASSERT(token != NULL);
+
+	hkds_token_entry* entry;
+	size_t eidx;
+	size_t pos;
+	bool res;
+
+	res = false;
+
+	if (memo != NULL && memo->entries != NULL && did != NULL && token != NULL)
+	{
+		pos = hkds_cache_index_locate(&memo->index, memo->entries, sizeof(hkds_token_entry), did, epoch);
+
+		if (memo->index.slots[pos] != 0U)
+		{
+			/* the epoch is already memoized; refresh it in place */
+			eidx = (size_t)memo->index.slots[pos] - 1U;
+		}
+		else
+		{
+			/* overwrite the oldest ring position */
+			eidx = memo->hand;
+			memo->hand = (memo->hand + 1U) % memo->capacity;
+
+			if (memo->entries[eidx].used == true)
+			{
+				hkds_token_memo_remove(memo, eidx);
+				/* removal may have shifted the probe run */
+				pos = hkds_cache_index_locate(&memo->index, memo->entries, sizeof(hkds_token_entry), did, epoch);
+			}
+
+			memo->index.slots[pos] = (uint32_t)(eidx + 1U);
+			++memo->count;
+		}
+
+		entry = &memo->entries[eidx];
+		utils_memory_copy(entry->key.did, did, HKDS_DID_SIZE);
+		entry->key.epoch = epoch;
+		utils_memory_copy(entry->token, token, HKDS_STK_SIZE);
+		entry->expiry = utils_time_monotonic() + memo->ttl;
+		entry->used = true;
+		res = true;
+	}
+
+	return res;
+}
+
+size_t hkds_token_memo_purge(hkds_token_memo* memo)
+{
+	HKDS_ASSERT(memo != NULL);
+
+	uint64_t now;
+	size_t cnt;
+
+	cnt = 0U;
+
+	if (memo != NULL && memo->entries != NULL && memo->ttl != 0U)
+	{
+		now = utils_time_monotonic();
+
+		for (size_t i = 0U; i < memo->capacity; ++i)
+		{
+			if (memo->entries[i].used == true && hkds_token_memo_expired(memo, &memo->entries[i], now) == true)
+			{
+				hkds_token_memo_remove(memo, i);
+				++cnt;
+			}
+		}
+	}
+
+	return cnt;
+}
@@ -0,0 +1,402 @@
+/* 2021-2026 Quantum Resistant Cryptographic Solutions Corporation
+ * All Rights Reserved.
+ *
+ * NOTICE:
+ * This software and all accompanying materials are the exclusive property of
+ * Quantum Resistant Cryptographic Solutions Corporation (QRCS). The intellectual
+ * and technical concepts contained herein are proprietary to QRCS and are
+ * protected under applicable Canadian, U.S., and international copyright,
+ * patent, and trade secret laws.
+ *
+ * CRYPTOGRAPHIC ALGORITHMS AND IMPLEMENTATIONS:
+ * - This software includes implementations of cryptographic primitives and
+ *   algorithms that are standardized or in the public domain, such as AES
+ *   and SHA-3, which are not proprietary to QRCS.
+ * - This software also includes cryptographic primitives, constructions, and
+ *   algorithms designed by QRCS, including but not limited to RCS, SCB, CSX, QMAC, and
+ *   related components, which are proprietary to QRCS.
+ * - All source code, implementations, protocol compositions, optimizations,
+ *   parameter selections, and engineering work contained in this software are
+ *   original works of QRCS and are protected under this license.
+ *
+ * LICENSE AND USE RESTRICTIONS:
+ * - This software is licensed under the Quantum Resistant Cryptographic Solutions
+ *   Public Research and Evaluation License (QRCS-PREL), 2025-2026.
+ * - Permission is granted solely for non-commercial evaluation, academic research,
+ *   cryptographic analysis, interoperability testing, and feasibility assessment.
+ * - Commercial use, production deployment, commercial redistribution, or
+ *   integration into products or services is strictly prohibited without a
+ *   separate written license agreement executed with QRCS.
+ * - Licensing and authorized distribution are solely at the discretion of QRCS.
+ *
+ * EXPERIMENTAL CRYPTOGRAPHY NOTICE:
+ * Portions of this software may include experimental, novel, or evolving
+ * cryptographic designs. Use of this software is entirely at the user's risk.
+ *
+ * DISCLAIMER:
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE, SECURITY, OR NON-INFRINGEMENT. QRCS DISCLAIMS ALL
+ * LIABILITY FOR ANY DIRECT, INDIRECT, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING FROM THE USE OR MISUSE OF THIS SOFTWARE.
+ *
+ * FULL LICENSE:
+ * This software is subject to the Quantum Resistant Cryptographic Solutions
+ * Public Research and Evaluation License (QRCS-PREL), 2025-2026. The complete license terms
+ * are provided in the accompanying LICENSE file or at https://www.qrcscorp.ca.
+ *
+ * Written by: John G. Underhill
+ * Contact: contact@qrcscorp.ca
+ */
+
+#ifndef HKDS_CACHE_H
+#define HKDS_CACHE_H
+
+#include "common.h"
+#include "hkds_config.h"
+#include "keccak.h"
+
+/**
+ * \file hkds_cache.h
+ * \brief This file contains the HKDS server derivation cache definitions.
+ *
+ * \details
+ * This header defines the structures and function prototypes for the server-side derivation caches.
+ * A transaction server that receives many messages from the same device within a single token epoch
+ * (\c HKDS_CACHE_SIZE consecutive transaction counters) would otherwise re-derive the embedded device key,
+ * the epoch token, and the full transaction key-stream for every message. The caches defined here retain
+ * that intermediate state so that only the first message of an epoch pays for the derivation.
+ *
+ * The keystream cache:
+ * - Is keyed by the device identity (DID) and the token epoch (transaction counter / \c HKDS_CACHE_SIZE), and bound to
+ *   the key identity of the master key set.
+ * - Retains the absorbed SHAKE state of each epoch, and squeezes key-stream blocks on demand,
+ *   so an entry only ever holds as many blocks as the deepest transaction key requested so far.
+ * - Is bounded by a caller supplied memory ceiling, and uses CLOCK (second-chance) eviction.
+ * - Securely erases an entry's key material when it is evicted, cleared, or destroyed.
+ *
+ * The embedded device key (EDK) table:
+ * - Is keyed by the device identity, and bound to the key identity of the master key set it was derived from.
+ * - Is filled in bulk at startup with the parallel EDK kernels, and lazily as unknown devices are seen.
+ * - Removes the DID||BDK hash from every server decryption and token request.
+ *
+ * The token memo:
+ * - Is keyed by the device identity and token epoch, and bound to the key identity of the master key set.
+ * - Is filled when a token is issued, and read when the messages of that epoch are decrypted.
+ * - Expires entries after a configurable time-to-live, securely erasing expired and evicted tokens.
+ *
+ * The caches are not internally synchronized; a cache instance must be owned by a single thread,
+ * or access to it must be serialized by the caller.
+ */
+
+/*!
+ * \def HKDS_KEYSTREAM_CACHE_BLOCKS
+ * \brief The number of PRF blocks that make up a complete epoch key-stream.
+ */
+#define HKDS_KEYSTREAM_CACHE_BLOCKS ((((size_t)HKDS_CACHE_SIZE * HKDS_MESSAGE_SIZE) + HKDS_PRF_RATE - 1U) / HKDS_PRF_RATE)
+
+/*!
+ * \def HKDS_KEYSTREAM_CACHE_SIZE
+ * \brief The byte size of a complete epoch key-stream.
+ */
+#define HKDS_KEYSTREAM_CACHE_SIZE (HKDS_KEYSTREAM_CACHE_BLOCKS * HKDS_PRF_RATE)
+
+/*!
+ * \struct hkds_cache_key
+ * \brief The lookup key of a derivation cache entry.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    uint8_t did[HKDS_DID_SIZE];  /*!< The device identity string */
+    uint32_t epoch;              /*!< The token epoch; the transaction counter divided by the cache size */
+} hkds_cache_key;
+
+/*!
+ * \struct hkds_cache_index
+ * \brief Contains an open-addressed derivation cache index.
+ *
+ * \details
+ * The index maps a cache key to a position in the owning cache's entry array. Slots hold the entry position
+ * plus one, or zero if empty, and are probed linearly from a hash of the key seeded with a random value at
+ * initialization. Deletion uses backward shifting, so the index never accumulates tombstones.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    uint32_t* slots;    /*!< The index slot array */
+    size_t mask;        /*!< The index slot count minus one */
+    uint64_t seed;      /*!< The hashing seed */
+} hkds_cache_index;
+
+/*!
+ * \struct hkds_keystream_entry
+ * \brief Contains a single cached epoch key-stream.
+ *
+ * \details
+ * The keccak state is retained after the last squeeze, so the key-stream can be extended
+ * one block at a time as deeper transaction keys in the epoch are requested.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    hkds_cache_key key;                            /*!< The device identity and epoch of this entry */
+    hkds_keccak_state kstate;                      /*!< The SHAKE state absorbed with the epoch PRF key */
+    uint8_t skey[HKDS_KEYSTREAM_CACHE_SIZE];       /*!< The key-stream blocks squeezed so far */
+    size_t nblocks;                                /*!< The number of key-stream blocks squeezed */
+    bool referenced;                               /*!< The CLOCK reference bit */
+} hkds_keystream_entry;
+
+/*!
+ * \struct hkds_keystream_cache
+ * \brief Contains the per-device epoch keystream cache state.
+ *
+ * \details
+ * The entries are stored in a single array of \c capacity elements, and located through an open-addressed index.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    hkds_keystream_entry* entries;  /*!< The cache entry array */
+    hkds_cache_index index;         /*!< The entry index */
+    uint8_t kid[HKDS_KID_SIZE];     /*!< The identity of the master key set the key-streams were derived from */
+    size_t capacity;                /*!< The maximum number of cached epochs */
+    size_t count;                   /*!< The number of cached epochs */
+    size_t hand;                    /*!< The CLOCK eviction hand */
+    uint64_t hits;                  /*!< The number of lookups served from the cache */
+    uint64_t misses;                /*!< The number of lookups that required a derivation */
+} hkds_keystream_cache;
+
+/*!
+ * \struct hkds_edk_entry
+ * \brief Contains a single embedded device key table entry.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    hkds_cache_key key;             /*!< The device identity; the epoch member is unused */
+    uint8_t edk[HKDS_EDK_SIZE];     /*!< The embedded device key */
+} hkds_edk_entry;
+
+/*!
+ * \struct hkds_edk_table
+ * \brief Contains the embedded device key table state.
+ *
+ * \details
+ * The table holds the embedded device keys of a registered device fleet, derived under a single master key set.
+ * It is sized for the fleet at initialization and never evicts; once full, further devices are derived on demand
+ * but not stored.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    hkds_edk_entry* entries;        /*!< The table entry array */
+    hkds_cache_index index;         /*!< The entry index */
+    uint8_t kid[HKDS_KID_SIZE];     /*!< The identity of the master key set the keys were derived from */
+    size_t capacity;                /*!< The maximum number of devices */
+    size_t count;                   /*!< The number of devices in the table */
+} hkds_edk_table;
+
+/*!
+ * \struct hkds_token_entry
+ * \brief Contains a single memoized epoch token.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    hkds_cache_key key;             /*!< The device identity and epoch of this entry */
+    uint8_t token[HKDS_STK_SIZE];   /*!< The device token of the epoch */
+    uint64_t expiry;                /*!< The monotonic time in microseconds at which the entry expires */
+    bool used;                      /*!< The entry holds a token */
+} hkds_token_entry;
+
+/*!
+ * \struct hkds_token_memo
+ * \brief Contains the epoch token memo state.
+ *
+ * \details
+ * Entries are written in insertion order around a ring; since every entry has the same time-to-live,
+ * the entry overwritten when the memo is full is always the one closest to expiry.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    hkds_token_entry* entries;      /*!< The memo entry ring */
+    hkds_cache_index index;         /*!< The entry index */
+    uint8_t kid[HKDS_KID_SIZE];     /*!< The identity of the master key set the tokens were derived from */
+    size_t capacity;                /*!< The maximum number of memoized tokens */
+    size_t count;                   /*!< The number of memoized tokens */
+    size_t hand;                    /*!< The next ring position to be written */
+    uint64_t ttl;                   /*!< The entry time-to-live in microseconds, or zero for no expiry */
+    uint64_t hits;                  /*!< The number of lookups served from the memo */
+    uint64_t misses;                /*!< The number of lookups that required a derivation */
+} hkds_token_memo;
+
+/**
+ * \brief Initialize a keystream cache.
+ *
+ * \details
+ * The number of cached epochs is the largest count of entries, including their index overhead,
+ * that fits within the memory ceiling. The ceiling must accommodate at least one entry.
+ *
+ * \param cache [out] Pointer to the keystream cache.
+ * \param kid [in] Pointer to the key identity of the master key set the cache serves.
+ * \param maxmem [in] The maximum number of bytes the cache may allocate.
+ * \return Returns true if the cache was initialized; false if the ceiling is too small or allocation failed.
+ */
+HKDS_EXPORT_API bool hkds_keystream_cache_initialize(hkds_keystream_cache* cache, const uint8_t* kid, size_t maxmem);
+
+/**
+ * \brief Securely erase all cached key-streams, and release the cache memory.
+ *
+ * \param cache [in,out] Pointer to the keystream cache.
+ */
+HKDS_EXPORT_API void hkds_keystream_cache_destroy(hkds_keystream_cache* cache);
+
+/**
+ * \brief Securely erase all cached key-streams, keeping the cache allocated.
+ *
+ * \details
+ * This function should be called whenever the master key set used with the cache is replaced.
+ *
+ * \param cache [in,out] Pointer to the keystream cache.
+ */
+HKDS_EXPORT_API void hkds_keystream_cache_clear(hkds_keystream_cache* cache);
+
+/**
+ * \brief Find the cached key-stream of a device epoch.
+ *
+ * \param cache [in,out] Pointer to the keystream cache.
+ * \param did [in] Pointer to the device identity string.
+ * \param epoch [in] The token epoch.
+ * \return Returns a pointer to the cache entry, or NULL if the epoch is not cached.
+ */
+HKDS_EXPORT_API hkds_keystream_entry* hkds_keystream_cache_find(hkds_keystream_cache* cache, const uint8_t* did, uint32_t epoch);
+
+/**
+ * \brief Insert a device epoch into the cache.
+ *
+ * \details
+ * The entry's SHAKE state is initialized with the epoch PRF key (the device token concatenated
+ * with the embedded device key). If the cache is full, an entry is evicted and securely erased.
+ *
+ * \param cache [in,out] Pointer to the keystream cache.
+ * \param did [in] Pointer to the device identity string.
+ * \param epoch [in] The token epoch.
+ * \param key [in] Pointer to the epoch PRF key.
+ * \param keylen [in] The length of the PRF key in bytes.
+ * \return Returns a pointer to the new cache entry, or NULL on failure.
+ */
+HKDS_EXPORT_API hkds_keystream_entry* hkds_keystream_cache_insert(hkds_keystream_cache* cache, const uint8_t* did, uint32_t epoch, const uint8_t* key, size_t keylen);
+
+/**
+ * \brief Copy key-stream bytes from a cache entry, squeezing additional blocks if required.
+ *
+ * \param entry [in,out] Pointer to the cache entry.
+ * \param offset [in] The key-stream byte offset.
+ * \param output [out] Pointer to the output array.
+ * \param outlen [in] The number of bytes to copy.
+ * \return Returns true on success; false if the request extends beyond the epoch key-stream.
+ */
+HKDS_EXPORT_API bool hkds_keystream_cache_extract(hkds_keystream_entry* entry, size_t offset, uint8_t* output, size_t outlen);
+
+/**
+ * \brief Initialize an embedded device key table.
+ *
+ * \param table [out] Pointer to the EDK table.
+ * \param kid [in] Pointer to the key identity of the master key set the table serves.
+ * \param capacity [in] The maximum number of devices held by the table.
+ * \return Returns true if the table was initialized; false if the capacity is invalid or allocation failed.
+ */
+HKDS_EXPORT_API bool hkds_edk_table_initialize(hkds_edk_table* table, const uint8_t* kid, size_t capacity);
+
+/**
+ * \brief Securely erase all device keys, and release the table memory.
+ *
+ * \param table [in,out] Pointer to the EDK table.
+ */
+HKDS_EXPORT_API void hkds_edk_table_destroy(hkds_edk_table* table);
+
+/**
+ * \brief Securely erase all device keys, keeping the table allocated.
+ *
+ * \param table [in,out] Pointer to the EDK table.
+ */
+HKDS_EXPORT_API void hkds_edk_table_clear(hkds_edk_table* table);
+
+/**
+ * \brief Find the embedded device key of a device.
+ *
+ * \details
+ * This function does not modify the table, and may be called concurrently with other lookups.
+ *
+ * \param table [in] Pointer to the EDK table.
+ * \param did [in] Pointer to the device identity string.
+ * \return Returns a pointer to the embedded device key, or NULL if the device is not in the table.
+ */
+HKDS_EXPORT_API const uint8_t* hkds_edk_table_find(const hkds_edk_table* table, const uint8_t* did);
+
+/**
+ * \brief Insert or replace the embedded device key of a device.
+ *
+ * \param table [in,out] Pointer to the EDK table.
+ * \param did [in] Pointer to the device identity string.
+ * \param edk [in] Pointer to the embedded device key.
+ * \return Returns true if the key was stored; false if the table is full.
+ */
+HKDS_EXPORT_API bool hkds_edk_table_insert(hkds_edk_table* table, const uint8_t* did, const uint8_t* edk);
+
+/**
+ * \brief Initialize an epoch token memo.
+ *
+ * \param memo [out] Pointer to the token memo.
+ * \param kid [in] Pointer to the key identity of the master key set the memo serves.
+ * \param capacity [in] The maximum number of memoized tokens.
+ * \param ttl [in] The token time-to-live in milliseconds, or zero if tokens do not expire.
+ * \return Returns true if the memo was initialized; false if the capacity is invalid or allocation failed.
+ */
+HKDS_EXPORT_API bool hkds_token_memo_initialize(hkds_token_memo* memo, const uint8_t* kid, size_t capacity, uint64_t ttl);
+
+/**
+ * \brief Securely erase all memoized tokens, and release the memo memory.
+ *
+ * \param memo [in,out] Pointer to the token memo.
+ */
+HKDS_EXPORT_API void hkds_token_memo_destroy(hkds_token_memo* memo);
+
+/**
+ * \brief Securely erase all memoized tokens, keeping the memo allocated.
+ *
+ * \param memo [in,out] Pointer to the token memo.
+ */
+HKDS_EXPORT_API void hkds_token_memo_clear(hkds_token_memo* memo);
+
+/**
+ * \brief Copy the memoized token of a device epoch.
+ *
+ * \details
+ * An expired entry is securely erased and reported as missing.
+ *
+ * \param memo [in,out] Pointer to the token memo.
+ * \param did [in] Pointer to the device identity string.
+ * \param epoch [in] The token epoch.
+ * \param token [out] Pointer to the output token array.
+ * \return Returns true if an unexpired token was found; false otherwise.
+ */
+HKDS_EXPORT_API bool hkds_token_memo_find(hkds_token_memo* memo, const uint8_t* did, uint32_t epoch, uint8_t* token);
+
+/**
+ * \brief Insert or refresh the token of a device epoch.
+ *
+ * \details
+ * The entry's time-to-live starts when it is inserted. If the memo is full, the oldest entry is securely erased and replaced.
+ *
+ * \param memo [in,out] Pointer to the token memo.
+ * \param did [in] Pointer to the device identity string.
+ * \param epoch [in] The token epoch.
+ * \param token [in] Pointer to the token array.
+ * \return Returns true if the token was stored.
+ */
+HKDS_EXPORT_API bool hkds_token_memo_insert(hkds_token_memo* memo, const uint8_t* did, uint32_t epoch, const uint8_t* token);
+
+/**
+ * \brief Securely erase all expired tokens.
+ *
+ * \param memo [in,out] Pointer to the token memo.
+ * \return Returns the number of tokens erased.
+ */
+HKDS_EXPORT_API size_t hkds_token_memo_purge(hkds_token_memo* memo);
+
+#endif
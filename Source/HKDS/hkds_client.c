@@ -2,21 +2,120 @@
 #include "keccak.h"
 #include "utils.h"
 
+#if defined(HKDS_CLIENT_LAZY_CACHE)
+static void hkds_client_absorb_sponge(hkds_client_state* state, const uint8_t* key, size_t keylen)
+{
+	uint8_t msg[HKDS_PRF_RATE] = { 0U };
+	size_t i;
+
+	utils_memory_clear(state->sponge, sizeof(state->sponge));
+
+	/* absorb the full blocks of the key */
+	while (keylen >= HKDS_PRF_RATE)
+	{
+		for (i = 0U; i < HKDS_PRF_RATE / sizeof(uint64_t); ++i)
+		{
+			state->sponge[i] ^= utils_integer_le8to64(key + (sizeof(uint64_t) * i));
+		}
+
+		hkds_keccak_permute_lanes(state->sponge, HKDS_KECCAK_PERMUTATION_ROUNDS);
+		keylen -= HKDS_PRF_RATE;
+		key += HKDS_PRF_RATE;
+	}
+
+	/* pad the final block with the SHAKE domain; the first squeeze permutes it */
+	utils_memory_copy(msg, key, keylen);
+	msg[keylen] = HKDS_KECCAK_SHAKE_DOMAIN_ID;
+	msg[HKDS_PRF_RATE - 1U] |= 0x80U;
+
+	for (i = 0U; i < HKDS_PRF_RATE / sizeof(uint64_t); ++i)
+	{
+		state->sponge[i] ^= utils_integer_le8to64(msg + (sizeof(uint64_t) * i));
+	}
+
+	utils_memory_secure_erase(msg, sizeof(msg));
+}
+
+static void hkds_client_squeeze_block(hkds_client_state* state)
+{
+	hkds_keccak_permute_lanes(state->sponge, HKDS_KECCAK_PERMUTATION_ROUNDS);
+
+	for (size_t i = 0U; i < HKDS_PRF_RATE / sizeof(uint64_t); ++i)
+	{
+		utils_integer_le64to8(state->block + (sizeof(uint64_t) * i), state->sponge[i]);
+	}
+
+	state->squeezed += HKDS_PRF_RATE;
+}
+
+static void hkds_client_squeeze_key(hkds_client_state* state, size_t offset, uint8_t* tkey)
+{
+	size_t base;
+	size_t klen;
+	size_t pos;
+
+	pos = 0U;
+
+	/* a key may straddle two blocks of the key-stream */
+	while (pos < HKDS_MESSAGE_SIZE)
+	{
+		base = state->squeezed - HKDS_PRF_RATE;
+
+		if (offset + pos >= state->squeezed)
+		{
+			/* advance the key-stream by one block; the remainder of the previous block is overwritten */
+			hkds_client_squeeze_block(state);
+		}
+		else if (offset + pos < base)
+		{
+			/* as with the eager cache, a key that was used or passed over reads as erased */
+			utils_memory_clear(tkey + pos, HKDS_MESSAGE_SIZE - pos);
+			pos = HKDS_MESSAGE_SIZE;
+		}
+		else
+		{
+			klen = state->squeezed - (offset + pos);
+			klen = (klen < HKDS_MESSAGE_SIZE - pos) ? klen : HKDS_MESSAGE_SIZE - pos;
+			utils_memory_copy(tkey + pos, state->block + (offset + pos - base), klen);
+			/* erase the block up to the end of the key, including any keys that were passed over */
+			utils_memory_secure_erase(state->block, offset + pos - base + klen);
+			pos += klen;
+		}
+	}
+}
+
+static void hkds_client_clear_sponge(hkds_client_state* state)
+{
+	utils_memory_secure_erase((uint8_t*)state->sponge, sizeof(state->sponge));
+	utils_memory_secure_erase(state->block, sizeof(state->block));
+	state->squeezed = 0U;
+}
+#endif
+
 static void hkds_client_generate_transaction_key(hkds_client_state* state, uint8_t* tkey)
 {
 	size_t idx;
 
 	/* extract the index value */
 	idx = (size_t)utils_integer_be8to32(((uint8_t*)state->ksn + HKDS_DID_SIZE)) % HKDS_CACHE_SIZE;
+#if defined(HKDS_CLIENT_LAZY_CACHE)
+	/* squeeze the key from the key-stream and erase it from the block */
+	hkds_client_squeeze_key(state, idx * HKDS_MESSAGE_SIZE, tkey);
+#else
 	/* copy the key and erase from cache memory */
 	utils_memory_copy(tkey, state->tkc[idx], HKDS_MESSAGE_SIZE);
 	utils_memory_secure_erase(state->tkc[idx], HKDS_MESSAGE_SIZE);
+#endif
 	/* increment the index counter */
 	utils_integer_be8increment(((uint8_t*)state->ksn + HKDS_DID_SIZE), HKDS_TKC_SIZE);
 
 	if (idx == HKDS_CACHE_SIZE - 1U)
 	{
 		state->cache_empty = true;
+#if defined(HKDS_CLIENT_LAZY_CACHE)
+		/* the epoch is spent; erase the key-stream state */
+		hkds_client_clear_sponge(state);
+#endif
 	}
 }
 
@@ -197,7 +296,9 @@ void hkds_client_generate_cache(hkds_client_state* state, const uint8_t* token)
 	HKDS_ASSERT(state != NULL);
 	HKDS_ASSERT(token != NULL);
 	
+#if !defined(HKDS_CLIENT_LAZY_CACHE)
 	uint8_t skey[HKDS_CACHE_SIZE * HKDS_MESSAGE_SIZE] = { 0U };
+#endif
 	uint8_t tmpk[HKDS_STK_SIZE + HKDS_EDK_SIZE] = { 0U };
 
 	if (state != NULL && token != NULL)
@@ -206,6 +307,12 @@ void hkds_client_generate_cache(hkds_client_state* state, const uint8_t* token)
 		utils_memory_copy(tmpk, token, HKDS_STK_SIZE);
 		utils_memory_copy(((uint8_t*)tmpk + HKDS_STK_SIZE), state->edk, HKDS_EDK_SIZE);
 
+#if defined(HKDS_CLIENT_LAZY_CACHE)
+		/* absorb the keys, and squeeze the first block, so the sponge does not hold the token in the clear */
+		hkds_client_absorb_sponge(state, tmpk, sizeof(tmpk));
+		state->squeezed = 0U;
+		hkds_client_squeeze_block(state);
+#else
 		/* generate the transaction key-cache */
 #if defined(HKDS_SHAKE_128)
 		hkds_shake128_compute(skey, sizeof(skey), tmpk, sizeof(tmpk));
@@ -220,7 +327,9 @@ void hkds_client_generate_cache(hkds_client_state* state, const uint8_t* token)
 		{
 			utils_memory_copy(state->tkc[i], ((uint8_t*)skey + (i * HKDS_MESSAGE_SIZE)), HKDS_MESSAGE_SIZE);
 		}
+#endif
 
+		utils_memory_secure_erase(tmpk, sizeof(tmpk));
 		state->cache_empty = false;
 	}
 }
@@ -238,11 +347,164 @@ void hkds_client_initialize_state(hkds_client_state* state, const uint8_t* edk,
 		utils_memory_copy(state->ksn, did, HKDS_DID_SIZE);
 		utils_memory_clear(((uint8_t*)state->ksn + HKDS_DID_SIZE), HKDS_TKC_SIZE);
 
+#if defined(HKDS_CLIENT_LAZY_CACHE)
+		hkds_client_clear_sponge(state);
+#else
 		for (size_t i = 0; i < HKDS_CACHE_SIZE; ++i)
 		{
 			utils_memory_clear(state->tkc[i], HKDS_MESSAGE_SIZE);
 		}
+#endif
 
 		state->cache_empty = true;
 	}
 }
+
+/* parallel x8 */
+
+static bool hkds_client_states_valid_x8(hkds_client_state* const state[HKDS_CACHX8_DEPTH])
+{
+	bool res;
+
+	res = (state != NULL);
+
+	for (size_t i = 0U; i < HKDS_CACHX8_DEPTH && res == true; ++i)
+	{
+		res = (state[i] != NULL);
+	}
+
+	return res;
+}
+
+void hkds_client_decrypt_token_x8(hkds_client_state* state[HKDS_CACHX8_DEPTH],
+	const uint8_t etok[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE + HKDS_TAG_SIZE],
+	uint8_t token[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE],
+	bool valid[HKDS_CACHX8_DEPTH])
+{
+	HKDS_ASSERT(state != NULL);
+	HKDS_ASSERT(etok != NULL);
+	HKDS_ASSERT(token != NULL);
+	HKDS_ASSERT(valid != NULL);
+
+	uint8_t mtk[HKDS_CACHX8_DEPTH][HKDS_TAG_SIZE] = { 0U };
+	uint8_t tms[HKDS_CACHX8_DEPTH][HKDS_TMS_SIZE] = { 0U };
+	uint8_t tmpk[HKDS_CACHX8_DEPTH][HKDS_CTOK_SIZE + HKDS_EDK_SIZE] = { 0U };
+	uint32_t tkc;
+	size_t i;
+
+	if (hkds_client_states_valid_x8(state) == true && etok != NULL && token != NULL && valid != NULL)
+	{
+		for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			/* the prf key is the customization string (tkc, algorithm name, device id) followed by the edk */
+			tkc = utils_integer_be8to32(((uint8_t*)state[i]->ksn + HKDS_DID_SIZE)) / HKDS_CACHE_SIZE;
+			utils_integer_be32to8(tmpk[i], tkc);
+			utils_memory_copy(((uint8_t*)tmpk[i] + HKDS_TKC_SIZE), hkds_formal_name, HKDS_NAME_SIZE);
+			utils_memory_copy(((uint8_t*)tmpk[i] + HKDS_TKC_SIZE + HKDS_NAME_SIZE), state[i]->ksn, HKDS_DID_SIZE);
+			utils_memory_copy(((uint8_t*)tmpk[i] + HKDS_CTOK_SIZE), state[i]->edk, HKDS_EDK_SIZE);
+
+			/* get the token mac key string */
+			hkds_client_get_tms(state[i], tms[i]);
+		}
+
+		/* M(tok, etok, tms) = kmac(m, k, c) */
+#if defined(HKDS_SHAKE_128)
+		hkds_kmac_128x8(mtk[0U], mtk[1U], mtk[2U], mtk[3U], mtk[4U], mtk[5U], mtk[6U], mtk[7U], HKDS_TAG_SIZE,
+			state[0U]->edk, state[1U]->edk, state[2U]->edk, state[3U]->edk, state[4U]->edk, state[5U]->edk, state[6U]->edk, state[7U]->edk, HKDS_EDK_SIZE,
+			tms[0U], tms[1U], tms[2U], tms[3U], tms[4U], tms[5U], tms[6U], tms[7U], HKDS_TMS_SIZE,
+			etok[0U], etok[1U], etok[2U], etok[3U], etok[4U], etok[5U], etok[6U], etok[7U], HKDS_STK_SIZE);
+#elif defined(HKDS_SHAKE_256)
+		hkds_kmac_256x8(mtk[0U], mtk[1U], mtk[2U], mtk[3U], mtk[4U], mtk[5U], mtk[6U], mtk[7U], HKDS_TAG_SIZE,
+			state[0U]->edk, state[1U]->edk, state[2U]->edk, state[3U]->edk, state[4U]->edk, state[5U]->edk, state[6U]->edk, state[7U]->edk, HKDS_EDK_SIZE,
+			tms[0U], tms[1U], tms[2U], tms[3U], tms[4U], tms[5U], tms[6U], tms[7U], HKDS_TMS_SIZE,
+			etok[0U], etok[1U], etok[2U], etok[3U], etok[4U], etok[5U], etok[6U], etok[7U], HKDS_STK_SIZE);
+#else
+		hkds_kmac_512x8(mtk[0U], mtk[1U], mtk[2U], mtk[3U], mtk[4U], mtk[5U], mtk[6U], mtk[7U], HKDS_TAG_SIZE,
+			state[0U]->edk, state[1U]->edk, state[2U]->edk, state[3U]->edk, state[4U]->edk, state[5U]->edk, state[6U]->edk, state[7U]->edk, HKDS_EDK_SIZE,
+			tms[0U], tms[1U], tms[2U], tms[3U], tms[4U], tms[5U], tms[6U], tms[7U], HKDS_TMS_SIZE,
+			etok[0U], etok[1U], etok[2U], etok[3U], etok[4U], etok[5U], etok[6U], etok[7U], HKDS_STK_SIZE);
+#endif
+
+		/* generate the key-streams of all the lanes; those that fail the MAC check are erased below */
+#if defined(HKDS_SHAKE_128)
+		hkds_shake_128x8(token[0U], token[1U], token[2U], token[3U], token[4U], token[5U], token[6U], token[7U], HKDS_STK_SIZE,
+			tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_CTOK_SIZE + HKDS_EDK_SIZE);
+#elif defined(HKDS_SHAKE_256)
+		hkds_shake_256x8(token[0U], token[1U], token[2U], token[3U], token[4U], token[5U], token[6U], token[7U], HKDS_STK_SIZE,
+			tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_CTOK_SIZE + HKDS_EDK_SIZE);
+#else
+		hkds_shake_512x8(token[0U], token[1U], token[2U], token[3U], token[4U], token[5U], token[6U], token[7U], HKDS_STK_SIZE,
+			tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_CTOK_SIZE + HKDS_EDK_SIZE);
+#endif
+
+		for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			/* compare the MAC generated with the one appended to the token message */
+			valid[i] = (utils_integer_verify(etok[i] + HKDS_STK_SIZE, mtk[i], HKDS_TAG_SIZE) == 0);
+
+			if (valid[i] == true)
+			{
+				/* decrypt the token */
+				utils_memory_xor(token[i], etok[i], HKDS_STK_SIZE);
+			}
+			else
+			{
+				utils_memory_secure_erase(token[i], HKDS_STK_SIZE);
+			}
+		}
+
+		utils_memory_secure_erase((uint8_t*)tmpk, sizeof(tmpk));
+	}
+}
+
+void hkds_client_generate_cache_x8(hkds_client_state* state[HKDS_CACHX8_DEPTH], const uint8_t token[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE])
+{
+	HKDS_ASSERT(state != NULL);
+	HKDS_ASSERT(token != NULL);
+
+#if defined(HKDS_CLIENT_LAZY_CACHE)
+	if (hkds_client_states_valid_x8(state) == true && token != NULL)
+	{
+		/* only the first block of each key-stream is squeezed; there is no cache to fill in parallel */
+		for (size_t i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			hkds_client_generate_cache(state[i], token[i]);
+		}
+	}
+#else
+	uint8_t tmpk[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE + HKDS_EDK_SIZE] = { 0U };
+	size_t i;
+
+	if (hkds_client_states_valid_x8(state) == true && token != NULL)
+	{
+		/* combine the token and edk keys */
+		for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			utils_memory_copy(tmpk[i], token[i], HKDS_STK_SIZE);
+			utils_memory_copy(((uint8_t*)tmpk[i] + HKDS_STK_SIZE), state[i]->edk, HKDS_EDK_SIZE);
+		}
+
+		/* generate the transaction key-caches directly into the cache arrays */
+#if defined(HKDS_SHAKE_128)
+		hkds_shake_128x8(state[0U]->tkc[0U], state[1U]->tkc[0U], state[2U]->tkc[0U], state[3U]->tkc[0U], state[4U]->tkc[0U], state[5U]->tkc[0U],
+			state[6U]->tkc[0U], state[7U]->tkc[0U], HKDS_CACHE_SIZE * HKDS_MESSAGE_SIZE,
+			tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_STK_SIZE + HKDS_EDK_SIZE);
+#elif defined(HKDS_SHAKE_256)
+		hkds_shake_256x8(state[0U]->tkc[0U], state[1U]->tkc[0U], state[2U]->tkc[0U], state[3U]->tkc[0U], state[4U]->tkc[0U], state[5U]->tkc[0U],
+			state[6U]->tkc[0U], state[7U]->tkc[0U], HKDS_CACHE_SIZE * HKDS_MESSAGE_SIZE,
+			tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_STK_SIZE + HKDS_EDK_SIZE);
+#else
+		hkds_shake_512x8(state[0U]->tkc[0U], state[1U]->tkc[0U], state[2U]->tkc[0U], state[3U]->tkc[0U], state[4U]->tkc[0U], state[5U]->tkc[0U],
+			state[6U]->tkc[0U], state[7U]->tkc[0U], HKDS_CACHE_SIZE * HKDS_MESSAGE_SIZE,
+			tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_STK_SIZE + HKDS_EDK_SIZE);
+#endif
+
+		for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			state[i]->cache_empty = false;
+		}
+
+		utils_memory_secure_erase((uint8_t*)tmpk, sizeof(tmpk));
+	}
+#endif
+}
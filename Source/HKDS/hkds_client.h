@@ -92,12 +92,24 @@
  * - \c tkc: The Transaction Key Cache, an array of keys (each of size \c HKDS_MESSAGE_SIZE) used for message encryption
  *   and authentication. The total number of keys is defined by \c HKDS_CACHE_SIZE.
  * - \c cache_empty: A boolean flag indicating whether the key cache has been exhausted.
+ *
+ * When \c HKDS_CLIENT_LAZY_CACHE is defined, the cache is replaced by:
+ *
+ * - \c sponge: The Keccak lanes of the SHAKE state keyed with the token and the EDK, advanced one block at a time.
+ * - \c block: The last squeezed block of the key-stream; the bytes of used keys are erased.
+ * - \c squeezed: The number of key-stream bytes squeezed in the current epoch.
  */
 HKDS_EXPORT_API typedef struct
 {
     uint8_t edk[HKDS_EDK_SIZE];
     uint8_t ksn[HKDS_KSN_SIZE];
+#if defined(HKDS_CLIENT_LAZY_CACHE)
+    uint64_t sponge[HKDS_KECCAK_STATE_SIZE];
+    uint8_t block[HKDS_PRF_RATE];
+    size_t squeezed;
+#else
     uint8_t tkc[HKDS_CACHE_SIZE][HKDS_MESSAGE_SIZE];
+#endif
     bool cache_empty;
 } hkds_client_state;
 
@@ -181,6 +193,9 @@ HKDS_EXPORT_API bool hkds_client_encrypt_authenticate_message(hkds_client_state*
  *
  * Upon completion, the client's cache-empty flag is set to false, indicating that valid keys are available for encryption.
  *
+ * When \c HKDS_CLIENT_LAZY_CACHE is defined, the combined key material is absorbed and only the first block of the
+ * key-stream is squeezed; the following blocks are squeezed as the transactions reach them.
+ *
  * \param state [in/out] Pointer to the HKDS client state structure.
  * \param token [in] Pointer to the secret token key array used in generating the key cache.
  */
@@ -204,5 +219,40 @@ HKDS_EXPORT_API void hkds_client_generate_cache(hkds_client_state* state, const
  */
 HKDS_EXPORT_API void hkds_client_initialize_state(hkds_client_state* state, const uint8_t* edk, const uint8_t* did);
 
+/* --- Parallel Vectorized x8 API --- */
+
+/**
+ * \brief Decrypt the encrypted token keys of 8 client states in parallel.
+ *
+ * \details
+ * This function is the x8 form of \ref hkds_client_decrypt_token, for hosts that serve many logical terminals. The
+ * token MACs of the 8 clients are computed together with the x8 KMAC function, and the token key-streams with the
+ * x8 SHAKE function. Each lane is checked on its own; the token of a lane that fails the MAC check is erased.
+ *
+ * \param state [in] An array of 8 pointers to HKDS client state structures.
+ * \param etok [in] A 2D array of 8 encrypted token keys with appended MAC tags.
+ * \param token [out] A 2D array where the decrypted token keys will be stored.
+ * \param valid [out] A boolean array indicating the verification status of each token.
+ */
+HKDS_EXPORT_API void hkds_client_decrypt_token_x8(hkds_client_state* state[HKDS_CACHX8_DEPTH],
+    const uint8_t etok[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE + HKDS_TAG_SIZE],
+    uint8_t token[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE],
+    bool valid[HKDS_CACHX8_DEPTH]);
+
+/**
+ * \brief Generate the transaction key caches of 8 client states in parallel.
+ *
+ * \details
+ * This function is the x8 form of \ref hkds_client_generate_cache. The 8 key caches are squeezed together with the
+ * x8 SHAKE function, directly into the cache arrays of the client states, and each cache-empty flag is cleared.
+ * When \c HKDS_CLIENT_LAZY_CACHE is defined, there are no cache arrays to fill, and each state is keyed in turn with
+ * \ref hkds_client_generate_cache.
+ *
+ * \param state [in,out] An array of 8 pointers to HKDS client state structures.
+ * \param token [in] A 2D array of the 8 secret token keys.
+ */
+HKDS_EXPORT_API void hkds_client_generate_cache_x8(hkds_client_state* state[HKDS_CACHX8_DEPTH],
+    const uint8_t token[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE]);
+
 
 #endif
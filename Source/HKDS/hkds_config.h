@@ -86,6 +86,8 @@
  * - \c packet_message_response: A server message response.
  * - \c packet_administrative_message: An administrative message.
  * - \c packet_error_message: An error message.
+ * - \c packet_batch_request: A batch envelope carrying several client requests.
+ * - \c packet_batch_response: A batch envelope carrying the server responses to a batch request.
  */
 typedef enum hkds_packet_type
 {
@@ -94,7 +96,9 @@ typedef enum hkds_packet_type
     packet_message_request       = 0x03U,    /*!< A client message request */
     packet_message_response      = 0x04U,    /*!< A server message response */
     packet_administrative_message= 0x05U,    /*!< An administrative message */
-    packet_error_message         = 0x06U     /*!< An error message */
+    packet_error_message         = 0x06U,    /*!< An error message */
+    packet_batch_request         = 0x07U,    /*!< A batch envelope of client requests */
+    packet_batch_response        = 0x08U     /*!< A batch envelope of server responses */
 } hkds_packet_type;
 
 /*! \enum hkds_protocol_id
@@ -221,6 +225,21 @@ typedef enum hkds_message_type
  */
 #define HKDS_CACHE_MULTIPLIER 4U
 
+/*!
+ * \def HKDS_CLIENT_LAZY_CACHE
+ * \brief Generate the client transaction keys incrementally.
+ *
+ * \details
+ * When defined, the client keeps the Keccak lanes of the absorbed SHAKE state of an epoch instead of the transaction key cache, and
+ * squeezes one rate-block at a time as the transactions consume the keys; each key is erased from the block as it is used.
+ * A new token is usable after a single permutation, and the client state holds one block of keys rather than the whole
+ * cache, so its size no longer grows with \c HKDS_CACHE_MULTIPLIER.
+ * The tradeoff is forward secrecy within the epoch: the Keccak permutation is invertible, so a captured client state
+ * reveals every key of the current epoch, including those already used. With the eager cache, the used keys are erased.
+ * The keys, and the protocol, are identical in both modes.
+ */
+//#define HKDS_CLIENT_LAZY_CACHE
+
 /*** Static Values (Do Not Change) ***/
 
 /*!
@@ -295,6 +314,12 @@ typedef enum hkds_message_type
  */
 #define HKDS_HEADER_SIZE 4U
 
+/*!
+ * \def HKDS_KECCAK_STATE_SIZE
+ * \brief The Keccak state array size in 64-bit lanes.
+ */
+#define HKDS_KECCAK_STATE_SIZE 25U
+
 /*!
  * \def HKDS_KID_SIZE
  * \brief The master key identity string size in bytes.
@@ -549,6 +574,23 @@ static const uint8_t hkds_mac_name[HKDS_NAME_SIZE] = { 0x75, 0x4B, 0x77, 0x65, 0
  */
 #define HKDS_ERROR_MESSAGE_SIZE (HKDS_HEADER_SIZE + HKDS_ERROR_SIZE)
 
+/*!
+ * \def HKDS_BATCH_HEADER_SIZE
+ * \brief The size of the batch envelope header.
+ *
+ * \details
+ * The packet header, whose length field holds this size, followed by the big-endian 16-bit record count,
+ * the packet type of the records, and a reserved byte. The envelope size is the header size plus the record count
+ * multiplied by the record size of the record type.
+ */
+#define HKDS_BATCH_HEADER_SIZE (HKDS_HEADER_SIZE + 4U)
+
+/*!
+ * \def HKDS_BATCH_MAX_RECORDS
+ * \brief The maximum number of records in a batch envelope.
+ */
+#define HKDS_BATCH_MAX_RECORDS 1024U
+
 /*** Packet Headers ***/
 
 /*!
@@ -1,59 +1,106 @@
 #include "hkds_factory.h"
 #include "utils.h"
 
+/* wire header encoding */
+
+static void hkds_factory_write_header(uint8_t* output, const hkds_packet_header* header)
+{
+	/* the enumerations are stored as single bytes; the in-memory header is wider than the wire header */
+	output[HKDS_PACKET_FLAG_OFFSET] = (uint8_t)header->flag;
+	output[HKDS_PACKET_PROTOCOL_OFFSET] = (uint8_t)header->protocol;
+	output[HKDS_PACKET_SEQUENCE_OFFSET] = header->sequence;
+	output[HKDS_PACKET_LENGTH_OFFSET] = header->length;
+}
+
+static hkds_packet_header hkds_factory_read_header(const uint8_t* input)
+{
+	hkds_packet_header hdr;
+
+	hdr.flag = (hkds_packet_type)input[HKDS_PACKET_FLAG_OFFSET];
+	hdr.protocol = (hkds_protocol_id)input[HKDS_PACKET_PROTOCOL_OFFSET];
+	hdr.sequence = input[HKDS_PACKET_SEQUENCE_OFFSET];
+	hdr.length = input[HKDS_PACKET_LENGTH_OFFSET];
+
+	return hdr;
+}
+
+/*!
+ * \def HKDS_FACTORY_HEADER_MASK
+ * \brief The header word bits that are validated; the sequence number is excluded.
+ */
+#define HKDS_FACTORY_HEADER_MASK 0xFF00FFFFUL
+
+/*!
+ * \def HKDS_FACTORY_HEADER_WORD
+ * \brief The header word of a packet type, with the sequence number cleared.
+ */
+#define HKDS_FACTORY_HEADER_WORD(type, size) ((uint32_t)(type) | ((uint32_t)HKDS_PROTOCOL_TYPE << 8U) | ((uint32_t)(size) << 24U))
+
+static uint32_t hkds_factory_header_word(const uint8_t* input)
+{
+	return (uint32_t)input[0U] | ((uint32_t)input[1U] << 8U) | ((uint32_t)input[2U] << 16U) | ((uint32_t)input[3U] << 24U);
+}
+
 /* header to raw packet */
 
 void hkds_factory_serialize_packet_header(uint8_t* output, const hkds_packet_header* header)
 {
-	utils_memory_copy(output, (const uint8_t*)header, HKDS_HEADER_SIZE);
+	hkds_factory_write_header(output, header);
 }
 
 void hkds_factory_serialize_client_message(uint8_t* output, const hkds_client_message_request* header)
 {
-	utils_memory_copy(output, (const uint8_t*)header, HKDS_CLIENT_MESSAGE_REQUEST_SIZE);
+	hkds_factory_write_header(output, &header->header);
+	utils_memory_copy(output + HKDS_PACKET_KSN_OFFSET, header->ksn, sizeof(header->ksn));
+	utils_memory_copy(output + HKDS_PACKET_MESSAGE_OFFSET, header->message, sizeof(header->message));
+	utils_memory_copy(output + HKDS_PACKET_TAG_OFFSET, header->tag, sizeof(header->tag));
 }
 
 void hkds_factory_serialize_client_token(uint8_t* output, const hkds_client_token_request* header)
 {
-	utils_memory_copy(output, (const uint8_t*)header, HKDS_CLIENT_TOKEN_REQUEST_SIZE);
+	hkds_factory_write_header(output, &header->header);
+	utils_memory_copy(output + HKDS_PACKET_KSN_OFFSET, header->ksn, sizeof(header->ksn));
 }
 
 void hkds_factory_serialize_server_message(uint8_t* output, const hkds_server_message_response* header)
 {
-	utils_memory_copy(output, (const uint8_t*)header, HKDS_SERVER_MESSAGE_RESPONSE_SIZE);
+	hkds_factory_write_header(output, &header->header);
+	utils_memory_copy(output + HKDS_HEADER_SIZE, header->message, sizeof(header->message));
 }
 
 void hkds_factory_serialize_server_token(uint8_t* output, const hkds_server_token_response* header)
 {
-	utils_memory_copy(output, (const uint8_t*)header, HKDS_SERVER_TOKEN_RESPONSE_SIZE);
+	hkds_factory_write_header(output, &header->header);
+	utils_memory_copy(output + HKDS_HEADER_SIZE, header->etok, sizeof(header->etok));
 }
 
 void hkds_factory_serialize_administrative_message(uint8_t* output, const hkds_administrative_message* header)
 {
-	utils_memory_copy(output, (const uint8_t*)header, HKDS_ADMIN_MESSAGE_SIZE);
+	hkds_factory_write_header(output, &header->header);
+	utils_memory_copy(output + HKDS_HEADER_SIZE, header->message, sizeof(header->message));
 }
 
 void hkds_factory_serialize_error_message(uint8_t* output, const hkds_error_message* header)
 {
-	utils_memory_copy(output, (const uint8_t*)header, HKDS_ERROR_MESSAGE_SIZE);
+	hkds_factory_write_header(output, &header->header);
+	utils_memory_copy(output + HKDS_HEADER_SIZE, header->message, sizeof(header->message));
 }
 
 /* raw packet to header */
 
 hkds_packet_header hkds_factory_extract_packet_header(const uint8_t* input)
 {
-	hkds_packet_header hdr = { 0U };
-
-	utils_memory_copy((uint8_t*)&hdr, input, HKDS_HEADER_SIZE);
-
-	return hdr;
+	return hkds_factory_read_header(input);
 }
 
 hkds_client_message_request hkds_factory_extract_client_message(const uint8_t* input)
 {
 	hkds_client_message_request hdr = { 0U };
 
-	utils_memory_copy((uint8_t*)&hdr, input, HKDS_CLIENT_MESSAGE_REQUEST_SIZE);
+	hdr.header = hkds_factory_read_header(input);
+	utils_memory_copy(hdr.ksn, input + HKDS_PACKET_KSN_OFFSET, sizeof(hdr.ksn));
+	utils_memory_copy(hdr.message, input + HKDS_PACKET_MESSAGE_OFFSET, sizeof(hdr.message));
+	utils_memory_copy(hdr.tag, input + HKDS_PACKET_TAG_OFFSET, sizeof(hdr.tag));
 
 	return hdr;
 }
@@ -62,7 +109,8 @@ hkds_client_token_request hkds_factory_extract_client_token(const uint8_t* input
 {
 	hkds_client_token_request hdr = { 0U };
 
-	utils_memory_copy((uint8_t*)&hdr, input, HKDS_CLIENT_TOKEN_REQUEST_SIZE);
+	hdr.header = hkds_factory_read_header(input);
+	utils_memory_copy(hdr.ksn, input + HKDS_PACKET_KSN_OFFSET, sizeof(hdr.ksn));
 
 	return hdr;
 }
@@ -71,7 +119,8 @@ hkds_server_message_response hkds_factory_extract_server_message(const uint8_t*
 {
 	hkds_server_message_response hdr = { 0U };
 
-	utils_memory_copy((uint8_t*)&hdr, input, HKDS_SERVER_MESSAGE_RESPONSE_SIZE);
+	hdr.header = hkds_factory_read_header(input);
+	utils_memory_copy(hdr.message, input + HKDS_HEADER_SIZE, sizeof(hdr.message));
 
 	return hdr;
 }
@@ -80,7 +129,8 @@ hkds_server_token_response hkds_factory_extract_server_token(const uint8_t* inpu
 {
 	hkds_server_token_response hdr = { 0U };
 
-	utils_memory_copy((uint8_t*)&hdr, input, HKDS_SERVER_TOKEN_RESPONSE_SIZE);
+	hdr.header = hkds_factory_read_header(input);
+	utils_memory_copy(hdr.etok, input + HKDS_HEADER_SIZE, sizeof(hdr.etok));
 
 	return hdr;
 }
@@ -89,7 +139,8 @@ hkds_administrative_message hkds_factory_extract_administrative_message(const ui
 {
 	hkds_administrative_message hdr = { 0U };
 
-	utils_memory_copy((uint8_t*)&hdr, input, HKDS_ADMIN_MESSAGE_SIZE);
+	hdr.header = hkds_factory_read_header(input);
+	utils_memory_copy(hdr.message, input + HKDS_HEADER_SIZE, sizeof(hdr.message));
 
 	return hdr;
 }
@@ -98,7 +149,8 @@ hkds_error_message hkds_factory_extract_error_message(const uint8_t* input)
 {
 	hkds_error_message hdr = { 0U };
 
-	utils_memory_copy((uint8_t*)&hdr, input, HKDS_ERROR_MESSAGE_SIZE);
+	hdr.header = hkds_factory_read_header(input);
+	utils_memory_copy(hdr.message, input + HKDS_HEADER_SIZE, sizeof(hdr.message));
 
 	return hdr;
 }
@@ -223,37 +275,455 @@ hkds_error_message hkds_factory_create_error_message(const uint8_t* message, hkd
 
 hkds_packet_type hkds_factory_extract_packet_type(const uint8_t* input)
 {
-	hkds_packet_header hdr;
+	return (hkds_packet_type)input[HKDS_PACKET_FLAG_OFFSET];
+}
 
-	hdr = hkds_factory_extract_packet_header(input);
+hkds_protocol_id hkds_factory_extract_protocol_id(const uint8_t* input)
+{
+	return (hkds_protocol_id)input[HKDS_PACKET_PROTOCOL_OFFSET];
+}
 
-	return hdr.flag;
+size_t hkds_factory_extract_packet_size(const uint8_t* input)
+{
+	return (size_t)input[HKDS_PACKET_LENGTH_OFFSET];
 }
 
-hkds_protocol_id hkds_factory_extract_protocol_id(const uint8_t* input)
+uint8_t hkds_factory_extract_packet_sequence(const uint8_t* input)
 {
-	hkds_packet_header hdr;
+	return input[HKDS_PACKET_SEQUENCE_OFFSET];
+}
+
+/* zero-copy packet views */
 
-	hdr = hkds_factory_extract_packet_header(input);
+size_t hkds_factory_packet_type_size(hkds_packet_type type)
+{
+	size_t res;
+
+	switch (type)
+	{
+		case packet_token_request:
+		{
+			res = HKDS_CLIENT_TOKEN_REQUEST_SIZE;
+			break;
+		}
+		case packet_token_response:
+		{
+			res = HKDS_SERVER_TOKEN_RESPONSE_SIZE;
+			break;
+		}
+		case packet_message_request:
+		{
+			res = HKDS_CLIENT_MESSAGE_REQUEST_SIZE;
+			break;
+		}
+		case packet_message_response:
+		{
+			res = HKDS_SERVER_MESSAGE_RESPONSE_SIZE;
+			break;
+		}
+		case packet_administrative_message:
+		{
+			res = HKDS_ADMIN_MESSAGE_SIZE;
+			break;
+		}
+		case packet_error_message:
+		{
+			res = HKDS_ERROR_MESSAGE_SIZE;
+			break;
+		}
+		default:
+		{
+			res = 0U;
+		}
+	}
 
-	return hdr.protocol;
+	return res;
 }
 
-size_t hkds_factory_extract_packet_size(const uint8_t* input)
+bool hkds_factory_view_packet(hkds_packet_view* view, const uint8_t* input, size_t inplen)
 {
-	hkds_packet_header hdr;
+	HKDS_ASSERT(view != NULL);
+	HKDS_ASSERT(input != NULL);
+
+	size_t plen;
+	bool res;
+
+	res = false;
 
-	hdr = hkds_factory_extract_packet_header(input);
+	if (view != NULL)
+	{
+		utils_memory_clear((uint8_t*)view, sizeof(hkds_packet_view));
+
+		if (input != NULL && inplen >= HKDS_HEADER_SIZE && input[HKDS_PACKET_PROTOCOL_OFFSET] == (uint8_t)HKDS_PROTOCOL_TYPE)
+		{
+			view->type = (hkds_packet_type)input[HKDS_PACKET_FLAG_OFFSET];
+			plen = hkds_factory_packet_type_size(view->type);
+
+			/* the length field must match the packet type, and the whole packet must be in the buffer */
+			if (plen != 0U && input[HKDS_PACKET_LENGTH_OFFSET] == plen && inplen >= plen)
+			{
+				view->packet = input;
+				view->length = plen;
+				view->sequence = input[HKDS_PACKET_SEQUENCE_OFFSET];
+
+				if (view->type == packet_message_request)
+				{
+					view->ksn = input + HKDS_PACKET_KSN_OFFSET;
+					view->message = input + HKDS_PACKET_MESSAGE_OFFSET;
+					view->tag = input + HKDS_PACKET_TAG_OFFSET;
+				}
+				else if (view->type == packet_token_request)
+				{
+					view->ksn = input + HKDS_PACKET_KSN_OFFSET;
+				}
+				else if (view->type == packet_token_response)
+				{
+					view->etok = input + HKDS_HEADER_SIZE;
+				}
+				else
+				{
+					view->message = input + HKDS_HEADER_SIZE;
+				}
+
+				res = true;
+			}
+		}
+	}
 
-	return (size_t)hdr.length;
+	return res;
 }
 
-uint8_t hkds_factory_extract_packet_sequence(const uint8_t* input)
+/* bulk packet parsing */
+
+void hkds_factory_reset_batch(hkds_packet_batch* batch, bool authenticated)
 {
-	hkds_packet_header hdr;
+	HKDS_ASSERT(batch != NULL);
+
+	if (batch != NULL)
+	{
+		batch->messages = 0U;
+		batch->tokens = 0U;
+		batch->rejected = 0U;
+		batch->authenticated = authenticated;
+		batch->malformed = false;
+	}
+}
+
+size_t hkds_factory_parse_packets(hkds_packet_batch* batch, const uint8_t* input, size_t inplen)
+{
+	HKDS_ASSERT(batch != NULL);
+	HKDS_ASSERT(input != NULL);
+
+	const uint32_t msgw = HKDS_FACTORY_HEADER_WORD(packet_message_request, HKDS_CLIENT_MESSAGE_REQUEST_SIZE);
+	const uint32_t tokw = HKDS_FACTORY_HEADER_WORD(packet_token_request, HKDS_CLIENT_TOKEN_REQUEST_SIZE);
+	uint32_t hdr;
+	size_t grp;
+	size_t lane;
+	size_t plen;
+	size_t pos;
+
+	pos = 0U;
+
+	if (batch != NULL && input != NULL)
+	{
+		while (inplen - pos >= HKDS_HEADER_SIZE)
+		{
+			hdr = hkds_factory_header_word(input + pos) & HKDS_FACTORY_HEADER_MASK;
+			plen = (size_t)input[pos + HKDS_PACKET_LENGTH_OFFSET];
+
+			if (input[pos + HKDS_PACKET_FLAG_OFFSET] == (uint8_t)packet_batch_request ||
+				input[pos + HKDS_PACKET_FLAG_OFFSET] == (uint8_t)packet_batch_response)
+			{
+				/* an envelope is skipped whole; its records are read with a batch view */
+				if (inplen - pos < HKDS_BATCH_HEADER_SIZE)
+				{
+					break;
+				}
+
+				plen = hkds_factory_extract_batch_size(input + pos);
+			}
+
+			if (plen < HKDS_HEADER_SIZE)
+			{
+				batch->malformed = true;
+				break;
+			}
+
+			if (inplen - pos < plen)
+			{
+				/* the packet continues in the next buffer */
+				break;
+			}
+
+			if (hdr == msgw)
+			{
+				if (batch->messages == HKDS_CACHX64_SIZE)
+				{
+					break;
+				}
+
+				grp = batch->messages / HKDS_CACHX8_DEPTH;
+				lane = batch->messages % HKDS_CACHX8_DEPTH;
+				utils_memory_copy(batch->msgksn[grp][lane], input + pos + HKDS_PACKET_KSN_OFFSET, HKDS_KSN_SIZE);
+
+				if (batch->authenticated == true)
+				{
+					/* the tag follows the cipher-text on the wire, so both are copied at once */
+					utils_memory_copy(batch->authmessage[grp][lane], input + pos + HKDS_PACKET_MESSAGE_OFFSET, HKDS_MESSAGE_SIZE + HKDS_TAG_SIZE);
+				}
+				else
+				{
+					utils_memory_copy(batch->message[grp][lane], input + pos + HKDS_PACKET_MESSAGE_OFFSET, HKDS_MESSAGE_SIZE);
+				}
+
+				++batch->messages;
+			}
+			else if (hdr == tokw)
+			{
+				if (batch->tokens == HKDS_CACHX64_SIZE)
+				{
+					break;
+				}
+
+				grp = batch->tokens / HKDS_CACHX8_DEPTH;
+				lane = batch->tokens % HKDS_CACHX8_DEPTH;
+				utils_memory_copy(batch->tokksn[grp][lane], input + pos + HKDS_PACKET_KSN_OFFSET, HKDS_KSN_SIZE);
+				++batch->tokens;
+			}
+			else
+			{
+				++batch->rejected;
+			}
+
+			pos += plen;
+		}
+	}
+
+	return pos;
+}
+
+/* batch envelopes */
+
+static void hkds_factory_write_batch_header(uint8_t* output, hkds_packet_type type, hkds_packet_type rectype, size_t count, uint8_t sequence)
+{
+	output[HKDS_PACKET_FLAG_OFFSET] = (uint8_t)type;
+	output[HKDS_PACKET_PROTOCOL_OFFSET] = (uint8_t)HKDS_PROTOCOL_TYPE;
+	output[HKDS_PACKET_SEQUENCE_OFFSET] = sequence;
+	output[HKDS_PACKET_LENGTH_OFFSET] = (uint8_t)HKDS_BATCH_HEADER_SIZE;
+	output[HKDS_HEADER_SIZE] = (uint8_t)(count >> 8U);
+	output[HKDS_HEADER_SIZE + 1U] = (uint8_t)count;
+	output[HKDS_HEADER_SIZE + 2U] = (uint8_t)rectype;
+	output[HKDS_HEADER_SIZE + 3U] = 0x00U;
+}
+
+static bool hkds_factory_batch_pairing(hkds_packet_type type, hkds_packet_type rectype)
+{
+	bool res;
+
+	/* a request envelope carries requests, and a response envelope responses */
+	if (type == packet_batch_request)
+	{
+		res = (rectype == packet_message_request || rectype == packet_token_request);
+	}
+	else if (type == packet_batch_response)
+	{
+		res = (rectype == packet_message_response || rectype == packet_token_response);
+	}
+	else
+	{
+		res = false;
+	}
+
+	return res;
+}
+
+size_t hkds_factory_batch_record_size(hkds_packet_type rectype)
+{
+	size_t res;
+
+	res = 0U;
+
+	if (rectype == packet_message_request)
+	{
+		res = HKDS_CLIENT_MESSAGE_REQUEST_SIZE - HKDS_HEADER_SIZE;
+	}
+	else if (rectype == packet_token_request)
+	{
+		res = HKDS_CLIENT_TOKEN_REQUEST_SIZE - HKDS_HEADER_SIZE;
+	}
+	else if (rectype == packet_message_response)
+	{
+		res = HKDS_SERVER_MESSAGE_RESPONSE_SIZE - HKDS_HEADER_SIZE;
+	}
+	else if (rectype == packet_token_response)
+	{
+		res = HKDS_SERVER_TOKEN_RESPONSE_SIZE - HKDS_HEADER_SIZE;
+	}
+
+	return res;
+}
+
+size_t hkds_factory_extract_batch_size(const uint8_t* input)
+{
+	HKDS_ASSERT(input != NULL);
+
+	hkds_packet_type rectype;
+	hkds_packet_type type;
+	size_t cnt;
+	size_t res;
+
+	res = 0U;
+
+	if (input != NULL)
+	{
+		type = (hkds_packet_type)input[HKDS_PACKET_FLAG_OFFSET];
+		rectype = (hkds_packet_type)input[HKDS_HEADER_SIZE + 2U];
+		cnt = ((size_t)input[HKDS_HEADER_SIZE] << 8U) | (size_t)input[HKDS_HEADER_SIZE + 1U];
+
+		if (hkds_factory_batch_pairing(type, rectype) == true && input[HKDS_PACKET_LENGTH_OFFSET] == HKDS_BATCH_HEADER_SIZE &&
+			cnt != 0U && cnt <= HKDS_BATCH_MAX_RECORDS)
+		{
+			res = HKDS_BATCH_HEADER_SIZE + (cnt * hkds_factory_batch_record_size(rectype));
+		}
+	}
 
-	hdr = hkds_factory_extract_packet_header(input);
+	return res;
+}
+
+size_t hkds_factory_serialize_batch_request(uint8_t* output, size_t outlen, hkds_packet_type rectype, const uint8_t* const* ksn,
+	const uint8_t* const* message, const uint8_t* const* tag, size_t count, uint8_t sequence)
+{
+	HKDS_ASSERT(output != NULL);
+	HKDS_ASSERT(ksn != NULL);
+
+	uint8_t* rec;
+	size_t rlen;
+	size_t res;
+
+	res = 0U;
+
+	if (output != NULL && ksn != NULL && count != 0U && count <= HKDS_BATCH_MAX_RECORDS &&
+		hkds_factory_batch_pairing(packet_batch_request, rectype) == true && (rectype == packet_token_request || message != NULL))
+	{
+		rlen = hkds_factory_batch_record_size(rectype);
+
+		if (outlen >= HKDS_BATCH_HEADER_SIZE + (count * rlen))
+		{
+			hkds_factory_write_batch_header(output, packet_batch_request, rectype, count, sequence);
+			rec = output + HKDS_BATCH_HEADER_SIZE;
+
+			for (size_t i = 0U; i < count; ++i)
+			{
+				utils_memory_copy(rec, ksn[i], HKDS_KSN_SIZE);
+
+				if (rectype == packet_message_request)
+				{
+					utils_memory_copy(rec + HKDS_KSN_SIZE, message[i], HKDS_MESSAGE_SIZE);
+
+					if (tag != NULL)
+					{
+						utils_memory_copy(rec + HKDS_KSN_SIZE + HKDS_MESSAGE_SIZE, tag[i], HKDS_TAG_SIZE);
+					}
+					else
+					{
+						utils_memory_clear(rec + HKDS_KSN_SIZE + HKDS_MESSAGE_SIZE, HKDS_TAG_SIZE);
+					}
+				}
+
+				rec += rlen;
+			}
+
+			res = HKDS_BATCH_HEADER_SIZE + (count * rlen);
+		}
+	}
 
-	return hdr.sequence;
+	return res;
 }
 
+size_t hkds_factory_serialize_batch_response(uint8_t* output, size_t outlen, hkds_packet_type rectype,
+	const uint8_t* const* payload, size_t count, uint8_t sequence)
+{
+	HKDS_ASSERT(output != NULL);
+
+	size_t rlen;
+	size_t res;
+
+	res = 0U;
+
+	if (output != NULL && count != 0U && count <= HKDS_BATCH_MAX_RECORDS &&
+		hkds_factory_batch_pairing(packet_batch_response, rectype) == true)
+	{
+		rlen = hkds_factory_batch_record_size(rectype);
+
+		if (outlen >= HKDS_BATCH_HEADER_SIZE + (count * rlen))
+		{
+			hkds_factory_write_batch_header(output, packet_batch_response, rectype, count, sequence);
+
+			if (payload != NULL)
+			{
+				for (size_t i = 0U; i < count; ++i)
+				{
+					utils_memory_copy(output + HKDS_BATCH_HEADER_SIZE + (i * rlen), payload[i], rlen);
+				}
+			}
+			else
+			{
+				/* the records are reserved, and written in place by the caller */
+				utils_memory_clear(output + HKDS_BATCH_HEADER_SIZE, count * rlen);
+			}
+
+			res = HKDS_BATCH_HEADER_SIZE + (count * rlen);
+		}
+	}
+
+	return res;
+}
+
+bool hkds_factory_view_batch(hkds_batch_view* view, const uint8_t* input, size_t inplen)
+{
+	HKDS_ASSERT(view != NULL);
+	HKDS_ASSERT(input != NULL);
+
+	size_t blen;
+	bool res;
+
+	res = false;
+
+	if (view != NULL)
+	{
+		utils_memory_clear((uint8_t*)view, sizeof(hkds_batch_view));
+
+		if (input != NULL && inplen >= HKDS_BATCH_HEADER_SIZE && input[HKDS_PACKET_PROTOCOL_OFFSET] == (uint8_t)HKDS_PROTOCOL_TYPE)
+		{
+			blen = hkds_factory_extract_batch_size(input);
+
+			if (blen != 0U && inplen >= blen)
+			{
+				view->type = (hkds_packet_type)input[HKDS_PACKET_FLAG_OFFSET];
+				view->rectype = (hkds_packet_type)input[HKDS_HEADER_SIZE + 2U];
+				view->sequence = input[HKDS_PACKET_SEQUENCE_OFFSET];
+				view->stride = hkds_factory_batch_record_size(view->rectype);
+				view->count = (blen - HKDS_BATCH_HEADER_SIZE) / view->stride;
+				view->length = blen;
+				view->records = input + HKDS_BATCH_HEADER_SIZE;
+				res = true;
+			}
+		}
+	}
+
+	return res;
+}
+
+void hkds_factory_batch_pointers(const hkds_batch_view* view, size_t offset, const uint8_t** output)
+{
+	HKDS_ASSERT(view != NULL);
+	HKDS_ASSERT(output != NULL);
+
+	if (view != NULL && output != NULL && offset < view->stride)
+	{
+		for (size_t i = 0U; i < view->count; ++i)
+		{
+			output[i] = view->records + (i * view->stride) + offset;
+		}
+	}
+}
@@ -67,8 +67,121 @@
  *    server token, administrative, and error messages) for network transmission.
  *  - Extraction of packet structures and header fields from serialized byte arrays.
  *  - Construction of packet structures by combining individual components.
+ *  - Zero-copy views of received packets, validated once, with pointers to the fields in the receive buffer.
+ *  - A bulk parser that sorts a buffer of back-to-back request packets into batches shaped for the x8 and x64
+ *    server functions.
+ *  - Batch envelopes, which carry many requests, or their responses, behind a single header, and are read in place.
+ *
+ * The wire header is four bytes; the packet type, the protocol identifier, the sequence number, and the packet
+ * length, in that order. The \ref hkds_packet_header structure stores the type and protocol as enumerations and
+ * is wider than the wire header, so the serialization functions encode and decode the header field by field.
  */
 
+/*!
+ * \def HKDS_PACKET_FLAG_OFFSET
+ * \brief The offset of the packet type in the wire header.
+ */
+#define HKDS_PACKET_FLAG_OFFSET 0U
+
+/*!
+ * \def HKDS_PACKET_PROTOCOL_OFFSET
+ * \brief The offset of the protocol identifier in the wire header.
+ */
+#define HKDS_PACKET_PROTOCOL_OFFSET 1U
+
+/*!
+ * \def HKDS_PACKET_SEQUENCE_OFFSET
+ * \brief The offset of the sequence number in the wire header.
+ */
+#define HKDS_PACKET_SEQUENCE_OFFSET 2U
+
+/*!
+ * \def HKDS_PACKET_LENGTH_OFFSET
+ * \brief The offset of the packet length in the wire header.
+ */
+#define HKDS_PACKET_LENGTH_OFFSET 3U
+
+/*!
+ * \def HKDS_PACKET_KSN_OFFSET
+ * \brief The offset of the key serial number in a client request.
+ */
+#define HKDS_PACKET_KSN_OFFSET HKDS_HEADER_SIZE
+
+/*!
+ * \def HKDS_PACKET_MESSAGE_OFFSET
+ * \brief The offset of the encrypted message in a client message request.
+ */
+#define HKDS_PACKET_MESSAGE_OFFSET (HKDS_HEADER_SIZE + HKDS_KSN_SIZE)
+
+/*!
+ * \def HKDS_PACKET_TAG_OFFSET
+ * \brief The offset of the authentication tag in a client message request.
+ */
+#define HKDS_PACKET_TAG_OFFSET (HKDS_HEADER_SIZE + HKDS_KSN_SIZE + HKDS_MESSAGE_SIZE)
+
+/*!
+ * \struct hkds_packet_view
+ * \brief A validated packet in a receive buffer.
+ *
+ * \details
+ * The field pointers refer to the receive buffer, and are NULL when the packet type does not carry the field;
+ * a client message request has a KSN, message, and tag, a token request a KSN, a token response an encrypted
+ * token, and the other packets a message. The view is valid while the receive buffer is unchanged.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    const uint8_t* packet;      /*!< The start of the packet */
+    const uint8_t* ksn;         /*!< The client's key serial number */
+    const uint8_t* message;     /*!< The message payload */
+    const uint8_t* tag;         /*!< The authentication tag */
+    const uint8_t* etok;        /*!< The encrypted token */
+    size_t length;              /*!< The packet length, including the header */
+    hkds_packet_type type;      /*!< The packet type */
+    uint8_t sequence;           /*!< The packet sequence number */
+} hkds_packet_view;
+
+/*!
+ * \struct hkds_packet_batch
+ * \brief Client requests sorted by type and arranged for the x8 and x64 server functions.
+ *
+ * \details
+ * Message request i is stored in group i / 8, lane i % 8, so each group is the input of an x8 call and the whole
+ * set the input of an x64 call; token request KSNs are arranged the same way. The cipher-text is stored with its tag
+ * in the authenticated arrays when the batch is reset for authenticated messages, and without it otherwise.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    uint8_t msgksn[HKDS_PARALLEL_DEPTH][HKDS_CACHX8_DEPTH][HKDS_KSN_SIZE];                         /*!< The KSNs of the message requests */
+    uint8_t message[HKDS_PARALLEL_DEPTH][HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE];                    /*!< The cipher-text of unauthenticated message requests */
+    uint8_t authmessage[HKDS_PARALLEL_DEPTH][HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE + HKDS_TAG_SIZE]; /*!< The cipher-text and tag of authenticated message requests */
+    uint8_t tokksn[HKDS_PARALLEL_DEPTH][HKDS_CACHX8_DEPTH][HKDS_KSN_SIZE];                         /*!< The KSNs of the token requests */
+    size_t messages;                                                                               /*!< The number of message requests */
+    size_t tokens;                                                                                 /*!< The number of token requests */
+    size_t rejected;                                                                               /*!< The number of skipped packets of another type or protocol */
+    bool authenticated;                                                                            /*!< Message requests carry an authentication tag */
+    bool malformed;                                                                                /*!< Parsing stopped at a header with an invalid length */
+} hkds_packet_batch;
+
+/*!
+ * \struct hkds_batch_view
+ * \brief A validated batch envelope in a receive buffer.
+ *
+ * \details
+ * The records follow the envelope header back to back; each record is the body of a packet of the record type,
+ * without the packet header. A message request record is the KSN, the cipher-text, and the tag, a token request
+ * record the KSN, a message response record the message, and a token response record the encrypted token.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    const uint8_t* records;     /*!< The first record */
+    size_t count;               /*!< The number of records */
+    size_t stride;              /*!< The record size */
+    size_t length;              /*!< The envelope size, including the header */
+    hkds_packet_type type;      /*!< The envelope type; a batch request or a batch response */
+    hkds_packet_type rectype;   /*!< The packet type of the records */
+    uint8_t sequence;           /*!< The envelope sequence number */
+} hkds_batch_view;
+
 /* convert header to serialized packet */
 
 /**
@@ -272,4 +385,132 @@ HKDS_EXPORT_API size_t hkds_factory_extract_packet_size(const uint8_t* input);
  */
 HKDS_EXPORT_API uint8_t hkds_factory_extract_packet_sequence(const uint8_t* input);
 
+/* zero-copy packet views */
+
+/**
+ * \brief Get the wire size of a packet type.
+ *
+ * \param type [in] The packet type.
+ * \return The packet size including the header, or zero if the type is unknown.
+ */
+HKDS_EXPORT_API size_t hkds_factory_packet_type_size(hkds_packet_type type);
+
+/**
+ * \brief Validate a received packet and view its fields in place.
+ *
+ * \details
+ * The packet is checked once: the protocol identifier must match the configured protocol, the type must be known,
+ * the length field must equal the size of the type, and the buffer must hold the whole packet. No bytes are copied.
+ *
+ * \param view [out] The packet view; cleared if the packet is invalid.
+ * \param input [in] The receive buffer, starting at the packet header.
+ * \param inplen [in] The number of bytes in the receive buffer.
+ * \return Returns true if the packet is valid.
+ */
+HKDS_EXPORT_API bool hkds_factory_view_packet(hkds_packet_view* view, const uint8_t* input, size_t inplen);
+
+/**
+ * \brief Empty a packet batch.
+ *
+ * \param batch [out] The packet batch.
+ * \param authenticated [in] Message requests carry an authentication tag.
+ */
+HKDS_EXPORT_API void hkds_factory_reset_batch(hkds_packet_batch* batch, bool authenticated);
+
+/**
+ * \brief Parse a buffer of back-to-back packets into a batch.
+ *
+ * \details
+ * The header of each packet is checked as a single 32-bit word against the expected type, protocol, and length of
+ * a message request and a token request, and the fields are copied once, into the batch arrays. Packets of another
+ * type or protocol, including batch envelopes, are skipped and counted. Parsing stops at the end of the buffer, at an
+ * incomplete packet, when the batch has no room for the next request, or at a header with a length field shorter
+ * than the header, which marks the batch as malformed. The requests are appended, so a batch can be filled from several buffers.
+ *
+ * \param batch [in,out] The packet batch.
+ * \param input [in] The buffer of packets.
+ * \param inplen [in] The number of bytes in the buffer.
+ * \return The number of bytes consumed; the unconsumed remainder starts at the first unparsed packet.
+ */
+HKDS_EXPORT_API size_t hkds_factory_parse_packets(hkds_packet_batch* batch, const uint8_t* input, size_t inplen);
+
+/* batch envelopes */
+
+/**
+ * \brief Get the record size of a batch envelope record type.
+ *
+ * \param rectype [in] The record type; a message or token request, or a message or token response.
+ * \return The record size, or zero if the type cannot be batched.
+ */
+HKDS_EXPORT_API size_t hkds_factory_batch_record_size(hkds_packet_type rectype);
+
+/**
+ * \brief Extract the total size of a batch envelope from its header.
+ *
+ * \param input [in] The serialized envelope, at least \c HKDS_BATCH_HEADER_SIZE bytes.
+ * \return The envelope size including the header, or zero if the record type or count is invalid.
+ */
+HKDS_EXPORT_API size_t hkds_factory_extract_batch_size(const uint8_t* input);
+
+/**
+ * \brief Serialize a batch envelope of client requests.
+ *
+ * \param output [out] The serialized envelope.
+ * \param outlen [in] The size of the output buffer.
+ * \param rectype [in] The record type; a message request or a token request.
+ * \param ksn [in] An array of pointers to the clients' key serial numbers.
+ * \param message [in] An array of pointers to the encrypted messages; unused for token requests.
+ * \param tag [in] An [optional] array of pointers to the authentication tags; the tags are zeroed if NULL.
+ * \param count [in] The number of requests; at most \c HKDS_BATCH_MAX_RECORDS.
+ * \param sequence [in] The envelope sequence number.
+ * \return The number of bytes written, or zero if the output is too small or a parameter is invalid.
+ */
+HKDS_EXPORT_API size_t hkds_factory_serialize_batch_request(uint8_t* output, size_t outlen, hkds_packet_type rectype, const uint8_t* const* ksn,
+    const uint8_t* const* message, const uint8_t* const* tag, size_t count, uint8_t sequence);
+
+/**
+ * \brief Serialize a batch envelope of server responses.
+ *
+ * \details
+ * The responses are stored in the order of the requests of the batch they answer. If no payload is supplied,
+ * the records are cleared, so a server can reserve the envelope and decrypt or encrypt each response into it in place.
+ *
+ * \param output [out] The serialized envelope.
+ * \param outlen [in] The size of the output buffer.
+ * \param rectype [in] The record type; a message response or a token response.
+ * \param payload [in] The [optional] array of pointers to the response messages or encrypted tokens.
+ * \param count [in] The number of responses; at most \c HKDS_BATCH_MAX_RECORDS.
+ * \param sequence [in] The envelope sequence number.
+ * \return The number of bytes written, or zero if the output is too small or a parameter is invalid.
+ */
+HKDS_EXPORT_API size_t hkds_factory_serialize_batch_response(uint8_t* output, size_t outlen, hkds_packet_type rectype,
+    const uint8_t* const* payload, size_t count, uint8_t sequence);
+
+/**
+ * \brief Validate a received batch envelope and view its records in place.
+ *
+ * \details
+ * The protocol identifier, the envelope type, the record type and count, and the buffer length are checked once;
+ * a request envelope must carry request records and a response envelope response records.
+ *
+ * \param view [out] The batch view; cleared if the envelope is invalid.
+ * \param input [in] The receive buffer, starting at the envelope header.
+ * \param inplen [in] The number of bytes in the receive buffer.
+ * \return Returns true if the envelope is valid.
+ */
+HKDS_EXPORT_API bool hkds_factory_view_batch(hkds_batch_view* view, const uint8_t* input, size_t inplen);
+
+/**
+ * \brief Fill an array of pointers to a field of every record in a batch envelope.
+ *
+ * \details
+ * The pointer array has the form taken by the server batch functions; for message request records, the KSNs are at
+ * offset zero, the cipher-text at \c HKDS_KSN_SIZE, and the tags at \c HKDS_KSN_SIZE plus \c HKDS_MESSAGE_SIZE.
+ *
+ * \param view [in] The batch view.
+ * \param offset [in] The byte offset of the field within a record.
+ * \param output [out] The array of pointers; it must hold the view record count.
+ */
+HKDS_EXPORT_API void hkds_factory_batch_pointers(const hkds_batch_view* view, size_t offset, const uint8_t** output);
+
 #endif
@@ -0,0 +1,424 @@
+#include "hkds_fleet.h"
+#include "hkds_client.h"
+#include "hkds_factory.h"
+#include "keccak.h"
+#include "utils.h"
+
+#define HKDS_FLEET_CACHE_BYTES (HKDS_CACHE_SIZE * HKDS_MESSAGE_SIZE)
+
+static uint32_t hkds_fleet_counter(const hkds_fleet_state* fleet, size_t device)
+{
+	return utils_integer_be8to32(fleet->ksn + (device * HKDS_KSN_SIZE) + HKDS_DID_SIZE);
+}
+
+static void hkds_fleet_settle(hkds_fleet_state* fleet, size_t device)
+{
+	/* a device that has used the last key of its epoch needs a new token */
+	fleet->status[device] = (hkds_fleet_counter(fleet, device) % HKDS_CACHE_SIZE == 0U) ?
+		(uint8_t)hkds_fleet_status_empty : (uint8_t)hkds_fleet_status_ready;
+}
+
+static void hkds_fleet_next_key(hkds_fleet_state* fleet, size_t device, uint8_t* key)
+{
+	uint8_t* ksn;
+	uint8_t* tkc;
+	size_t idx;
+
+	/* take the key at the counter position, erase it from the cache, and advance the counter */
+	ksn = fleet->ksn + (device * HKDS_KSN_SIZE);
+	idx = (size_t)hkds_fleet_counter(fleet, device) % HKDS_CACHE_SIZE;
+	tkc = fleet->tkc + (device * HKDS_FLEET_CACHE_BYTES) + (idx * HKDS_MESSAGE_SIZE);
+	utils_memory_copy(key, tkc, HKDS_MESSAGE_SIZE);
+	utils_memory_secure_erase(tkc, HKDS_MESSAGE_SIZE);
+	utils_integer_be8increment(ksn + HKDS_DID_SIZE, HKDS_TKC_SIZE);
+}
+
+static void hkds_fleet_tag_x8(uint8_t* const tag[HKDS_CACHX8_DEPTH], const uint8_t* const cpt[HKDS_CACHX8_DEPTH],
+	const uint8_t* const dat[HKDS_CACHX8_DEPTH], uint8_t mkey[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE])
+{
+	/* the KSN pointers stand in for the additional data, which has zero length */
+#if defined(HKDS_SHAKE_128)
+	hkds_kmac_128x8(tag[0U], tag[1U], tag[2U], tag[3U], tag[4U], tag[5U], tag[6U], tag[7U], HKDS_TAG_SIZE,
+		mkey[0U], mkey[1U], mkey[2U], mkey[3U], mkey[4U], mkey[5U], mkey[6U], mkey[7U], HKDS_MESSAGE_SIZE,
+		dat[0U], dat[1U], dat[2U], dat[3U], dat[4U], dat[5U], dat[6U], dat[7U], 0U,
+		cpt[0U], cpt[1U], cpt[2U], cpt[3U], cpt[4U], cpt[5U], cpt[6U], cpt[7U], HKDS_MESSAGE_SIZE);
+#elif defined(HKDS_SHAKE_256)
+	hkds_kmac_256x8(tag[0U], tag[1U], tag[2U], tag[3U], tag[4U], tag[5U], tag[6U], tag[7U], HKDS_TAG_SIZE,
+		mkey[0U], mkey[1U], mkey[2U], mkey[3U], mkey[4U], mkey[5U], mkey[6U], mkey[7U], HKDS_MESSAGE_SIZE,
+		dat[0U], dat[1U], dat[2U], dat[3U], dat[4U], dat[5U], dat[6U], dat[7U], 0U,
+		cpt[0U], cpt[1U], cpt[2U], cpt[3U], cpt[4U], cpt[5U], cpt[6U], cpt[7U], HKDS_MESSAGE_SIZE);
+#else
+	hkds_kmac_512x8(tag[0U], tag[1U], tag[2U], tag[3U], tag[4U], tag[5U], tag[6U], tag[7U], HKDS_TAG_SIZE,
+		mkey[0U], mkey[1U], mkey[2U], mkey[3U], mkey[4U], mkey[5U], mkey[6U], mkey[7U], HKDS_MESSAGE_SIZE,
+		dat[0U], dat[1U], dat[2U], dat[3U], dat[4U], dat[5U], dat[6U], dat[7U], 0U,
+		cpt[0U], cpt[1U], cpt[2U], cpt[3U], cpt[4U], cpt[5U], cpt[6U], cpt[7U], HKDS_MESSAGE_SIZE);
+#endif
+}
+
+static void hkds_fleet_tag(uint8_t* tag, const uint8_t* cpt, const uint8_t* dat, const uint8_t* mkey)
+{
+#if defined(HKDS_SHAKE_128)
+	hkds_kmac128_compute(tag, HKDS_TAG_SIZE, cpt, HKDS_MESSAGE_SIZE, mkey, HKDS_MESSAGE_SIZE, dat, 0U);
+#elif defined(HKDS_SHAKE_256)
+	hkds_kmac256_compute(tag, HKDS_TAG_SIZE, cpt, HKDS_MESSAGE_SIZE, mkey, HKDS_MESSAGE_SIZE, dat, 0U);
+#else
+	hkds_kmac512_compute(tag, HKDS_TAG_SIZE, cpt, HKDS_MESSAGE_SIZE, mkey, HKDS_MESSAGE_SIZE, dat, 0U);
+#endif
+}
+
+bool hkds_fleet_initialize(hkds_fleet_state* fleet, size_t count, bool authenticated)
+{
+	HKDS_ASSERT(fleet != NULL);
+	HKDS_ASSERT(count != 0U);
+
+	bool res;
+
+	res = false;
+
+	if (fleet != NULL && count != 0U)
+	{
+		utils_memory_clear((uint8_t*)fleet, sizeof(hkds_fleet_state));
+		fleet->edk = (uint8_t*)utils_memory_aligned_alloc(HKDS_SIMD_ALIGNMENT, count * HKDS_EDK_SIZE);
+		fleet->ksn = (uint8_t*)utils_memory_aligned_alloc(HKDS_SIMD_ALIGNMENT, count * HKDS_KSN_SIZE);
+		fleet->tkc = (uint8_t*)utils_memory_aligned_alloc(HKDS_SIMD_ALIGNMENT, count * HKDS_FLEET_CACHE_BYTES);
+		fleet->token = (uint8_t*)utils_memory_aligned_alloc(HKDS_SIMD_ALIGNMENT, count * HKDS_STK_SIZE);
+		fleet->expected = (uint8_t*)utils_memory_aligned_alloc(HKDS_SIMD_ALIGNMENT, count * HKDS_MESSAGE_SIZE);
+		fleet->status = (uint8_t*)utils_memory_aligned_alloc(HKDS_SIMD_ALIGNMENT, count);
+		fleet->refresh = (size_t*)utils_memory_aligned_alloc(HKDS_SIMD_ALIGNMENT, count * sizeof(size_t));
+		fleet->count = count;
+		fleet->authenticated = authenticated;
+
+		if (fleet->edk != NULL && fleet->ksn != NULL && fleet->tkc != NULL && fleet->token != NULL && fleet->expected != NULL &&
+			fleet->status != NULL && fleet->refresh != NULL)
+		{
+			utils_memory_clear(fleet->edk, count * HKDS_EDK_SIZE);
+			utils_memory_clear(fleet->ksn, count * HKDS_KSN_SIZE);
+			utils_memory_clear(fleet->tkc, count * HKDS_FLEET_CACHE_BYTES);
+			utils_memory_clear(fleet->token, count * HKDS_STK_SIZE);
+			utils_memory_clear(fleet->expected, count * HKDS_MESSAGE_SIZE);
+			utils_memory_clear(fleet->status, count);
+			res = true;
+		}
+		else
+		{
+			hkds_fleet_dispose(fleet);
+		}
+	}
+
+	return res;
+}
+
+void hkds_fleet_dispose(hkds_fleet_state* fleet)
+{
+	HKDS_ASSERT(fleet != NULL);
+
+	if (fleet != NULL)
+	{
+		if (fleet->edk != NULL)
+		{
+			utils_memory_secure_erase(fleet->edk, fleet->count * HKDS_EDK_SIZE);
+			utils_memory_aligned_free(fleet->edk);
+		}
+
+		if (fleet->tkc != NULL)
+		{
+			utils_memory_secure_erase(fleet->tkc, fleet->count * HKDS_FLEET_CACHE_BYTES);
+			utils_memory_aligned_free(fleet->tkc);
+		}
+
+		if (fleet->token != NULL)
+		{
+			utils_memory_secure_erase(fleet->token, fleet->count * HKDS_STK_SIZE);
+			utils_memory_aligned_free(fleet->token);
+		}
+
+		if (fleet->ksn != NULL)
+		{
+			utils_memory_aligned_free(fleet->ksn);
+		}
+
+		if (fleet->expected != NULL)
+		{
+			utils_memory_aligned_free(fleet->expected);
+		}
+
+		if (fleet->status != NULL)
+		{
+			utils_memory_aligned_free(fleet->status);
+		}
+
+		if (fleet->refresh != NULL)
+		{
+			utils_memory_aligned_free(fleet->refresh);
+		}
+
+		utils_memory_clear((uint8_t*)fleet, sizeof(hkds_fleet_state));
+	}
+}
+
+void hkds_fleet_provision(hkds_fleet_state* fleet, hkds_master_key* mdk, const uint8_t* did, uint32_t first)
+{
+	HKDS_ASSERT(fleet != NULL);
+	HKDS_ASSERT(mdk != NULL);
+	HKDS_ASSERT(did != NULL);
+
+	uint8_t tdid[HKDS_CACHX8_DEPTH][HKDS_DID_SIZE] = { 0U };
+	uint8_t tedk[HKDS_CACHX8_DEPTH][HKDS_EDK_SIZE] = { 0U };
+	hkds_server_x8_state tss = { 0 };
+	uint32_t ctr;
+	size_t dev;
+
+	if (fleet != NULL && mdk != NULL && did != NULL)
+	{
+		tss.mdk = mdk;
+
+		for (size_t base = 0U; base < fleet->count; base += HKDS_CACHX8_DEPTH)
+		{
+			/* the lanes past the last device repeat it, and their keys are discarded */
+			for (size_t i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+			{
+				dev = (base + i < fleet->count) ? base + i : fleet->count - 1U;
+				utils_memory_copy(tdid[i], did, HKDS_DID_SIZE);
+				utils_integer_be32to8(tdid[i] + HKDS_DID_SIZE - sizeof(uint32_t), first + (uint32_t)dev);
+			}
+
+			hkds_server_generate_edk_x8(&tss, tdid, tedk);
+
+			for (size_t i = 0U; i < HKDS_CACHX8_DEPTH && base + i < fleet->count; ++i)
+			{
+				dev = base + i;
+				/* the starting positions are spread across the epoch; even in authenticated mode, so a message's key pair
+				   never straddles two epochs */
+				ctr = (uint32_t)(dev % HKDS_CACHE_SIZE);
+				ctr = (fleet->authenticated == true) ? (ctr & ~1U) : ctr;
+				utils_memory_copy(fleet->edk + (dev * HKDS_EDK_SIZE), tedk[i], HKDS_EDK_SIZE);
+				utils_memory_copy(fleet->ksn + (dev * HKDS_KSN_SIZE), tdid[i], HKDS_DID_SIZE);
+				utils_integer_be32to8(fleet->ksn + (dev * HKDS_KSN_SIZE) + HKDS_DID_SIZE, ctr);
+				fleet->status[dev] = (uint8_t)hkds_fleet_status_empty;
+			}
+		}
+
+		fleet->cursor = 0U;
+		fleet->refreshcount = 0U;
+		utils_memory_secure_erase((uint8_t*)tedk, sizeof(tedk));
+		utils_memory_secure_erase((uint8_t*)&tss, sizeof(tss));
+	}
+}
+
+size_t hkds_fleet_generate(hkds_fleet_state* fleet, uint8_t* output, size_t outlen, size_t* devices, size_t maxcount, size_t* count)
+{
+	HKDS_ASSERT(fleet != NULL);
+	HKDS_ASSERT(output != NULL);
+	HKDS_ASSERT(devices != NULL);
+	HKDS_ASSERT(count != NULL);
+
+	uint8_t mkey[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0U };
+	uint8_t ctxt[HKDS_MESSAGE_SIZE] = { 0U };
+	const uint8_t* cpt[HKDS_CACHX8_DEPTH] = { NULL };
+	const uint8_t* dat[HKDS_CACHX8_DEPTH] = { NULL };
+	uint8_t* tag[HKDS_CACHX8_DEPTH] = { NULL };
+	hkds_client_message_request mreq = { 0 };
+	hkds_client_token_request treq;
+	const uint8_t* ksn;
+	uint8_t* pkt;
+	size_t lanes;
+	size_t polled;
+	size_t dev;
+	size_t res;
+
+	res = 0U;
+	lanes = 0U;
+
+	if (fleet != NULL && output != NULL && devices != NULL && count != NULL)
+	{
+		*count = 0U;
+
+		for (polled = 0U; polled < fleet->count && *count < maxcount && outlen - res >= HKDS_CLIENT_MESSAGE_REQUEST_SIZE; ++polled)
+		{
+			dev = fleet->cursor;
+			fleet->cursor = (fleet->cursor + 1U == fleet->count) ? 0U : fleet->cursor + 1U;
+			ksn = fleet->ksn + (dev * HKDS_KSN_SIZE);
+			pkt = output + res;
+
+			if (fleet->status[dev] == (uint8_t)hkds_fleet_status_ready)
+			{
+				/* the plaintext is the key serial number of the transaction */
+				utils_memory_copy(fleet->expected + (dev * HKDS_MESSAGE_SIZE), ksn, HKDS_MESSAGE_SIZE);
+				hkds_fleet_next_key(fleet, dev, ctxt);
+
+				for (size_t i = 0U; i < HKDS_MESSAGE_SIZE; ++i)
+				{
+					ctxt[i] ^= fleet->expected[(dev * HKDS_MESSAGE_SIZE) + i];
+				}
+
+				/* the request carries the key serial number before the counter was advanced */
+				mreq = hkds_factory_create_client_message_request(ctxt, fleet->expected + (dev * HKDS_MESSAGE_SIZE), NULL);
+				hkds_factory_serialize_client_message(pkt, &mreq);
+
+				if (fleet->authenticated == true)
+				{
+					/* the tag is computed with the next key, together with those of seven other requests */
+					hkds_fleet_next_key(fleet, dev, mkey[lanes]);
+					cpt[lanes] = pkt + HKDS_PACKET_MESSAGE_OFFSET;
+					dat[lanes] = pkt + HKDS_PACKET_KSN_OFFSET;
+					tag[lanes] = pkt + HKDS_PACKET_TAG_OFFSET;
+					++lanes;
+
+					if (lanes == HKDS_CACHX8_DEPTH)
+					{
+						hkds_fleet_tag_x8(tag, cpt, dat, mkey);
+						lanes = 0U;
+					}
+				}
+
+				fleet->status[dev] = (uint8_t)hkds_fleet_status_message;
+				devices[*count] = dev;
+				++(*count);
+				res += HKDS_CLIENT_MESSAGE_REQUEST_SIZE;
+			}
+			else if (fleet->status[dev] == (uint8_t)hkds_fleet_status_empty)
+			{
+				treq = hkds_factory_create_client_token_request(ksn);
+				hkds_factory_serialize_client_token(pkt, &treq);
+				fleet->status[dev] = (uint8_t)hkds_fleet_status_token;
+				devices[*count] = dev;
+				++(*count);
+				res += HKDS_CLIENT_TOKEN_REQUEST_SIZE;
+			}
+		}
+
+		for (size_t i = 0U; i < lanes; ++i)
+		{
+			hkds_fleet_tag(tag[i], cpt[i], dat[i], mkey[i]);
+		}
+
+		utils_memory_secure_erase((uint8_t*)mkey, sizeof(mkey));
+		utils_memory_secure_erase(ctxt, sizeof(ctxt));
+	}
+
+	return res;
+}
+
+bool hkds_fleet_receive(hkds_fleet_state* fleet, size_t device, const uint8_t* packet, size_t length)
+{
+	HKDS_ASSERT(fleet != NULL);
+	HKDS_ASSERT(packet != NULL);
+
+	hkds_client_state cs;
+	hkds_packet_view pv;
+	bool res;
+
+	res = false;
+
+	if (fleet != NULL && packet != NULL && device < fleet->count &&
+		hkds_factory_view_packet(&pv, packet, length) == true && pv.length == length)
+	{
+		if (fleet->status[device] == (uint8_t)hkds_fleet_status_token && pv.type == packet_token_response)
+		{
+			/* the client token function needs only the device key and serial number */
+			utils_memory_copy(cs.edk, fleet->edk + (device * HKDS_EDK_SIZE), HKDS_EDK_SIZE);
+			utils_memory_copy(cs.ksn, fleet->ksn + (device * HKDS_KSN_SIZE), HKDS_KSN_SIZE);
+			res = hkds_client_decrypt_token(&cs, pv.etok, fleet->token + (device * HKDS_STK_SIZE));
+			utils_memory_secure_erase(cs.edk, sizeof(cs.edk));
+
+			if (res == true)
+			{
+				fleet->status[device] = (uint8_t)hkds_fleet_status_refresh;
+				fleet->refresh[fleet->refreshcount] = device;
+				++fleet->refreshcount;
+				++fleet->tokens;
+
+				if (fleet->refreshcount == HKDS_CACHX8_DEPTH)
+				{
+					hkds_fleet_refresh(fleet);
+				}
+			}
+		}
+		else if (fleet->status[device] == (uint8_t)hkds_fleet_status_message && pv.type == packet_message_response)
+		{
+			res = utils_memory_are_equal(pv.message, fleet->expected + (device * HKDS_MESSAGE_SIZE), HKDS_MESSAGE_SIZE);
+
+			if (res == true)
+			{
+				hkds_fleet_settle(fleet, device);
+				++fleet->messages;
+			}
+		}
+	}
+
+	if (res == false && fleet != NULL && device < fleet->count)
+	{
+		++fleet->failures;
+		hkds_fleet_abandon(fleet, device);
+	}
+
+	return res;
+}
+
+void hkds_fleet_refresh(hkds_fleet_state* fleet)
+{
+	HKDS_ASSERT(fleet != NULL);
+
+	uint8_t tmpk[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE + HKDS_EDK_SIZE] = { 0U };
+	uint8_t skey[HKDS_FLEET_CACHE_BYTES] = { 0U };
+	uint8_t* out[HKDS_CACHX8_DEPTH];
+	size_t dev;
+	size_t pos;
+
+	if (fleet != NULL)
+	{
+		for (pos = 0U; pos < fleet->refreshcount; pos += HKDS_CACHX8_DEPTH)
+		{
+			/* the caches are squeezed straight into the device rows; the unused lanes write to a scratch cache */
+			for (size_t i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+			{
+				dev = fleet->refresh[(pos + i < fleet->refreshcount) ? pos + i : pos];
+				utils_memory_copy(tmpk[i], fleet->token + (dev * HKDS_STK_SIZE), HKDS_STK_SIZE);
+				utils_memory_copy(((uint8_t*)tmpk[i] + HKDS_STK_SIZE), fleet->edk + (dev * HKDS_EDK_SIZE), HKDS_EDK_SIZE);
+				out[i] = (pos + i < fleet->refreshcount) ? fleet->tkc + (dev * HKDS_FLEET_CACHE_BYTES) : skey;
+			}
+
+#if defined(HKDS_SHAKE_128)
+			hkds_shake_128x8(out[0U], out[1U], out[2U], out[3U], out[4U], out[5U], out[6U], out[7U], HKDS_FLEET_CACHE_BYTES,
+				tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_STK_SIZE + HKDS_EDK_SIZE);
+#elif defined(HKDS_SHAKE_256)
+			hkds_shake_256x8(out[0U], out[1U], out[2U], out[3U], out[4U], out[5U], out[6U], out[7U], HKDS_FLEET_CACHE_BYTES,
+				tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_STK_SIZE + HKDS_EDK_SIZE);
+#else
+			hkds_shake_512x8(out[0U], out[1U], out[2U], out[3U], out[4U], out[5U], out[6U], out[7U], HKDS_FLEET_CACHE_BYTES,
+				tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_STK_SIZE + HKDS_EDK_SIZE);
+#endif
+
+			for (size_t i = 0U; i < HKDS_CACHX8_DEPTH && pos + i < fleet->refreshcount; ++i)
+			{
+				dev = fleet->refresh[pos + i];
+				utils_memory_secure_erase(fleet->token + (dev * HKDS_STK_SIZE), HKDS_STK_SIZE);
+				fleet->status[dev] = (uint8_t)hkds_fleet_status_ready;
+				++fleet->epochs;
+			}
+		}
+
+		fleet->refreshcount = 0U;
+		utils_memory_secure_erase((uint8_t*)tmpk, sizeof(tmpk));
+		utils_memory_secure_erase(skey, sizeof(skey));
+	}
+}
+
+void hkds_fleet_abandon(hkds_fleet_state* fleet, size_t device)
+{
+	HKDS_ASSERT(fleet != NULL);
+
+	if (fleet != NULL && device < fleet->count)
+	{
+		if (fleet->status[device] == (uint8_t)hkds_fleet_status_token)
+		{
+			/* the token of the same epoch is requested again */
+			fleet->status[device] = (uint8_t)hkds_fleet_status_empty;
+		}
+		else if (fleet->status[device] == (uint8_t)hkds_fleet_status_message)
+		{
+			/* the keys of the lost message are spent */
+			hkds_fleet_settle(fleet, device);
+		}
+	}
+}
@@ -0,0 +1,202 @@
+/* 2021-2026 Quantum Resistant Cryptographic Solutions Corporation
+ * All Rights Reserved.
+ *
+ * NOTICE:
+ * This software and all accompanying materials are the exclusive property of
+ * Quantum Resistant Cryptographic Solutions Corporation (QRCS). The intellectual
+ * and technical concepts contained herein are proprietary to QRCS and are
+ * protected under applicable Canadian, U.S., and international copyright,
+ * patent, and trade secret laws.
+ *
+ * CRYPTOGRAPHIC ALGORITHMS AND IMPLEMENTATIONS:
+ * - This software includes implementations of cryptographic primitives and
+ *   algorithms that are standardized or in the public domain, such as AES
+ *   and SHA-3, which are not proprietary to QRCS.
+ * - This software also includes cryptographic primitives, constructions, and
+ *   algorithms designed by QRCS, including but not limited to RCS, SCB, CSX, QMAC, and
+ *   related components, which are proprietary to QRCS.
+ * - All source code, implementations, protocol compositions, optimizations,
+ *   parameter selections, and engineering work contained in this software are
+ *   original works of QRCS and are protected under this license.
+ *
+ * LICENSE AND USE RESTRICTIONS:
+ * - This software is licensed under the Quantum Resistant Cryptographic Solutions
+ *   Public Research and Evaluation License (QRCS-PREL), 2025-2026.
+ * - Permission is granted solely for non-commercial evaluation, academic research,
+ *   cryptographic analysis, interoperability testing, and feasibility assessment.
+ * - Commercial use, production deployment, commercial redistribution, or
+ *   integration into products or services is strictly prohibited without a
+ *   separate written license agreement executed with QRCS.
+ * - Licensing and authorized distribution are solely at the discretion of QRCS.
+ *
+ * EXPERIMENTAL CRYPTOGRAPHY NOTICE:
+ * Portions of this software may include experimental, novel, or evolving
+ * cryptographic designs. Use of this software is entirely at the user's risk.
+ *
+ * DISCLAIMER:
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE, SECURITY, OR NON-INFRINGEMENT. QRCS DISCLAIMS ALL
+ * LIABILITY FOR ANY DIRECT, INDIRECT, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING FROM THE USE OR MISUSE OF THIS SOFTWARE.
+ *
+ * FULL LICENSE:
+ * This software is subject to the Quantum Resistant Cryptographic Solutions
+ * Public Research and Evaluation License (QRCS-PREL), 2025-2026. The complete license terms
+ * are provided in the accompanying LICENSE file or at https://www.qrcscorp.ca.
+ *
+ * Written by: John G. Underhill
+ * Contact: contact@qrcscorp.ca
+ */
+
+#ifndef HKDS_FLEET_H
+#define HKDS_FLEET_H
+
+#include "common.h"
+#include "hkds_config.h"
+#include "hkds_server.h"
+
+/**
+ * \file hkds_fleet.h
+ * \brief This file contains the HKDS terminal fleet simulator definitions.
+ *
+ * \details
+ * A load test of a transaction server needs tens of thousands of terminals, and the client state models one device,
+ * with its own cache and scalar SHAKE calls. The fleet holds the state of many simulated devices in separate arrays,
+ * one per field, indexed by device, and advances them together:
+ * - The device keys are provisioned from the master key set with the x8 EDK kernel, eight devices at a time.
+ * - Each device starts at a different position of its first epoch, so the token exchanges of the fleet are spread
+ *   over time rather than arriving together, as they would from terminals installed on different days.
+ * - The caches of the devices whose tokens arrived are regenerated with the x8 SHAKE kernel, eight devices at a time;
+ *   a device whose cache is used up requests a token for its next epoch.
+ * - Message requests are encrypted with the next key of each device's cache, and in authenticated mode their tags are
+ *   computed with the x8 KMAC kernel, with no additional data, as the reference daemon verifies them.
+ *
+ * The message plaintext of a device is its key serial number at the time of the request, so an echoing server's
+ * responses can be checked. A device has at most one outstanding request, and its response is passed back with the
+ * device index; the caller routes the packets, and paces the fleet.
+ *
+ * The fleet is used by a single thread; a multi-threaded load generator gives each thread its own fleet, with a
+ * distinct range of device identities.
+ */
+
+/*!
+ * \enum hkds_fleet_status
+ * \brief The status of a simulated device.
+ */
+typedef enum hkds_fleet_status
+{
+    hkds_fleet_status_empty = 0x00U,    /*!< The cache is used up; the device requests a token */
+    hkds_fleet_status_token = 0x01U,    /*!< A token request is outstanding */
+    hkds_fleet_status_refresh = 0x02U,  /*!< The token was decrypted, and the cache awaits regeneration */
+    hkds_fleet_status_ready = 0x03U,    /*!< The cache holds keys; the device sends a message */
+    hkds_fleet_status_message = 0x04U   /*!< A message request is outstanding */
+} hkds_fleet_status;
+
+/*!
+ * \struct hkds_fleet_state
+ * \brief Contains the fleet state; the device fields are separate arrays, indexed by device.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    uint8_t* edk;               /*!< The embedded device keys, HKDS_EDK_SIZE bytes per device */
+    uint8_t* ksn;               /*!< The key serial numbers, HKDS_KSN_SIZE bytes per device */
+    uint8_t* tkc;               /*!< The transaction key caches, HKDS_CACHE_SIZE keys per device */
+    uint8_t* token;             /*!< The decrypted tokens awaiting cache regeneration, HKDS_STK_SIZE bytes per device */
+    uint8_t* expected;          /*!< The plaintext of each outstanding message, HKDS_MESSAGE_SIZE bytes per device */
+    uint8_t* status;            /*!< The status of each device */
+    size_t* refresh;            /*!< The devices awaiting cache regeneration */
+    size_t refreshcount;        /*!< The number of devices awaiting cache regeneration */
+    size_t count;               /*!< The number of devices */
+    size_t cursor;              /*!< The next device polled for a request */
+    uint64_t messages;          /*!< The number of verified message responses */
+    uint64_t tokens;            /*!< The number of decrypted tokens */
+    uint64_t epochs;            /*!< The number of regenerated caches */
+    uint64_t failures;          /*!< The number of error, mismatched, or unverified responses */
+    bool authenticated;         /*!< Message requests carry an authentication tag */
+} hkds_fleet_state;
+
+/**
+ * \brief Allocate the device arrays of a fleet.
+ *
+ * \param fleet [out] Pointer to the fleet state.
+ * \param count [in] The number of devices.
+ * \param authenticated [in] Message requests carry an authentication tag.
+ * \return Returns false if the count is zero, or the arrays could not be allocated.
+ */
+HKDS_EXPORT_API bool hkds_fleet_initialize(hkds_fleet_state* fleet, size_t count, bool authenticated);
+
+/**
+ * \brief Erase and free the device arrays, and clear the state.
+ *
+ * \param fleet [in,out] Pointer to the fleet state.
+ */
+HKDS_EXPORT_API void hkds_fleet_dispose(hkds_fleet_state* fleet);
+
+/**
+ * \brief Provision the device identities and keys of the fleet.
+ *
+ * \details
+ * The device identity of device i is the template identity with its last four bytes set to the big-endian value
+ * first + i, and its device key is derived from the master key set. Each device starts without a cache, at a
+ * transaction counter spread across the positions of an epoch.
+ *
+ * \param fleet [in,out] Pointer to the fleet state.
+ * \param mdk [in] The master key set of the server under test.
+ * \param did [in] The template device identity, HKDS_DID_SIZE bytes; the first four bytes are the key identity.
+ * \param first [in] The device number of the first device.
+ */
+HKDS_EXPORT_API void hkds_fleet_provision(hkds_fleet_state* fleet, hkds_master_key* mdk, const uint8_t* did, uint32_t first);
+
+/**
+ * \brief Build the next requests of the idle devices.
+ *
+ * \details
+ * The devices are polled in turn from the cursor; a device without a cache sends a token request, and a device with a
+ * cache a message request. The packets are written back to back, and each request's device is recorded in order.
+ *
+ * \param fleet [in,out] Pointer to the fleet state.
+ * \param output [out] The packet buffer.
+ * \param outlen [in] The byte size of the packet buffer.
+ * \param devices [out] Receives the device index of each request.
+ * \param maxcount [in] The maximum number of requests.
+ * \param count [out] Receives the number of requests.
+ * \return The number of bytes written.
+ */
+HKDS_EXPORT_API size_t hkds_fleet_generate(hkds_fleet_state* fleet, uint8_t* output, size_t outlen, size_t* devices, size_t maxcount, size_t* count);
+
+/**
+ * \brief Process the response to a device's outstanding request.
+ *
+ * \details
+ * A token response is decrypted and queued, and the caches are regenerated once eight devices are queued; a message
+ * response is checked against the plaintext. An error message, or an unexpected or invalid response, is counted as a
+ * failure, and the device is returned to its idle status.
+ *
+ * \param fleet [in,out] Pointer to the fleet state.
+ * \param device [in] The device index.
+ * \param packet [in] The response packet.
+ * \param length [in] The response packet length.
+ * \return Returns true if the response was valid.
+ */
+HKDS_EXPORT_API bool hkds_fleet_receive(hkds_fleet_state* fleet, size_t device, const uint8_t* packet, size_t length);
+
+/**
+ * \brief Regenerate the caches of all the queued devices.
+ *
+ * \details
+ * Called at the end of a pass, so a partial group of queued devices does not wait for eight tokens to arrive.
+ *
+ * \param fleet [in,out] Pointer to the fleet state.
+ */
+HKDS_EXPORT_API void hkds_fleet_refresh(hkds_fleet_state* fleet);
+
+/**
+ * \brief Return a device with an outstanding request to its idle status, after its response was lost.
+ *
+ * \param fleet [in,out] Pointer to the fleet state.
+ * \param device [in] The device index.
+ */
+HKDS_EXPORT_API void hkds_fleet_abandon(hkds_fleet_state* fleet, size_t device);
+
+#endif
@@ -0,0 +1,337 @@
+#include "hkds_framer.h"
+#include "hkds_factory.h"
+#include "utils.h"
+
+static size_t hkds_framer_frame_size(const uint8_t* input, size_t inplen, size_t maxlen, bool* malformed)
+{
+	hkds_packet_type type;
+	size_t flen;
+	size_t res;
+
+	res = 0U;
+
+	if (inplen >= HKDS_HEADER_SIZE)
+	{
+		type = (hkds_packet_type)input[HKDS_PACKET_FLAG_OFFSET];
+		flen = 0U;
+
+		if (input[HKDS_PACKET_PROTOCOL_OFFSET] != (uint8_t)HKDS_PROTOCOL_TYPE)
+		{
+			*malformed = true;
+		}
+		else if (type == packet_batch_request || type == packet_batch_response)
+		{
+			/* the envelope size is known once the count and record type have arrived */
+			if (inplen >= HKDS_BATCH_HEADER_SIZE)
+			{
+				flen = hkds_factory_extract_batch_size(input);
+				*malformed = (flen == 0U || flen > maxlen);
+			}
+		}
+		else
+		{
+			flen = hkds_factory_packet_type_size(type);
+			*malformed = (flen == 0U || input[HKDS_PACKET_LENGTH_OFFSET] != flen);
+		}
+
+		if (*malformed == false && flen != 0U && inplen >= flen)
+		{
+			res = flen;
+		}
+	}
+
+	return res;
+}
+
+static size_t hkds_framer_measure(hkds_framer_state* framer, size_t position)
+{
+	return hkds_framer_frame_size(framer->buffer + position, framer->tail - position, framer->capacity, &framer->malformed);
+}
+
+static void hkds_framer_compact(hkds_framer_state* framer)
+{
+	size_t rem;
+
+	rem = framer->tail - framer->head;
+
+	if (rem <= framer->head)
+	{
+		utils_memory_copy(framer->buffer, framer->buffer + framer->head, rem);
+	}
+	else
+	{
+		/* the ranges overlap; a forward byte copy to the lower address is safe */
+		for (size_t i = 0U; i < rem; ++i)
+		{
+			framer->buffer[i] = framer->buffer[framer->head + i];
+		}
+	}
+
+	framer->head = 0U;
+	framer->tail = rem;
+}
+
+bool hkds_framer_initialize(hkds_framer_state* framer, uint8_t* buffer, size_t buflen)
+{
+	HKDS_ASSERT(framer != NULL);
+	HKDS_ASSERT(buflen >= HKDS_FRAMER_MIN_SIZE);
+
+	bool res;
+
+	res = false;
+
+	if (framer != NULL)
+	{
+		framer->buffer = NULL;
+		framer->external = false;
+
+		if (buflen >= HKDS_FRAMER_MIN_SIZE)
+		{
+			if (buffer != NULL)
+			{
+				framer->buffer = buffer;
+				framer->external = true;
+			}
+			else
+			{
+				framer->buffer = (uint8_t*)utils_memory_aligned_alloc(HKDS_SIMD_ALIGNMENT, buflen);
+			}
+		}
+
+		if (framer->buffer != NULL)
+		{
+			framer->capacity = buflen;
+			framer->head = 0U;
+			framer->tail = 0U;
+			framer->malformed = false;
+			res = true;
+		}
+	}
+
+	return res;
+}
+
+void hkds_framer_destroy(hkds_framer_state* framer)
+{
+	HKDS_ASSERT(framer != NULL);
+
+	if (framer != NULL)
+	{
+		if (framer->buffer != NULL)
+		{
+			utils_memory_secure_erase(framer->buffer, framer->capacity);
+
+			if (framer->external == false)
+			{
+				utils_memory_aligned_free(framer->buffer);
+			}
+		}
+
+		framer->buffer = NULL;
+		framer->capacity = 0U;
+		framer->head = 0U;
+		framer->tail = 0U;
+		framer->external = false;
+		framer->malformed = false;
+	}
+}
+
+void hkds_framer_reset(hkds_framer_state* framer)
+{
+	HKDS_ASSERT(framer != NULL);
+
+	if (framer != NULL)
+	{
+		framer->head = 0U;
+		framer->tail = 0U;
+		framer->malformed = false;
+	}
+}
+
+size_t hkds_framer_write(hkds_framer_state* framer, const uint8_t* input, size_t inplen)
+{
+	HKDS_ASSERT(framer != NULL);
+	HKDS_ASSERT(input != NULL);
+
+	size_t res;
+
+	res = 0U;
+
+	if (framer != NULL && input != NULL && framer->buffer != NULL && framer->malformed == false)
+	{
+		if (framer->head == framer->tail)
+		{
+			/* every frame was taken, so the buffer is rewound without a copy */
+			framer->head = 0U;
+			framer->tail = 0U;
+		}
+		else if (framer->capacity - framer->tail < inplen && framer->head != 0U)
+		{
+			/* only the unread bytes, usually a single partial packet, are moved */
+			hkds_framer_compact(framer);
+		}
+
+		res = (inplen <= framer->capacity - framer->tail) ? inplen : framer->capacity - framer->tail;
+
+		if (res != 0U)
+		{
+			utils_memory_copy(framer->buffer + framer->tail, input, res);
+			framer->tail += res;
+		}
+	}
+
+	return res;
+}
+
+bool hkds_framer_next(hkds_framer_state* framer, hkds_frame* frame)
+{
+	HKDS_ASSERT(framer != NULL);
+	HKDS_ASSERT(frame != NULL);
+
+	size_t flen;
+	bool res;
+
+	res = false;
+
+	if (frame != NULL)
+	{
+		utils_memory_clear((uint8_t*)frame, sizeof(hkds_frame));
+
+		if (framer != NULL && framer->buffer != NULL && framer->malformed == false)
+		{
+			flen = hkds_framer_measure(framer, framer->head);
+
+			if (flen != 0U)
+			{
+				frame->packet = framer->buffer + framer->head;
+				frame->length = flen;
+				frame->type = (hkds_packet_type)frame->packet[HKDS_PACKET_FLAG_OFFSET];
+				framer->head += flen;
+				res = true;
+			}
+		}
+	}
+
+	return res;
+}
+
+size_t hkds_framer_complete(hkds_framer_state* framer, const uint8_t** output)
+{
+	HKDS_ASSERT(framer != NULL);
+	HKDS_ASSERT(output != NULL);
+
+	size_t flen;
+	size_t pos;
+	size_t res;
+
+	res = 0U;
+
+	if (framer != NULL && output != NULL && framer->buffer != NULL)
+	{
+		*output = framer->buffer + framer->head;
+		pos = framer->head;
+
+		if (framer->malformed == false)
+		{
+			flen = hkds_framer_measure(framer, pos);
+
+			while (flen != 0U)
+			{
+				pos += flen;
+				flen = hkds_framer_measure(framer, pos);
+			}
+		}
+
+		res = pos - framer->head;
+	}
+
+	return res;
+}
+
+void hkds_framer_consume(hkds_framer_state* framer, size_t length)
+{
+	HKDS_ASSERT(framer != NULL);
+
+	if (framer != NULL)
+	{
+		HKDS_ASSERT(length <= framer->tail - framer->head);
+
+		framer->head += (length <= framer->tail - framer->head) ? length : framer->tail - framer->head;
+	}
+}
+
+size_t hkds_framer_pending(const hkds_framer_state* framer)
+{
+	HKDS_ASSERT(framer != NULL);
+
+	size_t res;
+
+	res = 0U;
+
+	if (framer != NULL)
+	{
+		res = framer->tail - framer->head;
+	}
+
+	return res;
+}
+
+size_t hkds_framer_needed(const hkds_framer_state* framer)
+{
+	HKDS_ASSERT(framer != NULL);
+
+	const uint8_t* pkt;
+	size_t avl;
+	size_t flen;
+	size_t res;
+
+	res = 0U;
+
+	if (framer != NULL && framer->buffer != NULL && framer->malformed == false && framer->tail != framer->head)
+	{
+		pkt = framer->buffer + framer->head;
+		avl = framer->tail - framer->head;
+
+		if (avl < HKDS_HEADER_SIZE)
+		{
+			res = HKDS_HEADER_SIZE - avl;
+		}
+		else if (pkt[HKDS_PACKET_FLAG_OFFSET] == (uint8_t)packet_batch_request || pkt[HKDS_PACKET_FLAG_OFFSET] == (uint8_t)packet_batch_response)
+		{
+			flen = (avl >= HKDS_BATCH_HEADER_SIZE) ? hkds_factory_extract_batch_size(pkt) : HKDS_BATCH_HEADER_SIZE;
+			res = (flen > avl) ? flen - avl : 0U;
+		}
+		else
+		{
+			flen = hkds_factory_packet_type_size((hkds_packet_type)pkt[HKDS_PACKET_FLAG_OFFSET]);
+			res = (flen > avl) ? flen - avl : 0U;
+		}
+	}
+
+	return res;
+}
+
+size_t hkds_framer_scan(const uint8_t* input, size_t inplen, size_t maxlen, bool* malformed)
+{
+	HKDS_ASSERT(input != NULL);
+	HKDS_ASSERT(malformed != NULL);
+
+	size_t flen;
+	size_t res;
+
+	res = 0U;
+
+	if (input != NULL && malformed != NULL)
+	{
+		*malformed = false;
+		flen = hkds_framer_frame_size(input, inplen, maxlen, malformed);
+
+		while (flen != 0U)
+		{
+			res += flen;
+			flen = hkds_framer_frame_size(input + res, inplen - res, maxlen, malformed);
+		}
+	}
+
+	return res;
+}
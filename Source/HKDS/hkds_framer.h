@@ -0,0 +1,233 @@
+/* 2021-2026 Quantum Resistant Cryptographic Solutions Corporation
+ * All Rights Reserved.
+ *
+ * NOTICE:
+ * This software and all accompanying materials are the exclusive property of
+ * Quantum Resistant Cryptographic Solutions Corporation (QRCS). The intellectual
+ * and technical concepts contained herein are proprietary to QRCS and are
+ * protected under applicable Canadian, U.S., and international copyright,
+ * patent, and trade secret laws.
+ *
+ * CRYPTOGRAPHIC ALGORITHMS AND IMPLEMENTATIONS:
+ * - This software includes implementations of cryptographic primitives and
+ *   algorithms that are standardized or in the public domain, such as AES
+ *   and SHA-3, which are not proprietary to QRCS.
+ * - This software also includes cryptographic primitives, constructions, and
+ *   algorithms designed by QRCS, including but not limited to RCS, SCB, CSX, QMAC, and
+ *   related components, which are proprietary to QRCS.
+ * - All source code, implementations, protocol compositions, optimizations,
+ *   parameter selections, and engineering work contained in this software are
+ *   original works of QRCS and are protected under this license.
+ *
+ * LICENSE AND USE RESTRICTIONS:
+ * - This software is licensed under the Quantum Resistant Cryptographic Solutions
+ *   Public Research and Evaluation License (QRCS-PREL), 2025-2026.
+ * - Permission is granted solely for non-commercial evaluation, academic research,
+ *   cryptographic analysis, interoperability testing, and feasibility assessment.
+ * - Commercial use, production deployment, commercial redistribution, or
+ *   integration into products or services is strictly prohibited without a
+ *   separate written license agreement executed with QRCS.
+ * - Licensing and authorized distribution are solely at the discretion of QRCS.
+ *
+ * EXPERIMENTAL CRYPTOGRAPHY NOTICE:
+ * Portions of this software may include experimental, novel, or evolving
+ * cryptographic designs. Use of this software is entirely at the user's risk.
+ *
+ * DISCLAIMER:
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE, SECURITY, OR NON-INFRINGEMENT. QRCS DISCLAIMS ALL
+ * LIABILITY FOR ANY DIRECT, INDIRECT, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING FROM THE USE OR MISUSE OF THIS SOFTWARE.
+ *
+ * FULL LICENSE:
+ * This software is subject to the Quantum Resistant Cryptographic Solutions
+ * Public Research and Evaluation License (QRCS-PREL), 2025-2026. The complete license terms
+ * are provided in the accompanying LICENSE file or at https://www.qrcscorp.ca.
+ *
+ * Written by: John G. Underhill
+ * Contact: contact@qrcscorp.ca
+ */
+
+#ifndef HKDS_FRAMER_H
+#define HKDS_FRAMER_H
+
+#include "common.h"
+#include "hkds_config.h"
+
+/**
+ * \file hkds_framer.h
+ * \brief This file contains the HKDS stream framer definitions.
+ *
+ * \details
+ * The packet factory functions expect a whole packet in a buffer, but a byte stream such as a TCP connection
+ * delivers packets split and merged at arbitrary points. The framer reassembles the stream: received chunks of any
+ * size are written to it, and it yields each complete packet or batch envelope as a contiguous frame in its own
+ * buffer, which can be passed directly to the factory view and extract functions.
+ *
+ * The framer holds a single receive buffer, allocated once when the framer is initialized or supplied by the caller,
+ * so framing makes no per-packet allocations. Frames are read in place; the read position advances as frames are
+ * taken, and the bytes of a trailing partial packet are moved to the start of the buffer only when a write needs the
+ * room, so a stream of small packets is copied once, on its way into the buffer.
+ *
+ * Each frame is checked as its header arrives: the protocol identifier must match, the length field of a packet must
+ * match its type, and a batch envelope must be valid and fit in the buffer. A byte stream carries no markers to
+ * resynchronize on, so a failed check marks the framer as malformed, and it accepts no further input until it is reset;
+ * the connection should normally be closed.
+ *
+ * The framer is used by a single thread; it is type agnostic, and serves both the client and the server side of a stream.
+ */
+
+/*!
+ * \def HKDS_FRAMER_MIN_SIZE
+ * \brief The smallest framer buffer; holds any single packet, whose length field is one byte.
+ */
+#define HKDS_FRAMER_MIN_SIZE 256U
+
+/*!
+ * \def HKDS_FRAMER_MAX_RECORD_SIZE
+ * \brief The largest batch envelope record; a message request with its tag, or an encrypted token.
+ */
+#define HKDS_FRAMER_MAX_RECORD_SIZE ((HKDS_ETOK_SIZE > (HKDS_KSN_SIZE + HKDS_MESSAGE_SIZE + HKDS_TAG_SIZE)) ? \
+    HKDS_ETOK_SIZE : (HKDS_KSN_SIZE + HKDS_MESSAGE_SIZE + HKDS_TAG_SIZE))
+
+/*!
+ * \def HKDS_FRAMER_MAX_SIZE
+ * \brief The framer buffer size that holds the largest batch envelope.
+ */
+#define HKDS_FRAMER_MAX_SIZE (HKDS_BATCH_HEADER_SIZE + (HKDS_BATCH_MAX_RECORDS * HKDS_FRAMER_MAX_RECORD_SIZE))
+
+/*!
+ * \struct hkds_framer_state
+ * \brief Contains the stream framer state.
+ *
+ * \details
+ * The bytes between the head and the tail positions are buffered and not yet taken; the frames in this range are
+ * complete, except for the last, which may be partial.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    uint8_t* buffer;        /*!< The receive buffer */
+    size_t capacity;        /*!< The byte size of the receive buffer */
+    size_t head;            /*!< The position of the next frame */
+    size_t tail;            /*!< The end of the buffered bytes */
+    bool external;          /*!< The buffer was supplied by the caller */
+    bool malformed;         /*!< An invalid header was received; the framer must be reset */
+} hkds_framer_state;
+
+/*!
+ * \struct hkds_frame
+ * \brief A complete packet or batch envelope in the framer buffer.
+ *
+ * \details
+ * The frame refers to the framer buffer, and is valid until the next write to, or reset of, the framer.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    const uint8_t* packet;  /*!< The first byte of the packet header */
+    size_t length;          /*!< The frame size, including the header */
+    hkds_packet_type type;  /*!< The packet type */
+} hkds_frame;
+
+/**
+ * \brief Initialize a stream framer.
+ *
+ * \param framer [out] Pointer to the framer state.
+ * \param buffer [in] The [optional] receive buffer; if NULL, a buffer of the requested size is allocated.
+ * \param buflen [in] The byte size of the receive buffer; at least \c HKDS_FRAMER_MIN_SIZE. Batch envelopes larger than
+ * the buffer are rejected as malformed; \c HKDS_FRAMER_MAX_SIZE holds any envelope.
+ * \return Returns false if the buffer is too small or could not be allocated.
+ */
+HKDS_EXPORT_API bool hkds_framer_initialize(hkds_framer_state* framer, uint8_t* buffer, size_t buflen);
+
+/**
+ * \brief Erase the framer buffer, free it unless it was supplied by the caller, and clear the state.
+ *
+ * \param framer [in,out] Pointer to the framer state.
+ */
+HKDS_EXPORT_API void hkds_framer_destroy(hkds_framer_state* framer);
+
+/**
+ * \brief Discard the buffered bytes and clear the malformed flag, so the framer can serve a new stream.
+ *
+ * \param framer [in,out] Pointer to the framer state.
+ */
+HKDS_EXPORT_API void hkds_framer_reset(hkds_framer_state* framer);
+
+/**
+ * \brief Write a received chunk of the stream to the framer.
+ *
+ * \details
+ * The chunk may hold any part of one or more packets. If the buffer cannot hold the whole chunk, the leading part that
+ * fits is written; the caller takes the complete frames and writes the remainder.
+ *
+ * \param framer [in,out] Pointer to the framer state.
+ * \param input [in] The received bytes.
+ * \param inplen [in] The number of received bytes.
+ * \return The number of bytes written; zero if the buffer is full of unread frames, or the framer is malformed.
+ */
+HKDS_EXPORT_API size_t hkds_framer_write(hkds_framer_state* framer, const uint8_t* input, size_t inplen);
+
+/**
+ * \brief Take the next complete frame.
+ *
+ * \param framer [in,out] Pointer to the framer state.
+ * \param frame [out] The frame; cleared if there is no complete frame.
+ * \return Returns true if a frame was taken; false if the next frame is incomplete, or the framer is malformed.
+ */
+HKDS_EXPORT_API bool hkds_framer_next(hkds_framer_state* framer, hkds_frame* frame);
+
+/**
+ * \brief Get the run of complete frames at the read position, without taking them.
+ *
+ * \details
+ * The run is contiguous, and can be passed to \ref hkds_factory_parse_packets to fill a batch from all the complete
+ * frames at once; the bytes it consumes are then taken with \ref hkds_framer_consume.
+ *
+ * \param framer [in,out] Pointer to the framer state; the malformed flag is set if an invalid header is reached.
+ * \param output [out] Receives the address of the first complete frame.
+ * \return The byte length of the run; zero if there is no complete frame.
+ */
+HKDS_EXPORT_API size_t hkds_framer_complete(hkds_framer_state* framer, const uint8_t** output);
+
+/**
+ * \brief Take bytes from the read position, after they were processed in place.
+ *
+ * \param framer [in,out] Pointer to the framer state.
+ * \param length [in] The number of bytes to take; at most the length of the complete run.
+ */
+HKDS_EXPORT_API void hkds_framer_consume(hkds_framer_state* framer, size_t length);
+
+/**
+ * \brief Get the number of buffered bytes that have not been taken.
+ *
+ * \param framer [in] Pointer to the framer state.
+ * \return The number of buffered bytes.
+ */
+HKDS_EXPORT_API size_t hkds_framer_pending(const hkds_framer_state* framer);
+
+/**
+ * \brief Get the number of bytes that complete the next step of the partial frame at the read position.
+ *
+ * \details
+ * A transport that receives into its own buffers can complete a frame split across two of them by writing only the
+ * bytes it needs, and read the frames that follow in place with \ref hkds_framer_scan. Until the frame header has
+ * arrived, the result is the number of bytes needed to complete the header, after which it is the remainder of the frame.
+ *
+ * \param framer [in] Pointer to the framer state.
+ * \return The number of bytes needed; zero if no bytes are buffered, the frame is complete, or its header is invalid.
+ */
+HKDS_EXPORT_API size_t hkds_framer_needed(const hkds_framer_state* framer);
+
+/**
+ * \brief Measure the run of complete frames in a caller buffer, with the checks the framer applies.
+ *
+ * \param input [in] The received bytes, starting at a frame boundary.
+ * \param inplen [in] The number of received bytes.
+ * \param maxlen [in] The largest accepted batch envelope.
+ * \param malformed [out] Set to true if the run ends at an invalid header.
+ * \return The byte length of the run; the remainder is a partial frame, or starts at the invalid header.
+ */
+HKDS_EXPORT_API size_t hkds_framer_scan(const uint8_t* input, size_t inplen, size_t maxlen, bool* malformed);
+
+#endif
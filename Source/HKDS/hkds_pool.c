@@ -0,0 +1,618 @@
+#if !defined(_POSIX_C_SOURCE) && !defined(_WIN32)
+	/* required for the pthread and sysconf declarations in strict C11 builds */
+#	define _POSIX_C_SOURCE 200809L
+#endif
+#include "hkds_pool.h"
+#include "utils.h"
+#include <stdlib.h>
+
+#if defined(HKDS_SYSTEM_OS_WINDOWS)
+#	if !defined(WIN32_LEAN_AND_MEAN)
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	include <Windows.h>
+typedef CRITICAL_SECTION hkds_pool_mutex;
+typedef CONDITION_VARIABLE hkds_pool_condition;
+typedef HANDLE hkds_pool_thread;
+#else
+#	include <pthread.h>
+#	include <unistd.h>
+typedef pthread_mutex_t hkds_pool_mutex;
+typedef pthread_cond_t hkds_pool_condition;
+typedef pthread_t hkds_pool_thread;
+#endif
+
+typedef struct
+{
+	size_t pending;									/* the number of jobs of a loop that have not completed */
+} hkds_pool_group;
+
+typedef struct
+{
+	hkds_pool_task task;							/* the loop body */
+	void* context;									/* the caller context */
+	size_t begin;									/* the first index of the range */
+	size_t end;										/* one past the last index of the range */
+	hkds_pool_group* group;							/* the loop this job belongs to */
+} hkds_pool_job;
+
+typedef struct
+{
+	hkds_pool_job jobs[HKDS_POOL_QUEUE_DEPTH];		/* the job ring */
+	hkds_pool_mutex mutex;							/* the queue lock */
+	size_t head;									/* the steal position */
+	size_t tail;									/* the owner position */
+	hkds_pool_thread thread;						/* the worker thread */
+	hkds_pool_context* pool;						/* the owning pool */
+	size_t id;										/* the worker index */
+} hkds_pool_worker;
+
+struct hkds_pool_context
+{
+	hkds_pool_worker* workers;						/* the worker array */
+	size_t count;									/* the number of workers */
+	hkds_pool_mutex mutex;							/* the pool lock */
+	hkds_pool_condition work;						/* signalled when jobs are queued, or on shutdown */
+	hkds_pool_condition done;						/* signalled when a loop completes */
+	size_t queued;									/* the number of jobs reserved or waiting in the queues */
+	size_t next;									/* the round-robin submission cursor */
+	bool shutdown;									/* set when the pool is being destroyed */
+};
+
+/* platform threading */
+
+#if defined(HKDS_SYSTEM_OS_WINDOWS)
+static void hkds_pool_mutex_initialize(hkds_pool_mutex* mutex)
+{
+	InitializeCriticalSection(mutex);
+}
+
+static void hkds_pool_mutex_destroy(hkds_pool_mutex* mutex)
+{
+	DeleteCriticalSection(mutex);
+}
+
+static void hkds_pool_mutex_lock(hkds_pool_mutex* mutex)
+{
+	EnterCriticalSection(mutex);
+}
+
+static void hkds_pool_mutex_unlock(hkds_pool_mutex* mutex)
+{
+	LeaveCriticalSection(mutex);
+}
+
+static void hkds_pool_condition_initialize(hkds_pool_condition* cond)
+{
+	InitializeConditionVariable(cond);
+}
+
+static void hkds_pool_condition_destroy(hkds_pool_condition* cond)
+{
+	(void)cond;
+}
+
+static void hkds_pool_condition_wait(hkds_pool_condition* cond, hkds_pool_mutex* mutex)
+{
+	SleepConditionVariableCS(cond, mutex, INFINITE);
+}
+
+static void hkds_pool_condition_broadcast(hkds_pool_condition* cond)
+{
+	WakeAllConditionVariable(cond);
+}
+#else
+static void hkds_pool_mutex_initialize(hkds_pool_mutex* mutex)
+{
+	pthread_mutex_init(mutex, NULL);
+}
+
+static void hkds_pool_mutex_destroy(hkds_pool_mutex* mutex)
+{
+	pthread_mutex_destroy(mutex);
+}
+
+static void hkds_pool_mutex_lock(hkds_pool_mutex* mutex)
+{
+	pthread_mutex_lock(mutex);
+}
+
+static void hkds_pool_mutex_unlock(hkds_pool_mutex* mutex)
+{
+	pthread_mutex_unlock(mutex);
+}
+
+static void hkds_pool_condition_initialize(hkds_pool_condition* cond)
+{
+	pthread_cond_init(cond, NULL);
+}
+
+static void hkds_pool_condition_destroy(hkds_pool_condition* cond)
+{
+	pthread_cond_destroy(cond);
+}
+
+static void hkds_pool_condition_wait(hkds_pool_condition* cond, hkds_pool_mutex* mutex)
+{
+	pthread_cond_wait(cond, mutex);
+}
+
+static void hkds_pool_condition_broadcast(hkds_pool_condition* cond)
+{
+	pthread_cond_broadcast(cond);
+}
+#endif
+
+/* worker queues */
+
+static bool hkds_pool_queue_push(hkds_pool_worker* worker, const hkds_pool_job* job)
+{
+	bool res;
+
+	res = false;
+	hkds_pool_mutex_lock(&worker->mutex);
+
+	if (worker->tail - worker->head < HKDS_POOL_QUEUE_DEPTH)
+	{
+		worker->jobs[worker->tail & (HKDS_POOL_QUEUE_DEPTH - 1U)] = *job;
+		++worker->tail;
+		res = true;
+	}
+
+	hkds_pool_mutex_unlock(&worker->mutex);
+
+	return res;
+}
+
+static bool hkds_pool_queue_pop(hkds_pool_worker* worker, hkds_pool_job* job)
+{
+	bool res;
+
+	res = false;
+	hkds_pool_mutex_lock(&worker->mutex);
+
+	/* the owner takes the most recently queued job, which is the most likely to be cache resident */
+	if (worker->tail != worker->head)
+	{
+		--worker->tail;
+		*job = worker->jobs[worker->tail & (HKDS_POOL_QUEUE_DEPTH - 1U)];
+		res = true;
+	}
+
+	hkds_pool_mutex_unlock(&worker->mutex);
+
+	return res;
+}
+
+static bool hkds_pool_queue_steal(hkds_pool_worker* worker, hkds_pool_job* job)
+{
+	bool res;
+
+	res = false;
+	hkds_pool_mutex_lock(&worker->mutex);
+
+	/* a thief takes the oldest job from the opposite end of the queue */
+	if (worker->tail != worker->head)
+	{
+		*job = worker->jobs[worker->head & (HKDS_POOL_QUEUE_DEPTH - 1U)];
+		++worker->head;
+		res = true;
+	}
+
+	hkds_pool_mutex_unlock(&worker->mutex);
+
+	return res;
+}
+
+/* job scheduling */
+
+static bool hkds_pool_take(hkds_pool_context* ctx, size_t self, hkds_pool_job* job)
+{
+	bool res;
+
+	res = false;
+
+	/* a worker checks its own queue first; a submitting thread (self == count) only steals */
+	if (self < ctx->count)
+	{
+		res = hkds_pool_queue_pop(&ctx->workers[self], job);
+	}
+
+	for (size_t i = 1U; i <= ctx->count && res == false; ++i)
+	{
+		res = hkds_pool_queue_steal(&ctx->workers[(self + i) % ctx->count], job);
+	}
+
+	if (res == true)
+	{
+		hkds_pool_mutex_lock(&ctx->mutex);
+		--ctx->queued;
+		hkds_pool_mutex_unlock(&ctx->mutex);
+	}
+
+	return res;
+}
+
+static void hkds_pool_execute(hkds_pool_context* ctx, const hkds_pool_job* job)
+{
+	for (size_t i = job->begin; i < job->end; ++i)
+	{
+		job->task(job->context, i);
+	}
+
+	/* a detached job has no loop waiting on it */
+	if (job->group != NULL)
+	{
+		hkds_pool_mutex_lock(&ctx->mutex);
+		--job->group->pending;
+
+		if (job->group->pending == 0U)
+		{
+			hkds_pool_condition_broadcast(&ctx->done);
+		}
+
+		hkds_pool_mutex_unlock(&ctx->mutex);
+	}
+}
+
+static void hkds_pool_worker_run(hkds_pool_worker* worker)
+{
+	hkds_pool_context* ctx;
+	hkds_pool_job job;
+	bool stop;
+
+	ctx = worker->pool;
+	stop = false;
+
+	while (stop == false)
+	{
+		if (hkds_pool_take(ctx, worker->id, &job) == true)
+		{
+			hkds_pool_execute(ctx, &job);
+		}
+		else
+		{
+			hkds_pool_mutex_lock(&ctx->mutex);
+
+			while (ctx->queued == 0U && ctx->shutdown == false)
+			{
+				hkds_pool_condition_wait(&ctx->work, &ctx->mutex);
+			}
+
+			/* queued jobs are drained before the worker exits */
+			stop = (ctx->shutdown == true && ctx->queued == 0U);
+			hkds_pool_mutex_unlock(&ctx->mutex);
+		}
+	}
+}
+
+#if defined(HKDS_SYSTEM_OS_WINDOWS)
+static DWORD WINAPI hkds_pool_worker_entry(LPVOID arg)
+{
+	hkds_pool_worker_run((hkds_pool_worker*)arg);
+
+	return 0;
+}
+
+static bool hkds_pool_thread_start(hkds_pool_worker* worker)
+{
+	worker->thread = CreateThread(NULL, 0, &hkds_pool_worker_entry, worker, 0, NULL);
+
+	return (worker->thread != NULL);
+}
+
+static void hkds_pool_thread_join(hkds_pool_worker* worker)
+{
+	WaitForSingleObject(worker->thread, INFINITE);
+	CloseHandle(worker->thread);
+}
+#else
+static void* hkds_pool_worker_entry(void* arg)
+{
+	hkds_pool_worker_run((hkds_pool_worker*)arg);
+
+	return NULL;
+}
+
+static bool hkds_pool_thread_start(hkds_pool_worker* worker)
+{
+	return (pthread_create(&worker->thread, NULL, &hkds_pool_worker_entry, worker) == 0);
+}
+
+static void hkds_pool_thread_join(hkds_pool_worker* worker)
+{
+	pthread_join(worker->thread, NULL);
+}
+#endif
+
+bool hkds_pool_initialize(hkds_thread_pool* pool, size_t threads)
+{
+	HKDS_ASSERT(pool != NULL);
+
+	hkds_pool_context* ctx;
+	size_t i;
+	bool res;
+
+	res = false;
+
+	if (pool != NULL)
+	{
+		pool->context = NULL;
+		pool->threads = 0U;
+
+		if (threads == 0U)
+		{
+			threads = hkds_pool_processor_count();
+		}
+
+		ctx = (hkds_pool_context*)malloc(sizeof(hkds_pool_context));
+
+		if (ctx != NULL)
+		{
+			ctx->workers = (hkds_pool_worker*)malloc(threads * sizeof(hkds_pool_worker));
+
+			if (ctx->workers != NULL)
+			{
+				ctx->count = threads;
+				ctx->queued = 0U;
+				ctx->next = 0U;
+				ctx->shutdown = false;
+				hkds_pool_mutex_initialize(&ctx->mutex);
+				hkds_pool_condition_initialize(&ctx->work);
+				hkds_pool_condition_initialize(&ctx->done);
+
+				/* every queue is ready before the first worker starts scanning them */
+				for (i = 0U; i < threads; ++i)
+				{
+					ctx->workers[i].head = 0U;
+					ctx->workers[i].tail = 0U;
+					ctx->workers[i].pool = ctx;
+					ctx->workers[i].id = i;
+					hkds_pool_mutex_initialize(&ctx->workers[i].mutex);
+				}
+
+				res = true;
+
+				for (i = 0U; i < threads; ++i)
+				{
+					if (hkds_pool_thread_start(&ctx->workers[i]) == false)
+					{
+						res = false;
+						break;
+					}
+				}
+
+				if (res == true)
+				{
+					pool->context = ctx;
+					pool->threads = threads;
+				}
+				else
+				{
+					/* stop and join the workers that did start, then release the pool */
+					hkds_pool_mutex_lock(&ctx->mutex);
+					ctx->shutdown = true;
+					hkds_pool_condition_broadcast(&ctx->work);
+					hkds_pool_mutex_unlock(&ctx->mutex);
+
+					for (size_t j = 0U; j < i; ++j)
+					{
+						hkds_pool_thread_join(&ctx->workers[j]);
+					}
+
+					for (size_t j = 0U; j < threads; ++j)
+					{
+						hkds_pool_mutex_destroy(&ctx->workers[j].mutex);
+					}
+
+					hkds_pool_condition_destroy(&ctx->done);
+					hkds_pool_condition_destroy(&ctx->work);
+					hkds_pool_mutex_destroy(&ctx->mutex);
+					free(ctx->workers);
+					free(ctx);
+				}
+			}
+			else
+			{
+				free(ctx);
+			}
+		}
+	}
+
+	return res;
+}
+
+void hkds_pool_destroy(hkds_thread_pool* pool)
+{
+	HKDS_ASSERT(pool != NULL);
+
+	hkds_pool_context* ctx;
+
+	if (pool != NULL && pool->context != NULL)
+	{
+		ctx = pool->context;
+
+		hkds_pool_mutex_lock(&ctx->mutex);
+		ctx->shutdown = true;
+		hkds_pool_condition_broadcast(&ctx->work);
+		hkds_pool_mutex_unlock(&ctx->mutex);
+
+		/* every worker is joined before any queue lock is released, since idle workers scan all of the queues */
+		for (size_t i = 0U; i < ctx->count; ++i)
+		{
+			hkds_pool_thread_join(&ctx->workers[i]);
+		}
+
+		for (size_t i = 0U; i < ctx->count; ++i)
+		{
+			hkds_pool_mutex_destroy(&ctx->workers[i].mutex);
+		}
+
+		hkds_pool_condition_destroy(&ctx->done);
+		hkds_pool_condition_destroy(&ctx->work);
+		hkds_pool_mutex_destroy(&ctx->mutex);
+		free(ctx->workers);
+		free(ctx);
+
+		pool->context = NULL;
+		pool->threads = 0U;
+	}
+}
+
+void hkds_pool_parallel_for(hkds_thread_pool* pool, size_t count, hkds_pool_task task, void* context)
+{
+	HKDS_ASSERT(task != NULL);
+
+	hkds_pool_context* ctx;
+	hkds_pool_group group;
+	hkds_pool_job job;
+	size_t chunks;
+	size_t start;
+
+	if (task != NULL && count != 0U)
+	{
+		ctx = (pool != NULL) ? pool->context : NULL;
+
+		if (ctx == NULL || ctx->count == 0U || count == 1U)
+		{
+			/* no workers, or nothing to share; run the loop on the calling thread */
+			for (size_t i = 0U; i < count; ++i)
+			{
+				task(context, i);
+			}
+		}
+		else
+		{
+			chunks = (count < ctx->count * HKDS_POOL_SPLIT_FACTOR) ? count : ctx->count * HKDS_POOL_SPLIT_FACTOR;
+			group.pending = chunks;
+			job.task = task;
+			job.context = context;
+			job.group = &group;
+
+			/* reserve the jobs before they become visible, so a thief can never take the queued count below zero */
+			hkds_pool_mutex_lock(&ctx->mutex);
+			ctx->queued += chunks;
+			start = ctx->next;
+			ctx->next += chunks;
+			hkds_pool_mutex_unlock(&ctx->mutex);
+
+			for (size_t i = 0U; i < chunks; ++i)
+			{
+				job.begin = (i * count) / chunks;
+				job.end = ((i + 1U) * count) / chunks;
+
+				if (hkds_pool_queue_push(&ctx->workers[(start + i) % ctx->count], &job) == false)
+				{
+					/* the selected queue is full; the submitting thread executes the job */
+					hkds_pool_mutex_lock(&ctx->mutex);
+					--ctx->queued;
+					hkds_pool_mutex_unlock(&ctx->mutex);
+					hkds_pool_execute(ctx, &job);
+				}
+			}
+
+			hkds_pool_mutex_lock(&ctx->mutex);
+			hkds_pool_condition_broadcast(&ctx->work);
+			hkds_pool_mutex_unlock(&ctx->mutex);
+
+			/* the calling thread executes queued jobs until its own loop has completed */
+			for (;;)
+			{
+				hkds_pool_mutex_lock(&ctx->mutex);
+
+				if (group.pending == 0U)
+				{
+					hkds_pool_mutex_unlock(&ctx->mutex);
+					break;
+				}
+
+				hkds_pool_mutex_unlock(&ctx->mutex);
+
+				if (hkds_pool_take(ctx, ctx->count, &job) == true)
+				{
+					hkds_pool_execute(ctx, &job);
+				}
+				else
+				{
+					hkds_pool_mutex_lock(&ctx->mutex);
+
+					while (group.pending != 0U && ctx->queued == 0U)
+					{
+						hkds_pool_condition_wait(&ctx->done, &ctx->mutex);
+					}
+
+					hkds_pool_mutex_unlock(&ctx->mutex);
+				}
+			}
+		}
+	}
+}
+
+bool hkds_pool_submit(hkds_thread_pool* pool, hkds_pool_task task, void* context, size_t index)
+{
+	HKDS_ASSERT(task != NULL);
+
+	hkds_pool_context* ctx;
+	hkds_pool_job job;
+	size_t start;
+	bool res;
+
+	res = false;
+
+	if (pool != NULL && pool->context != NULL && pool->context->count != 0U && task != NULL)
+	{
+		ctx = pool->context;
+		job.task = task;
+		job.context = context;
+		job.begin = index;
+		job.end = index + 1U;
+		job.group = NULL;
+
+		hkds_pool_mutex_lock(&ctx->mutex);
+		++ctx->queued;
+		start = ctx->next;
+		++ctx->next;
+		hkds_pool_mutex_unlock(&ctx->mutex);
+
+		res = hkds_pool_queue_push(&ctx->workers[start % ctx->count], &job);
+
+		hkds_pool_mutex_lock(&ctx->mutex);
+
+		if (res == true)
+		{
+			hkds_pool_condition_broadcast(&ctx->work);
+		}
+		else
+		{
+			--ctx->queued;
+		}
+
+		hkds_pool_mutex_unlock(&ctx->mutex);
+	}
+
+	return res;
+}
+
+size_t hkds_pool_processor_count(void)
+{
+	size_t res;
+
+#if defined(HKDS_SYSTEM_OS_WINDOWS)
+	SYSTEM_INFO info;
+
+	GetSystemInfo(&info);
+	res = (size_t)info.dwNumberOfProcessors;
+#else
+	long cpus;
+
+	cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	res = (cpus > 0) ? (size_t)cpus : 1U;
+#endif
+
+	if (res == 0U)
+	{
+		res = 1U;
+	}
+
+	return res;
+}
@@ -0,0 +1,172 @@
+/* 2021-2026 Quantum Resistant Cryptographic Solutions Corporation
+ * All Rights Reserved.
+ *
+ * NOTICE:
+ * This software and all accompanying materials are the exclusive property of
+ * Quantum Resistant Cryptographic Solutions Corporation (QRCS). The intellectual
+ * and technical concepts contained herein are proprietary to QRCS and are
+ * protected under applicable Canadian, U.S., and international copyright,
+ * patent, and trade secret laws.
+ *
+ * CRYPTOGRAPHIC ALGORITHMS AND IMPLEMENTATIONS:
+ * - This software includes implementations of cryptographic primitives and
+ *   algorithms that are standardized or in the public domain, such as AES
+ *   and SHA-3, which are not proprietary to QRCS.
+ * - This software also includes cryptographic primitives, constructions, and
+ *   algorithms designed by QRCS, including but not limited to RCS, SCB, CSX, QMAC, and
+ *   related components, which are proprietary to QRCS.
+ * - All source code, implementations, protocol compositions, optimizations,
+ *   parameter selections, and engineering work contained in this software are
+ *   original works of QRCS and are protected under this license.
+ *
+ * LICENSE AND USE RESTRICTIONS:
+ * - This software is licensed under the Quantum Resistant Cryptographic Solutions
+ *   Public Research and Evaluation License (QRCS-PREL), 2025-2026.
+ * - Permission is granted solely for non-commercial evaluation, academic research,
+ *   cryptographic analysis, interoperability testing, and feasibility assessment.
+ * - Commercial use, production deployment, commercial redistribution, or
+ *   integration into products or services is strictly prohibited without a
+ *   separate written license agreement executed with QRCS.
+ * - Licensing and authorized distribution are solely at the discretion of QRCS.
+ *
+ * EXPERIMENTAL CRYPTOGRAPHY NOTICE:
+ * Portions of this software may include experimental, novel, or evolving
+ * cryptographic designs. Use of this software is entirely at the user's risk.
+ *
+ * DISCLAIMER:
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE, SECURITY, OR NON-INFRINGEMENT. QRCS DISCLAIMS ALL
+ * LIABILITY FOR ANY DIRECT, INDIRECT, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING FROM THE USE OR MISUSE OF THIS SOFTWARE.
+ *
+ * FULL LICENSE:
+ * This software is subject to the Quantum Resistant Cryptographic Solutions
+ * Public Research and Evaluation License (QRCS-PREL), 2025-2026. The complete license terms
+ * are provided in the accompanying LICENSE file or at https://www.qrcscorp.ca.
+ *
+ * Written by: John G. Underhill
+ * Contact: contact@qrcscorp.ca
+ */
+
+#ifndef HKDS_POOL_H
+#define HKDS_POOL_H
+
+#include "common.h"
+
+/**
+ * \file hkds_pool.h
+ * \brief This file contains the HKDS server thread pool definitions.
+ *
+ * \details
+ * This header defines a persistent worker thread pool used to spread the server batch derivations across cores.
+ * The pool is created once and sized at runtime, so a server can use every core of the host, and it does not pay
+ * a thread fork and join cost on every call.
+ *
+ * The pool:
+ * - Starts one worker thread per requested thread, or one per online processor when zero threads are requested.
+ * - Gives each worker its own double-ended job queue; a worker takes work from the back of its own queue,
+ *   and steals from the front of the other workers' queues when its own queue is empty.
+ * - Splits a parallel loop of any length into at most \c HKDS_POOL_SPLIT_FACTOR jobs per worker, and distributes them
+ *   across the worker queues.
+ * - Has the calling thread execute jobs alongside the workers until its loop completes, so a loop submitted from inside
+ *   a pool job cannot deadlock the pool.
+ *
+ * Worker threads use POSIX threads, or the native Windows threading API on Windows.
+ */
+
+/*!
+ * \def HKDS_POOL_QUEUE_DEPTH
+ * \brief The job capacity of each worker queue; must be a power of two.
+ *
+ * \details
+ * A job that does not fit in the selected worker queue is executed by the submitting thread.
+ */
+#define HKDS_POOL_QUEUE_DEPTH 64U
+
+/*!
+ * \def HKDS_POOL_SPLIT_FACTOR
+ * \brief The maximum number of jobs a parallel loop is split into, per worker thread.
+ */
+#define HKDS_POOL_SPLIT_FACTOR 4U
+
+/*!
+ * \typedef hkds_pool_task
+ * \brief A parallel loop body; called once for each index of the loop, with the caller's context.
+ */
+typedef void (*hkds_pool_task)(void* context, size_t index);
+
+/*!
+ * \struct hkds_pool_context
+ * \brief The internal pool state; the worker threads, their queues, and synchronization objects.
+ */
+typedef struct hkds_pool_context hkds_pool_context;
+
+/*!
+ * \struct hkds_thread_pool
+ * \brief Contains an HKDS worker thread pool.
+ */
+HKDS_EXPORT_API typedef struct
+{
+    hkds_pool_context* context;  /*!< The internal pool state */
+    size_t threads;              /*!< The number of worker threads */
+} hkds_thread_pool;
+
+/**
+ * \brief Initialize a thread pool and start its worker threads.
+ *
+ * \param pool [out] Pointer to the thread pool.
+ * \param threads [in] The number of worker threads; zero selects the number of online processors.
+ * \return Returns true if the pool was initialized and all of its threads started.
+ */
+HKDS_EXPORT_API bool hkds_pool_initialize(hkds_thread_pool* pool, size_t threads);
+
+/**
+ * \brief Destroy a thread pool.
+ *
+ * \details
+ * The workers finish any queued jobs, and the threads are joined before the pool memory is released.
+ *
+ * \param pool [in/out] Pointer to the thread pool.
+ */
+HKDS_EXPORT_API void hkds_pool_destroy(hkds_thread_pool* pool);
+
+/**
+ * \brief Run a parallel loop on the thread pool.
+ *
+ * \details
+ * The task is called once for every index in [0, count). The loop is split into contiguous ranges that are
+ * queued on the workers, and the calling thread executes ranges until every index has completed.
+ * If the pool is NULL or has no workers, the loop is executed by the calling thread.
+ *
+ * \param pool [in] Pointer to the thread pool.
+ * \param count [in] The number of loop iterations.
+ * \param task [in] The loop body.
+ * \param context [in] The caller context passed to every task call.
+ */
+HKDS_EXPORT_API void hkds_pool_parallel_for(hkds_thread_pool* pool, size_t count, hkds_pool_task task, void* context);
+
+/**
+ * \brief Queue a single detached job on the thread pool.
+ *
+ * \details
+ * The task is called once with the index, by a worker thread, and the function returns without waiting for it.
+ * Jobs still queued when the pool is destroyed are executed before the workers exit.
+ *
+ * \param pool [in] Pointer to the thread pool.
+ * \param task [in] The job body.
+ * \param context [in] The caller context passed to the task; it must remain valid until the task has run.
+ * \param index [in] The index passed to the task.
+ * \return Returns false if the pool has no workers or the selected worker queue is full; the job is not queued,
+ * and the caller may execute it directly.
+ */
+HKDS_EXPORT_API bool hkds_pool_submit(hkds_thread_pool* pool, hkds_pool_task task, void* context, size_t index);
+
+/**
+ * \brief Get the number of online processors.
+ *
+ * \return Returns the number of processors available to the process; at least one.
+ */
+HKDS_EXPORT_API size_t hkds_pool_processor_count(void);
+
+#endif
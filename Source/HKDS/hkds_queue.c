@@ -1,132 +1,502 @@
 #include "hkds_queue.h"
 #include "utils.h"
 
+/* slab layout */
+
+static size_t hkds_queue_align(size_t length)
+{
+	return (length + (HKDS_QUEUE_ALIGNMENT - 1U)) & ~(size_t)(HKDS_QUEUE_ALIGNMENT - 1U);
+}
+
+static size_t hkds_queue_layout(size_t depth, size_t width, hkds_queue_mode mode, size_t* dlen, size_t* seqlen, size_t* taglen)
+{
+	size_t res;
+
+	res = 0U;
+	*dlen = 1U;
+
+	/* round the depth up to a power of two so a counter maps to a slot with a mask */
+	while (*dlen < depth && *dlen <= (HKDS_SIZE_MAX >> 2U))
+	{
+		*dlen <<= 1U;
+	}
+
+	if (depth != 0U && width != 0U && *dlen >= depth &&
+		*dlen <= (HKDS_SIZE_MAX >> 1U) / (width + sizeof(uint64_t) + sizeof(hkds_atomic_size)))
+	{
+		/* the sequence numbers, then the tags, then the slots, each section starting on a cache line */
+		*seqlen = (mode == hkds_queue_mode_mpmc) ? hkds_queue_align(*dlen * sizeof(hkds_atomic_size)) : 0U;
+		*taglen = hkds_queue_align(*dlen * sizeof(uint64_t));
+		res = *seqlen + *taglen + hkds_queue_align(*dlen * width);
+	}
+
+	return res;
+}
+
+static uint8_t* hkds_queue_slot(const hkds_message_queue_state* ctx, size_t pos)
+{
+	return ctx->state.queue + ((pos & ctx->state.mask) * ctx->state.width);
+}
+
+static size_t hkds_queue_available(const hkds_message_queue_state* ctx)
+{
+	size_t head;
+	size_t tail;
+
+	/* read the head first; the tail can only have moved forward since */
+	head = hkds_atomic_load(&ctx->state.head);
+	tail = hkds_atomic_load(&ctx->state.tail);
+
+	return (tail >= head) ? (tail - head) : 0U;
+}
+
+static bool hkds_queue_claim(hkds_message_queue_state* ctx, size_t items, size_t* position)
+{
+	size_t pos;
+	size_t seq;
+	size_t i;
+	bool res;
+
+	res = false;
+	pos = hkds_atomic_load(&ctx->state.head);
+
+	if (ctx->state.mode == hkds_queue_mode_spsc)
+	{
+		/* the consumer owns the head; the acquire on the tail publishes the item contents */
+		if (hkds_atomic_load(&ctx->state.tail) - pos >= items)
+		{
+			*position = pos;
+			res = true;
+		}
+	}
+	else
+	{
+		for (;;)
+		{
+			/* every slot in the range must be published at its expected position */
+			for (i = 0U; i < items; ++i)
+			{
+				seq = hkds_atomic_load(&ctx->state.sequence[(pos + i) & ctx->state.mask]);
+
+				if (seq != pos + i + 1U)
+				{
+					break;
+				}
+			}
+
+			if (i == items)
+			{
+				/* claim the whole range in one step */
+				if (hkds_atomic_compare_exchange(&ctx->state.head, &pos, pos + items) == true)
+				{
+					*position = pos;
+					res = true;
+					break;
+				}
+			}
+			else if (seq < pos + i + 1U)
+			{
+				/* the range has not been published; too few items are queued */
+				break;
+			}
+			else
+			{
+				pos = hkds_atomic_load(&ctx->state.head);
+			}
+		}
+	}
+
+	return res;
+}
+
+static void hkds_queue_release(hkds_message_queue_state* ctx, size_t position, size_t items)
+{
+	if (ctx->state.mode == hkds_queue_mode_spsc)
+	{
+		hkds_atomic_store(&ctx->state.head, position + items);
+	}
+	else
+	{
+		/* a released slot becomes writable one lap later */
+		for (size_t i = 0U; i < items; ++i)
+		{
+			hkds_atomic_store(&ctx->state.sequence[(position + i) & ctx->state.mask], position + i + ctx->state.depth);
+		}
+	}
+}
+
+static bool hkds_queue_claim_write(hkds_message_queue_state* ctx, size_t items, size_t* position)
+{
+	size_t pos;
+	size_t seq;
+	size_t i;
+	bool res;
+
+	res = false;
+	pos = hkds_atomic_load(&ctx->state.tail);
+
+	if (ctx->state.mode == hkds_queue_mode_spsc)
+	{
+		/* the producer owns the tail; the acquire on the head orders the slot reuse */
+		if (ctx->state.depth - (pos - hkds_atomic_load(&ctx->state.head)) >= items)
+		{
+			*position = pos;
+			res = true;
+		}
+	}
+	else
+	{
+		for (;;)
+		{
+			/* every slot in the range must be free at its expected position */
+			for (i = 0U; i < items; ++i)
+			{
+				seq = hkds_atomic_load(&ctx->state.sequence[(pos + i) & ctx->state.mask]);
+
+				if (seq != pos + i)
+				{
+					break;
+				}
+			}
+
+			if (i == items)
+			{
+				if (hkds_atomic_compare_exchange(&ctx->state.tail, &pos, pos + items) == true)
+				{
+					*position = pos;
+					res = true;
+					break;
+				}
+			}
+			else if (seq < pos + i)
+			{
+				/* the slot still holds an unread item; the queue is full */
+				break;
+			}
+			else
+			{
+				pos = hkds_atomic_load(&ctx->state.tail);
+			}
+		}
+	}
+
+	return res;
+}
+
+static uint64_t hkds_queue_default_tag(const hkds_message_queue_state* ctx)
+{
+	return (ctx->tag != NULL) ? utils_integer_le8to64(ctx->tag) : 0U;
+}
+
+static void hkds_queue_publish(hkds_message_queue_state* ctx, size_t position, size_t items, uint64_t tag)
+{
+	for (size_t i = 0U; i < items; ++i)
+	{
+		ctx->state.tags[(position + i) & ctx->state.mask] = tag;
+	}
+
+	if (ctx->state.mode == hkds_queue_mode_spsc)
+	{
+		hkds_atomic_store(&ctx->state.tail, position + items);
+	}
+	else
+	{
+		for (size_t i = 0U; i < items; ++i)
+		{
+			hkds_atomic_store(&ctx->state.sequence[(position + i) & ctx->state.mask], position + i + 1U);
+		}
+	}
+}
+
+static void hkds_queue_view_set(const hkds_message_queue_state* ctx, hkds_queue_view* view, size_t position, size_t items)
+{
+	size_t idx;
+
+	idx = position & ctx->state.mask;
+	view->position = position;
+	view->count = items;
+	view->width = ctx->state.width;
+	view->first = ctx->state.queue + (idx * ctx->state.width);
+	view->firstcount = (items < ctx->state.depth - idx) ? items : ctx->state.depth - idx;
+	view->second = (view->firstcount < items) ? ctx->state.queue : NULL;
+}
+
+static void hkds_queue_take(hkds_message_queue_state* ctx, size_t position, size_t items, uint8_t* output, size_t stride)
+{
+	size_t first;
+	size_t idx;
+
+	idx = position & ctx->state.mask;
+
+	if (stride == ctx->state.width)
+	{
+		/* the claimed range is at most two contiguous runs of slots, split where the ring wraps */
+		first = ctx->state.depth - idx;
+		first = (items < first) ? items : first;
+		utils_memory_copy(output, ctx->state.queue + (idx * ctx->state.width), first * ctx->state.width);
+		utils_memory_secure_erase(ctx->state.queue + (idx * ctx->state.width), first * ctx->state.width);
+		utils_memory_clear((uint8_t*)(ctx->state.tags + idx), first * sizeof(uint64_t));
+
+		if (first < items)
+		{
+			utils_memory_copy(output + (first * ctx->state.width), ctx->state.queue, (items - first) * ctx->state.width);
+			utils_memory_secure_erase(ctx->state.queue, (items - first) * ctx->state.width);
+			utils_memory_clear((uint8_t*)ctx->state.tags, (items - first) * sizeof(uint64_t));
+		}
+	}
+	else
+	{
+		for (size_t i = 0U; i < items; ++i)
+		{
+			idx = (position + i) & ctx->state.mask;
+			utils_memory_copy(output + (i * stride), ctx->state.queue + (idx * ctx->state.width), (stride < ctx->state.width) ? stride : ctx->state.width);
+			utils_memory_secure_erase(ctx->state.queue + (idx * ctx->state.width), ctx->state.width);
+			ctx->state.tags[idx] = 0U;
+		}
+	}
+}
+
+size_t hkds_message_queue_buffer_size(size_t depth, size_t width, hkds_queue_mode mode)
+{
+	size_t dlen;
+	size_t seqlen;
+	size_t taglen;
+
+	return hkds_queue_layout(depth, width, mode, &dlen, &seqlen, &taglen);
+}
+
 void hkds_message_queue_destroy(hkds_message_queue_state* ctx)
 {
 	HKDS_ASSERT(ctx != NULL);
 
 	if (ctx != NULL)
 	{
-		for (size_t i = 0U; i < ctx->state.depth; ++i)
+		if (ctx->state.slab != NULL)
 		{
-			if (ctx->state.queue[i] != NULL)
+			utils_memory_secure_erase(ctx->state.slab, ctx->state.slablen);
+
+			if (ctx->state.external == false)
 			{
-				utils_memory_clear(ctx->state.queue[i], ctx->state.width);
-				utils_memory_aligned_free(ctx->state.queue[i]);
+				utils_memory_aligned_free(ctx->state.slab);
 			}
 		}
 
-		utils_memory_aligned_free(ctx->state.queue);
-		utils_memory_secure_erase((uint8_t*)ctx->state.tags, sizeof(ctx->state.tags));
-		ctx->state.count = 0U;
+		ctx->state.slab = NULL;
+		ctx->state.slablen = 0U;
+		ctx->state.queue = NULL;
+		ctx->state.tags = NULL;
+		ctx->state.sequence = NULL;
+		ctx->state.external = false;
+		hkds_atomic_store(&ctx->state.head, 0U);
+		hkds_atomic_store(&ctx->state.tail, 0U);
 		ctx->state.depth = 0U;
-		ctx->state.position = 0U;
+		ctx->state.mask = 0U;
 		ctx->state.width = 0U;
 	}
 }
 
-void hkds_message_queue_flush(hkds_message_queue_state* ctx, uint8_t* output)
+size_t hkds_message_queue_flush(hkds_message_queue_state* ctx, uint8_t* output)
 {
 	HKDS_ASSERT(ctx != NULL);
 	HKDS_ASSERT(output != NULL);
 
-	if (ctx->state.queue != NULL)
+	size_t i;
+
+	i = 0U;
+
+	if (ctx != NULL && output != NULL && ctx->state.queue != NULL)
 	{
-		for (size_t i = 0U; i < ctx->state.position; ++i)
+		/* bounded by the depth, so concurrent producers cannot overrun the output */
+		while (i < ctx->state.depth && hkds_message_queue_pop(ctx, (output + (i * ctx->state.width)), ctx->state.width) == true)
 		{
-			if (ctx->state.queue[i] != NULL)
-			{
-				utils_memory_copy((output + (i * ctx->state.width)), ctx->state.queue[i], ctx->state.width);
-				utils_memory_secure_erase(ctx->state.queue[i], ctx->state.width);
-			}
+			++i;
 		}
+	}
+
+	return i;
+}
+
+bool hkds_message_queue_initialize(hkds_message_queue_state* ctx, size_t depth, size_t width, uint8_t* tag)
+{
+	HKDS_ASSERT(ctx != NULL);
+	HKDS_ASSERT(depth != 0U);
+	HKDS_ASSERT(width != 0U);
+
+	bool res;
+
+	res = false;
 
-		ctx->state.count = 0U;
-		ctx->state.position = 0U;
-		utils_memory_secure_erase((uint8_t*)ctx->state.tags, sizeof(ctx->state.tags));
+	if (ctx != NULL)
+	{
+		/* the queue memory is allocated */
+		res = hkds_message_queue_initialize_ex(ctx, depth, width, tag, HKDS_QUEUE_DEFAULT_MODE, NULL, 0U);
 	}
+
+	return res;
 }
 
-void hkds_message_queue_initialize(hkds_message_queue_state* ctx, size_t depth, size_t width, uint8_t* tag)
+bool hkds_message_queue_initialize_ex(hkds_message_queue_state* ctx, size_t depth, size_t width, uint8_t* tag, hkds_queue_mode mode, uint8_t* buffer, size_t buflen)
 {
 	HKDS_ASSERT(ctx != NULL);
 	HKDS_ASSERT(depth != 0U);
 	HKDS_ASSERT(width != 0U);
 
-	ctx->state.queue = (uint8_t**)utils_memory_aligned_alloc(HKDS_QUEUE_ALIGNMENT, depth * sizeof(uint8_t*));
+	size_t dlen;
+	size_t seqlen;
+	size_t slen;
+	size_t taglen;
+	bool res;
+
+	res = false;
 
-	if (ctx->state.queue != NULL)
+	if (ctx != NULL)
 	{
-		ctx->tag = tag;
+		slen = hkds_queue_layout(depth, width, mode, &dlen, &seqlen, &taglen);
+		ctx->state.slab = NULL;
+		ctx->state.external = false;
 
-		for (size_t i = 0; i < depth; ++i)
+		if (slen != 0U)
 		{
-			ctx->state.queue[i] = utils_memory_aligned_alloc(HKDS_QUEUE_ALIGNMENT, width);
-
-			if (ctx->state.queue[i] != NULL)
+			if (buffer != NULL)
 			{
-				utils_memory_clear(ctx->state.queue[i], width);
+				if (buflen >= slen && ((uintptr_t)buffer & (HKDS_QUEUE_ALIGNMENT - 1U)) == 0U)
+				{
+					ctx->state.slab = buffer;
+					ctx->state.external = true;
+				}
+			}
+			else
+			{
+				ctx->state.slab = (uint8_t*)utils_memory_aligned_alloc(HKDS_QUEUE_ALIGNMENT, slen);
 			}
 		}
 
-		ctx->state.count = 0U;
-		ctx->state.depth = depth;
-		ctx->state.position = 0U;
-		utils_memory_clear((uint8_t*)ctx->state.tags, HKDS_QUEUE_MAX_DEPTH);
-		ctx->state.width = width;
+		if (ctx->state.slab != NULL)
+		{
+			utils_memory_clear(ctx->state.slab, slen);
+			ctx->tag = tag;
+			ctx->state.slablen = slen;
+			ctx->state.sequence = (mode == hkds_queue_mode_mpmc) ? (hkds_atomic_size*)ctx->state.slab : NULL;
+			ctx->state.tags = (uint64_t*)(ctx->state.slab + seqlen);
+			ctx->state.queue = ctx->state.slab + seqlen + taglen;
+			ctx->state.depth = dlen;
+			ctx->state.mask = dlen - 1U;
+			ctx->state.width = width;
+			ctx->state.mode = mode;
+			hkds_atomic_store(&ctx->state.head, 0U);
+			hkds_atomic_store(&ctx->state.tail, 0U);
+
+			if (mode == hkds_queue_mode_mpmc)
+			{
+				/* a slot is writable at position p when its sequence equals p, and readable when it equals p + 1 */
+				for (size_t i = 0U; i < dlen; ++i)
+				{
+					hkds_atomic_store(&ctx->state.sequence[i], i);
+				}
+			}
+
+			res = true;
+		}
 	}
+
+	return res;
 }
 
-void hkds_message_queue_pop(hkds_message_queue_state* ctx, uint8_t* output, size_t outlen)
+bool hkds_message_queue_pop(hkds_message_queue_state* ctx, uint8_t* output, size_t outlen)
 {
 	HKDS_ASSERT(ctx != NULL);
 	HKDS_ASSERT(output != NULL);
 	HKDS_ASSERT(outlen != 0U);
 
-	if (ctx->state.position != 0U)
+	size_t pos;
+	bool res;
+
+	res = false;
+
+	if (ctx != NULL && output != NULL && outlen != 0U && outlen <= ctx->state.width)
 	{
-		if (!hkds_message_queue_empty(ctx) && outlen <= ctx->state.width)
+		if (hkds_queue_claim(ctx, 1U, &pos) == true)
 		{
-			utils_memory_copy(output, ctx->state.queue[0U], outlen);
-			utils_memory_secure_erase(ctx->state.queue[0U], ctx->state.width);
+			hkds_queue_take(ctx, pos, 1U, output, outlen);
+			hkds_queue_release(ctx, pos, 1U);
+			res = true;
+		}
+	}
 
-			if (ctx->state.count > 1U)
-			{
-				for (size_t i = 1U; i < ctx->state.count; ++i)
-				{
-					utils_memory_copy(ctx->state.queue[i - 1U], ctx->state.queue[i], ctx->state.width);
-					ctx->state.tags[i - 1U] = ctx->state.tags[i];
-				}
-			}
+	return res;
+}
 
-			utils_memory_secure_erase(ctx->state.queue[ctx->state.position - 1U], ctx->state.width);
-			ctx->state.tags[ctx->state.position - 1U] = 0U;
-			--ctx->state.count;
-			--ctx->state.position;
-		}
+bool hkds_message_queue_push(hkds_message_queue_state* ctx, const uint8_t* input, size_t inplen)
+{
+	HKDS_ASSERT(ctx != NULL);
+
+	bool res;
+
+	res = false;
+
+	if (ctx != NULL)
+	{
+		res = hkds_message_queue_push_tagged(ctx, input, inplen, hkds_queue_default_tag(ctx));
 	}
+
+	return res;
 }
 
-void hkds_message_queue_push(hkds_message_queue_state* ctx, const uint8_t* input, size_t inplen)
+bool hkds_message_queue_push_tagged(hkds_message_queue_state* ctx, const uint8_t* input, size_t inplen, uint64_t tag)
 {
 	HKDS_ASSERT(ctx != NULL);
 	HKDS_ASSERT(input != NULL);
 	HKDS_ASSERT(inplen != 0U);
 
-	uint64_t tag;
+	size_t pos;
+	bool res;
 
-	if (ctx->state.position != ctx->state.depth)
+	res = false;
+
+	if (ctx != NULL && input != NULL && inplen != 0U && inplen <= ctx->state.width)
 	{
-		tag = utils_integer_le8to64(ctx->tag);
+		if (hkds_queue_claim_write(ctx, 1U, &pos) == true)
+		{
+			utils_memory_copy(hkds_queue_slot(ctx, pos), input, inplen);
+			hkds_queue_publish(ctx, pos, 1U, tag);
+			res = true;
+		}
+	}
+
+	return res;
+}
+
+bool hkds_message_queue_peek_tag(const hkds_message_queue_state* ctx, uint64_t* tag)
+{
+	HKDS_ASSERT(ctx != NULL);
+	HKDS_ASSERT(tag != NULL);
+
+	size_t pos;
+	bool res;
 
-		if (!hkds_message_queue_full(ctx) && inplen <= ctx->state.width)
+	res = false;
+
+	if (ctx != NULL && tag != NULL && ctx->state.queue != NULL)
+	{
+		pos = hkds_atomic_load(&ctx->state.head);
+
+		/* the acquire on the publication orders the tag read after the producer's write */
+		if (ctx->state.mode == hkds_queue_mode_spsc)
+		{
+			res = (hkds_atomic_load(&ctx->state.tail) != pos);
+		}
+		else
 		{
-			utils_memory_copy(ctx->state.queue[ctx->state.position], input, inplen);
-			ctx->state.tags[ctx->state.position] = tag;
-			++ctx->state.position;
-			++ctx->state.count;
+			res = (hkds_atomic_load(&ctx->state.sequence[pos & ctx->state.mask]) == pos + 1U);
+		}
+
+		if (res == true)
+		{
+			*tag = ctx->state.tags[pos & ctx->state.mask];
 		}
 	}
+
+	return res;
 }
 
 bool hkds_message_queue_full(const hkds_message_queue_state* ctx)
@@ -139,7 +509,7 @@ bool hkds_message_queue_full(const hkds_message_queue_state* ctx)
 
 	if (ctx != NULL)
 	{
-		res = (bool)(ctx->state.count == ctx->state.depth);
+		res = (bool)(hkds_queue_available(ctx) >= ctx->state.depth);
 	}
 
 	return res;
@@ -155,7 +525,7 @@ bool hkds_message_queue_empty(const hkds_message_queue_state* ctx)
 
 	if (ctx != NULL)
 	{
-		res = (bool)(ctx->state.count == 0U);
+		res = (bool)(hkds_queue_available(ctx) == 0U);
 	}
 
 	return res;
@@ -171,7 +541,13 @@ size_t hkds_message_queue_count(const hkds_message_queue_state* ctx)
 
 	if (ctx != NULL)
 	{
-		res = ctx->state.count;
+		res = hkds_queue_available(ctx);
+
+		/* a multiple producer tail may run ahead of items still being written */
+		if (res > ctx->state.depth)
+		{
+			res = ctx->state.depth;
+		}
 	}
 
 	return res;
@@ -181,59 +557,189 @@ size_t hkds_message_queue_count(const hkds_message_queue_state* ctx)
 
 size_t hkds_message_queue_extract_block_x8(hkds_message_queue_state* ctx, uint8_t output[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE])
 {
-	size_t i;
+	HKDS_ASSERT(ctx != NULL);
+	HKDS_ASSERT(output != NULL);
 
-	i = 0U;
+	size_t pos;
+	size_t res;
+
+	res = 0U;
 
-	if (ctx->state.position >= HKDS_CACHX8_DEPTH)
+	if (ctx != NULL && output != NULL && ctx->state.width <= HKDS_MESSAGE_SIZE && ctx->state.depth >= HKDS_CACHX8_DEPTH)
 	{
-		for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+		if (hkds_queue_claim(ctx, HKDS_CACHX8_DEPTH, &pos) == true)
 		{
-			hkds_message_queue_pop(ctx, output[i], ctx->state.width);
+			hkds_queue_take(ctx, pos, HKDS_CACHX8_DEPTH, (uint8_t*)output, HKDS_MESSAGE_SIZE);
+			hkds_queue_release(ctx, pos, HKDS_CACHX8_DEPTH);
+			res = HKDS_CACHX8_DEPTH;
 		}
 	}
 
-	return i;
+	return res;
 }
 
 size_t hkds_message_queue_extract_block_x64(hkds_message_queue_state* ctx, uint8_t output[HKDS_PARALLEL_DEPTH][HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE])
 {
-	size_t i;
-	size_t j;
+	HKDS_ASSERT(ctx != NULL);
+	HKDS_ASSERT(output != NULL);
 
-	i = 0U;
-	j = 0U;
+	size_t pos;
+	size_t res;
+
+	res = 0U;
 
-	if (ctx->state.position >= HKDS_CACHX64_SIZE)
+	if (ctx != NULL && output != NULL && ctx->state.width <= HKDS_MESSAGE_SIZE && ctx->state.depth >= HKDS_CACHX64_SIZE)
 	{
-		for (i = 0U; i < HKDS_PARALLEL_DEPTH; ++i)
+		if (hkds_queue_claim(ctx, HKDS_CACHX64_SIZE, &pos) == true)
 		{
-			for (j = 0U; j < HKDS_CACHX8_DEPTH; ++j)
-			{
-				hkds_message_queue_pop(ctx, output[i][j], ctx->state.width);
-			}
+			hkds_queue_take(ctx, pos, HKDS_CACHX64_SIZE, (uint8_t*)output, HKDS_MESSAGE_SIZE);
+			hkds_queue_release(ctx, pos, HKDS_CACHX64_SIZE);
+			res = HKDS_CACHX64_SIZE;
 		}
 	}
 
-	return (i * j);
+	return res;
 }
 
 /* stream queue serialization */
 
 size_t hkds_message_queue_extract_stream(hkds_message_queue_state* ctx, uint8_t* stream, size_t items)
 {
-	size_t i;
+	HKDS_ASSERT(ctx != NULL);
+	HKDS_ASSERT(stream != NULL);
 
-	i = 0U;
+	size_t pos;
+	size_t res;
+
+	res = 0U;
 
-	if (ctx->state.position >= items)
+	if (ctx != NULL && stream != NULL && items != 0U && items <= ctx->state.depth)
 	{
-		for (i = 0U; i < items; ++i)
+		if (hkds_queue_claim(ctx, items, &pos) == true)
 		{
-			hkds_message_queue_pop(ctx, (stream + (i * ctx->state.width)), ctx->state.width);
+			hkds_queue_take(ctx, pos, items, stream, ctx->state.width);
+			hkds_queue_release(ctx, pos, items);
+			res = items;
 		}
 	}
 
-	return i;
+	return res;
 }
 
+/* zero-copy views */
+
+uint8_t* hkds_message_queue_view_item(const hkds_queue_view* view, size_t index)
+{
+	HKDS_ASSERT(view != NULL);
+	HKDS_ASSERT(index < view->count);
+
+	uint8_t* res;
+
+	res = NULL;
+
+	if (view != NULL && index < view->count)
+	{
+		res = (index < view->firstcount) ? view->first + (index * view->width) :
+			view->second + ((index - view->firstcount) * view->width);
+	}
+
+	return res;
+}
+
+void hkds_message_queue_view_pointers(const hkds_queue_view* view, size_t offset, const uint8_t** output)
+{
+	HKDS_ASSERT(view != NULL);
+	HKDS_ASSERT(output != NULL);
+	HKDS_ASSERT(offset < view->width);
+
+	if (view != NULL && output != NULL && offset < view->width)
+	{
+		for (size_t i = 0U; i < view->firstcount; ++i)
+		{
+			output[i] = view->first + (i * view->width) + offset;
+		}
+
+		for (size_t i = view->firstcount; i < view->count; ++i)
+		{
+			output[i] = view->second + ((i - view->firstcount) * view->width) + offset;
+		}
+	}
+}
+
+bool hkds_message_queue_reserve(hkds_message_queue_state* ctx, hkds_queue_view* view, size_t items)
+{
+	HKDS_ASSERT(ctx != NULL);
+	HKDS_ASSERT(view != NULL);
+
+	size_t pos;
+	bool res;
+
+	res = false;
+
+	if (ctx != NULL && view != NULL && items != 0U && items <= ctx->state.depth)
+	{
+		if (hkds_queue_claim_write(ctx, items, &pos) == true)
+		{
+			hkds_queue_view_set(ctx, view, pos, items);
+			res = true;
+		}
+	}
+
+	return res;
+}
+
+void hkds_message_queue_commit(hkds_message_queue_state* ctx, hkds_queue_view* view)
+{
+	HKDS_ASSERT(ctx != NULL);
+	HKDS_ASSERT(view != NULL);
+
+	if (ctx != NULL && view != NULL && view->count != 0U)
+	{
+		hkds_queue_publish(ctx, view->position, view->count, hkds_queue_default_tag(ctx));
+		utils_memory_clear((uint8_t*)view, sizeof(hkds_queue_view));
+	}
+}
+
+bool hkds_message_queue_acquire(hkds_message_queue_state* ctx, hkds_queue_view* view, size_t items)
+{
+	HKDS_ASSERT(ctx != NULL);
+	HKDS_ASSERT(view != NULL);
+
+	size_t pos;
+	bool res;
+
+	res = false;
+
+	if (ctx != NULL && view != NULL && items != 0U && items <= ctx->state.depth)
+	{
+		if (hkds_queue_claim(ctx, items, &pos) == true)
+		{
+			hkds_queue_view_set(ctx, view, pos, items);
+			res = true;
+		}
+	}
+
+	return res;
+}
+
+void hkds_message_queue_release(hkds_message_queue_state* ctx, hkds_queue_view* view)
+{
+	HKDS_ASSERT(ctx != NULL);
+	HKDS_ASSERT(view != NULL);
+
+	if (ctx != NULL && view != NULL && view->count != 0U)
+	{
+		/* erase the items in place before the slots are handed back to the producers */
+		utils_memory_secure_erase(view->first, view->firstcount * view->width);
+		utils_memory_clear((uint8_t*)(ctx->state.tags + (view->position & ctx->state.mask)), view->firstcount * sizeof(uint64_t));
+
+		if (view->second != NULL)
+		{
+			utils_memory_secure_erase(view->second, (view->count - view->firstcount) * view->width);
+			utils_memory_clear((uint8_t*)ctx->state.tags, (view->count - view->firstcount) * sizeof(uint64_t));
+		}
+
+		hkds_queue_release(ctx, view->position, view->count);
+		utils_memory_clear((uint8_t*)view, sizeof(hkds_queue_view));
+	}
+}
@@ -64,6 +64,21 @@
  * message queue. The queue is used to store, manage, and export messages within the HKDS system.
  * It provides functionality for initializing the queue, adding and removing items, checking the queue
  * status, and exporting blocks or streams of messages.
+ *
+ * The queue is a power-of-two ring indexed by free-running head and tail counters, so every operation
+ * is O(1) per item, and a block export claims the whole block in one step. It is lock-free in both modes:
+ * - **Single Producer, Single Consumer:** One thread pushes and one thread pops; the head and tail
+ *   counters are the only shared state.
+ * - **Multiple Producer, Multiple Consumer:** Any number of threads push and pop; each slot carries a
+ *   sequence number that tells producers and consumers when it is free or filled.
+ *
+ * The slots, the slot tags, and the sequence numbers share a single cache-aligned slab, with the slots stored
+ * back to back, so a block export is a sequential read. The slab is allocated by the queue, or supplied by
+ * the caller, in which case the queue makes no heap allocations; \ref hkds_message_queue_buffer_size
+ * returns the slab size for a queue configuration.
+ *
+ * The full, empty, and count functions return a snapshot, which may be stale by the time it is used
+ * when other threads are operating on the queue.
  */
 
 /*!
@@ -78,11 +93,20 @@
  */
 #define HKDS_QUEUE_ALIGNMENT 64U
 
+/*! \enum hkds_queue_mode
+ * \brief The queue concurrency mode.
+ */
+typedef enum hkds_queue_mode
+{
+    hkds_queue_mode_spsc = 0x00U,   /*!< One producer thread and one consumer thread */
+    hkds_queue_mode_mpmc = 0x01U,   /*!< Any number of producer and consumer threads */
+} hkds_queue_mode;
+
 /*!
- * \def HKDS_QUEUE_MAX_DEPTH
- * \brief The maximum queue depth.
+ * \def HKDS_QUEUE_DEFAULT_MODE
+ * \brief The concurrency mode of a queue created with \ref hkds_message_queue_initialize.
  */
-#define HKDS_QUEUE_MAX_DEPTH 64U
+#define HKDS_QUEUE_DEFAULT_MODE hkds_queue_mode_mpmc
 
 /*!
  * \struct hkds_queue_state
@@ -90,19 +114,26 @@
  *
  * \details
  * This structure holds the internal state of a generic HKDS queue, including:
- * - A pointer to a 2-dimensional array representing the queue.
- * - A corresponding array of 64-bit tags for each queue item.
- * - Counters for the current item count, maximum depth, next empty slot (position), and the
- *   maximum byte length (width) of a queue item.
+ * - The slab holding the queue slots, each the width of a queue item, stored contiguously.
+ * - A corresponding array of 64-bit tags for each queue slot.
+ * - The per-slot sequence numbers used in multiple producer mode.
+ * - The head and tail counters, each on its own cache line; the slot index of a counter is the counter masked by the depth.
+ * - The depth, a power of two, and the maximum byte length (width) of a queue item.
  */
 HKDS_EXPORT_API typedef struct hkds_queue_state
 {
-    uint8_t** queue;                   /*!< Pointer to a 2-dimensional queue array. */
-    uint64_t tags[HKDS_QUEUE_MAX_DEPTH]; /*!< 64-bit tag associated with each queue item. */
-    size_t count;                      /*!< The number of queue items currently in the queue. */
-    size_t depth;                      /*!< The maximum number of items in the queue. */
-    size_t position;                   /*!< The index of the next empty slot in the queue. */
-    size_t width;                      /*!< The maximum byte length of a queue item. */
+    uint8_t* queue;                     /*!< The contiguous slot array. */
+    uint64_t* tags;                     /*!< 64-bit tag associated with each queue slot. */
+    hkds_atomic_size* sequence;         /*!< The slot sequence numbers; multiple producer mode only. */
+    uint8_t* slab;                      /*!< The memory block holding the slots, tags, and sequence numbers. */
+    size_t slablen;                     /*!< The byte length of the memory block. */
+    size_t depth;                       /*!< The maximum number of items in the queue. */
+    size_t mask;                        /*!< The depth minus one. */
+    size_t width;                       /*!< The maximum byte length of a queue item. */
+    hkds_queue_mode mode;               /*!< The concurrency mode. */
+    bool external;                      /*!< The memory block was supplied by the caller. */
+    HKDS_ALIGN(HKDS_QUEUE_ALIGNMENT) hkds_atomic_size head; /*!< The count of items removed from the queue. */
+    HKDS_ALIGN(HKDS_QUEUE_ALIGNMENT) hkds_atomic_size tail; /*!< The count of items added to the queue. */
 } hkds_queue_state;
 
 /*!
@@ -118,55 +149,112 @@ typedef struct hkds_message_queue_state
     hkds_queue_state state; /*!< The internal queue state context. */
 } hkds_message_queue_state;
 
+/*!
+ * \struct hkds_queue_view
+ * \brief A range of queue slots accessed in place.
+ *
+ * \details
+ * A view refers directly to the slot memory of a claimed range of queue items. The range is at most two
+ * contiguous runs of slots, split where the ring wraps; \ref hkds_message_queue_view_item and
+ * \ref hkds_message_queue_view_pointers resolve the address of an item.
+ */
+HKDS_EXPORT_API typedef struct hkds_queue_view
+{
+    uint8_t* first;         /*!< The first contiguous run of slots. */
+    uint8_t* second;        /*!< The run of slots after the wrap point, or NULL. */
+    size_t firstcount;      /*!< The number of slots in the first run. */
+    size_t count;           /*!< The number of slots in the view. */
+    size_t position;        /*!< The queue position of the first slot. */
+    size_t width;           /*!< The byte width of a slot. */
+} hkds_queue_view;
+
 /**
  * \brief Resets the queue context state.
  *
  * \details
- * This function destroys the message queue context by clearing and freeing all allocated memory,
- * resetting internal counters, and clearing associated tags.
+ * This function destroys the message queue context by clearing the queue memory, freeing it unless it
+ * was supplied by the caller, and resetting the internal counters.
  *
  * \param ctx [in,out] The message queue state context.
  */
 HKDS_EXPORT_API void hkds_message_queue_destroy(hkds_message_queue_state* ctx);
 
+/**
+ * \brief Returns the memory block size required by a queue.
+ *
+ * \details
+ * This function returns the byte length of the slab holding the slots, tags, and sequence numbers of a queue
+ * with the given configuration, for use with a caller-supplied buffer.
+ *
+ * \param depth [in] The maximum number of items the queue can hold; rounded up to a power of two.
+ * \param width [in] The maximum byte length of each queue item.
+ * \param mode [in] The concurrency mode.
+ * \return The required buffer length, or zero if the configuration is invalid.
+ */
+HKDS_EXPORT_API size_t hkds_message_queue_buffer_size(size_t depth, size_t width, hkds_queue_mode mode);
+
 /**
  * \brief Flushes the contents of the queue to a byte array.
  *
  * \details
- * This function copies all items currently in the queue to the provided output array, then clears
- * the queue and resets its state.
+ * This function removes all items currently in the queue and copies them, in order, to the provided output array,
+ * which must be able to hold a full queue.
  *
  * \param ctx [in,out] The message queue state context.
  * \param output [out] The byte array that will receive the flushed queue items.
+ * \return The number of items flushed.
  */
-HKDS_EXPORT_API void hkds_message_queue_flush(hkds_message_queue_state* ctx, uint8_t* output);
+HKDS_EXPORT_API size_t hkds_message_queue_flush(hkds_message_queue_state* ctx, uint8_t* output);
 
 /**
  * \brief Initializes the queue state context.
  *
  * \details
  * This function allocates and initializes the internal structures of the message queue with the specified
- * depth, width, and associated tag.
+ * depth, width, and associated tag. The depth is rounded up to a power of two. The queue is created in the
+ * \c HKDS_QUEUE_DEFAULT_MODE concurrency mode, which is safe for any number of producer and consumer threads.
+ *
+ * \param ctx [in,out] The message queue state context.
+ * \param depth [in] The maximum number of items the queue can hold.
+ * \param width [in] The maximum byte length of each queue item.
+ * \param tag [in] Pointer to the tag associated with the message queue.
+ * \return Returns false if the configuration is invalid or the memory could not be allocated.
+ */
+HKDS_EXPORT_API bool hkds_message_queue_initialize(hkds_message_queue_state* ctx, size_t depth, size_t width, uint8_t* tag);
+
+/**
+ * \brief Initializes the queue state context with a concurrency mode and optional caller memory.
+ *
+ * \details
+ * This function initializes the internal structures of the message queue with the specified depth, width,
+ * concurrency mode, and associated tag. The depth is rounded up to a power of two.
+ * If a buffer is supplied, the queue is built in it and no memory is allocated; the buffer must be aligned to
+ * \c HKDS_QUEUE_ALIGNMENT and hold at least \ref hkds_message_queue_buffer_size bytes, and must outlive the queue.
+ * Otherwise the queue allocates a single aligned block.
  *
  * \param ctx [in,out] The message queue state context.
  * \param depth [in] The maximum number of items the queue can hold.
  * \param width [in] The maximum byte length of each queue item.
  * \param tag [in] Pointer to the tag associated with the message queue.
+ * \param mode [in] The concurrency mode.
+ * \param buffer [in] The [optional] caller-supplied queue memory, or NULL to allocate.
+ * \param buflen [in] The byte length of the caller-supplied buffer.
+ * \return Returns false if the configuration is invalid, the buffer is too small or misaligned, or the memory could not be allocated.
  */
-HKDS_EXPORT_API void hkds_message_queue_initialize(hkds_message_queue_state* ctx, size_t depth, size_t width, uint8_t* tag);
+HKDS_EXPORT_API bool hkds_message_queue_initialize_ex(hkds_message_queue_state* ctx, size_t depth, size_t width, uint8_t* tag, hkds_queue_mode mode, uint8_t* buffer, size_t buflen);
 
 /**
  * \brief Removes an item from the queue and copies it to the output array.
  *
  * \details
- * This function removes the first item from the queue, copies its data to the provided output array,
- * and shifts the remaining items forward in the queue.
+ * This function removes the oldest item from the queue and copies its data to the provided output array.
  *
  * \param ctx [in,out] The message queue state context.
  * \param output [out] The output array where the removed item will be stored.
  * \param outlen [in] The length (in bytes) of the output array.
+ * \return Returns false if the queue is empty.
  */
-HKDS_EXPORT_API void hkds_message_queue_pop(hkds_message_queue_state* ctx, uint8_t* output, size_t outlen);
+HKDS_EXPORT_API bool hkds_message_queue_pop(hkds_message_queue_state* ctx, uint8_t* output, size_t outlen);
 
 /**
  * \brief Adds an item to the queue.
@@ -177,8 +265,37 @@ HKDS_EXPORT_API void hkds_message_queue_pop(hkds_message_queue_state* ctx, uint8
  * \param ctx [in,out] The message queue state context.
  * \param inpput [in] The input array containing the data to be added.
  * \param inplen [in] The length (in bytes) of the input data.
+ * \return Returns false if the queue is full.
+ */
+HKDS_EXPORT_API bool hkds_message_queue_push(hkds_message_queue_state* ctx, const uint8_t* inpput, size_t inplen);
+
+/**
+ * \brief Adds an item to the queue with an explicit slot tag.
+ *
+ * \details
+ * This function adds an item as \ref hkds_message_queue_push does, but stores the supplied 64-bit value as the slot
+ * tag in place of the queue tag; for example, the arrival time of the item.
+ *
+ * \param ctx [in,out] The message queue state context.
+ * \param input [in] The input array containing the data to be added.
+ * \param inplen [in] The length (in bytes) of the input data.
+ * \param tag [in] The slot tag.
+ * \return Returns false if the queue is full.
  */
-HKDS_EXPORT_API void hkds_message_queue_push(hkds_message_queue_state* ctx, const uint8_t* inpput, size_t inplen);
+HKDS_EXPORT_API bool hkds_message_queue_push_tagged(hkds_message_queue_state* ctx, const uint8_t* input, size_t inplen, uint64_t tag);
+
+/**
+ * \brief Reads the slot tag of the oldest item in the queue.
+ *
+ * \details
+ * The item is not removed. The function must only be called by the queue's single consumer, since another consumer
+ * could remove the item and a producer reuse its slot while the tag is read.
+ *
+ * \param ctx [in] The message queue state context.
+ * \param tag [out] Receives the slot tag.
+ * \return Returns false if the queue is empty.
+ */
+HKDS_EXPORT_API bool hkds_message_queue_peek_tag(const hkds_message_queue_state* ctx, uint64_t* tag);
 
 /**
  * \brief Checks if the queue is full.
@@ -221,6 +338,7 @@ HKDS_EXPORT_API size_t hkds_message_queue_count(const hkds_message_queue_state*
  * \details
  * This function extracts a block of 8 messages from the queue and stores them in a 2D array.
  * The output array should have dimensions [HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE].
+ * The block is claimed in one step, and nothing is extracted if fewer than 8 messages are queued.
  *
  * \param ctx [in,out] The message queue state context.
  * \param output [out] A 2-dimensional array that will receive the exported messages.
@@ -234,6 +352,7 @@ HKDS_EXPORT_API size_t hkds_message_queue_extract_block_x8(hkds_message_queue_st
  * \details
  * This function extracts messages from the queue and arranges them in a 3D array with dimensions
  * [HKDS_PARALLEL_DEPTH][HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE].
+ * The block is claimed in one step, and nothing is extracted if fewer than 64 messages are queued.
  *
  * \param ctx [in,out] The message queue state context.
  * \param output [out] A 3-dimensional array that will receive the exported messages.
@@ -246,6 +365,7 @@ HKDS_EXPORT_API size_t hkds_message_queue_extract_block_x64(hkds_message_queue_s
  *
  * \details
  * This function extracts a specified number of messages from the queue and serializes them into a linear byte array.
+ * The messages are claimed in one step, and nothing is extracted if fewer than the specified number are queued.
  *
  * \param ctx [in,out] The message queue state context.
  * \param stream [out] The array that will receive the serialized messages.
@@ -254,4 +374,74 @@ HKDS_EXPORT_API size_t hkds_message_queue_extract_block_x64(hkds_message_queue_s
  */
 HKDS_EXPORT_API size_t hkds_message_queue_extract_stream(hkds_message_queue_state* ctx, uint8_t* stream, size_t items);
 
+/* zero-copy views */
+
+/**
+ * \brief Reserves a range of empty slots for writing in place.
+ *
+ * \details
+ * This function claims the next set of free slots and returns a view of them, so the producer can write the items
+ * directly into the queue memory. The items become visible to consumers when the view is committed; in multiple
+ * producer mode, consumers of later items wait until then, so a reservation should be committed promptly.
+ *
+ * \param ctx [in,out] The message queue state context.
+ * \param view [out] The view that receives the reserved slots.
+ * \param items [in] The number of slots to reserve.
+ * \return Returns false if fewer than the requested number of slots are free.
+ */
+HKDS_EXPORT_API bool hkds_message_queue_reserve(hkds_message_queue_state* ctx, hkds_queue_view* view, size_t items);
+
+/**
+ * \brief Publishes the items written to a reserved view.
+ *
+ * \param ctx [in,out] The message queue state context.
+ * \param view [in,out] The reserved view; it is cleared on return.
+ */
+HKDS_EXPORT_API void hkds_message_queue_commit(hkds_message_queue_state* ctx, hkds_queue_view* view);
+
+/**
+ * \brief Claims a range of queued items for reading in place.
+ *
+ * \details
+ * This function claims the next set of items in one step and returns a view of their slots, so they can be passed
+ * to the server batch functions without being copied out of the queue. The slots are not reused until the view is
+ * released. In single consumer mode, only one view may be held at a time.
+ *
+ * \param ctx [in,out] The message queue state context.
+ * \param view [out] The view that receives the claimed items.
+ * \param items [in] The number of items to claim.
+ * \return Returns false if fewer than the requested number of items are queued.
+ */
+HKDS_EXPORT_API bool hkds_message_queue_acquire(hkds_message_queue_state* ctx, hkds_queue_view* view, size_t items);
+
+/**
+ * \brief Erases the items of a claimed view and returns the slots to the queue.
+ *
+ * \param ctx [in,out] The message queue state context.
+ * \param view [in,out] The claimed view; it is cleared on return.
+ */
+HKDS_EXPORT_API void hkds_message_queue_release(hkds_message_queue_state* ctx, hkds_queue_view* view);
+
+/**
+ * \brief Returns the address of an item in a view.
+ *
+ * \param view [in] The queue view.
+ * \param index [in] The index of the item within the view.
+ * \return A pointer to the item slot, or NULL if the index is out of range.
+ */
+HKDS_EXPORT_API uint8_t* hkds_message_queue_view_item(const hkds_queue_view* view, size_t index);
+
+/**
+ * \brief Fills an array of pointers to a field of every item in a view.
+ *
+ * \details
+ * The pointer array has the form taken by the server batch functions; for example, a queue of client message
+ * requests yields the KSN pointers at one offset, and the ciphertext pointers at another.
+ *
+ * \param view [in] The queue view.
+ * \param offset [in] The byte offset of the field within an item.
+ * \param output [out] The array of pointers; it must hold the view item count.
+ */
+HKDS_EXPORT_API void hkds_message_queue_view_pointers(const hkds_queue_view* view, size_t offset, const uint8_t** output);
+
 #endif
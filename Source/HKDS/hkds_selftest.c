@@ -532,7 +532,7 @@ static bool kmac_512_kat(void)
 	return status;
 }
 
-#if defined(HKDS_SYSTEM_HAS_AVX2)
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
 static bool kmac128x4_equality(void)
 {
 	uint8_t cst[4U][16U] = { 0U };
@@ -936,7 +936,7 @@ static bool shake512x4_equality(void)
 }
 #endif
 
-#if defined(HKDS_SYSTEM_HAS_AVX512)
+#if defined(HKDS_KECCAK_AVX512_KERNELS)
 static bool kmac128x8_equality(void)
 {
 	uint8_t cst[8U][16U] = { 0U };
@@ -1066,7 +1066,7 @@ static bool kmac256x8_equality(void)
 {
 	uint8_t cst[8U][32U] = { 0U };
 	uint8_t key[8U][34U] = { 0U };
-	uint8_t msg[8U][25U6] = { 0U };
+	uint8_t msg[8U][256U] = { 0U };
 	uint8_t otp[8U][32U] = { 0U };
 	uint8_t exp[8U][32U] = { 0U };
 	size_t i;
@@ -1648,7 +1648,7 @@ static bool hkds_selftest_sha3_test(void)
 	}
 
 
-#if defined(HKDS_SYSTEM_HAS_AVX2)
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
 
 	if (kmac128x4_equality() == false)
 	{
@@ -1677,7 +1677,7 @@ static bool hkds_selftest_sha3_test(void)
 
 #endif
 
-#if defined(HKDS_SYSTEM_HAS_AVX512)
+#if defined(HKDS_KECCAK_AVX512_KERNELS)
 
 	if (kmac128x8_equality() == false)
 	{
@@ -5,6 +5,12 @@
 #	include <omp.h>
 #endif
 
+/*!
+ * \def HKDS_SERVER_KEYSTREAM_SIZE
+ * \brief The largest epoch key-stream the x8 derivations squeeze; the last key of an epoch with its MAC key.
+ */
+#define HKDS_SERVER_KEYSTREAM_SIZE ((HKDS_CACHE_SIZE + 1U) * HKDS_MESSAGE_SIZE)
+
 static void hkds_server_generate_token(const uint8_t* stk, const uint8_t* ctok, uint8_t* token)
 {
 	uint8_t tkey[HKDS_CTOK_SIZE + HKDS_STK_SIZE] = { 0U };
@@ -44,36 +50,124 @@ static void hkds_server_get_tms(const uint8_t* ksn, uint8_t* tms)
 	utils_memory_copy((tms + HKDS_KSN_SIZE), hkds_mac_name, HKDS_NAME_SIZE);
 }
 
-static void hkds_server_generate_transaction_key(hkds_server_state* state, uint8_t* tkey, size_t tkeylen)
+static void hkds_server_get_edk(hkds_server_state* state, uint8_t* edk)
+{
+	const uint8_t* tedk;
+
+	tedk = NULL;
+
+	/* the table is only valid for the master key set it was derived from */
+	if (state->edktable != NULL && utils_memory_are_equal(state->edktable->kid, state->mdk->kid, HKDS_KID_SIZE) == true)
+	{
+		tedk = hkds_edk_table_find(state->edktable, state->ksn);
+
+		if (tedk == NULL)
+		{
+			/* derive the key of an unknown device and add it to the table */
+			hkds_server_generate_edk(state->mdk->bdk, state->ksn, edk);
+			hkds_edk_table_insert(state->edktable, state->ksn, edk);
+		}
+		else
+		{
+			utils_memory_copy(edk, tedk, HKDS_EDK_SIZE);
+		}
+	}
+	else
+	{
+		hkds_server_generate_edk(state->mdk->bdk, state->ksn, edk);
+	}
+}
+
+static bool hkds_server_token_memo_valid(const hkds_token_memo* memo, const hkds_master_key* mdk)
+{
+	/* the memo is only valid for the master key set it was derived from */
+	return (memo != NULL && utils_memory_are_equal(memo->kid, mdk->kid, HKDS_KID_SIZE) == true);
+}
+
+static void hkds_server_get_token(hkds_server_state* state, const uint8_t* ctok, uint8_t* token)
+{
+	uint32_t epoch;
+
+	if (hkds_server_token_memo_valid(state->tokenmemo, state->mdk) == true)
+	{
+		epoch = utils_integer_be8to32(((uint8_t*)state->ksn + HKDS_DID_SIZE)) / HKDS_CACHE_SIZE;
+
+		if (hkds_token_memo_find(state->tokenmemo, state->ksn, epoch, token) == false)
+		{
+			hkds_server_generate_token(state->mdk->stk, ctok, token);
+			hkds_token_memo_insert(state->tokenmemo, state->ksn, epoch, token);
+		}
+	}
+	else
+	{
+		hkds_server_generate_token(state->mdk->stk, ctok, token);
+	}
+}
+
+static void hkds_server_generate_prf_key(hkds_server_state* state, uint8_t* tmpk)
 {
 	uint8_t ctok[HKDS_CTOK_SIZE] = { 0U };
-	uint8_t did[HKDS_DID_SIZE] = { 0U };
 	uint8_t edk[HKDS_EDK_SIZE] = { 0U };
-	uint8_t skey[((((HKDS_CACHE_SIZE + 1U) * HKDS_MESSAGE_SIZE) + HKDS_PRF_RATE - 1U) / HKDS_PRF_RATE) * HKDS_PRF_RATE] = { 0U };
 	uint8_t tok[HKDS_STK_SIZE] = { 0U };
-	uint8_t tmpk[HKDS_STK_SIZE + HKDS_EDK_SIZE] = { 0U };
-	size_t nblocks;
-	uint32_t index;
-
-	/* get the key counter mod the cache size from the ksn */
-	index = utils_integer_be8to32(((uint8_t*)state->ksn + HKDS_DID_SIZE)) % HKDS_CACHE_SIZE;
-
-	/* copy the device id from the ksn */
-	utils_memory_copy(did, state->ksn, HKDS_DID_SIZE);
 
-	/* generate the device key */
-	hkds_server_generate_edk(state->mdk->bdk, did, edk);
+	/* get the device key */
+	hkds_server_get_edk(state, edk);
 
 	/* generate the custom token string */
 	hkds_server_get_ctok(state, ctok);
 
-	/* generate the device token from the base token and customization string */
-	hkds_server_generate_token(state->mdk->stk, ctok, tok);
+	/* get the device token from the memo, or generate it from the base token and customization string */
+	hkds_server_get_token(state, ctok, tok);
 
 	/* copy token and edk to PRF key */
 	utils_memory_copy(tmpk, tok, HKDS_STK_SIZE);
 	utils_memory_copy(((uint8_t*)tmpk + HKDS_STK_SIZE), edk, HKDS_EDK_SIZE);
 
+	utils_memory_secure_erase(edk, sizeof(edk));
+	utils_memory_secure_erase(tok, sizeof(tok));
+}
+
+static bool hkds_server_cached_transaction_key(hkds_server_state* state, uint8_t* tkey, size_t tkeylen)
+{
+	uint8_t tmpk[HKDS_STK_SIZE + HKDS_EDK_SIZE] = { 0U };
+	hkds_keystream_entry* entry;
+	uint32_t counter;
+	bool res;
+
+	res = false;
+	counter = utils_integer_be8to32(((uint8_t*)state->ksn + HKDS_DID_SIZE));
+
+	/* look up the epoch key-stream, and derive and insert it on a miss */
+	entry = hkds_keystream_cache_find(state->kcache, state->ksn, counter / HKDS_CACHE_SIZE);
+
+	if (entry == NULL)
+	{
+		hkds_server_generate_prf_key(state, tmpk);
+		entry = hkds_keystream_cache_insert(state->kcache, state->ksn, counter / HKDS_CACHE_SIZE, tmpk, sizeof(tmpk));
+		utils_memory_secure_erase(tmpk, sizeof(tmpk));
+	}
+
+	if (entry != NULL)
+	{
+		res = hkds_keystream_cache_extract(entry, (size_t)(counter % HKDS_CACHE_SIZE) * HKDS_MESSAGE_SIZE, tkey, tkeylen);
+	}
+
+	return res;
+}
+
+static void hkds_server_derive_transaction_key(hkds_server_state* state, uint8_t* tkey, size_t tkeylen)
+{
+	uint8_t skey[((((HKDS_CACHE_SIZE + 1U) * HKDS_MESSAGE_SIZE) + HKDS_PRF_RATE - 1U) / HKDS_PRF_RATE) * HKDS_PRF_RATE] = { 0U };
+	uint8_t tmpk[HKDS_STK_SIZE + HKDS_EDK_SIZE] = { 0U };
+	size_t nblocks;
+	uint32_t index;
+
+	/* get the key counter mod the cache size from the ksn */
+	index = utils_integer_be8to32(((uint8_t*)state->ksn + HKDS_DID_SIZE)) % HKDS_CACHE_SIZE;
+
+	/* derive the token and device key PRF key */
+	hkds_server_generate_prf_key(state, tmpk);
+
 	hkds_keccak_state ks;
 	utils_memory_clear((uint8_t*)ks.state, HKDS_KECCAK_STATE_SIZE * sizeof(uint64_t));
 
@@ -99,6 +193,24 @@ static void hkds_server_generate_transaction_key(hkds_server_state* state, uint8
 	utils_memory_copy(tkey, ((uint8_t*)skey + ((size_t)index * HKDS_MESSAGE_SIZE)), tkeylen);
 }
 
+static void hkds_server_generate_transaction_key(hkds_server_state* state, uint8_t* tkey, size_t tkeylen)
+{
+	bool res;
+
+	res = false;
+
+	/* serve the key from the epoch key-stream cache if one is attached for this master key set */
+	if (state->kcache != NULL && utils_memory_are_equal(state->kcache->kid, state->mdk->kid, HKDS_KID_SIZE) == true)
+	{
+		res = hkds_server_cached_transaction_key(state, tkey, tkeylen);
+	}
+
+	if (res == false)
+	{
+		hkds_server_derive_transaction_key(state, tkey, tkeylen);
+	}
+}
+
 void hkds_server_decrypt_message(hkds_server_state* state, const uint8_t* ciphertext, uint8_t* plaintext)
 {
 	HKDS_ASSERT(state != NULL);
@@ -189,7 +301,6 @@ void hkds_server_encrypt_token(hkds_server_state* state, uint8_t* etok)
 	HKDS_ASSERT(etok != NULL);
 	
 	uint8_t ctok[HKDS_CTOK_SIZE] = { 0U };
-	uint8_t did[HKDS_DID_SIZE] = { 0U };
 	uint8_t edk[HKDS_EDK_SIZE] = { 0U };
 	uint8_t tms[HKDS_TMS_SIZE] = { 0U };
 	uint8_t tmpk[HKDS_CTOK_SIZE + HKDS_EDK_SIZE] = { 0U };
@@ -197,11 +308,8 @@ void hkds_server_encrypt_token(hkds_server_state* state, uint8_t* etok)
 
 	if (state != NULL && etok != NULL)
 	{
-		/* copy the device id from the ksn */
-		utils_memory_copy(did, state->ksn, HKDS_DID_SIZE);
-
-		/* generate the embedded device key */
-		hkds_server_generate_edk(state->mdk->bdk, did, edk);
+		/* get the embedded device key */
+		hkds_server_get_edk(state, edk);
 
 		/* generate the custom token string */
 		hkds_server_get_ctok(state, ctok);
@@ -209,6 +317,12 @@ void hkds_server_encrypt_token(hkds_server_state* state, uint8_t* etok)
 		/* generate the device token from the base token and customization string */
 		hkds_server_generate_token(state->mdk->stk, ctok, tok);
 
+		/* memoize the issued token for the message decryptions of this epoch */
+		if (hkds_server_token_memo_valid(state->tokenmemo, state->mdk) == true)
+		{
+			hkds_token_memo_insert(state->tokenmemo, state->ksn, utils_integer_be8to32(ctok), tok);
+		}
+
 		/* copy ctok and edk to PRF key */
 		utils_memory_copy(tmpk, ctok, HKDS_CTOK_SIZE);
 		utils_memory_copy(((uint8_t*)tmpk + HKDS_CTOK_SIZE), edk, HKDS_EDK_SIZE);
@@ -276,6 +390,39 @@ void hkds_server_initialize_state(hkds_server_state* state, hkds_master_key* mdk
 		state->mdk = mdk;
 		state->count = utils_integer_be8to32(ksn + HKDS_DID_SIZE);
 		state->rate = HKDS_PRF_RATE;
+		state->kcache = NULL;
+		state->edktable = NULL;
+		state->tokenmemo = NULL;
+	}
+}
+
+void hkds_server_set_token_memo(hkds_server_state* state, hkds_token_memo* tokenmemo)
+{
+	HKDS_ASSERT(state != NULL);
+
+	if (state != NULL)
+	{
+		state->tokenmemo = tokenmemo;
+	}
+}
+
+void hkds_server_set_edk_table(hkds_server_state* state, hkds_edk_table* edktable)
+{
+	HKDS_ASSERT(state != NULL);
+
+	if (state != NULL)
+	{
+		state->edktable = edktable;
+	}
+}
+
+void hkds_server_set_keystream_cache(hkds_server_state* state, hkds_keystream_cache* kcache)
+{
+	HKDS_ASSERT(state != NULL);
+
+	if (state != NULL)
+	{
+		state->kcache = kcache;
 	}
 }
 
@@ -303,14 +450,14 @@ static void hkds_server_generate_token_x8(const hkds_server_x8_state* state, uin
 #endif
 }
 
-static void hkds_server_get_ctok_x8(hkds_server_x8_state* state, uint8_t ctok[HKDS_CACHX8_DEPTH][HKDS_CTOK_SIZE])
+static void hkds_server_get_ctok_x8(const hkds_server_x8_state* state, uint8_t ctok[HKDS_CACHX8_DEPTH][HKDS_CTOK_SIZE])
 {
 	uint32_t tkc[HKDS_CACHX8_DEPTH] = { 0U };
 
 	/* add the token counter to customization string (ksn-counter / key-store size) */
 	for (size_t i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
 	{
-		tkc[i] = utils_integer_be8to32(((uint8_t*)state->ksn[i] + HKDS_DID_SIZE)) / HKDS_CACHE_SIZE;
+		tkc[i] = utils_integer_be8to32(((const uint8_t*)state->ksn[i] + HKDS_DID_SIZE)) / HKDS_CACHE_SIZE;
 		utils_integer_be32to8(ctok[i], tkc[i]);
 		/* add the mode hkds_formal_name to customization string */
 		utils_memory_copy(((uint8_t*)ctok[i] + HKDS_TKC_SIZE), hkds_formal_name, HKDS_NAME_SIZE);
@@ -319,276 +466,476 @@ static void hkds_server_get_ctok_x8(hkds_server_x8_state* state, uint8_t ctok[HK
 	}
 }
 
-static void hkds_server_generate_transaction_key_x8(hkds_server_x8_state* state, uint8_t tkey[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE])
+/* the derivation caches are not synchronized; their lookups and inserts are made on the calling thread,
+   while the derivations of the lanes they miss may run on any thread */
+
+typedef struct
 {
-	uint8_t ctok[HKDS_CACHX8_DEPTH][HKDS_CTOK_SIZE] = { 0U };
-	uint8_t did[HKDS_CACHX8_DEPTH][HKDS_DID_SIZE] = { 0U };
-	uint8_t edk[HKDS_CACHX8_DEPTH][HKDS_EDK_SIZE] = { 0U };
-	uint8_t skey[HKDS_CACHX8_DEPTH][HKDS_CACHE_SIZE * HKDS_MESSAGE_SIZE] = { 0U };
-	uint8_t tok[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE] = { 0U };
-	uint8_t tmpk[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE + HKDS_EDK_SIZE] = { 0U };
-	uint32_t index[HKDS_CACHX8_DEPTH] = { 0U };
-	size_t i;
+	uint8_t edk[HKDS_CACHX8_DEPTH][HKDS_EDK_SIZE];
+	uint8_t tok[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE];
+	bool edkfound[HKDS_CACHX8_DEPTH];
+	bool tokfound[HKDS_CACHX8_DEPTH];
+} hkds_server_x8_keys;
 
-	for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
-	{
-		/* get the key counter mod the cache size from the ksn */
-		index[i] = utils_integer_be8to32(((uint8_t*)state->ksn[i] + HKDS_DID_SIZE)) % HKDS_CACHE_SIZE;
-		/* copy the device id from the ksn */
-		utils_memory_copy(did[i], state->ksn[i], HKDS_DID_SIZE);
-	}
+static bool hkds_server_edk_table_valid(const hkds_edk_table* table, const hkds_master_key* mdk)
+{
+	return (table != NULL && utils_memory_are_equal(table->kid, mdk->kid, HKDS_KID_SIZE) == true);
+}
 
-	/* generate the device key */
-	hkds_server_generate_edk_x8(state, did, edk);
+static bool hkds_server_keys_attached_x8(const hkds_server_x8_state* state)
+{
+	return (hkds_server_edk_table_valid(state->edktable, state->mdk) == true ||
+		hkds_server_token_memo_valid(state->tokenmemo, state->mdk) == true);
+}
 
-	/* generate the custom token string */
-	hkds_server_get_ctok_x8(state, ctok);
+static void hkds_server_keys_find_x8(const hkds_server_x8_state* state, hkds_server_x8_keys* keys, bool tokens)
+{
+	const uint8_t* tedk;
+	bool memo;
+	bool table;
 
-	/* generate the device token from the base token and customization string */
-	hkds_server_generate_token_x8(state, ctok, tok);
+	table = hkds_server_edk_table_valid(state->edktable, state->mdk);
+	memo = (tokens == true && hkds_server_token_memo_valid(state->tokenmemo, state->mdk) == true);
 
-	for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+	for (size_t i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
 	{
-		/* copy token and edk to PRF key */
-		utils_memory_copy(tmpk[i], tok[i], HKDS_STK_SIZE);
-		utils_memory_copy(((uint8_t*)tmpk[i] + HKDS_STK_SIZE), edk[i], HKDS_EDK_SIZE);
-	}
+		keys->edkfound[i] = false;
+		keys->tokfound[i] = false;
 
-	/* generate the minimum number of blocks, and return the transaction key */
-#if defined(HKDS_SHAKE_128)
-	hkds_shake_128x8(skey[0U], skey[1U], skey[2U], skey[3U], skey[4U], skey[5U], skey[6U], skey[7U], sizeof(skey[0U]),
-		tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_STK_SIZE + HKDS_EDK_SIZE);
-#elif defined(HKDS_SHAKE_256)
-	hkds_shake_256x8(skey[0U], skey[1U], skey[2U], skey[3U], skey[4U], skey[5U], skey[6U], skey[7U], sizeof(skey[0U]),
-		tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_STK_SIZE + HKDS_EDK_SIZE);
-#else
-	hkds_shake_512x8(skey[0U], skey[1U], skey[2U], skey[3U], skey[4U], skey[5U], skey[6U], skey[7U], sizeof(skey[0U]),
-		tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_STK_SIZE + HKDS_EDK_SIZE);
-#endif
+		if (table == true)
+		{
+			tedk = hkds_edk_table_find(state->edktable, state->ksn[i]);
 
-	for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
-	{
-		utils_memory_copy((uint8_t*)tkey[i], ((uint8_t*)skey[i] + ((size_t)index[i] * HKDS_MESSAGE_SIZE)), HKDS_MESSAGE_SIZE);
+			if (tedk != NULL)
+			{
+				utils_memory_copy(keys->edk[i], tedk, HKDS_EDK_SIZE);
+				keys->edkfound[i] = true;
+			}
+		}
+
+		if (memo == true)
+		{
+			keys->tokfound[i] = hkds_token_memo_find(state->tokenmemo, state->ksn[i],
+				utils_integer_be8to32(((const uint8_t*)state->ksn[i] + HKDS_DID_SIZE)) / HKDS_CACHE_SIZE, keys->tok[i]);
+		}
 	}
 }
 
-static void hkds_server_generate_transaction_authkey_x8(hkds_server_x8_state* state, uint8_t tkey[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE + HKDS_TAG_SIZE])
+static void hkds_server_keys_derive_x8(const hkds_server_x8_state* state, hkds_server_x8_keys* keys)
 {
 	uint8_t ctok[HKDS_CACHX8_DEPTH][HKDS_CTOK_SIZE] = { 0U };
 	uint8_t did[HKDS_CACHX8_DEPTH][HKDS_DID_SIZE] = { 0U };
-	uint8_t edk[HKDS_CACHX8_DEPTH][HKDS_EDK_SIZE] = { 0U };
-	uint8_t skey[HKDS_CACHX8_DEPTH][(HKDS_CACHE_SIZE + 1U) * HKDS_MESSAGE_SIZE];
-	//uint8_t skey[HKDS_CACHX8_DEPTH][HKDS_CACHE_SIZE * HKDS_MESSAGE_SIZE] = { 0U };
-	uint8_t tok[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE] = { 0U };
-	uint8_t tmpk[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE + HKDS_EDK_SIZE] = { 0U };
-	uint32_t index[HKDS_CACHX8_DEPTH] = { 0U };
+	uint8_t tedk[HKDS_CACHX8_DEPTH][HKDS_EDK_SIZE] = { 0U };
+	uint8_t ttok[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE] = { 0U };
+	bool edkall;
+	bool tokall;
 	size_t i;
 
+	edkall = true;
+	tokall = true;
+
 	for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
 	{
-		/* get the key counter mod the cache size from the ksn */
-		index[i] = utils_integer_be8to32(((uint8_t*)state->ksn [i]+ HKDS_DID_SIZE)) % HKDS_CACHE_SIZE;
-		/* copy the device id from the ksn */
-		utils_memory_copy(did[i], state->ksn[i], HKDS_DID_SIZE);
+		edkall = (edkall == true && keys->edkfound[i] == true);
+		tokall = (tokall == true && keys->tokfound[i] == true);
 	}
 
-	/* generate the device key */
-	hkds_server_generate_edk_x8(state, did, edk);
+	if (edkall == false)
+	{
+		for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			/* copy the device id from the ksn */
+			utils_memory_copy(did[i], state->ksn[i], HKDS_DID_SIZE);
+		}
 
-	/* generate the custom token string */
-	hkds_server_get_ctok_x8(state, ctok);
+		/* at least one lane is unknown; derive the full set with the x8 kernel */
+		hkds_server_generate_edk_x8(state, did, tedk);
 
-	/* generate the device token from the base token and customization string */
-	hkds_server_generate_token_x8(state, ctok, tok);
+		for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			if (keys->edkfound[i] == false)
+			{
+				utils_memory_copy(keys->edk[i], tedk[i], HKDS_EDK_SIZE);
+			}
+		}
 
-	for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
-	{
-		/* copy token and edk to PRF key */
-		utils_memory_copy(tmpk[i], tok[i], HKDS_STK_SIZE);
-		utils_memory_copy(((uint8_t*)tmpk[i] + HKDS_STK_SIZE), edk[i], HKDS_EDK_SIZE);
+		utils_memory_secure_erase(tedk, sizeof(tedk));
 	}
 
-	/* generate the minimum number of blocks, and return the transaction key */
-#if defined(HKDS_SHAKE_128)
-	hkds_shake_128x8(skey[0U], skey[1U], skey[2U], skey[3U], skey[4U], skey[5U], skey[6U], skey[7U], sizeof(skey[0U]),
-		tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_STK_SIZE + HKDS_EDK_SIZE);
-#elif defined(HKDS_SHAKE_256)
-	hkds_shake_256x8(skey[0U], skey[1U], skey[2U], skey[3U], skey[4U], skey[5U], skey[6U], skey[7U], sizeof(skey[0U]),
-		tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_STK_SIZE + HKDS_EDK_SIZE);
-#else
-	hkds_shake_512x8(skey[0U], skey[1U], skey[2U], skey[3U], skey[4U], skey[5U], skey[6U], skey[7U], sizeof(skey[0U]),
-		tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_STK_SIZE + HKDS_EDK_SIZE);
-#endif
-
-	for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	if (tokall == false)
 	{
-		utils_memory_copy((uint8_t*)tkey[i], ((uint8_t*)skey[i] + ((size_t)index[i] * HKDS_MESSAGE_SIZE)), 2 * HKDS_MESSAGE_SIZE);
+		/* at least one lane is not memoized; derive the full set from the base token and customization strings */
+		hkds_server_get_ctok_x8(state, ctok);
+		hkds_server_generate_token_x8(state, ctok, ttok);
+
+		for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			if (keys->tokfound[i] == false)
+			{
+				utils_memory_copy(keys->tok[i], ttok[i], HKDS_STK_SIZE);
+			}
+		}
+
+		utils_memory_secure_erase(ttok, sizeof(ttok));
 	}
 }
 
-void hkds_server_decrypt_message_x8(hkds_server_x8_state* state, const uint8_t ciphertext[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE], uint8_t plaintext[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE])
+static void hkds_server_keys_insert_x8(const hkds_server_x8_state* state, const hkds_server_x8_keys* keys, size_t lanes)
 {
-	HKDS_ASSERT(state != NULL);
-	HKDS_ASSERT(ciphertext != NULL);
-	HKDS_ASSERT(plaintext != NULL);
+	bool memo;
+	bool table;
 
-	if (state != NULL && ciphertext != NULL && plaintext != NULL)
+	table = hkds_server_edk_table_valid(state->edktable, state->mdk);
+	memo = hkds_server_token_memo_valid(state->tokenmemo, state->mdk);
+
+	/* store the keys the derivation pass produced */
+	for (size_t i = 0U; i < lanes; ++i)
 	{
-		/* copy the key directly into the empty plaintext array */
-		hkds_server_generate_transaction_key_x8(state, plaintext);
+		if (table == true && keys->edkfound[i] == false)
+		{
+			hkds_edk_table_insert(state->edktable, state->ksn[i], keys->edk[i]);
+		}
 
-		/* XOR the key-stream and and cipher-text */
-		for (size_t i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+		if (memo == true && keys->tokfound[i] == false)
 		{
-			utils_memory_xor(plaintext[i], ciphertext[i], HKDS_MESSAGE_SIZE);
+			hkds_token_memo_insert(state->tokenmemo, state->ksn[i],
+				utils_integer_be8to32(((const uint8_t*)state->ksn[i] + HKDS_DID_SIZE)) / HKDS_CACHE_SIZE, keys->tok[i]);
 		}
 	}
 }
 
-void hkds_server_encrypt_token_x8(hkds_server_x8_state* state, uint8_t etok[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE + HKDS_TAG_SIZE])
+static void hkds_server_generate_keystream_x8(const hkds_server_x8_state* state, hkds_server_x8_keys* keys, uint8_t skey[HKDS_CACHX8_DEPTH][HKDS_SERVER_KEYSTREAM_SIZE], size_t slen)
 {
-	HKDS_ASSERT(state != NULL);
-	HKDS_ASSERT(etok != NULL);
-	
-	uint8_t ctok[HKDS_CACHX8_DEPTH][HKDS_CTOK_SIZE] = { 0U };
-	uint8_t did[HKDS_CACHX8_DEPTH][HKDS_DID_SIZE] = { 0U };
-	uint8_t edk[HKDS_CACHX8_DEPTH][HKDS_EDK_SIZE] = { 0U };
-	uint8_t tms[HKDS_TMS_SIZE] = { 0U };
-	uint8_t tmpk[HKDS_CACHX8_DEPTH][HKDS_CTOK_SIZE + HKDS_EDK_SIZE] = { 0U };
-	uint8_t tok[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE] = { 0U };
+	uint8_t tmpk[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE + HKDS_EDK_SIZE] = { 0U };
 	size_t i;
 
-	if (state != NULL && etok != NULL)
+	if (keys == NULL)
 	{
-		/* copy the device id from the ksn */
-		for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
-		{
-			utils_memory_copy(did[i], state->ksn[i], HKDS_DID_SIZE);
-		}
-
-		/* generate the embedded device key */
-		hkds_server_generate_edk_x8(state, did, edk);
+		uint8_t ctok[HKDS_CACHX8_DEPTH][HKDS_CTOK_SIZE] = { 0U };
+		uint8_t dkey[HKDS_CACHX8_DEPTH][HKDS_DID_SIZE + HKDS_BDK_SIZE] = { 0U };
+		uint8_t tkey[HKDS_CACHX8_DEPTH][HKDS_CTOK_SIZE + HKDS_STK_SIZE] = { 0U };
+		const uint8_t* pdkey[HKDS_CACHX8_DEPTH];
+		const uint8_t* ptkey[HKDS_CACHX8_DEPTH];
+		uint8_t* pskey[HKDS_CACHX8_DEPTH];
 
 		/* generate the custom token string */
 		hkds_server_get_ctok_x8(state, ctok);
 
-		/* generate the device token from the base token and customization string */
-		hkds_server_generate_token_x8(state, ctok, tok);
-
-		/* copy ctok and edk to PRF key */
 		for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
 		{
-			utils_memory_copy(tmpk[i], ctok[i], HKDS_CTOK_SIZE);
-			utils_memory_copy(((uint8_t*)tmpk[i] + HKDS_CTOK_SIZE), edk[i], HKDS_EDK_SIZE);
+			utils_memory_copy(dkey[i], state->ksn[i], HKDS_DID_SIZE);
+			utils_memory_copy(((uint8_t*)dkey[i] + HKDS_DID_SIZE), state->mdk->bdk, HKDS_BDK_SIZE);
+			utils_memory_copy(tkey[i], ctok[i], HKDS_CTOK_SIZE);
+			utils_memory_copy(((uint8_t*)tkey[i] + HKDS_CTOK_SIZE), state->mdk->stk, HKDS_STK_SIZE);
+			pdkey[i] = dkey[i];
+			ptkey[i] = tkey[i];
+			pskey[i] = skey[i];
 		}
 
-		/* initialize shake with the ctok and edk, and generate the encryption key */
+		/* without cached keys, no lane needs its edk or token as bytes; derive the tokens and device keys,
+		   and squeeze the key-streams, without leaving the lane registers */
 #if defined(HKDS_SHAKE_128)
-		hkds_shake_128x8(etok[0U], etok[1U], etok[2U], etok[3U], etok[4U], etok[5U], etok[6U], etok[7U], HKDS_STK_SIZE,
-			tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_CTOK_SIZE + HKDS_EDK_SIZE);
+		hkds_shake_chain_x8(hkds_keccak_rate_128, pskey, slen, ptkey, sizeof(tkey[0U]), HKDS_STK_SIZE, pdkey, sizeof(dkey[0U]), HKDS_EDK_SIZE);
 #elif defined(HKDS_SHAKE_256)
-		hkds_shake_256x8(etok[0U], etok[1U], etok[2U], etok[3U], etok[4U], etok[5U], etok[6U], etok[7U], HKDS_STK_SIZE,
-			tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_CTOK_SIZE + HKDS_EDK_SIZE);
+		hkds_shake_chain_x8(hkds_keccak_rate_256, pskey, slen, ptkey, sizeof(tkey[0U]), HKDS_STK_SIZE, pdkey, sizeof(dkey[0U]), HKDS_EDK_SIZE);
 #else
-		hkds_shake_512x8(etok[0U], etok[1U], etok[2U], etok[3U], etok[4U], etok[5U], etok[6U], etok[7U], HKDS_STK_SIZE,
-			tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_CTOK_SIZE + HKDS_EDK_SIZE);
+		hkds_shake_chain_x8(hkds_keccak_rate_512, pskey, slen, ptkey, sizeof(tkey[0U]), HKDS_STK_SIZE, pdkey, sizeof(dkey[0U]), HKDS_EDK_SIZE);
 #endif
 
-		/* encrypt the token set */
-		for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
-		{
-			utils_memory_xor(etok[i], tok[i], HKDS_STK_SIZE);
-		}
+		utils_memory_secure_erase(tkey, sizeof(tkey));
+		utils_memory_secure_erase(dkey, sizeof(dkey));
+	}
+	else
+	{
+		/* derive the device keys and tokens the caches did not hold */
+		hkds_server_keys_derive_x8(state, keys);
 
 		for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
 		{
-			hkds_server_get_tms(state->ksn[i], tms);
+			/* copy token and edk to PRF key */
+			utils_memory_copy(tmpk[i], keys->tok[i], HKDS_STK_SIZE);
+			utils_memory_copy(((uint8_t*)tmpk[i] + HKDS_STK_SIZE), keys->edk[i], HKDS_EDK_SIZE);
+		}
 
+		/* generate the epoch key-streams up to the requested length */
 #if defined(HKDS_SHAKE_128)
-			hkds_kmac128_compute(etok[i] + HKDS_STK_SIZE, HKDS_TAG_SIZE, etok[i], HKDS_STK_SIZE, edk[i], HKDS_EDK_SIZE, tms, HKDS_TMS_SIZE);
+		hkds_shake_128x8(skey[0U], skey[1U], skey[2U], skey[3U], skey[4U], skey[5U], skey[6U], skey[7U], slen,
+			tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_STK_SIZE + HKDS_EDK_SIZE);
 #elif defined(HKDS_SHAKE_256)
-			hkds_kmac256_compute(etok[i] + HKDS_STK_SIZE, HKDS_TAG_SIZE, etok[i], HKDS_STK_SIZE, edk[i], HKDS_EDK_SIZE, tms, HKDS_TMS_SIZE);
+		hkds_shake_256x8(skey[0U], skey[1U], skey[2U], skey[3U], skey[4U], skey[5U], skey[6U], skey[7U], slen,
+			tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_STK_SIZE + HKDS_EDK_SIZE);
 #else
-			hkds_kmac512_compute(etok[i] + HKDS_STK_SIZE, HKDS_TAG_SIZE, etok[i], HKDS_STK_SIZE, edk[i], HKDS_EDK_SIZE, tms, HKDS_TMS_SIZE);
+		hkds_shake_512x8(skey[0U], skey[1U], skey[2U], skey[3U], skey[4U], skey[5U], skey[6U], skey[7U], slen,
+			tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_STK_SIZE + HKDS_EDK_SIZE);
 #endif
-		}
+
+		utils_memory_secure_erase(tmpk, sizeof(tmpk));
 	}
 }
 
-void hkds_server_decrypt_verify_message_x8(hkds_server_x8_state* state, 
-	const uint8_t ciphertext[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE + HKDS_TAG_SIZE],
-	const uint8_t data[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE], size_t datalen, 
-	uint8_t plaintext[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE], 
-	bool valid[HKDS_CACHX8_DEPTH])
+static void hkds_server_generate_transaction_key_x8(const hkds_server_x8_state* state, hkds_server_x8_keys* keys, uint8_t tkey[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE])
 {
-	HKDS_ASSERT(state != NULL);
-	HKDS_ASSERT(ciphertext != NULL);
-	HKDS_ASSERT(data != NULL);
-	HKDS_ASSERT(plaintext != NULL);
-	HKDS_ASSERT(valid != NULL);
+	uint8_t skey[HKDS_CACHX8_DEPTH][HKDS_SERVER_KEYSTREAM_SIZE];
+	uint32_t index[HKDS_CACHX8_DEPTH] = { 0U };
+	size_t slen;
+	size_t i;
 
-	uint8_t code[HKDS_CACHX8_DEPTH][HKDS_TAG_SIZE] = { 0U };
-	uint8_t dkey[HKDS_CACHX8_DEPTH][2 * HKDS_MESSAGE_SIZE] = { 0U };
+	slen = 0U;
 
-	if (state != NULL && ciphertext != NULL && data != NULL && plaintext != NULL && valid != NULL)
+	for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
 	{
-		/* derive the transaction key  */
-		hkds_server_generate_transaction_authkey_x8(state, dkey);
-
-		/* generate the MAC code for the cipher-text received */
-#if defined(HKDS_SHAKE_128)
-		hkds_kmac_128x8(code[0U], code[1U], code[2U], code[3U], code[4U], code[5U], code[6U], code[7U], HKDS_TAG_SIZE,
-			((uint8_t*)dkey[0U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[1U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[2U] + HKDS_MESSAGE_SIZE),
-			((uint8_t*)dkey[3U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[4U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[5U] + HKDS_MESSAGE_SIZE),
-			((uint8_t*)dkey[6U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[7U] + HKDS_MESSAGE_SIZE), HKDS_MESSAGE_SIZE,
-			data[0U], data[1U], data[2U], data[3U], data[4U], data[5U], data[6U], data[7U], datalen,
-			ciphertext[0U], ciphertext[1U], ciphertext[2U], ciphertext[3U], ciphertext[4U],
-			ciphertext[5U], ciphertext[6U], ciphertext[7U], HKDS_MESSAGE_SIZE);
-#elif defined(HKDS_SHAKE_256)
-		hkds_kmac_256x8(code[0U], code[1U], code[2U], code[3U], code[4U], code[5U], code[6U], code[7U], HKDS_TAG_SIZE,
-			((uint8_t*)dkey[0U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[1U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[2U] + HKDS_MESSAGE_SIZE),
-			((uint8_t*)dkey[3U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[4U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[5U] + HKDS_MESSAGE_SIZE),
-			((uint8_t*)dkey[6U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[7U] + HKDS_MESSAGE_SIZE), HKDS_MESSAGE_SIZE,
-			data[0U], data[1U], data[2U], data[3U], data[4U], data[5U], data[6U], data[7U], datalen,
-			ciphertext[0U], ciphertext[1U], ciphertext[2U], ciphertext[3U], ciphertext[4U],
-			ciphertext[5U], ciphertext[6U], ciphertext[7U], HKDS_MESSAGE_SIZE);
-#else
-		hkds_kmac_512x8(code[0U], code[1U], code[2U], code[3U], code[4U], code[5U], code[6U], code[7U], HKDS_TAG_SIZE,
-			((uint8_t*)dkey[0U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[1U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[2U] + HKDS_MESSAGE_SIZE),
-			((uint8_t*)dkey[3U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[4U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[5U] + HKDS_MESSAGE_SIZE),
-			((uint8_t*)dkey[6U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[7U] + HKDS_MESSAGE_SIZE), HKDS_MESSAGE_SIZE,
-			data[0U], data[1U], data[2U], data[3U], data[4U], data[5U], data[6U], data[7U], datalen,
-			ciphertext[0U], ciphertext[1U], ciphertext[2U], ciphertext[3U], ciphertext[4U],
-			ciphertext[5U], ciphertext[6U], ciphertext[7U], HKDS_MESSAGE_SIZE);
-#endif
+		/* get the key counter mod the cache size from the ksn */
+		index[i] = utils_integer_be8to32(((uint8_t*)state->ksn[i] + HKDS_DID_SIZE)) % HKDS_CACHE_SIZE;
 
-		/* compare the MAC generated with the one appended to the message */
-		for (size_t i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+		/* track the deepest key-stream position any lane requires */
+		if (((size_t)index[i] * HKDS_MESSAGE_SIZE) + HKDS_MESSAGE_SIZE > slen)
 		{
-			valid[i] = false;
-
-			if (utils_integer_verify(code[i], ((const uint8_t*)ciphertext[i] + HKDS_MESSAGE_SIZE), HKDS_TAG_SIZE) == 0)
-			{
-				/* if the MAC check succeeds, decrypt the message */
-				utils_memory_copy(plaintext[i], ciphertext[i], HKDS_MESSAGE_SIZE);
-				utils_memory_xor(plaintext[i], dkey[i], HKDS_MESSAGE_SIZE);
-				valid[i] = true;
-			}
+			slen = ((size_t)index[i] * HKDS_MESSAGE_SIZE) + HKDS_MESSAGE_SIZE;
 		}
 	}
+
+	/* generate the minimum number of blocks for the deepest lane, and return the transaction keys */
+	hkds_server_generate_keystream_x8(state, keys, skey, slen);
+
+	for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		utils_memory_copy((uint8_t*)tkey[i], ((uint8_t*)skey[i] + ((size_t)index[i] * HKDS_MESSAGE_SIZE)), HKDS_MESSAGE_SIZE);
+	}
 }
 
-void hkds_server_generate_edk_x8(const hkds_server_x8_state* state,
-	uint8_t did[HKDS_CACHX8_DEPTH][HKDS_DID_SIZE],
-	uint8_t edk[HKDS_CACHX8_DEPTH][HKDS_EDK_SIZE])
+static void hkds_server_generate_transaction_authkey_x8(const hkds_server_x8_state* state, hkds_server_x8_keys* keys, uint8_t tkey[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE + HKDS_TAG_SIZE])
 {
-	HKDS_ASSERT(state != NULL);
-	HKDS_ASSERT(did != NULL);
-	HKDS_ASSERT(edk != NULL);
+	uint8_t skey[HKDS_CACHX8_DEPTH][HKDS_SERVER_KEYSTREAM_SIZE];
+	uint32_t index[HKDS_CACHX8_DEPTH] = { 0U };
+	size_t slen;
+	size_t i;
 
-	uint8_t dkey[HKDS_CACHX8_DEPTH][HKDS_BDK_SIZE + HKDS_DID_SIZE] = { 0U };
+	slen = 0U;
 
-	if (state != NULL && did != NULL && edk != NULL)
+	for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		/* get the key counter mod the cache size from the ksn */
+		index[i] = utils_integer_be8to32(((uint8_t*)state->ksn[i] + HKDS_DID_SIZE)) % HKDS_CACHE_SIZE;
+
+		/* track the deepest key-stream position any lane requires */
+		if (((size_t)index[i] * HKDS_MESSAGE_SIZE) + (2U * HKDS_MESSAGE_SIZE) > slen)
+		{
+			slen = ((size_t)index[i] * HKDS_MESSAGE_SIZE) + (2U * HKDS_MESSAGE_SIZE);
+		}
+	}
+
+	/* generate the minimum number of blocks for the deepest lane, and return the transaction keys */
+	hkds_server_generate_keystream_x8(state, keys, skey, slen);
+
+	for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		utils_memory_copy((uint8_t*)tkey[i], ((uint8_t*)skey[i] + ((size_t)index[i] * HKDS_MESSAGE_SIZE)), 2 * HKDS_MESSAGE_SIZE);
+	}
+}
+
+static void hkds_server_decrypt_keys_x8(const hkds_server_x8_state* state, hkds_server_x8_keys* keys,
+	const uint8_t ciphertext[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE], uint8_t plaintext[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE])
+{
+	/* copy the key directly into the empty plaintext array */
+	hkds_server_generate_transaction_key_x8(state, keys, plaintext);
+
+	/* XOR the key-stream and and cipher-text */
+	for (size_t i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		utils_memory_xor(plaintext[i], ciphertext[i], HKDS_MESSAGE_SIZE);
+	}
+}
+
+static void hkds_server_encrypt_token_keys_x8(const hkds_server_x8_state* state, hkds_server_x8_keys* keys, uint8_t etok[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE + HKDS_TAG_SIZE])
+{
+	uint8_t ctok[HKDS_CACHX8_DEPTH][HKDS_CTOK_SIZE] = { 0U };
+	uint8_t tms[HKDS_TMS_SIZE] = { 0U };
+	uint8_t tmpk[HKDS_CACHX8_DEPTH][HKDS_CTOK_SIZE + HKDS_EDK_SIZE] = { 0U };
+	size_t i;
+
+	/* get the embedded device keys, and generate the device tokens from the base token and customization string */
+	hkds_server_keys_derive_x8(state, keys);
+
+	/* generate the custom token string */
+	hkds_server_get_ctok_x8(state, ctok);
+
+	/* copy ctok and edk to PRF key */
+	for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		utils_memory_copy(tmpk[i], ctok[i], HKDS_CTOK_SIZE);
+		utils_memory_copy(((uint8_t*)tmpk[i] + HKDS_CTOK_SIZE), keys->edk[i], HKDS_EDK_SIZE);
+	}
+
+	/* initialize shake with the ctok and edk, and generate the encryption key */
+#if defined(HKDS_SHAKE_128)
+	hkds_shake_128x8(etok[0U], etok[1U], etok[2U], etok[3U], etok[4U], etok[5U], etok[6U], etok[7U], HKDS_STK_SIZE,
+		tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_CTOK_SIZE + HKDS_EDK_SIZE);
+#elif defined(HKDS_SHAKE_256)
+	hkds_shake_256x8(etok[0U], etok[1U], etok[2U], etok[3U], etok[4U], etok[5U], etok[6U], etok[7U], HKDS_STK_SIZE,
+		tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_CTOK_SIZE + HKDS_EDK_SIZE);
+#else
+	hkds_shake_512x8(etok[0U], etok[1U], etok[2U], etok[3U], etok[4U], etok[5U], etok[6U], etok[7U], HKDS_STK_SIZE,
+		tmpk[0U], tmpk[1U], tmpk[2U], tmpk[3U], tmpk[4U], tmpk[5U], tmpk[6U], tmpk[7U], HKDS_CTOK_SIZE + HKDS_EDK_SIZE);
+#endif
+
+	/* encrypt the token set */
+	for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		utils_memory_xor(etok[i], keys->tok[i], HKDS_STK_SIZE);
+	}
+
+	for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		hkds_server_get_tms(state->ksn[i], tms);
+
+#if defined(HKDS_SHAKE_128)
+		hkds_kmac128_compute(etok[i] + HKDS_STK_SIZE, HKDS_TAG_SIZE, etok[i], HKDS_STK_SIZE, keys->edk[i], HKDS_EDK_SIZE, tms, HKDS_TMS_SIZE);
+#elif defined(HKDS_SHAKE_256)
+		hkds_kmac256_compute(etok[i] + HKDS_STK_SIZE, HKDS_TAG_SIZE, etok[i], HKDS_STK_SIZE, keys->edk[i], HKDS_EDK_SIZE, tms, HKDS_TMS_SIZE);
+#else
+		hkds_kmac512_compute(etok[i] + HKDS_STK_SIZE, HKDS_TAG_SIZE, etok[i], HKDS_STK_SIZE, keys->edk[i], HKDS_EDK_SIZE, tms, HKDS_TMS_SIZE);
+#endif
+	}
+
+	utils_memory_secure_erase(tmpk, sizeof(tmpk));
+}
+
+static void hkds_server_decrypt_verify_keys_x8(const hkds_server_x8_state* state, hkds_server_x8_keys* keys,
+	const uint8_t ciphertext[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE + HKDS_TAG_SIZE],
+	const uint8_t data[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE], size_t datalen,
+	uint8_t plaintext[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE],
+	bool valid[HKDS_CACHX8_DEPTH])
+{
+	uint8_t code[HKDS_CACHX8_DEPTH][HKDS_TAG_SIZE] = { 0U };
+	uint8_t dkey[HKDS_CACHX8_DEPTH][2 * HKDS_MESSAGE_SIZE] = { 0U };
+
+	/* derive the transaction key */
+	hkds_server_generate_transaction_authkey_x8(state, keys, dkey);
+
+	/* generate the MAC code for the cipher-text received */
+#if defined(HKDS_SHAKE_128)
+	hkds_kmac_128x8(code[0U], code[1U], code[2U], code[3U], code[4U], code[5U], code[6U], code[7U], HKDS_TAG_SIZE,
+		((uint8_t*)dkey[0U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[1U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[2U] + HKDS_MESSAGE_SIZE),
+		((uint8_t*)dkey[3U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[4U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[5U] + HKDS_MESSAGE_SIZE),
+		((uint8_t*)dkey[6U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[7U] + HKDS_MESSAGE_SIZE), HKDS_MESSAGE_SIZE,
+		data[0U], data[1U], data[2U], data[3U], data[4U], data[5U], data[6U], data[7U], datalen,
+		ciphertext[0U], ciphertext[1U], ciphertext[2U], ciphertext[3U], ciphertext[4U],
+		ciphertext[5U], ciphertext[6U], ciphertext[7U], HKDS_MESSAGE_SIZE);
+#elif defined(HKDS_SHAKE_256)
+	hkds_kmac_256x8(code[0U], code[1U], code[2U], code[3U], code[4U], code[5U], code[6U], code[7U], HKDS_TAG_SIZE,
+		((uint8_t*)dkey[0U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[1U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[2U] + HKDS_MESSAGE_SIZE),
+		((uint8_t*)dkey[3U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[4U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[5U] + HKDS_MESSAGE_SIZE),
+		((uint8_t*)dkey[6U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[7U] + HKDS_MESSAGE_SIZE), HKDS_MESSAGE_SIZE,
+		data[0U], data[1U], data[2U], data[3U], data[4U], data[5U], data[6U], data[7U], datalen,
+		ciphertext[0U], ciphertext[1U], ciphertext[2U], ciphertext[3U], ciphertext[4U],
+		ciphertext[5U], ciphertext[6U], ciphertext[7U], HKDS_MESSAGE_SIZE);
+#else
+	hkds_kmac_512x8(code[0U], code[1U], code[2U], code[3U], code[4U], code[5U], code[6U], code[7U], HKDS_TAG_SIZE,
+		((uint8_t*)dkey[0U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[1U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[2U] + HKDS_MESSAGE_SIZE),
+		((uint8_t*)dkey[3U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[4U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[5U] + HKDS_MESSAGE_SIZE),
+		((uint8_t*)dkey[6U] + HKDS_MESSAGE_SIZE), ((uint8_t*)dkey[7U] + HKDS_MESSAGE_SIZE), HKDS_MESSAGE_SIZE,
+		data[0U], data[1U], data[2U], data[3U], data[4U], data[5U], data[6U], data[7U], datalen,
+		ciphertext[0U], ciphertext[1U], ciphertext[2U], ciphertext[3U], ciphertext[4U],
+		ciphertext[5U], ciphertext[6U], ciphertext[7U], HKDS_MESSAGE_SIZE);
+#endif
+
+	/* compare the MAC generated with the one appended to the message */
+	for (size_t i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		valid[i] = false;
+
+		if (utils_integer_verify(code[i], ((const uint8_t*)ciphertext[i] + HKDS_MESSAGE_SIZE), HKDS_TAG_SIZE) == 0)
+		{
+			/* if the MAC check succeeds, decrypt the message */
+			utils_memory_copy(plaintext[i], ciphertext[i], HKDS_MESSAGE_SIZE);
+			utils_memory_xor(plaintext[i], dkey[i], HKDS_MESSAGE_SIZE);
+			valid[i] = true;
+		}
+	}
+}
+
+void hkds_server_decrypt_message_x8(hkds_server_x8_state* state, const uint8_t ciphertext[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE], uint8_t plaintext[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE])
+{
+	HKDS_ASSERT(state != NULL);
+	HKDS_ASSERT(ciphertext != NULL);
+	HKDS_ASSERT(plaintext != NULL);
+
+	hkds_server_x8_keys keys;
+
+	if (state != NULL && ciphertext != NULL && plaintext != NULL)
+	{
+		if (hkds_server_keys_attached_x8(state) == true)
+		{
+			hkds_server_keys_find_x8(state, &keys, true);
+			hkds_server_decrypt_keys_x8(state, &keys, ciphertext, plaintext);
+			hkds_server_keys_insert_x8(state, &keys, HKDS_CACHX8_DEPTH);
+			utils_memory_secure_erase((uint8_t*)&keys, sizeof(keys));
+		}
+		else
+		{
+			hkds_server_decrypt_keys_x8(state, NULL, ciphertext, plaintext);
+		}
+	}
+}
+
+void hkds_server_encrypt_token_x8(hkds_server_x8_state* state, uint8_t etok[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE + HKDS_TAG_SIZE])
+{
+	HKDS_ASSERT(state != NULL);
+	HKDS_ASSERT(etok != NULL);
+
+	hkds_server_x8_keys keys;
+
+	if (state != NULL && etok != NULL)
+	{
+		/* the issued tokens are always generated, and memoized for the message decryptions of this epoch */
+		hkds_server_keys_find_x8(state, &keys, false);
+		hkds_server_encrypt_token_keys_x8(state, &keys, etok);
+		hkds_server_keys_insert_x8(state, &keys, HKDS_CACHX8_DEPTH);
+		utils_memory_secure_erase((uint8_t*)&keys, sizeof(keys));
+	}
+}
+
+void hkds_server_decrypt_verify_message_x8(hkds_server_x8_state* state,
+	const uint8_t ciphertext[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE + HKDS_TAG_SIZE],
+	const uint8_t data[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE], size_t datalen,
+	uint8_t plaintext[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE],
+	bool valid[HKDS_CACHX8_DEPTH])
+{
+	HKDS_ASSERT(state != NULL);
+	HKDS_ASSERT(ciphertext != NULL);
+	HKDS_ASSERT(data != NULL);
+	HKDS_ASSERT(plaintext != NULL);
+	HKDS_ASSERT(valid != NULL);
+
+	hkds_server_x8_keys keys;
+
+	if (state != NULL && ciphertext != NULL && data != NULL && plaintext != NULL && valid != NULL)
+	{
+		if (hkds_server_keys_attached_x8(state) == true)
+		{
+			hkds_server_keys_find_x8(state, &keys, true);
+			hkds_server_decrypt_verify_keys_x8(state, &keys, ciphertext, data, datalen, plaintext, valid);
+			hkds_server_keys_insert_x8(state, &keys, HKDS_CACHX8_DEPTH);
+			utils_memory_secure_erase((uint8_t*)&keys, sizeof(keys));
+		}
+		else
+		{
+			hkds_server_decrypt_verify_keys_x8(state, NULL, ciphertext, data, datalen, plaintext, valid);
+		}
+	}
+}
+
+void hkds_server_generate_edk_x8(const hkds_server_x8_state* state,
+	uint8_t did[HKDS_CACHX8_DEPTH][HKDS_DID_SIZE],
+	uint8_t edk[HKDS_CACHX8_DEPTH][HKDS_EDK_SIZE])
+{
+	HKDS_ASSERT(state != NULL);
+	HKDS_ASSERT(did != NULL);
+	HKDS_ASSERT(edk != NULL);
+
+	uint8_t dkey[HKDS_CACHX8_DEPTH][HKDS_BDK_SIZE + HKDS_DID_SIZE] = { 0U };
+
+	if (state != NULL && did != NULL && edk != NULL)
 	{
 		for (size_t i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
 		{
@@ -620,6 +967,9 @@ void hkds_server_initialize_state_x8(hkds_server_x8_state* state,
 	if (state != NULL && mdk != NULL && ksn != NULL)
 	{
 		state->mdk = mdk;
+		state->edktable = NULL;
+		state->tokenmemo = NULL;
+		state->pool = NULL;
 
 		for (size_t i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
 		{
@@ -628,9 +978,581 @@ void hkds_server_initialize_state_x8(hkds_server_x8_state* state,
 	}
 }
 
-/* parallel SIMD vectorized x64 api */
+void hkds_server_set_edk_table_x8(hkds_server_x8_state* state, hkds_edk_table* edktable)
+{
+	HKDS_ASSERT(state != NULL);
+
+	if (state != NULL)
+	{
+		state->edktable = edktable;
+	}
+}
+
+void hkds_server_set_token_memo_x8(hkds_server_x8_state* state, hkds_token_memo* tokenmemo)
+{
+	HKDS_ASSERT(state != NULL);
+
+	if (state != NULL)
+	{
+		state->tokenmemo = tokenmemo;
+	}
+}
+
+void hkds_server_set_thread_pool_x8(hkds_server_x8_state* state, hkds_thread_pool* pool)
+{
+	HKDS_ASSERT(state != NULL);
+
+	if (state != NULL)
+	{
+		state->pool = pool;
+	}
+}
+
+bool hkds_server_load_edk_table(hkds_edk_table* table, hkds_master_key* mdk, const uint8_t did[][HKDS_DID_SIZE], size_t count)
+{
+	HKDS_ASSERT(table != NULL);
+	HKDS_ASSERT(mdk != NULL);
+	HKDS_ASSERT(did != NULL);
+
+	hkds_server_x8_state state = { 0U };
+	uint8_t gdid[HKDS_CACHX8_DEPTH][HKDS_DID_SIZE] = { 0U };
+	uint8_t gedk[HKDS_CACHX8_DEPTH][HKDS_EDK_SIZE] = { 0U };
+	size_t glen;
+	bool res;
+
+	res = false;
+
+	if (table != NULL && mdk != NULL && did != NULL && utils_memory_are_equal(table->kid, mdk->kid, HKDS_KID_SIZE) == true)
+	{
+		state.mdk = mdk;
+		res = true;
+
+		/* derive the keys in groups of eight, padding the final group with its first device */
+		for (size_t i = 0U; i < count; i += HKDS_CACHX8_DEPTH)
+		{
+			glen = (count - i < HKDS_CACHX8_DEPTH) ? count - i : HKDS_CACHX8_DEPTH;
+
+			for (size_t j = 0U; j < HKDS_CACHX8_DEPTH; ++j)
+			{
+				utils_memory_copy(gdid[j], did[i + ((j < glen) ? j : 0U)], HKDS_DID_SIZE);
+			}
 
+			hkds_server_generate_edk_x8(&state, gdid, gedk);
+
+			for (size_t j = 0U; j < glen; ++j)
+			{
+				if (hkds_edk_table_insert(table, gdid[j], gedk[j]) == false)
+				{
+					res = false;
+				}
+			}
+		}
+
+		utils_memory_secure_erase(gedk, sizeof(gedk));
+	}
+
+	return res;
+}
+
+/* arbitrary length batch api */
+
+typedef struct
+{
+	uint8_t did[HKDS_DID_SIZE];
+	uint32_t epoch;
+	uint32_t index;
+	size_t request;
+} hkds_server_batch_entry;
+
+typedef struct
+{
+	const hkds_server_x8_state* state;
+	const hkds_server_batch_entry* entries;
+	const size_t* runs;
+	size_t nruns;
+	const uint8_t* const* ciphertext;
+	const uint8_t* const* data;
+	size_t datalen;
+	uint8_t* const* plaintext;
+	bool* valid;
+	hkds_server_x8_keys* keys;
+} hkds_server_batch_context;
+
+static void hkds_server_parallel_run(hkds_thread_pool* pool, size_t count, hkds_pool_task task, void* context)
+{
+	if (pool != NULL)
+	{
+		hkds_pool_parallel_for(pool, count, task, context);
+	}
+	else
+	{
+		int64_t i;
+
+		/* without a pool, the loop is shared with OpenMP when it is enabled, or run in sequence */
 #if defined(HKDS_SYSTEM_OPENMP)
+#pragma omp parallel for schedule(dynamic)
+#endif
+		for (i = 0; i < (int64_t)count; ++i)
+		{
+			task(context, (size_t)i);
+		}
+	}
+}
+
+static int hkds_server_batch_compare(const void* a, const void* b)
+{
+	const hkds_server_batch_entry* ea = (const hkds_server_batch_entry*)a;
+	const hkds_server_batch_entry* eb = (const hkds_server_batch_entry*)b;
+	int res;
+
+	/* order by device and epoch, then by request to keep the plan deterministic */
+	res = memcmp(ea->did, eb->did, HKDS_DID_SIZE);
+
+	if (res == 0)
+	{
+		res = (ea->epoch > eb->epoch) - (ea->epoch < eb->epoch);
+	}
+
+	if (res == 0)
+	{
+		res = (ea->request > eb->request) - (ea->request < eb->request);
+	}
+
+	return res;
+}
+
+static size_t hkds_server_batch_plan(const uint8_t* const ksn[], size_t base, size_t count, hkds_server_batch_entry* entries, size_t* runs)
+{
+	hkds_server_batch_entry tmp;
+	uint32_t ctr;
+	size_t nruns;
+	size_t j;
+
+	nruns = 0U;
+
+	/* the entries of a slice keep the index of their request in the whole batch */
+	for (size_t i = 0U; i < count; ++i)
+	{
+		ctr = utils_integer_be8to32(ksn[base + i] + HKDS_DID_SIZE);
+		utils_memory_copy(entries[i].did, ksn[base + i], HKDS_DID_SIZE);
+		entries[i].epoch = ctr / HKDS_CACHE_SIZE;
+		entries[i].index = ctr % HKDS_CACHE_SIZE;
+		entries[i].request = base + i;
+	}
+
+	/* a slice of at most 64 requests is ordered in place by insertion */
+	for (size_t i = 1U; i < count; ++i)
+	{
+		tmp = entries[i];
+		j = i;
+
+		while (j > 0U && hkds_server_batch_compare(&entries[j - 1U], &tmp) > 0)
+		{
+			entries[j] = entries[j - 1U];
+			--j;
+		}
+
+		entries[j] = tmp;
+	}
+
+	/* each run of requests sharing a device and epoch is served by a single derivation */
+	for (size_t i = 0U; i < count; ++i)
+	{
+		if (i == 0U || entries[i].epoch != entries[i - 1U].epoch ||
+			utils_memory_are_equal(entries[i].did, entries[i - 1U].did, HKDS_DID_SIZE) == false)
+		{
+			runs[nruns] = i;
+			++nruns;
+		}
+	}
+
+	runs[nruns] = count;
+
+	return nruns;
+}
+
+static size_t hkds_server_batch_group_load(const hkds_server_x8_state* state, hkds_server_x8_state* gstate, const hkds_server_batch_entry* entries,
+	const size_t* runs, size_t nruns, size_t group, size_t keylen, size_t lane[HKDS_CACHX8_DEPTH], size_t* slen)
+{
+	const hkds_server_batch_entry* ent;
+	size_t glen;
+	size_t base;
+
+	base = group * HKDS_CACHX8_DEPTH;
+	glen = (nruns - base < HKDS_CACHX8_DEPTH) ? nruns - base : HKDS_CACHX8_DEPTH;
+	*gstate = *state;
+	*slen = 0U;
+
+	/* each lane derives one device epoch; the unused lanes of a partial group repeat its first run and are discarded */
+	for (size_t i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		lane[i] = base + ((i < glen) ? i : 0U);
+		ent = &entries[runs[lane[i]]];
+		utils_memory_copy(gstate->ksn[i], ent->did, HKDS_DID_SIZE);
+		utils_integer_be32to8(((uint8_t*)gstate->ksn[i] + HKDS_DID_SIZE), ent->epoch * HKDS_CACHE_SIZE);
+
+		/* the group squeezes to the deepest key any request in it uses */
+		for (size_t j = runs[lane[i]]; j < runs[lane[i] + 1U]; ++j)
+		{
+			if (((size_t)entries[j].index * HKDS_MESSAGE_SIZE) + keylen > *slen)
+			{
+				*slen = ((size_t)entries[j].index * HKDS_MESSAGE_SIZE) + keylen;
+			}
+		}
+	}
+
+	return glen;
+}
+
+static void hkds_server_batch_verify_x8(uint8_t skey[HKDS_CACHX8_DEPTH][HKDS_SERVER_KEYSTREAM_SIZE], const hkds_server_batch_entry* job[HKDS_CACHX8_DEPTH],
+	const size_t jlane[HKDS_CACHX8_DEPTH], size_t jlen, const uint8_t* const ciphertext[], const uint8_t* const data[], size_t datalen,
+	uint8_t* const plaintext[], bool valid[])
+{
+	uint8_t code[HKDS_CACHX8_DEPTH][HKDS_TAG_SIZE] = { 0U };
+	const uint8_t* cpt[HKDS_CACHX8_DEPTH];
+	const uint8_t* dat[HKDS_CACHX8_DEPTH];
+	const uint8_t* mkey[HKDS_CACHX8_DEPTH];
+	const uint8_t* tkey;
+	size_t j;
+
+	/* gather the MAC jobs; the unused lanes of a partial set repeat its first job */
+	for (size_t i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		j = (i < jlen) ? i : 0U;
+		cpt[i] = ciphertext[job[j]->request];
+		dat[i] = data[job[j]->request];
+		mkey[i] = (const uint8_t*)skey[jlane[j]] + (((size_t)job[j]->index + 1U) * HKDS_MESSAGE_SIZE);
+	}
+
+#if defined(HKDS_SHAKE_128)
+	hkds_kmac_128x8(code[0U], code[1U], code[2U], code[3U], code[4U], code[5U], code[6U], code[7U], HKDS_TAG_SIZE,
+		mkey[0U], mkey[1U], mkey[2U], mkey[3U], mkey[4U], mkey[5U], mkey[6U], mkey[7U], HKDS_MESSAGE_SIZE,
+		dat[0U], dat[1U], dat[2U], dat[3U], dat[4U], dat[5U], dat[6U], dat[7U], datalen,
+		cpt[0U], cpt[1U], cpt[2U], cpt[3U], cpt[4U], cpt[5U], cpt[6U], cpt[7U], HKDS_MESSAGE_SIZE);
+#elif defined(HKDS_SHAKE_256)
+	hkds_kmac_256x8(code[0U], code[1U], code[2U], code[3U], code[4U], code[5U], code[6U], code[7U], HKDS_TAG_SIZE,
+		mkey[0U], mkey[1U], mkey[2U], mkey[3U], mkey[4U], mkey[5U], mkey[6U], mkey[7U], HKDS_MESSAGE_SIZE,
+		dat[0U], dat[1U], dat[2U], dat[3U], dat[4U], dat[5U], dat[6U], dat[7U], datalen,
+		cpt[0U], cpt[1U], cpt[2U], cpt[3U], cpt[4U], cpt[5U], cpt[6U], cpt[7U], HKDS_MESSAGE_SIZE);
+#else
+	hkds_kmac_512x8(code[0U], code[1U], code[2U], code[3U], code[4U], code[5U], code[6U], code[7U], HKDS_TAG_SIZE,
+		mkey[0U], mkey[1U], mkey[2U], mkey[3U], mkey[4U], mkey[5U], mkey[6U], mkey[7U], HKDS_MESSAGE_SIZE,
+		dat[0U], dat[1U], dat[2U], dat[3U], dat[4U], dat[5U], dat[6U], dat[7U], datalen,
+		cpt[0U], cpt[1U], cpt[2U], cpt[3U], cpt[4U], cpt[5U], cpt[6U], cpt[7U], HKDS_MESSAGE_SIZE);
+#endif
+
+	/* compare the MAC generated with the one appended to the message */
+	for (size_t i = 0U; i < jlen; ++i)
+	{
+		valid[job[i]->request] = false;
+
+		if (utils_integer_verify(code[i], cpt[i] + HKDS_MESSAGE_SIZE, HKDS_TAG_SIZE) == 0)
+		{
+			/* if the MAC check succeeds, decrypt the message */
+			tkey = (const uint8_t*)skey[jlane[i]] + ((size_t)job[i]->index * HKDS_MESSAGE_SIZE);
+			utils_memory_copy(plaintext[job[i]->request], cpt[i], HKDS_MESSAGE_SIZE);
+			utils_memory_xor(plaintext[job[i]->request], tkey, HKDS_MESSAGE_SIZE);
+			valid[job[i]->request] = true;
+		}
+	}
+}
+
+static void hkds_server_batch_decrypt_group(void* context, size_t group)
+{
+	const hkds_server_batch_context* ctx = (const hkds_server_batch_context*)context;
+	hkds_server_x8_state gstate;
+	uint8_t skey[HKDS_CACHX8_DEPTH][HKDS_SERVER_KEYSTREAM_SIZE];
+	size_t lane[HKDS_CACHX8_DEPTH];
+	size_t glen;
+	size_t slen;
+
+	glen = hkds_server_batch_group_load(ctx->state, &gstate, ctx->entries, ctx->runs, ctx->nruns, group, HKDS_MESSAGE_SIZE, lane, &slen);
+	hkds_server_generate_keystream_x8(&gstate, (ctx->keys != NULL) ? &ctx->keys[group] : NULL, skey, slen);
+
+	/* every request in a run is decrypted with the key-stream of its lane */
+	for (size_t i = 0U; i < glen; ++i)
+	{
+		for (size_t j = ctx->runs[lane[i]]; j < ctx->runs[lane[i] + 1U]; ++j)
+		{
+			utils_memory_copy(ctx->plaintext[ctx->entries[j].request], ctx->ciphertext[ctx->entries[j].request], HKDS_MESSAGE_SIZE);
+			utils_memory_xor(ctx->plaintext[ctx->entries[j].request], ((uint8_t*)skey[i] + ((size_t)ctx->entries[j].index * HKDS_MESSAGE_SIZE)), HKDS_MESSAGE_SIZE);
+		}
+	}
+
+	utils_memory_secure_erase(skey, sizeof(skey));
+}
+
+static void hkds_server_batch_verify_group(void* context, size_t group)
+{
+	const hkds_server_batch_context* ctx = (const hkds_server_batch_context*)context;
+	hkds_server_x8_state gstate;
+	uint8_t skey[HKDS_CACHX8_DEPTH][HKDS_SERVER_KEYSTREAM_SIZE];
+	const hkds_server_batch_entry* job[HKDS_CACHX8_DEPTH];
+	size_t jlane[HKDS_CACHX8_DEPTH];
+	size_t lane[HKDS_CACHX8_DEPTH];
+	size_t glen;
+	size_t jlen;
+	size_t slen;
+
+	glen = hkds_server_batch_group_load(ctx->state, &gstate, ctx->entries, ctx->runs, ctx->nruns, group, 2U * HKDS_MESSAGE_SIZE, lane, &slen);
+	hkds_server_generate_keystream_x8(&gstate, (ctx->keys != NULL) ? &ctx->keys[group] : NULL, skey, slen);
+	jlen = 0U;
+
+	/* the requests of the group are authenticated eight at a time, independent of their lane */
+	for (size_t i = 0U; i < glen; ++i)
+	{
+		for (size_t j = ctx->runs[lane[i]]; j < ctx->runs[lane[i] + 1U]; ++j)
+		{
+			job[jlen] = &ctx->entries[j];
+			jlane[jlen] = i;
+			++jlen;
+
+			if (jlen == HKDS_CACHX8_DEPTH)
+			{
+				hkds_server_batch_verify_x8(skey, job, jlane, jlen, ctx->ciphertext, ctx->data, ctx->datalen, ctx->plaintext, ctx->valid);
+				jlen = 0U;
+			}
+		}
+	}
+
+	if (jlen != 0U)
+	{
+		hkds_server_batch_verify_x8(skey, job, jlane, jlen, ctx->ciphertext, ctx->data, ctx->datalen, ctx->plaintext, ctx->valid);
+	}
+
+	utils_memory_secure_erase(skey, sizeof(skey));
+}
+
+static void hkds_server_batch_keys(const hkds_server_batch_context* ctx, size_t groups, bool insert)
+{
+	hkds_server_x8_state gstate;
+	size_t lane[HKDS_CACHX8_DEPTH];
+	size_t glen;
+	size_t slen;
+
+	/* the cache lookups before the groups are derived, and the inserts after, are made on the calling thread */
+	for (size_t i = 0U; i < groups; ++i)
+	{
+		glen = hkds_server_batch_group_load(ctx->state, &gstate, ctx->entries, ctx->runs, ctx->nruns, i, 0U, lane, &slen);
+
+		if (insert == true)
+		{
+			hkds_server_keys_insert_x8(&gstate, &ctx->keys[i], glen);
+		}
+		else
+		{
+			hkds_server_keys_find_x8(&gstate, &ctx->keys[i], true);
+		}
+	}
+}
+
+static void hkds_server_batch_run(const hkds_server_x8_state* state, size_t count, const uint8_t* const ksn[], hkds_server_batch_context* ctx, hkds_pool_task task)
+{
+	hkds_server_batch_entry entries[HKDS_CACHX64_SIZE];
+	hkds_server_x8_keys keys[HKDS_CACHX64_SIZE / HKDS_CACHX8_DEPTH];
+	size_t runs[HKDS_CACHX64_SIZE + 1U];
+	size_t groups;
+	size_t slen;
+	bool cached;
+
+	cached = hkds_server_keys_attached_x8(state);
+	ctx->state = state;
+	ctx->entries = entries;
+	ctx->runs = runs;
+	ctx->keys = (cached == true) ? keys : NULL;
+
+	/* the batch is processed in consecutive slices of up to 64 requests, each planned on the stack;
+	   a device epoch that spans slices is derived once per slice, or found in an attached cache */
+	for (size_t base = 0U; base < count; base += slen)
+	{
+		slen = (count - base < HKDS_CACHX64_SIZE) ? count - base : HKDS_CACHX64_SIZE;
+
+		/* group the requests by device and epoch; the lanes are assigned to unique derivations */
+		ctx->nruns = hkds_server_batch_plan(ksn, base, slen, entries, runs);
+		groups = (ctx->nruns + HKDS_CACHX8_DEPTH - 1U) / HKDS_CACHX8_DEPTH;
+
+		if (cached == true)
+		{
+			hkds_server_batch_keys(ctx, groups, false);
+		}
+
+		/* only the derivations are distributed; the caches are not touched by the groups */
+		hkds_server_parallel_run(state->pool, groups, task, ctx);
+
+		if (cached == true)
+		{
+			hkds_server_batch_keys(ctx, groups, true);
+		}
+	}
+
+	if (cached == true)
+	{
+		utils_memory_secure_erase((uint8_t*)keys, sizeof(keys));
+	}
+}
+
+bool hkds_server_decrypt_batch(const hkds_server_x8_state* state, size_t count, const uint8_t* const ksn[], const uint8_t* const ciphertext[], uint8_t* const plaintext[])
+{
+	HKDS_ASSERT(state != NULL);
+	HKDS_ASSERT(ksn != NULL);
+	HKDS_ASSERT(ciphertext != NULL);
+	HKDS_ASSERT(plaintext != NULL);
+
+	hkds_server_batch_context ctx = { 0U };
+	bool res;
+
+	res = false;
+
+	if (state != NULL && ksn != NULL && ciphertext != NULL && plaintext != NULL && count != 0U)
+	{
+		ctx.ciphertext = ciphertext;
+		ctx.plaintext = plaintext;
+		hkds_server_batch_run(state, count, ksn, &ctx, &hkds_server_batch_decrypt_group);
+		res = true;
+	}
+
+	return res;
+}
+
+bool hkds_server_decrypt_verify_batch(const hkds_server_x8_state* state, size_t count, const uint8_t* const ksn[], const uint8_t* const ciphertext[],
+	const uint8_t* const data[], size_t datalen, uint8_t* const plaintext[], bool valid[])
+{
+	HKDS_ASSERT(state != NULL);
+	HKDS_ASSERT(ksn != NULL);
+	HKDS_ASSERT(ciphertext != NULL);
+	HKDS_ASSERT(data != NULL);
+	HKDS_ASSERT(datalen <= HKDS_MESSAGE_SIZE);
+	HKDS_ASSERT(plaintext != NULL);
+	HKDS_ASSERT(valid != NULL);
+
+	hkds_server_batch_context ctx = { 0U };
+	bool res;
+
+	res = false;
+
+	if (state != NULL && ksn != NULL && ciphertext != NULL && data != NULL && datalen <= HKDS_MESSAGE_SIZE &&
+		plaintext != NULL && valid != NULL && count != 0U)
+	{
+		ctx.ciphertext = ciphertext;
+		ctx.data = data;
+		ctx.datalen = datalen;
+		ctx.plaintext = plaintext;
+		ctx.valid = valid;
+		hkds_server_batch_run(state, count, ksn, &ctx, &hkds_server_batch_verify_group);
+		res = true;
+	}
+
+	return res;
+}
+
+/* parallel SIMD vectorized x64 api */
+
+typedef struct
+{
+	hkds_server_x8_state* state;
+	hkds_server_x8_keys* const* keys;
+	const uint8_t (*ciphertext)[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE];
+	uint8_t (*plaintext)[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE];
+} hkds_server_x64_decrypt_context;
+
+typedef struct
+{
+	hkds_server_x8_state* state;
+	hkds_server_x8_keys* const* keys;
+	const uint8_t (*ciphertext)[HKDS_CACHX8_DEPTH][HKDS_TAG_SIZE + HKDS_MESSAGE_SIZE];
+	const uint8_t (*data)[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE];
+	size_t datalen;
+	uint8_t (*plaintext)[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE];
+	bool (*valid)[HKDS_CACHX8_DEPTH];
+} hkds_server_x64_verify_context;
+
+typedef struct
+{
+	hkds_server_x8_state* state;
+	hkds_server_x8_keys* const* keys;
+	uint8_t (*etok)[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE + HKDS_TAG_SIZE];
+} hkds_server_x64_token_context;
+
+typedef struct
+{
+	const hkds_server_x8_state* state;
+	uint8_t (*did)[HKDS_CACHX8_DEPTH][HKDS_DID_SIZE];
+	uint8_t (*edk)[HKDS_CACHX8_DEPTH][HKDS_EDK_SIZE];
+} hkds_server_x64_edk_context;
+
+typedef struct
+{
+	hkds_server_x8_state* state;
+	hkds_master_key* mdk;
+	const uint8_t (*ksn)[HKDS_CACHX8_DEPTH][HKDS_KSN_SIZE];
+} hkds_server_x64_initialize_context;
+
+static void hkds_server_x64_keys_find(const hkds_server_x8_state state[HKDS_PARALLEL_DEPTH], hkds_server_x8_keys keys[HKDS_PARALLEL_DEPTH],
+	hkds_server_x8_keys* lkeys[HKDS_PARALLEL_DEPTH], bool issue)
+{
+	/* the cache lookups are made on the calling thread; token issuance always resolves its keys */
+	for (size_t i = 0U; i < HKDS_PARALLEL_DEPTH; ++i)
+	{
+		lkeys[i] = NULL;
+
+		if (issue == true || hkds_server_keys_attached_x8(&state[i]) == true)
+		{
+			hkds_server_keys_find_x8(&state[i], &keys[i], issue == false);
+			lkeys[i] = &keys[i];
+		}
+	}
+}
+
+static void hkds_server_x64_keys_insert(const hkds_server_x8_state state[HKDS_PARALLEL_DEPTH], hkds_server_x8_keys keys[HKDS_PARALLEL_DEPTH],
+	hkds_server_x8_keys* const lkeys[HKDS_PARALLEL_DEPTH])
+{
+	/* the cache inserts are made on the calling thread once every lane is derived */
+	for (size_t i = 0U; i < HKDS_PARALLEL_DEPTH; ++i)
+	{
+		if (lkeys[i] != NULL)
+		{
+			hkds_server_keys_insert_x8(&state[i], lkeys[i], HKDS_CACHX8_DEPTH);
+		}
+	}
+
+	utils_memory_secure_erase((uint8_t*)keys, HKDS_PARALLEL_DEPTH * sizeof(hkds_server_x8_keys));
+}
+
+static void hkds_server_x64_decrypt_task(void* context, size_t index)
+{
+	const hkds_server_x64_decrypt_context* ctx = (const hkds_server_x64_decrypt_context*)context;
+
+	hkds_server_decrypt_keys_x8(&ctx->state[index], ctx->keys[index], ctx->ciphertext[index], ctx->plaintext[index]);
+}
+
+static void hkds_server_x64_verify_task(void* context, size_t index)
+{
+	const hkds_server_x64_verify_context* ctx = (const hkds_server_x64_verify_context*)context;
+
+	hkds_server_decrypt_verify_keys_x8(&ctx->state[index], ctx->keys[index], ctx->ciphertext[index], ctx->data[index], ctx->datalen, ctx->plaintext[index], ctx->valid[index]);
+}
+
+static void hkds_server_x64_token_task(void* context, size_t index)
+{
+	const hkds_server_x64_token_context* ctx = (const hkds_server_x64_token_context*)context;
+
+	hkds_server_encrypt_token_keys_x8(&ctx->state[index], ctx->keys[index], ctx->etok[index]);
+}
+
+static void hkds_server_x64_edk_task(void* context, size_t index)
+{
+	const hkds_server_x64_edk_context* ctx = (const hkds_server_x64_edk_context*)context;
+
+	hkds_server_generate_edk_x8(&ctx->state[index], ctx->did[index], ctx->edk[index]);
+}
+
+static void hkds_server_x64_initialize_task(void* context, size_t index)
+{
+	const hkds_server_x64_initialize_context* ctx = (const hkds_server_x64_initialize_context*)context;
+
+	hkds_server_initialize_state_x8(&ctx->state[index], &ctx->mdk[index], ctx->ksn[index]);
+}
+
 void hkds_server_decrypt_message_x64(hkds_server_x8_state state[HKDS_PARALLEL_DEPTH], 
 	const uint8_t ciphertext[HKDS_PARALLEL_DEPTH][HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE], 
 	uint8_t plaintext[HKDS_PARALLEL_DEPTH][HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE])
@@ -641,13 +1563,14 @@ void hkds_server_decrypt_message_x64(hkds_server_x8_state state[HKDS_PARALLEL_DE
 
 	if (state != NULL && ciphertext != NULL && plaintext != NULL)
 	{
-		int32_t i;
-
-#pragma omp parallel for
-		for (i = 0; i < HKDS_PARALLEL_DEPTH; ++i)
-		{
-			hkds_server_decrypt_message_x8(&state[i], ciphertext[i], plaintext[i]);
-		}
+		hkds_server_x8_keys keys[HKDS_PARALLEL_DEPTH];
+		hkds_server_x8_keys* lkeys[HKDS_PARALLEL_DEPTH];
+		hkds_server_x64_decrypt_context ctx = { state, lkeys, ciphertext, plaintext };
+
+		/* only the derivations are distributed; the caches are not touched by the lanes */
+		hkds_server_x64_keys_find(state, keys, lkeys, false);
+		hkds_server_parallel_run(state[0U].pool, HKDS_PARALLEL_DEPTH, &hkds_server_x64_decrypt_task, &ctx);
+		hkds_server_x64_keys_insert(state, keys, lkeys);
 	}
 }
 
@@ -665,13 +1588,14 @@ void hkds_server_decrypt_verify_message_x64(hkds_server_x8_state state[HKDS_PARA
 
 	if (state != NULL && ciphertext != NULL && data != NULL && plaintext != NULL && valid != NULL)
 	{
-		int32_t i;
-
-#pragma omp parallel for
-		for (i = 0; i < HKDS_PARALLEL_DEPTH; ++i)
-		{
-			hkds_server_decrypt_verify_message_x8(&state[i], ciphertext[i], data[i], datalen, plaintext[i], valid[i]);
-		}
+		hkds_server_x8_keys keys[HKDS_PARALLEL_DEPTH];
+		hkds_server_x8_keys* lkeys[HKDS_PARALLEL_DEPTH];
+		hkds_server_x64_verify_context ctx = { state, lkeys, ciphertext, data, datalen, plaintext, valid };
+
+		/* only the derivations are distributed; the caches are not touched by the lanes */
+		hkds_server_x64_keys_find(state, keys, lkeys, false);
+		hkds_server_parallel_run(state[0U].pool, HKDS_PARALLEL_DEPTH, &hkds_server_x64_verify_task, &ctx);
+		hkds_server_x64_keys_insert(state, keys, lkeys);
 	}
 }
 
@@ -683,13 +1607,14 @@ void hkds_server_encrypt_token_x64(hkds_server_x8_state state[HKDS_PARALLEL_DEPT
 
 	if (state != NULL && etok != NULL)
 	{
-		int32_t i;
-
-#pragma omp parallel for
-		for (i = 0; i < HKDS_PARALLEL_DEPTH; ++i)
-		{
-			hkds_server_encrypt_token_x8(&state[i], etok[i]);
-		}
+		hkds_server_x8_keys keys[HKDS_PARALLEL_DEPTH];
+		hkds_server_x8_keys* lkeys[HKDS_PARALLEL_DEPTH];
+		hkds_server_x64_token_context ctx = { state, lkeys, etok };
+
+		/* only the derivations are distributed; the caches are not touched by the lanes */
+		hkds_server_x64_keys_find(state, keys, lkeys, true);
+		hkds_server_parallel_run(state[0U].pool, HKDS_PARALLEL_DEPTH, &hkds_server_x64_token_task, &ctx);
+		hkds_server_x64_keys_insert(state, keys, lkeys);
 	}
 }
 
@@ -703,13 +1628,9 @@ void hkds_server_generate_edk_x64(const hkds_server_x8_state state[HKDS_PARALLEL
 
 	if (state != NULL && did != NULL && edk != NULL)
 	{
-		int32_t i;
+		hkds_server_x64_edk_context ctx = { state, did, edk };
 
-#pragma omp parallel for
-		for (i = 0; i < HKDS_PARALLEL_DEPTH; ++i)
-		{
-			hkds_server_generate_edk_x8(&state[i], did[i], edk[i]);
-		}
+		hkds_server_parallel_run(state[0U].pool, HKDS_PARALLEL_DEPTH, &hkds_server_x64_edk_task, &ctx);
 	}
 }
 
@@ -723,14 +1644,9 @@ void hkds_server_initialize_state_x64(hkds_server_x8_state state[HKDS_PARALLEL_D
 
 	if (state != NULL && mdk != NULL && ksn != NULL)
 	{
-		int32_t i;
+		hkds_server_x64_initialize_context ctx = { state, mdk, ksn };
 
-#pragma omp parallel for
-		for (i = 0; i < HKDS_PARALLEL_DEPTH; ++i)
-		{
-			hkds_server_initialize_state_x8(&state[i], &mdk[i], ksn[i]);
-		}
+		/* the states are not yet initialized, so no pool is attached to them */
+		hkds_server_parallel_run(NULL, HKDS_PARALLEL_DEPTH, &hkds_server_x64_initialize_task, &ctx);
 	}
 }
-
-#endif
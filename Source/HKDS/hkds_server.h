@@ -53,6 +53,8 @@
 #define HKDS_SERVER_H
 
 #include "hkds_config.h"
+#include "hkds_cache.h"
+#include "hkds_pool.h"
 
 /**
  * \file hkds_server.h
@@ -92,13 +94,19 @@ HKDS_EXPORT_API typedef struct
  * - \c mdk: A pointer to the master key set used for deriving keys.
  * - \c count: The token or transaction count.
  * - \c rate: The output rate for the key derivation function (PRF).
+ * - \c kcache: An optional pointer to an epoch keystream cache, or NULL.
+ * - \c edktable: An optional pointer to an embedded device key table, or NULL.
+ * - \c tokenmemo: An optional pointer to an epoch token memo, or NULL.
  */
 HKDS_EXPORT_API typedef struct
 {
-    uint8_t ksn[HKDS_KSN_SIZE];  /*!< The key serial number array */
-    hkds_master_key* mdk;        /*!< A pointer to the master derivation key */
-    size_t count;                /*!< The token count */
-    size_t rate;                 /*!< The derivation function's rate */
+    uint8_t ksn[HKDS_KSN_SIZE];     /*!< The key serial number array */
+    hkds_master_key* mdk;           /*!< A pointer to the master derivation key */
+    size_t count;                   /*!< The token count */
+    size_t rate;                    /*!< The derivation function's rate */
+    hkds_keystream_cache* kcache;   /*!< An optional epoch keystream cache */
+    hkds_edk_table* edktable;       /*!< An optional embedded device key table */
+    hkds_token_memo* tokenmemo;     /*!< An optional epoch token memo */
 } hkds_server_state;
 
 /**
@@ -179,7 +187,7 @@ HKDS_EXPORT_API bool hkds_server_generate_mdk(bool (*rng_generate)(uint8_t*, siz
  *
  * \details
  * This function initializes the server state by copying the client's key serial number (KSN), assigning
- * the master key pointer, and initializing the token count and derivation rate.
+ * the master key pointer, and initializing the token count and derivation rate. No keystream cache is attached.
  *
  * \param state [in,out] Pointer to the HKDS server state.
  * \param mdk [in] Pointer to the master key set.
@@ -187,6 +195,62 @@ HKDS_EXPORT_API bool hkds_server_generate_mdk(bool (*rng_generate)(uint8_t*, siz
  */
 HKDS_EXPORT_API void hkds_server_initialize_state(hkds_server_state* state, hkds_master_key* mdk, const uint8_t* ksn);
 
+/**
+ * \brief Attach an epoch keystream cache to the server state.
+ *
+ * \details
+ * When a cache is attached, the message decryption functions derive the embedded device key, token,
+ * and key-stream once per device epoch, and serve subsequent transaction keys of that epoch from the cache.
+ * A cache serves the single master key set whose identity it was initialized with; a cache attached to a state with
+ * a different key identity is ignored. The state initialization function detaches the cache, so this function must
+ * be called after \ref hkds_server_initialize_state.
+ *
+ * \param state [in,out] Pointer to the HKDS server state.
+ * \param kcache [in] Pointer to an initialized keystream cache, or NULL to detach the cache.
+ */
+HKDS_EXPORT_API void hkds_server_set_keystream_cache(hkds_server_state* state, hkds_keystream_cache* kcache);
+
+/**
+ * \brief Attach an embedded device key table to the server state.
+ *
+ * \details
+ * When a table is attached, and its key identity matches the state's master key set, the decryption and
+ * token encryption functions take the device's EDK from the table instead of deriving it. Devices missing from
+ * the table are derived and added to it. The state initialization function detaches the table.
+ *
+ * \param state [in,out] Pointer to the HKDS server state.
+ * \param edktable [in] Pointer to an initialized EDK table, or NULL to detach the table.
+ */
+HKDS_EXPORT_API void hkds_server_set_edk_table(hkds_server_state* state, hkds_edk_table* edktable);
+
+/**
+ * \brief Attach an epoch token memo to the server state.
+ *
+ * \details
+ * When a memo is attached, and its key identity matches the state's master key set, the token encryption
+ * function stores each issued token, and the decryption functions take the epoch token from the memo instead
+ * of deriving it. Tokens missing from the memo are derived and added to it. The state initialization function
+ * detaches the memo.
+ *
+ * \param state [in,out] Pointer to the HKDS server state.
+ * \param tokenmemo [in] Pointer to an initialized token memo, or NULL to detach the memo.
+ */
+HKDS_EXPORT_API void hkds_server_set_token_memo(hkds_server_state* state, hkds_token_memo* tokenmemo);
+
+/**
+ * \brief Fill an embedded device key table with the keys of a device fleet.
+ *
+ * \details
+ * The keys are derived with the x8 EDK kernel, eight devices at a time.
+ *
+ * \param table [in,out] Pointer to an initialized EDK table.
+ * \param mdk [in] Pointer to the master key set; its key identity must match the table's.
+ * \param did [in] An array of device identity strings.
+ * \param count [in] The number of device identities.
+ * \return Returns true if every key was stored; false if the key identities differ or the table is full.
+ */
+HKDS_EXPORT_API bool hkds_server_load_edk_table(hkds_edk_table* table, hkds_master_key* mdk, const uint8_t did[][HKDS_DID_SIZE], size_t count);
+
 /* --- Parallel Vectorized x8 API --- */
 
 /*!
@@ -195,13 +259,17 @@ HKDS_EXPORT_API void hkds_server_initialize_state(hkds_server_state* state, hkds
  *
  * \details
  * This structure is used for vectorized (x8) operations in the server implementation, allowing simultaneous
- * processing of 8 client messages. It includes a 2-dimensional array of client key serial numbers (KSNs) and
- * a pointer to the master key set.
+ * processing of 8 client messages. It includes a 2-dimensional array of client key serial numbers (KSNs),
+ * a pointer to the master key set, optional pointers to an embedded device key table and an epoch token memo,
+ * and an optional worker thread pool used by the batch and x64 functions.
  */
 HKDS_EXPORT_API typedef struct
 {
     uint8_t ksn[HKDS_CACHX8_DEPTH][HKDS_KSN_SIZE];  /*!< The clients' key serial number 2D array */
     hkds_master_key* mdk;                           /*!< A pointer to the master derivation key structure */
+    hkds_edk_table* edktable;                       /*!< An optional embedded device key table */
+    hkds_token_memo* tokenmemo;                     /*!< An optional epoch token memo */
+    hkds_thread_pool* pool;                         /*!< An optional worker thread pool */
 } hkds_server_x8_state;
 
 /**
@@ -282,10 +350,110 @@ HKDS_EXPORT_API void hkds_server_initialize_state_x8(hkds_server_x8_state* state
     hkds_master_key* mdk, 
     const uint8_t ksn[HKDS_CACHX8_DEPTH][HKDS_KSN_SIZE]);
 
-#if defined(HKDS_SYSTEM_OPENMP)
+/**
+ * \brief Attach an embedded device key table to the x8 server state.
+ *
+ * \details
+ * The table is not synchronized; the x64 and batch functions make its lookups and inserts on the calling thread,
+ * and distribute only the key derivations.
+ * The state initialization function detaches the table.
+ *
+ * \param state [in,out] Pointer to the HKDS x8 server state.
+ * \param edktable [in] Pointer to an initialized EDK table, or NULL to detach the table.
+ */
+HKDS_EXPORT_API void hkds_server_set_edk_table_x8(hkds_server_x8_state* state, hkds_edk_table* edktable);
+
+/**
+ * \brief Attach an epoch token memo to the x8 server state.
+ *
+ * \details
+ * The memo is not synchronized; the x64 and batch functions make its lookups and inserts on the calling thread,
+ * and distribute only the key derivations.
+ * The state initialization function detaches the memo.
+ *
+ * \param state [in,out] Pointer to the HKDS x8 server state.
+ * \param tokenmemo [in] Pointer to an initialized token memo, or NULL to detach the memo.
+ */
+HKDS_EXPORT_API void hkds_server_set_token_memo_x8(hkds_server_x8_state* state, hkds_token_memo* tokenmemo);
+
+/**
+ * \brief Attach a worker thread pool to the x8 server state.
+ *
+ * \details
+ * The batch functions run their x8 groups on the pool attached to the template state, and the x64 functions
+ * on the pool attached to the first state of the set. Without a pool, the groups are shared with OpenMP
+ * when it is enabled, or processed in sequence. The derivation cache lookups and inserts are made on the calling
+ * thread before and after the groups run. The state initialization function detaches the pool.
+ *
+ * \param state [in,out] Pointer to the HKDS x8 server state.
+ * \param pool [in] Pointer to an initialized thread pool, or NULL to detach the pool.
+ */
+HKDS_EXPORT_API void hkds_server_set_thread_pool_x8(hkds_server_x8_state* state, hkds_thread_pool* pool);
+
+/* --- Arbitrary Length Batch API --- */
+
+/**
+ * \brief Decrypt a batch of client messages of any length.
+ *
+ * \details
+ * The batch is processed in consecutive slices of up to 64 messages, each planned on the stack, so the function
+ * does not allocate memory. The requests of a slice are grouped by device and epoch, so the EDK, token and key-stream
+ * of each unique device epoch are derived once and serve every message in the slice that maps to it. The unique derivations
+ * are packed into groups of eight and derived with the x8 kernels, squeezing only to the deepest key each group
+ * uses; the unused lanes of a partial final group repeat its first derivation, and their output is discarded.
+ * The groups are distributed across the thread pool attached to the template state, or across cores with OpenMP
+ * when no pool is attached; the lookups and inserts of any attached derivation cache are made on the calling thread.
+ *
+ * \param state [in] Pointer to a template x8 server state that supplies the master key set and any attached caches;
+ * its KSN array is not used.
+ * \param count [in] The number of messages in the batch.
+ * \param ksn [in] An array of pointers to the clients' key serial numbers.
+ * \param ciphertext [in] An array of pointers to the encrypted messages.
+ * \param plaintext [out] An array of pointers to the buffers that receive the decrypted messages.
+ * \return Returns false if the batch is empty or a parameter is invalid.
+ */
+HKDS_EXPORT_API bool hkds_server_decrypt_batch(const hkds_server_x8_state* state, size_t count,
+    const uint8_t* const ksn[],
+    const uint8_t* const ciphertext[],
+    uint8_t* const plaintext[]);
+
+/**
+ * \brief Verify and decrypt a batch of authenticated client messages of any length.
+ *
+ * \details
+ * The batch is processed in consecutive slices of up to 64 messages, each planned on the stack, so the function
+ * does not allocate memory. The requests of a slice are grouped by device and epoch, so the EDK, token and key-stream
+ * of each unique device epoch are derived once and serve every message in the slice that maps to it. The unique derivations
+ * are packed into groups of eight and derived with the x8 kernels, and the MAC checks of each group are computed
+ * eight messages at a time. The groups are distributed across the thread pool attached to the template state,
+ * or across cores with OpenMP when no pool is attached; the lookups and inserts of any attached derivation cache
+ * are made on the calling thread.
+ *
+ * \param state [in] Pointer to a template x8 server state that supplies the master key set and any attached caches;
+ * its KSN array is not used.
+ * \param count [in] The number of messages in the batch.
+ * \param ksn [in] An array of pointers to the clients' key serial numbers.
+ * \param ciphertext [in] An array of pointers to the encrypted messages, each with an appended MAC tag.
+ * \param data [in] An array of pointers to the additional data for MAC computation.
+ * \param datalen [in] The length of each additional data array; at most \c HKDS_MESSAGE_SIZE bytes.
+ * \param plaintext [out] An array of pointers to the buffers that receive the decrypted messages.
+ * \param valid [out] An array receiving the verification status of each message.
+ * \return Returns false if the batch is empty or a parameter is invalid.
+ */
+HKDS_EXPORT_API bool hkds_server_decrypt_verify_batch(const hkds_server_x8_state* state, size_t count,
+    const uint8_t* const ksn[],
+    const uint8_t* const ciphertext[],
+    const uint8_t* const data[], size_t datalen,
+    uint8_t* const plaintext[],
+    bool valid[]);
 
 /* --- Parallel SIMD Vectorized x64 API --- */
 
+/*
+ * The x64 functions run their eight x8 groups on the thread pool attached to the first state of the set,
+ * or with OpenMP when no pool is attached, or in sequence when neither is available.
+ */
+
 /**
  * \brief Decrypt a 3-dimensional 8x8 set of client messages.
  *
@@ -362,4 +530,3 @@ HKDS_EXPORT_API void hkds_server_initialize_state_x64(hkds_server_x8_state state
     const uint8_t ksn[HKDS_PARALLEL_DEPTH][HKDS_CACHX8_DEPTH][HKDS_KSN_SIZE]);
 
 #endif
-#endif
@@ -80,9 +80,9 @@ static size_t keccak_right_encode(uint8_t* buffer, size_t value)
 	return n + 1U;
 }
 
-#if defined(HKDS_SYSTEM_HAS_AVX512)
+#if defined(HKDS_KECCAK_AVX512_KERNELS)
 
-static void hkds_keccak_permute_p8x1600(__m512i state[HKDS_KECCAK_STATE_SIZE], size_t rounds)
+static HKDS_TARGET_AVX512 void hkds_keccak_permute_p8x1600(__m512i state[HKDS_KECCAK_STATE_SIZE], size_t rounds)
 {
 	HKDS_ASSERT(rounds % 2U == 0U);
 
@@ -381,9 +381,9 @@ static void hkds_keccak_permute_p8x1600(__m512i state[HKDS_KECCAK_STATE_SIZE], s
 
 #endif
 
-#if defined(HKDS_SYSTEM_HAS_AVX2)
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
 
-static void hkds_keccak_permute_p4x1600(__m256i state[HKDS_KECCAK_STATE_SIZE], size_t rounds)
+static HKDS_TARGET_AVX2 void hkds_keccak_permute_p4x1600(__m256i state[HKDS_KECCAK_STATE_SIZE], size_t rounds)
 {
 	HKDS_ASSERT(rounds % 2U == 0U);
 
@@ -1189,6 +1189,16 @@ void hkds_keccak_permute(hkds_keccak_state* ctx, size_t rounds)
 	}
 }
 
+void hkds_keccak_permute_lanes(uint64_t* state, size_t rounds)
+{
+	HKDS_ASSERT(state != NULL);
+
+	if (state != NULL)
+	{
+		hkds_keccak_permute_p1600c(state, rounds);
+	}
+}
+
 void hkds_keccak_squeezeblocks(hkds_keccak_state* ctx, uint8_t* output, size_t nblocks, hkds_keccak_rate rate, size_t rounds)
 {
 	HKDS_ASSERT(ctx != NULL);
@@ -1430,9 +1440,9 @@ void hkds_kmac_update(hkds_keccak_state* ctx, hkds_keccak_rate rate, const uint8
 
 /* parallel SHAKE x4 */
 
-#if defined(HKDS_SYSTEM_HAS_AVX2)
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
 
-void hkds_keccakx4_absorb(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
+HKDS_TARGET_AVX2 void hkds_keccakx4_absorb(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
 	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3, size_t inplen, uint8_t domain)
 {
 	HKDS_ASSERT(inp0 != NULL);
@@ -1519,7 +1529,7 @@ void hkds_keccakx4_absorb(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rat
 	}
 }
 
-void hkds_keccakx4_squeezeblocks(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
+HKDS_TARGET_AVX2 void hkds_keccakx4_squeezeblocks(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
 	uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t nblocks)
 {
 	HKDS_ASSERT(out0 != NULL);
@@ -1557,12 +1567,12 @@ void hkds_keccakx4_squeezeblocks(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_kec
 
 #endif
 
-#if defined(HKDS_SYSTEM_HAS_AVX512)
+#if defined(HKDS_KECCAK_AVX512_KERNELS)
 
 #define _mm512_extract_epi64x(b, i) ( \
         _mm_extract_epi64(_mm512_extracti64x2_epi64(b, i / 2), i % 2))
 
-void hkds_keccakx8_absorb(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
+HKDS_TARGET_AVX512 void hkds_keccakx8_absorb(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
 	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
 	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7, size_t inplen, uint8_t domain)
 {
@@ -1675,7 +1685,7 @@ void hkds_keccakx8_absorb(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rat
 	}
 }
 
-void hkds_keccakx8_squeezeblocks(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
+HKDS_TARGET_AVX512 void hkds_keccakx8_squeezeblocks(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
 	uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, uint8_t* out4,
 	uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t nblocks)
 {
@@ -1728,22 +1738,11 @@ void hkds_keccakx8_squeezeblocks(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_kec
 
 #endif
 
-void hkds_shake_128x4(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
+
+static HKDS_TARGET_AVX2 void hkds_shake_128x4_avx2(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
 	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3, size_t inplen)
 {
-	HKDS_ASSERT(inp0 != NULL);
-	HKDS_ASSERT(inp1 != NULL);
-	HKDS_ASSERT(inp2 != NULL);
-	HKDS_ASSERT(inp3 != NULL);
-	HKDS_ASSERT(out0 != NULL);
-	HKDS_ASSERT(out1 != NULL);
-	HKDS_ASSERT(out2 != NULL);
-	HKDS_ASSERT(out3 != NULL);
-	HKDS_ASSERT(inplen != 0U);
-	HKDS_ASSERT(outlen != 0U);
-
-#if defined(HKDS_SYSTEM_HAS_AVX2)
-
 	size_t i;
 	size_t nblocks = outlen / HKDS_KECCAK_128_RATE;
 	HKDS_ALIGN(32) uint8_t t[4U][HKDS_KECCAK_128_RATE] = { 0U };
@@ -1774,33 +1773,24 @@ void hkds_shake_128x4(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3
 			out3[i] = t[3U][i];
 		}
 	}
+}
 
-#else
+#endif
 
+static void hkds_shake_128x4_scalar(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3, size_t inplen)
+{
 	hkds_shake128_compute(out0, outlen, inp0, inplen);
 	hkds_shake128_compute(out1, outlen, inp1, inplen);
 	hkds_shake128_compute(out2, outlen, inp2, inplen);
 	hkds_shake128_compute(out3, outlen, inp3, inplen);
-
-#endif
 }
 
-void hkds_shake_256x4(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
+
+static HKDS_TARGET_AVX2 void hkds_shake_256x4_avx2(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
 	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3, size_t inplen)
 {
-	HKDS_ASSERT(inp0 != NULL);
-	HKDS_ASSERT(inp1 != NULL);
-	HKDS_ASSERT(inp2 != NULL);
-	HKDS_ASSERT(inp3 != NULL);
-	HKDS_ASSERT(out0 != NULL);
-	HKDS_ASSERT(out1 != NULL);
-	HKDS_ASSERT(out2 != NULL);
-	HKDS_ASSERT(out3 != NULL);
-	HKDS_ASSERT(inplen != 0U);
-	HKDS_ASSERT(outlen != 0U);
-
-#if defined(HKDS_SYSTEM_HAS_AVX2)
-
 	size_t nblocks = outlen / HKDS_KECCAK_256_RATE;
 	HKDS_ALIGN(32) uint8_t t[4U][HKDS_KECCAK_256_RATE] = { 0U };
 	HKDS_ALIGN(32) __m256i state[HKDS_KECCAK_STATE_SIZE] = { 0U };
@@ -1830,33 +1820,24 @@ void hkds_shake_256x4(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3
 			out3[i] = t[3U][i];
 		}
 	}
+}
 
-#else
+#endif
 
+static void hkds_shake_256x4_scalar(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3, size_t inplen)
+{
 	hkds_shake256_compute(out0, outlen, inp0, inplen);
 	hkds_shake256_compute(out1, outlen, inp1, inplen);
 	hkds_shake256_compute(out2, outlen, inp2, inplen);
 	hkds_shake256_compute(out3, outlen, inp3, inplen);
-
-#endif
 }
 
-void hkds_shake_512x4(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
+
+static HKDS_TARGET_AVX2 void hkds_shake_512x4_avx2(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
 	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3, size_t inplen)
 {
-	HKDS_ASSERT(inp0 != NULL);
-	HKDS_ASSERT(inp1 != NULL);
-	HKDS_ASSERT(inp2 != NULL);
-	HKDS_ASSERT(inp3 != NULL);
-	HKDS_ASSERT(out0 != NULL);
-	HKDS_ASSERT(out1 != NULL);
-	HKDS_ASSERT(out2 != NULL);
-	HKDS_ASSERT(out3 != NULL);
-	HKDS_ASSERT(inplen != 0U);
-	HKDS_ASSERT(outlen != 0U);
-
-#if defined(HKDS_SYSTEM_HAS_AVX2)
-
 	size_t nblocks = outlen / HKDS_KECCAK_512_RATE;
 	HKDS_ALIGN(32) uint8_t t[4U][HKDS_KECCAK_512_RATE] = { 0U };
 	HKDS_ALIGN(32) __m256i state[HKDS_KECCAK_STATE_SIZE] = { 0U };
@@ -1886,45 +1867,28 @@ void hkds_shake_512x4(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3
 			out3[i] = t[3U][i];
 		}
 	}
+}
 
-#else
+#endif
 
+static void hkds_shake_512x4_scalar(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3, size_t inplen)
+{
 	hkds_shake512_compute(out0, outlen, inp0, inplen);
 	hkds_shake512_compute(out1, outlen, inp1, inplen);
 	hkds_shake512_compute(out2, outlen, inp2, inplen);
 	hkds_shake512_compute(out3, outlen, inp3, inplen);
-
-#endif
 }
 
 /* parallel shake x8 */
 
-void hkds_shake_128x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+#if defined(HKDS_KECCAK_AVX512_KERNELS)
+
+static HKDS_TARGET_AVX512 void hkds_shake_128x8_avx512(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
 	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
 	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
 	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7, size_t inplen)
 {
-	HKDS_ASSERT(inp0 != NULL);
-	HKDS_ASSERT(inp1 != NULL);
-	HKDS_ASSERT(inp2 != NULL);
-	HKDS_ASSERT(inp3 != NULL);
-	HKDS_ASSERT(inp4 != NULL);
-	HKDS_ASSERT(inp5 != NULL);
-	HKDS_ASSERT(inp6 != NULL);
-	HKDS_ASSERT(inp7 != NULL);
-	HKDS_ASSERT(out0 != NULL);
-	HKDS_ASSERT(out1 != NULL);
-	HKDS_ASSERT(out2 != NULL);
-	HKDS_ASSERT(out3 != NULL);
-	HKDS_ASSERT(out4 != NULL);
-	HKDS_ASSERT(out5 != NULL);
-	HKDS_ASSERT(out6 != NULL);
-	HKDS_ASSERT(out7 != NULL);
-	HKDS_ASSERT(inplen != 0U);
-	HKDS_ASSERT(outlen != 0U);
-
-#if defined(HKDS_SYSTEM_HAS_AVX512)
-
 	size_t nblocks = outlen / HKDS_KECCAK_128_RATE;
 	HKDS_ALIGN(64) uint8_t t[8U][HKDS_KECCAK_128_RATE] = { 0U };
 	HKDS_ALIGN(64) __m512i state[HKDS_KECCAK_STATE_SIZE] = { 0U };
@@ -1962,14 +1926,28 @@ void hkds_shake_128x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3
 			out7[i] = t[7U][i];
 		}
 	}
+}
 
-#elif defined(HKDS_SYSTEM_HAS_AVX2)
+#endif
 
-	hkds_shake_128x4(out0, out1, out2, out3, outlen, inp0, inp1, inp2, inp3, inplen);
-	hkds_shake_128x4(out4, out5, out6, out7, outlen, inp4, inp5, inp6, inp7, inplen);
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
 
-#else
+static HKDS_TARGET_AVX2 void hkds_shake_128x8_avx2(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
+	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7, size_t inplen)
+{
+	hkds_shake_128x4_avx2(out0, out1, out2, out3, outlen, inp0, inp1, inp2, inp3, inplen);
+	hkds_shake_128x4_avx2(out4, out5, out6, out7, outlen, inp4, inp5, inp6, inp7, inplen);
+}
 
+#endif
+
+static void hkds_shake_128x8_scalar(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
+	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7, size_t inplen)
+{
 	hkds_shake128_compute(out0, outlen, inp0, inplen);
 	hkds_shake128_compute(out1, outlen, inp1, inplen);
 	hkds_shake128_compute(out2, outlen, inp2, inplen);
@@ -1978,36 +1956,15 @@ void hkds_shake_128x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3
 	hkds_shake128_compute(out5, outlen, inp5, inplen);
 	hkds_shake128_compute(out6, outlen, inp6, inplen);
 	hkds_shake128_compute(out7, outlen, inp7, inplen);
-
-#endif
 }
 
-void hkds_shake_256x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+#if defined(HKDS_KECCAK_AVX512_KERNELS)
+
+static HKDS_TARGET_AVX512 void hkds_shake_256x8_avx512(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
 	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
 	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
 	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7, size_t inplen)
 {
-	HKDS_ASSERT(inp0 != NULL);
-	HKDS_ASSERT(inp1 != NULL);
-	HKDS_ASSERT(inp2 != NULL);
-	HKDS_ASSERT(inp3 != NULL);
-	HKDS_ASSERT(inp4 != NULL);
-	HKDS_ASSERT(inp5 != NULL);
-	HKDS_ASSERT(inp6 != NULL);
-	HKDS_ASSERT(inp7 != NULL);
-	HKDS_ASSERT(out0 != NULL);
-	HKDS_ASSERT(out1 != NULL);
-	HKDS_ASSERT(out2 != NULL);
-	HKDS_ASSERT(out3 != NULL);
-	HKDS_ASSERT(out4 != NULL);
-	HKDS_ASSERT(out5 != NULL);
-	HKDS_ASSERT(out6 != NULL);
-	HKDS_ASSERT(out7 != NULL);
-	HKDS_ASSERT(inplen != 0U);
-	HKDS_ASSERT(outlen != 0U);
-
-#if defined(HKDS_SYSTEM_HAS_AVX512)
-
 	size_t nblocks = outlen / HKDS_KECCAK_256_RATE;
 	HKDS_ALIGN(64) uint8_t t[8U][HKDS_KECCAK_256_RATE] = { 0U };
 	HKDS_ALIGN(64) __m512i state[HKDS_KECCAK_STATE_SIZE] = { 0U };
@@ -2045,14 +2002,28 @@ void hkds_shake_256x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3
 			out7[i] = t[7U][i];
 		}
 	}
+}
 
-#elif defined(HKDS_SYSTEM_HAS_AVX2)
+#endif
 
-	hkds_shake_256x4(out0, out1, out2, out3, outlen, inp0, inp1, inp2, inp3, inplen);
-	hkds_shake_256x4(out4, out5, out6, out7, outlen, inp4, inp5, inp6, inp7, inplen);
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
 
-#else
+static HKDS_TARGET_AVX2 void hkds_shake_256x8_avx2(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
+	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7, size_t inplen)
+{
+	hkds_shake_256x4_avx2(out0, out1, out2, out3, outlen, inp0, inp1, inp2, inp3, inplen);
+	hkds_shake_256x4_avx2(out4, out5, out6, out7, outlen, inp4, inp5, inp6, inp7, inplen);
+}
 
+#endif
+
+static void hkds_shake_256x8_scalar(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
+	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7, size_t inplen)
+{
 	hkds_shake256_compute(out0, outlen, inp0, inplen);
 	hkds_shake256_compute(out1, outlen, inp1, inplen);
 	hkds_shake256_compute(out2, outlen, inp2, inplen);
@@ -2061,36 +2032,15 @@ void hkds_shake_256x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3
 	hkds_shake256_compute(out5, outlen, inp5, inplen);
 	hkds_shake256_compute(out6, outlen, inp6, inplen);
 	hkds_shake256_compute(out7, outlen, inp7, inplen);
-
-#endif
 }
 
-void hkds_shake_512x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+#if defined(HKDS_KECCAK_AVX512_KERNELS)
+
+static HKDS_TARGET_AVX512 void hkds_shake_512x8_avx512(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
 	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
 	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
 	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7, size_t inplen)
 {
-	HKDS_ASSERT(inp0 != NULL);
-	HKDS_ASSERT(inp1 != NULL);
-	HKDS_ASSERT(inp2 != NULL);
-	HKDS_ASSERT(inp3 != NULL);
-	HKDS_ASSERT(inp4 != NULL);
-	HKDS_ASSERT(inp5 != NULL);
-	HKDS_ASSERT(inp6 != NULL);
-	HKDS_ASSERT(inp7 != NULL);
-	HKDS_ASSERT(out0 != NULL);
-	HKDS_ASSERT(out1 != NULL);
-	HKDS_ASSERT(out2 != NULL);
-	HKDS_ASSERT(out3 != NULL);
-	HKDS_ASSERT(out4 != NULL);
-	HKDS_ASSERT(out5 != NULL);
-	HKDS_ASSERT(out6 != NULL);
-	HKDS_ASSERT(out7 != NULL);
-	HKDS_ASSERT(inplen != 0U);
-	HKDS_ASSERT(outlen != 0U);
-
-#if defined(HKDS_SYSTEM_HAS_AVX512)
-
 	size_t nblocks = outlen / HKDS_KECCAK_512_RATE;
 	HKDS_ALIGN(64) uint8_t t[8U][HKDS_KECCAK_512_RATE] = { 0U };
 	HKDS_ALIGN(64) __m512i state[HKDS_KECCAK_STATE_SIZE] = { 0U };
@@ -2128,14 +2078,28 @@ void hkds_shake_512x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3
 			out7[i] = t[7U][i];
 		}
 	}
+}
 
-#elif defined(HKDS_SYSTEM_HAS_AVX2)
+#endif
 
-	hkds_shake_512x4(out0, out1, out2, out3, outlen, inp0, inp1, inp2, inp3, inplen);
-	hkds_shake_512x4(out4, out5, out6, out7, outlen, inp4, inp5, inp6, inp7, inplen);
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
 
-#else
+static HKDS_TARGET_AVX2 void hkds_shake_512x8_avx2(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
+	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7, size_t inplen)
+{
+	hkds_shake_512x4_avx2(out0, out1, out2, out3, outlen, inp0, inp1, inp2, inp3, inplen);
+	hkds_shake_512x4_avx2(out4, out5, out6, out7, outlen, inp4, inp5, inp6, inp7, inplen);
+}
 
+#endif
+
+static void hkds_shake_512x8_scalar(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
+	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7, size_t inplen)
+{
 	hkds_shake512_compute(out0, outlen, inp0, inplen);
 	hkds_shake512_compute(out1, outlen, inp1, inplen);
 	hkds_shake512_compute(out2, outlen, inp2, inplen);
@@ -2144,15 +2108,13 @@ void hkds_shake_512x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3
 	hkds_shake512_compute(out5, outlen, inp5, inplen);
 	hkds_shake512_compute(out6, outlen, inp6, inplen);
 	hkds_shake512_compute(out7, outlen, inp7, inplen);
-
-#endif
 }
 
 /* parallel kmac x4 */
 
-#if defined(HKDS_SYSTEM_HAS_AVX2)
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
 
-static void kmacx4_fast_absorb(__m256i state[HKDS_KECCAK_STATE_SIZE], const uint8_t* inp0, const uint8_t* inp1,
+static HKDS_TARGET_AVX2 void kmacx4_fast_absorb(__m256i state[HKDS_KECCAK_STATE_SIZE], const uint8_t* inp0, const uint8_t* inp1,
 	const uint8_t* inp2, const uint8_t* inp3, size_t inplen)
 {
 	__m256i t;
@@ -2174,7 +2136,7 @@ static void kmacx4_fast_absorb(__m256i state[HKDS_KECCAK_STATE_SIZE], const uint
 	}
 }
 
-static void kmacx4_customize(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
+static HKDS_TARGET_AVX2 void kmacx4_customize(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
 	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3, size_t keylen,
 	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3, size_t cstlen,
 	const uint8_t* name, size_t nmelen)
@@ -2256,7 +2218,7 @@ static void kmacx4_customize(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_
 	hkds_keccak_permute_p4x1600(state, HKDS_KECCAK_PERMUTATION_ROUNDS);
 }
 
-static void kmacx4_finalize(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
+static HKDS_TARGET_AVX2 void kmacx4_finalize(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
 	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3, size_t msglen,
 	uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen)
 {
@@ -2332,128 +2294,92 @@ static void kmacx4_finalize(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_r
 
 #endif
 
-void hkds_kmac_128x4(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
+
+static HKDS_TARGET_AVX2 void hkds_kmac_128x4_avx2(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
 	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3, size_t keylen,
 	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3, size_t cstlen,
 	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3, size_t msglen)
 {
-	HKDS_ASSERT(key0 != NULL);
-	HKDS_ASSERT(key1 != NULL);
-	HKDS_ASSERT(key2 != NULL);
-	HKDS_ASSERT(key3 != NULL);
-	HKDS_ASSERT(msg0 != NULL);
-	HKDS_ASSERT(msg1 != NULL);
-	HKDS_ASSERT(msg2 != NULL);
-	HKDS_ASSERT(msg3 != NULL);
-	HKDS_ASSERT(out0 != NULL);
-	HKDS_ASSERT(out1 != NULL);
-	HKDS_ASSERT(out2 != NULL);
-	HKDS_ASSERT(out3 != NULL);
-	HKDS_ASSERT(keylen != 0U);
-	HKDS_ASSERT(msglen != 0U);
-	HKDS_ASSERT(outlen != 0U);
-
-#if defined(HKDS_SYSTEM_HAS_AVX2)
-
 	HKDS_ALIGN(32) __m256i state[HKDS_KECCAK_STATE_SIZE] = { 0U };
 	const HKDS_ALIGN(32) uint8_t name[] = { 0x4BU, 0x4DU, 0x41U, 0x43U };
 
 	kmacx4_customize(state, hkds_keccak_rate_128, key0, key1, key2, key3, keylen, cst0, cst1, cst2, cst3, cstlen, name, sizeof(name));
 	kmacx4_finalize(state, hkds_keccak_rate_128, msg0, msg1, msg2, msg3, msglen, out0, out1, out2, out3, outlen);
+}
 
-#else
+#endif
 
+static void hkds_kmac_128x4_scalar(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3, size_t keylen,
+	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3, size_t cstlen,
+	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3, size_t msglen)
+{
 	hkds_kmac128_compute(out0, outlen, msg0, msglen, key0, keylen, cst0, cstlen);
 	hkds_kmac128_compute(out1, outlen, msg1, msglen, key1, keylen, cst1, cstlen);
 	hkds_kmac128_compute(out2, outlen, msg2, msglen, key2, keylen, cst2, cstlen);
 	hkds_kmac128_compute(out3, outlen, msg3, msglen, key3, keylen, cst3, cstlen);
-
-#endif
 }
 
-void hkds_kmac_256x4(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
+
+static HKDS_TARGET_AVX2 void hkds_kmac_256x4_avx2(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
 	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3, size_t keylen,
 	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3, size_t cstlen,
 	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3, size_t msglen)
 {
-	HKDS_ASSERT(key0 != NULL);
-	HKDS_ASSERT(key1 != NULL);
-	HKDS_ASSERT(key2 != NULL);
-	HKDS_ASSERT(key3 != NULL);
-	HKDS_ASSERT(msg0 != NULL);
-	HKDS_ASSERT(msg1 != NULL);
-	HKDS_ASSERT(msg2 != NULL);
-	HKDS_ASSERT(msg3 != NULL);
-	HKDS_ASSERT(out0 != NULL);
-	HKDS_ASSERT(out1 != NULL);
-	HKDS_ASSERT(out2 != NULL);
-	HKDS_ASSERT(out3 != NULL);
-	HKDS_ASSERT(keylen != 0U);
-	HKDS_ASSERT(msglen != 0U);
-	HKDS_ASSERT(outlen != 0U);
-
-#if defined(HKDS_SYSTEM_HAS_AVX2)
-
 	HKDS_ALIGN(32) __m256i state[HKDS_KECCAK_STATE_SIZE] = { 0U };
 	const uint8_t HKDS_ALIGN(32) name[] = { 0x4BU, 0x4DU, 0x41U, 0x43U };
 
 	kmacx4_customize(state, hkds_keccak_rate_256, key0, key1, key2, key3, keylen, cst0, cst1, cst2, cst3, cstlen, name, sizeof(name));
 	kmacx4_finalize(state, hkds_keccak_rate_256, msg0, msg1, msg2, msg3, msglen, out0, out1, out2, out3, outlen);
+}
 
-#else
+#endif
 
+static void hkds_kmac_256x4_scalar(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3, size_t keylen,
+	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3, size_t cstlen,
+	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3, size_t msglen)
+{
 	hkds_kmac256_compute(out0, outlen, msg0, msglen, key0, keylen, cst0, cstlen);
 	hkds_kmac256_compute(out1, outlen, msg1, msglen, key1, keylen, cst1, cstlen);
 	hkds_kmac256_compute(out2, outlen, msg2, msglen, key2, keylen, cst2, cstlen);
 	hkds_kmac256_compute(out3, outlen, msg3, msglen, key3, keylen, cst3, cstlen);
-
-#endif
 }
 
-void hkds_kmac_512x4(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
+
+static HKDS_TARGET_AVX2 void hkds_kmac_512x4_avx2(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
 	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3, size_t keylen,
 	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3, size_t cstlen,
 	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3, size_t msglen)
 {
-	HKDS_ASSERT(key0 != NULL);
-	HKDS_ASSERT(key1 != NULL);
-	HKDS_ASSERT(key2 != NULL);
-	HKDS_ASSERT(key3 != NULL);
-	HKDS_ASSERT(msg0 != NULL);
-	HKDS_ASSERT(msg1 != NULL);
-	HKDS_ASSERT(msg2 != NULL);
-	HKDS_ASSERT(msg3 != NULL);
-	HKDS_ASSERT(out0 != NULL);
-	HKDS_ASSERT(out1 != NULL);
-	HKDS_ASSERT(out2 != NULL);
-	HKDS_ASSERT(out3 != NULL);
-	HKDS_ASSERT(keylen != 0U);
-	HKDS_ASSERT(msglen != 0U);
-	HKDS_ASSERT(outlen != 0U);
-
-#if defined(HKDS_SYSTEM_HAS_AVX2)
-
 	HKDS_ALIGN(32) __m256i state[HKDS_KECCAK_STATE_SIZE] = { 0U };
 	const HKDS_ALIGN(32) uint8_t name[] = { 0x4BU, 0x4DU, 0x41U, 0x43U };
 
 	kmacx4_customize(state, hkds_keccak_rate_512, key0, key1, key2, key3, keylen, cst0, cst1, cst2, cst3, cstlen, name, sizeof(name));
 	kmacx4_finalize(state, hkds_keccak_rate_512, msg0, msg1, msg2, msg3, msglen, out0, out1, out2, out3, outlen);
+}
 
-#else
+#endif
 
+static void hkds_kmac_512x4_scalar(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3, size_t keylen,
+	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3, size_t cstlen,
+	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3, size_t msglen)
+{
 	hkds_kmac512_compute(out0, outlen, msg0, msglen, key0, keylen, cst0, cstlen);
 	hkds_kmac512_compute(out1, outlen, msg1, msglen, key1, keylen, cst1, cstlen);
 	hkds_kmac512_compute(out2, outlen, msg2, msglen, key2, keylen, cst2, cstlen);
 	hkds_kmac512_compute(out3, outlen, msg3, msglen, key3, keylen, cst3, cstlen);
-
-#endif
 }
 
 /* parallel kmac x8 */
 
-#if defined(HKDS_SYSTEM_HAS_AVX512)
+#if defined(HKDS_KECCAK_AVX512_KERNELS)
 
-static void kmacx8_fast_absorb(__m512i state[HKDS_KECCAK_STATE_SIZE],
+static HKDS_TARGET_AVX512 void kmacx8_fast_absorb(__m512i state[HKDS_KECCAK_STATE_SIZE],
 	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
 	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7,
 	size_t inplen)
@@ -2481,7 +2407,7 @@ static void kmacx8_fast_absorb(__m512i state[HKDS_KECCAK_STATE_SIZE],
 	}
 }
 
-static void kmacx8_customize(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
+static HKDS_TARGET_AVX512 void kmacx8_customize(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
 	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3,
 	const uint8_t* key4, const uint8_t* key5, const uint8_t* key6, const uint8_t* key7, size_t keylen,
 	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3,
@@ -2580,7 +2506,7 @@ static void kmacx8_customize(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_
 	hkds_keccak_permute_p8x1600(state, HKDS_KECCAK_PERMUTATION_ROUNDS);
 }
 
-static void kmacx8_finalize(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
+static HKDS_TARGET_AVX512 void kmacx8_finalize(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
 	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3,
 	const uint8_t* msg4, const uint8_t* msg5, const uint8_t* msg6, const uint8_t* msg7, size_t msglen,
 	uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
@@ -2677,7 +2603,9 @@ static void kmacx8_finalize(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_r
 
 #endif
 
-void hkds_kmac_128x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+#if defined(HKDS_KECCAK_AVX512_KERNELS)
+
+static HKDS_TARGET_AVX512 void hkds_kmac_128x8_avx512(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
 	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
 	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3,
 	const uint8_t* key4, const uint8_t* key5, const uint8_t* key6, const uint8_t* key7, size_t keylen,
@@ -2686,36 +2614,6 @@ void hkds_kmac_128x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
 	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3,
 	const uint8_t* msg4, const uint8_t* msg5, const uint8_t* msg6, const uint8_t* msg7, size_t msglen)
 {
-	HKDS_ASSERT(key0 != NULL);
-	HKDS_ASSERT(key1 != NULL);
-	HKDS_ASSERT(key2 != NULL);
-	HKDS_ASSERT(key3 != NULL);
-	HKDS_ASSERT(key4 != NULL);
-	HKDS_ASSERT(key5 != NULL);
-	HKDS_ASSERT(key6 != NULL);
-	HKDS_ASSERT(key7 != NULL);
-	HKDS_ASSERT(msg0 != NULL);
-	HKDS_ASSERT(msg1 != NULL);
-	HKDS_ASSERT(msg2 != NULL);
-	HKDS_ASSERT(msg3 != NULL);
-	HKDS_ASSERT(msg4 != NULL);
-	HKDS_ASSERT(msg5 != NULL);
-	HKDS_ASSERT(msg6 != NULL);
-	HKDS_ASSERT(msg7 != NULL);
-	HKDS_ASSERT(out0 != NULL);
-	HKDS_ASSERT(out1 != NULL);
-	HKDS_ASSERT(out2 != NULL);
-	HKDS_ASSERT(out3 != NULL);
-	HKDS_ASSERT(out4 != NULL);
-	HKDS_ASSERT(out5 != NULL);
-	HKDS_ASSERT(out6 != NULL);
-	HKDS_ASSERT(out7 != NULL);
-	HKDS_ASSERT(keylen != 0U);
-	HKDS_ASSERT(msglen != 0U);
-	HKDS_ASSERT(outlen != 0U);
-
-#if defined(HKDS_SYSTEM_HAS_AVX512)
-
 	HKDS_ALIGN(64) __m512i state[HKDS_KECCAK_STATE_SIZE] = { 0U };
 	const HKDS_ALIGN(64) uint8_t name[] = { 0x4BU, 0x4DU, 0x41U, 0x43U };
 
@@ -2723,16 +2621,38 @@ void hkds_kmac_128x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
 		cst0, cst1, cst2, cst3, cst4, cst5, cst6, cst7, cstlen, name, sizeof(name));
 	kmacx8_finalize(state, hkds_keccak_rate_128, msg0, msg1, msg2, msg3, msg4, msg5, msg6, msg7, msglen,
 		out0, out1, out2, out3, out4, out5, out6, out7, outlen);
+}
 
-#elif defined(HKDS_SYSTEM_HAS_AVX2)
+#endif
 
-	hkds_kmac_128x4(out0, out1, out2, out3, outlen, key0, key1, key2, key3, keylen,
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
+
+static HKDS_TARGET_AVX2 void hkds_kmac_128x8_avx2(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3,
+	const uint8_t* key4, const uint8_t* key5, const uint8_t* key6, const uint8_t* key7, size_t keylen,
+	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3,
+	const uint8_t* cst4, const uint8_t* cst5, const uint8_t* cst6, const uint8_t* cst7, size_t cstlen,
+	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3,
+	const uint8_t* msg4, const uint8_t* msg5, const uint8_t* msg6, const uint8_t* msg7, size_t msglen)
+{
+	hkds_kmac_128x4_avx2(out0, out1, out2, out3, outlen, key0, key1, key2, key3, keylen,
 		cst0, cst1, cst2, cst3, cstlen, msg0, msg1, msg2, msg3, msglen);
-	hkds_kmac_128x4(out4, out5, out6, out7, outlen, key4, key5, key6, key7, keylen,
+	hkds_kmac_128x4_avx2(out4, out5, out6, out7, outlen, key4, key5, key6, key7, keylen,
 		cst4, cst5, cst6, cst7, cstlen, msg4, msg5, msg6, msg7, msglen);
+}
 
-#else
+#endif
 
+static void hkds_kmac_128x8_scalar(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3,
+	const uint8_t* key4, const uint8_t* key5, const uint8_t* key6, const uint8_t* key7, size_t keylen,
+	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3,
+	const uint8_t* cst4, const uint8_t* cst5, const uint8_t* cst6, const uint8_t* cst7, size_t cstlen,
+	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3,
+	const uint8_t* msg4, const uint8_t* msg5, const uint8_t* msg6, const uint8_t* msg7, size_t msglen)
+{
 	hkds_kmac128_compute(out0, outlen, msg0, msglen, key0, keylen, cst0, cstlen);
 	hkds_kmac128_compute(out1, outlen, msg1, msglen, key1, keylen, cst1, cstlen);
 	hkds_kmac128_compute(out2, outlen, msg2, msglen, key2, keylen, cst2, cstlen);
@@ -2741,11 +2661,11 @@ void hkds_kmac_128x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
 	hkds_kmac128_compute(out5, outlen, msg5, msglen, key5, keylen, cst5, cstlen);
 	hkds_kmac128_compute(out6, outlen, msg6, msglen, key6, keylen, cst6, cstlen);
 	hkds_kmac128_compute(out7, outlen, msg7, msglen, key7, keylen, cst7, cstlen);
-
-#endif
 }
 
-void hkds_kmac_256x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+#if defined(HKDS_KECCAK_AVX512_KERNELS)
+
+static HKDS_TARGET_AVX512 void hkds_kmac_256x8_avx512(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
 	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
 	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3,
 	const uint8_t* key4, const uint8_t* key5, const uint8_t* key6, const uint8_t* key7, size_t keylen,
@@ -2754,36 +2674,6 @@ void hkds_kmac_256x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
 	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3,
 	const uint8_t* msg4, const uint8_t* msg5, const uint8_t* msg6, const uint8_t* msg7, size_t msglen)
 {
-	HKDS_ASSERT(key0 != NULL);
-	HKDS_ASSERT(key1 != NULL);
-	HKDS_ASSERT(key2 != NULL);
-	HKDS_ASSERT(key3 != NULL);
-	HKDS_ASSERT(key4 != NULL);
-	HKDS_ASSERT(key5 != NULL);
-	HKDS_ASSERT(key6 != NULL);
-	HKDS_ASSERT(key7 != NULL);
-	HKDS_ASSERT(msg0 != NULL);
-	HKDS_ASSERT(msg1 != NULL);
-	HKDS_ASSERT(msg2 != NULL);
-	HKDS_ASSERT(msg3 != NULL);
-	HKDS_ASSERT(msg4 != NULL);
-	HKDS_ASSERT(msg5 != NULL);
-	HKDS_ASSERT(msg6 != NULL);
-	HKDS_ASSERT(msg7 != NULL);
-	HKDS_ASSERT(out0 != NULL);
-	HKDS_ASSERT(out1 != NULL);
-	HKDS_ASSERT(out2 != NULL);
-	HKDS_ASSERT(out3 != NULL);
-	HKDS_ASSERT(out4 != NULL);
-	HKDS_ASSERT(out5 != NULL);
-	HKDS_ASSERT(out6 != NULL);
-	HKDS_ASSERT(out7 != NULL);
-	HKDS_ASSERT(keylen != 0U);
-	HKDS_ASSERT(msglen != 0U);
-	HKDS_ASSERT(outlen != 0U);
-
-#if defined(HKDS_SYSTEM_HAS_AVX512)
-
 	HKDS_ALIGN(64) __m512i state[HKDS_KECCAK_STATE_SIZE] = { 0U };
 	const HKDS_ALIGN(64) uint8_t name[] = { 0x4BU, 0x4DU, 0x41U, 0x43U };
 
@@ -2791,16 +2681,38 @@ void hkds_kmac_256x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
 		cst0, cst1, cst2, cst3, cst4, cst5, cst6, cst7, cstlen, name, sizeof(name));
 	kmacx8_finalize(state, hkds_keccak_rate_256, msg0, msg1, msg2, msg3, msg4, msg5, msg6, msg7, msglen,
 		out0, out1, out2, out3, out4, out5, out6, out7, outlen);
+}
 
-#elif defined(HKDS_SYSTEM_HAS_AVX2)
+#endif
+
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
 
-	hkds_kmac_256x4(out0, out1, out2, out3, outlen, key0, key1, key2, key3, keylen,
+static HKDS_TARGET_AVX2 void hkds_kmac_256x8_avx2(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3,
+	const uint8_t* key4, const uint8_t* key5, const uint8_t* key6, const uint8_t* key7, size_t keylen,
+	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3,
+	const uint8_t* cst4, const uint8_t* cst5, const uint8_t* cst6, const uint8_t* cst7, size_t cstlen,
+	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3,
+	const uint8_t* msg4, const uint8_t* msg5, const uint8_t* msg6, const uint8_t* msg7, size_t msglen)
+{
+	hkds_kmac_256x4_avx2(out0, out1, out2, out3, outlen, key0, key1, key2, key3, keylen,
 		cst0, cst1, cst2, cst3, cstlen, msg0, msg1, msg2, msg3, msglen);
-	hkds_kmac_256x4(out4, out5, out6, out7, outlen, key4, key5, key6, key7, keylen,
+	hkds_kmac_256x4_avx2(out4, out5, out6, out7, outlen, key4, key5, key6, key7, keylen,
 		cst4, cst5, cst6, cst7, cstlen, msg4, msg5, msg6, msg7, msglen);
+}
 
-#else
+#endif
 
+static void hkds_kmac_256x8_scalar(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3,
+	const uint8_t* key4, const uint8_t* key5, const uint8_t* key6, const uint8_t* key7, size_t keylen,
+	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3,
+	const uint8_t* cst4, const uint8_t* cst5, const uint8_t* cst6, const uint8_t* cst7, size_t cstlen,
+	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3,
+	const uint8_t* msg4, const uint8_t* msg5, const uint8_t* msg6, const uint8_t* msg7, size_t msglen)
+{
 	hkds_kmac256_compute(out0, outlen, msg0, msglen, key0, keylen, cst0, cstlen);
 	hkds_kmac256_compute(out1, outlen, msg1, msglen, key1, keylen, cst1, cstlen);
 	hkds_kmac256_compute(out2, outlen, msg2, msglen, key2, keylen, cst2, cstlen);
@@ -2809,11 +2721,11 @@ void hkds_kmac_256x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
 	hkds_kmac256_compute(out5, outlen, msg5, msglen, key5, keylen, cst5, cstlen);
 	hkds_kmac256_compute(out6, outlen, msg6, msglen, key6, keylen, cst6, cstlen);
 	hkds_kmac256_compute(out7, outlen, msg7, msglen, key7, keylen, cst7, cstlen);
-
-#endif
 }
 
-void hkds_kmac_512x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+#if defined(HKDS_KECCAK_AVX512_KERNELS)
+
+static HKDS_TARGET_AVX512 void hkds_kmac_512x8_avx512(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
 	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
 	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3,
 	const uint8_t* key4, const uint8_t* key5, const uint8_t* key6, const uint8_t* key7, size_t keylen,
@@ -2822,36 +2734,6 @@ void hkds_kmac_512x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
 	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3,
 	const uint8_t* msg4, const uint8_t* msg5, const uint8_t* msg6, const uint8_t* msg7, size_t msglen)
 {
-	HKDS_ASSERT(key0 != NULL);
-	HKDS_ASSERT(key1 != NULL);
-	HKDS_ASSERT(key2 != NULL);
-	HKDS_ASSERT(key3 != NULL);
-	HKDS_ASSERT(key4 != NULL);
-	HKDS_ASSERT(key5 != NULL);
-	HKDS_ASSERT(key6 != NULL);
-	HKDS_ASSERT(key7 != NULL);
-	HKDS_ASSERT(msg0 != NULL);
-	HKDS_ASSERT(msg1 != NULL);
-	HKDS_ASSERT(msg2 != NULL);
-	HKDS_ASSERT(msg3 != NULL);
-	HKDS_ASSERT(msg4 != NULL);
-	HKDS_ASSERT(msg5 != NULL);
-	HKDS_ASSERT(msg6 != NULL);
-	HKDS_ASSERT(msg7 != NULL);
-	HKDS_ASSERT(out0 != NULL);
-	HKDS_ASSERT(out1 != NULL);
-	HKDS_ASSERT(out2 != NULL);
-	HKDS_ASSERT(out3 != NULL);
-	HKDS_ASSERT(out4 != NULL);
-	HKDS_ASSERT(out5 != NULL);
-	HKDS_ASSERT(out6 != NULL);
-	HKDS_ASSERT(out7 != NULL);
-	HKDS_ASSERT(keylen != 0U);
-	HKDS_ASSERT(msglen != 0U);
-	HKDS_ASSERT(outlen != 0U);
-
-#if defined(HKDS_SYSTEM_HAS_AVX512)
-
 	HKDS_ALIGN(64) __m512i state[HKDS_KECCAK_STATE_SIZE] = { 0U };
 	const HKDS_ALIGN(64) uint8_t name[] = { 0x4BU, 0x4DU, 0x41U, 0x43U };
 
@@ -2859,16 +2741,38 @@ void hkds_kmac_512x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
 		cst0, cst1, cst2, cst3, cst4, cst5, cst6, cst7, cstlen, name, sizeof(name));
 	kmacx8_finalize(state, hkds_keccak_rate_512, msg0, msg1, msg2, msg3, msg4, msg5, msg6, msg7, msglen,
 		out0, out1, out2, out3, out4, out5, out6, out7, outlen);
+}
 
-#elif defined(HKDS_SYSTEM_HAS_AVX2)
+#endif
 
-	hkds_kmac_512x4(out0, out1, out2, out3, outlen, key0, key1, key2, key3, keylen,
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
+
+static HKDS_TARGET_AVX2 void hkds_kmac_512x8_avx2(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3,
+	const uint8_t* key4, const uint8_t* key5, const uint8_t* key6, const uint8_t* key7, size_t keylen,
+	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3,
+	const uint8_t* cst4, const uint8_t* cst5, const uint8_t* cst6, const uint8_t* cst7, size_t cstlen,
+	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3,
+	const uint8_t* msg4, const uint8_t* msg5, const uint8_t* msg6, const uint8_t* msg7, size_t msglen)
+{
+	hkds_kmac_512x4_avx2(out0, out1, out2, out3, outlen, key0, key1, key2, key3, keylen,
 		cst0, cst1, cst2, cst3, cstlen, msg0, msg1, msg2, msg3, msglen);
-	hkds_kmac_512x4(out4, out5, out6, out7, outlen, key4, key5, key6, key7, keylen,
+	hkds_kmac_512x4_avx2(out4, out5, out6, out7, outlen, key4, key5, key6, key7, keylen,
 		cst4, cst5, cst6, cst7, cstlen, msg4, msg5, msg6, msg7, msglen);
+}
 
-#else
+#endif
 
+static void hkds_kmac_512x8_scalar(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3,
+	const uint8_t* key4, const uint8_t* key5, const uint8_t* key6, const uint8_t* key7, size_t keylen,
+	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3,
+	const uint8_t* cst4, const uint8_t* cst5, const uint8_t* cst6, const uint8_t* cst7, size_t cstlen,
+	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3,
+	const uint8_t* msg4, const uint8_t* msg5, const uint8_t* msg6, const uint8_t* msg7, size_t msglen)
+{
 	hkds_kmac512_compute(out0, outlen, msg0, msglen, key0, keylen, cst0, cstlen);
 	hkds_kmac512_compute(out1, outlen, msg1, msglen, key1, keylen, cst1, cstlen);
 	hkds_kmac512_compute(out2, outlen, msg2, msglen, key2, keylen, cst2, cstlen);
@@ -2877,6 +2781,778 @@ void hkds_kmac_512x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
 	hkds_kmac512_compute(out5, outlen, msg5, msglen, key5, keylen, cst5, cstlen);
 	hkds_kmac512_compute(out6, outlen, msg6, msglen, key6, keylen, cst6, cstlen);
 	hkds_kmac512_compute(out7, outlen, msg7, msglen, key7, keylen, cst7, cstlen);
+}
+
+/* chained SHAKE x8 */
+
+#if defined(HKDS_KECCAK_AVX512_KERNELS)
+
+static HKDS_TARGET_AVX512 void hkds_shake_chain_x8_avx512(hkds_keccak_rate rate, uint8_t* const output[HKDS_KECCAK_CHAIN_LANES], size_t outlen,
+	const uint8_t* const first[HKDS_KECCAK_CHAIN_LANES], size_t firstlen, size_t firstout,
+	const uint8_t* const second[HKDS_KECCAK_CHAIN_LANES], size_t secondlen, size_t secondout)
+{
+	HKDS_ALIGN(64) __m512i sa[HKDS_KECCAK_STATE_SIZE] = { 0U };
+	HKDS_ALIGN(64) __m512i sb[HKDS_KECCAK_STATE_SIZE] = { 0U };
+	HKDS_ALIGN(64) __m512i sc[HKDS_KECCAK_STATE_SIZE] = { 0U };
+	HKDS_ALIGN(64) uint8_t t[8U][HKDS_KECCAK_STATE_BYTE_SIZE] = { 0U };
+	uint8_t* pout[8U];
+	size_t nblocks;
+	size_t pos;
+	size_t rw;
+	size_t i;
+
+	rw = (size_t)rate / sizeof(uint64_t);
+
+	/* both inner instances are absorbed and permuted once; their output words are the first rate words of the state */
+	hkds_keccakx8_absorb(sa, rate, first[0U], first[1U], first[2U], first[3U], first[4U], first[5U], first[6U], first[7U], firstlen, HKDS_KECCAK_SHAKE_DOMAIN_ID);
+	hkds_keccakx8_absorb(sb, rate, second[0U], second[1U], second[2U], second[3U], second[4U], second[5U], second[6U], second[7U], secondlen, HKDS_KECCAK_SHAKE_DOMAIN_ID);
+	hkds_keccak_permute_p8x1600(sa, HKDS_KECCAK_PERMUTATION_ROUNDS);
+	hkds_keccak_permute_p8x1600(sb, HKDS_KECCAK_PERMUTATION_ROUNDS);
+
+	/* the outer instance absorbs the inner output words directly from the lane registers */
+	pos = 0U;
+
+	for (i = 0U; i < firstout / sizeof(uint64_t); ++i)
+	{
+		sc[pos] = _mm512_xor_si512(sc[pos], sa[i]);
+		++pos;
+
+		if (pos == rw)
+		{
+			hkds_keccak_permute_p8x1600(sc, HKDS_KECCAK_PERMUTATION_ROUNDS);
+			pos = 0U;
+		}
+	}
+
+	for (i = 0U; i < secondout / sizeof(uint64_t); ++i)
+	{
+		sc[pos] = _mm512_xor_si512(sc[pos], sb[i]);
+		++pos;
+
+		if (pos == rw)
+		{
+			hkds_keccak_permute_p8x1600(sc, HKDS_KECCAK_PERMUTATION_ROUNDS);
+			pos = 0U;
+		}
+	}
+
+	sc[pos] = _mm512_xor_si512(sc[pos], _mm512_set1_epi64((int64_t)HKDS_KECCAK_SHAKE_DOMAIN_ID));
+	sc[rw - 1U] = _mm512_xor_si512(sc[rw - 1U], _mm512_set1_epi64((int64_t)(1ULL << 63)));
+
+	for (i = 0U; i < 8U; ++i)
+	{
+		pout[i] = output[i];
+	}
+
+	nblocks = outlen / (size_t)rate;
+
+	if (nblocks != 0U)
+	{
+		hkds_keccakx8_squeezeblocks(sc, rate, pout[0U], pout[1U], pout[2U], pout[3U], pout[4U], pout[5U], pout[6U], pout[7U], nblocks);
+
+		for (i = 0U; i < 8U; ++i)
+		{
+			pout[i] += nblocks * (size_t)rate;
+		}
+
+		outlen -= nblocks * (size_t)rate;
+	}
+
+	if (outlen != 0U)
+	{
+		hkds_keccakx8_squeezeblocks(sc, rate, t[0U], t[1U], t[2U], t[3U], t[4U], t[5U], t[6U], t[7U], 1U);
+
+		for (i = 0U; i < 8U; ++i)
+		{
+			utils_memory_copy(pout[i], t[i], outlen);
+		}
+	}
+
+	utils_memory_secure_erase(t, sizeof(t));
+	utils_memory_secure_erase(sa, sizeof(sa));
+	utils_memory_secure_erase(sb, sizeof(sb));
+	utils_memory_secure_erase(sc, sizeof(sc));
+}
 
 #endif
+
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
+
+static HKDS_TARGET_AVX2 void hkds_shake_chain_x4_avx2(hkds_keccak_rate rate, uint8_t* const output[4U], size_t outlen,
+	const uint8_t* const first[4U], size_t firstlen, size_t firstout,
+	const uint8_t* const second[4U], size_t secondlen, size_t secondout)
+{
+	HKDS_ALIGN(32) __m256i sa[HKDS_KECCAK_STATE_SIZE] = { 0U };
+	HKDS_ALIGN(32) __m256i sb[HKDS_KECCAK_STATE_SIZE] = { 0U };
+	HKDS_ALIGN(32) __m256i sc[HKDS_KECCAK_STATE_SIZE] = { 0U };
+	HKDS_ALIGN(32) uint8_t t[4U][HKDS_KECCAK_STATE_BYTE_SIZE] = { 0U };
+	uint8_t* pout[4U];
+	size_t nblocks;
+	size_t pos;
+	size_t rw;
+	size_t i;
+
+	rw = (size_t)rate / sizeof(uint64_t);
+
+	hkds_keccakx4_absorb(sa, rate, first[0U], first[1U], first[2U], first[3U], firstlen, HKDS_KECCAK_SHAKE_DOMAIN_ID);
+	hkds_keccakx4_absorb(sb, rate, second[0U], second[1U], second[2U], second[3U], secondlen, HKDS_KECCAK_SHAKE_DOMAIN_ID);
+	hkds_keccak_permute_p4x1600(sa, HKDS_KECCAK_PERMUTATION_ROUNDS);
+	hkds_keccak_permute_p4x1600(sb, HKDS_KECCAK_PERMUTATION_ROUNDS);
+
+	pos = 0U;
+
+	for (i = 0U; i < firstout / sizeof(uint64_t); ++i)
+	{
+		sc[pos] = _mm256_xor_si256(sc[pos], sa[i]);
+		++pos;
+
+		if (pos == rw)
+		{
+			hkds_keccak_permute_p4x1600(sc, HKDS_KECCAK_PERMUTATION_ROUNDS);
+			pos = 0U;
+		}
+	}
+
+	for (i = 0U; i < secondout / sizeof(uint64_t); ++i)
+	{
+		sc[pos] = _mm256_xor_si256(sc[pos], sb[i]);
+		++pos;
+
+		if (pos == rw)
+		{
+			hkds_keccak_permute_p4x1600(sc, HKDS_KECCAK_PERMUTATION_ROUNDS);
+			pos = 0U;
+		}
+	}
+
+	sc[pos] = _mm256_xor_si256(sc[pos], _mm256_set1_epi64x((int64_t)HKDS_KECCAK_SHAKE_DOMAIN_ID));
+	sc[rw - 1U] = _mm256_xor_si256(sc[rw - 1U], _mm256_set1_epi64x((int64_t)(1ULL << 63)));
+
+	for (i = 0U; i < 4U; ++i)
+	{
+		pout[i] = output[i];
+	}
+
+	nblocks = outlen / (size_t)rate;
+
+	if (nblocks != 0U)
+	{
+		hkds_keccakx4_squeezeblocks(sc, rate, pout[0U], pout[1U], pout[2U], pout[3U], nblocks);
+
+		for (i = 0U; i < 4U; ++i)
+		{
+			pout[i] += nblocks * (size_t)rate;
+		}
+
+		outlen -= nblocks * (size_t)rate;
+	}
+
+	if (outlen != 0U)
+	{
+		hkds_keccakx4_squeezeblocks(sc, rate, t[0U], t[1U], t[2U], t[3U], 1U);
+
+		for (i = 0U; i < 4U; ++i)
+		{
+			utils_memory_copy(pout[i], t[i], outlen);
+		}
+	}
+
+	utils_memory_secure_erase(t, sizeof(t));
+	utils_memory_secure_erase(sa, sizeof(sa));
+	utils_memory_secure_erase(sb, sizeof(sb));
+	utils_memory_secure_erase(sc, sizeof(sc));
+}
+
+static HKDS_TARGET_AVX2 void hkds_shake_chain_x8_avx2(hkds_keccak_rate rate, uint8_t* const output[HKDS_KECCAK_CHAIN_LANES], size_t outlen,
+	const uint8_t* const first[HKDS_KECCAK_CHAIN_LANES], size_t firstlen, size_t firstout,
+	const uint8_t* const second[HKDS_KECCAK_CHAIN_LANES], size_t secondlen, size_t secondout)
+{
+	hkds_shake_chain_x4_avx2(rate, output, outlen, first, firstlen, firstout, second, secondlen, secondout);
+	hkds_shake_chain_x4_avx2(rate, output + 4U, outlen, first + 4U, firstlen, firstout, second + 4U, secondlen, secondout);
+}
+
+#endif
+
+static void hkds_shake_chain_compute(hkds_keccak_rate rate, uint8_t* output, size_t outlen, const uint8_t* input, size_t inplen)
+{
+	if (rate == hkds_keccak_rate_128)
+	{
+		hkds_shake128_compute(output, outlen, input, inplen);
+	}
+	else if (rate == hkds_keccak_rate_256)
+	{
+		hkds_shake256_compute(output, outlen, input, inplen);
+	}
+	else
+	{
+		hkds_shake512_compute(output, outlen, input, inplen);
+	}
+}
+
+static void hkds_shake_chain_x8_scalar(hkds_keccak_rate rate, uint8_t* const output[HKDS_KECCAK_CHAIN_LANES], size_t outlen,
+	const uint8_t* const first[HKDS_KECCAK_CHAIN_LANES], size_t firstlen, size_t firstout,
+	const uint8_t* const second[HKDS_KECCAK_CHAIN_LANES], size_t secondlen, size_t secondout)
+{
+	uint8_t tmpk[2U * HKDS_KECCAK_STATE_BYTE_SIZE] = { 0U };
+
+	for (size_t i = 0U; i < HKDS_KECCAK_CHAIN_LANES; ++i)
+	{
+		hkds_shake_chain_compute(rate, tmpk, firstout, first[i], firstlen);
+		hkds_shake_chain_compute(rate, tmpk + firstout, secondout, second[i], secondlen);
+		hkds_shake_chain_compute(rate, output[i], outlen, tmpk, firstout + secondout);
+	}
+
+	utils_memory_secure_erase(tmpk, sizeof(tmpk));
+}
+
+/* multi-lane kernel dispatch */
+
+typedef void (*keccak_shakex4_function)(uint8_t*, uint8_t*, uint8_t*, uint8_t*, size_t,
+	const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*, size_t);
+
+typedef void (*keccak_shakex8_function)(uint8_t*, uint8_t*, uint8_t*, uint8_t*,
+	uint8_t*, uint8_t*, uint8_t*, uint8_t*, size_t,
+	const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*,
+	const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*, size_t);
+
+typedef void (*keccak_kmacx4_function)(uint8_t*, uint8_t*, uint8_t*, uint8_t*, size_t,
+	const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*, size_t,
+	const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*, size_t,
+	const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*, size_t);
+
+typedef void (*keccak_kmacx8_function)(uint8_t*, uint8_t*, uint8_t*, uint8_t*,
+	uint8_t*, uint8_t*, uint8_t*, uint8_t*, size_t,
+	const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*,
+	const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*, size_t,
+	const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*,
+	const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*, size_t,
+	const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*,
+	const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*, size_t);
+
+typedef void (*keccak_shake_chain_function)(hkds_keccak_rate, uint8_t* const[HKDS_KECCAK_CHAIN_LANES], size_t,
+	const uint8_t* const[HKDS_KECCAK_CHAIN_LANES], size_t, size_t,
+	const uint8_t* const[HKDS_KECCAK_CHAIN_LANES], size_t, size_t);
+
+typedef struct
+{
+	keccak_shakex4_function shake128x4;
+	keccak_shakex4_function shake256x4;
+	keccak_shakex4_function shake512x4;
+	keccak_shakex8_function shake128x8;
+	keccak_shakex8_function shake256x8;
+	keccak_shakex8_function shake512x8;
+	keccak_kmacx4_function kmac128x4;
+	keccak_kmacx4_function kmac256x4;
+	keccak_kmacx4_function kmac512x4;
+	keccak_kmacx8_function kmac128x8;
+	keccak_kmacx8_function kmac256x8;
+	keccak_kmacx8_function kmac512x8;
+	keccak_shake_chain_function shakechainx8;
+} keccak_dispatch_table;
+
+static const keccak_dispatch_table KECCAK_DISPATCH_SCALAR =
+{
+	&hkds_shake_128x4_scalar, &hkds_shake_256x4_scalar, &hkds_shake_512x4_scalar,
+	&hkds_shake_128x8_scalar, &hkds_shake_256x8_scalar, &hkds_shake_512x8_scalar,
+	&hkds_kmac_128x4_scalar, &hkds_kmac_256x4_scalar, &hkds_kmac_512x4_scalar,
+	&hkds_kmac_128x8_scalar, &hkds_kmac_256x8_scalar, &hkds_kmac_512x8_scalar,
+	&hkds_shake_chain_x8_scalar
+};
+
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
+static const keccak_dispatch_table KECCAK_DISPATCH_AVX2 =
+{
+	&hkds_shake_128x4_avx2, &hkds_shake_256x4_avx2, &hkds_shake_512x4_avx2,
+	&hkds_shake_128x8_avx2, &hkds_shake_256x8_avx2, &hkds_shake_512x8_avx2,
+	&hkds_kmac_128x4_avx2, &hkds_kmac_256x4_avx2, &hkds_kmac_512x4_avx2,
+	&hkds_kmac_128x8_avx2, &hkds_kmac_256x8_avx2, &hkds_kmac_512x8_avx2,
+	&hkds_shake_chain_x8_avx2
+};
+#endif
+
+#if defined(HKDS_KECCAK_AVX512_KERNELS)
+/* the x4 functions have no 8-lane form, so they keep the AVX2 kernels */
+static const keccak_dispatch_table KECCAK_DISPATCH_AVX512 =
+{
+	&hkds_shake_128x4_avx2, &hkds_shake_256x4_avx2, &hkds_shake_512x4_avx2,
+	&hkds_shake_128x8_avx512, &hkds_shake_256x8_avx512, &hkds_shake_512x8_avx512,
+	&hkds_kmac_128x4_avx2, &hkds_kmac_256x4_avx2, &hkds_kmac_512x4_avx2,
+	&hkds_kmac_128x8_avx512, &hkds_kmac_256x8_avx512, &hkds_kmac_512x8_avx512,
+	&hkds_shake_chain_x8_avx512
+};
+#endif
+
+/* the tables start at the compile-time instruction set, so the functions are usable before the processor is queried */
+#if defined(HKDS_SYSTEM_HAS_AVX512)
+static const keccak_dispatch_table* keccak_dispatch = &KECCAK_DISPATCH_AVX512;
+static hkds_keccak_simd_level keccak_simd_supported = hkds_keccak_simd_avx512;
+static hkds_keccak_simd_level keccak_simd_active = hkds_keccak_simd_avx512;
+#elif defined(HKDS_SYSTEM_HAS_AVX2)
+static const keccak_dispatch_table* keccak_dispatch = &KECCAK_DISPATCH_AVX2;
+static hkds_keccak_simd_level keccak_simd_supported = hkds_keccak_simd_avx2;
+static hkds_keccak_simd_level keccak_simd_active = hkds_keccak_simd_avx2;
+#else
+static const keccak_dispatch_table* keccak_dispatch = &KECCAK_DISPATCH_SCALAR;
+static hkds_keccak_simd_level keccak_simd_supported = hkds_keccak_simd_none;
+static hkds_keccak_simd_level keccak_simd_active = hkds_keccak_simd_none;
+#endif
+
+static void keccak_dispatch_select(hkds_keccak_simd_level level)
+{
+	keccak_dispatch = &KECCAK_DISPATCH_SCALAR;
+
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
+	if (level == hkds_keccak_simd_avx2)
+	{
+		keccak_dispatch = &KECCAK_DISPATCH_AVX2;
+	}
+#endif
+#if defined(HKDS_KECCAK_AVX512_KERNELS)
+	if (level == hkds_keccak_simd_avx512)
+	{
+		keccak_dispatch = &KECCAK_DISPATCH_AVX512;
+	}
+#endif
+
+	keccak_simd_active = level;
+}
+
+#if defined(HKDS_SYSTEM_RUNTIME_DISPATCH)
+
+static void keccak_dispatch_initialize(void) __attribute__((constructor));
+
+static void keccak_dispatch_initialize(void)
+{
+	/* runs once at load time, before any thread can call the multi-lane functions;
+	   the builtins read cpuid, and report a feature only when the operating system saves its registers */
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx512f") != 0)
+	{
+		keccak_simd_supported = hkds_keccak_simd_avx512;
+	}
+	else if (__builtin_cpu_supports("avx2") != 0)
+	{
+		keccak_simd_supported = hkds_keccak_simd_avx2;
+	}
+	else
+	{
+		keccak_simd_supported = hkds_keccak_simd_none;
+	}
+
+	keccak_dispatch_select(keccak_simd_supported);
+}
+
+#endif
+
+hkds_keccak_simd_level hkds_keccak_simd_get_level(void)
+{
+	return keccak_simd_active;
+}
+
+hkds_keccak_simd_level hkds_keccak_simd_get_supported(void)
+{
+	return keccak_simd_supported;
+}
+
+bool hkds_keccak_simd_set_level(hkds_keccak_simd_level level)
+{
+	bool res;
+
+	res = false;
+
+	if (level <= keccak_simd_supported)
+	{
+		keccak_dispatch_select(level);
+		res = true;
+	}
+
+	return res;
+}
+
+/* parallel SHAKE and KMAC */
+
+void hkds_shake_128x4(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3, size_t inplen)
+{
+	HKDS_ASSERT(inp0 != NULL);
+	HKDS_ASSERT(inp1 != NULL);
+	HKDS_ASSERT(inp2 != NULL);
+	HKDS_ASSERT(inp3 != NULL);
+	HKDS_ASSERT(out0 != NULL);
+	HKDS_ASSERT(out1 != NULL);
+	HKDS_ASSERT(out2 != NULL);
+	HKDS_ASSERT(out3 != NULL);
+	HKDS_ASSERT(inplen != 0U);
+	HKDS_ASSERT(outlen != 0U);
+
+	keccak_dispatch->shake128x4(out0, out1, out2, out3, outlen,
+		inp0, inp1, inp2, inp3, inplen);
+}
+
+void hkds_shake_256x4(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3, size_t inplen)
+{
+	HKDS_ASSERT(inp0 != NULL);
+	HKDS_ASSERT(inp1 != NULL);
+	HKDS_ASSERT(inp2 != NULL);
+	HKDS_ASSERT(inp3 != NULL);
+	HKDS_ASSERT(out0 != NULL);
+	HKDS_ASSERT(out1 != NULL);
+	HKDS_ASSERT(out2 != NULL);
+	HKDS_ASSERT(out3 != NULL);
+	HKDS_ASSERT(inplen != 0U);
+	HKDS_ASSERT(outlen != 0U);
+
+	keccak_dispatch->shake256x4(out0, out1, out2, out3, outlen,
+		inp0, inp1, inp2, inp3, inplen);
+}
+
+void hkds_shake_512x4(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3, size_t inplen)
+{
+	HKDS_ASSERT(inp0 != NULL);
+	HKDS_ASSERT(inp1 != NULL);
+	HKDS_ASSERT(inp2 != NULL);
+	HKDS_ASSERT(inp3 != NULL);
+	HKDS_ASSERT(out0 != NULL);
+	HKDS_ASSERT(out1 != NULL);
+	HKDS_ASSERT(out2 != NULL);
+	HKDS_ASSERT(out3 != NULL);
+	HKDS_ASSERT(inplen != 0U);
+	HKDS_ASSERT(outlen != 0U);
+
+	keccak_dispatch->shake512x4(out0, out1, out2, out3, outlen,
+		inp0, inp1, inp2, inp3, inplen);
+}
+
+void hkds_shake_128x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
+	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7, size_t inplen)
+{
+	HKDS_ASSERT(inp0 != NULL);
+	HKDS_ASSERT(inp1 != NULL);
+	HKDS_ASSERT(inp2 != NULL);
+	HKDS_ASSERT(inp3 != NULL);
+	HKDS_ASSERT(inp4 != NULL);
+	HKDS_ASSERT(inp5 != NULL);
+	HKDS_ASSERT(inp6 != NULL);
+	HKDS_ASSERT(inp7 != NULL);
+	HKDS_ASSERT(out0 != NULL);
+	HKDS_ASSERT(out1 != NULL);
+	HKDS_ASSERT(out2 != NULL);
+	HKDS_ASSERT(out3 != NULL);
+	HKDS_ASSERT(out4 != NULL);
+	HKDS_ASSERT(out5 != NULL);
+	HKDS_ASSERT(out6 != NULL);
+	HKDS_ASSERT(out7 != NULL);
+	HKDS_ASSERT(inplen != 0U);
+	HKDS_ASSERT(outlen != 0U);
+
+	keccak_dispatch->shake128x8(out0, out1, out2, out3,
+		out4, out5, out6, out7, outlen,
+		inp0, inp1, inp2, inp3,
+		inp4, inp5, inp6, inp7, inplen);
+}
+
+void hkds_shake_256x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
+	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7, size_t inplen)
+{
+	HKDS_ASSERT(inp0 != NULL);
+	HKDS_ASSERT(inp1 != NULL);
+	HKDS_ASSERT(inp2 != NULL);
+	HKDS_ASSERT(inp3 != NULL);
+	HKDS_ASSERT(inp4 != NULL);
+	HKDS_ASSERT(inp5 != NULL);
+	HKDS_ASSERT(inp6 != NULL);
+	HKDS_ASSERT(inp7 != NULL);
+	HKDS_ASSERT(out0 != NULL);
+	HKDS_ASSERT(out1 != NULL);
+	HKDS_ASSERT(out2 != NULL);
+	HKDS_ASSERT(out3 != NULL);
+	HKDS_ASSERT(out4 != NULL);
+	HKDS_ASSERT(out5 != NULL);
+	HKDS_ASSERT(out6 != NULL);
+	HKDS_ASSERT(out7 != NULL);
+	HKDS_ASSERT(inplen != 0U);
+	HKDS_ASSERT(outlen != 0U);
+
+	keccak_dispatch->shake256x8(out0, out1, out2, out3,
+		out4, out5, out6, out7, outlen,
+		inp0, inp1, inp2, inp3,
+		inp4, inp5, inp6, inp7, inplen);
+}
+
+void hkds_shake_512x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
+	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7, size_t inplen)
+{
+	HKDS_ASSERT(inp0 != NULL);
+	HKDS_ASSERT(inp1 != NULL);
+	HKDS_ASSERT(inp2 != NULL);
+	HKDS_ASSERT(inp3 != NULL);
+	HKDS_ASSERT(inp4 != NULL);
+	HKDS_ASSERT(inp5 != NULL);
+	HKDS_ASSERT(inp6 != NULL);
+	HKDS_ASSERT(inp7 != NULL);
+	HKDS_ASSERT(out0 != NULL);
+	HKDS_ASSERT(out1 != NULL);
+	HKDS_ASSERT(out2 != NULL);
+	HKDS_ASSERT(out3 != NULL);
+	HKDS_ASSERT(out4 != NULL);
+	HKDS_ASSERT(out5 != NULL);
+	HKDS_ASSERT(out6 != NULL);
+	HKDS_ASSERT(out7 != NULL);
+	HKDS_ASSERT(inplen != 0U);
+	HKDS_ASSERT(outlen != 0U);
+
+	keccak_dispatch->shake512x8(out0, out1, out2, out3,
+		out4, out5, out6, out7, outlen,
+		inp0, inp1, inp2, inp3,
+		inp4, inp5, inp6, inp7, inplen);
+}
+
+void hkds_kmac_128x4(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3, size_t keylen,
+	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3, size_t cstlen,
+	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3, size_t msglen)
+{
+	HKDS_ASSERT(key0 != NULL);
+	HKDS_ASSERT(key1 != NULL);
+	HKDS_ASSERT(key2 != NULL);
+	HKDS_ASSERT(key3 != NULL);
+	HKDS_ASSERT(msg0 != NULL);
+	HKDS_ASSERT(msg1 != NULL);
+	HKDS_ASSERT(msg2 != NULL);
+	HKDS_ASSERT(msg3 != NULL);
+	HKDS_ASSERT(out0 != NULL);
+	HKDS_ASSERT(out1 != NULL);
+	HKDS_ASSERT(out2 != NULL);
+	HKDS_ASSERT(out3 != NULL);
+	HKDS_ASSERT(keylen != 0U);
+	HKDS_ASSERT(msglen != 0U);
+	HKDS_ASSERT(outlen != 0U);
+
+	keccak_dispatch->kmac128x4(out0, out1, out2, out3, outlen,
+		key0, key1, key2, key3, keylen,
+		cst0, cst1, cst2, cst3, cstlen,
+		msg0, msg1, msg2, msg3, msglen);
+}
+
+void hkds_kmac_256x4(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3, size_t keylen,
+	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3, size_t cstlen,
+	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3, size_t msglen)
+{
+	HKDS_ASSERT(key0 != NULL);
+	HKDS_ASSERT(key1 != NULL);
+	HKDS_ASSERT(key2 != NULL);
+	HKDS_ASSERT(key3 != NULL);
+	HKDS_ASSERT(msg0 != NULL);
+	HKDS_ASSERT(msg1 != NULL);
+	HKDS_ASSERT(msg2 != NULL);
+	HKDS_ASSERT(msg3 != NULL);
+	HKDS_ASSERT(out0 != NULL);
+	HKDS_ASSERT(out1 != NULL);
+	HKDS_ASSERT(out2 != NULL);
+	HKDS_ASSERT(out3 != NULL);
+	HKDS_ASSERT(keylen != 0U);
+	HKDS_ASSERT(msglen != 0U);
+	HKDS_ASSERT(outlen != 0U);
+
+	keccak_dispatch->kmac256x4(out0, out1, out2, out3, outlen,
+		key0, key1, key2, key3, keylen,
+		cst0, cst1, cst2, cst3, cstlen,
+		msg0, msg1, msg2, msg3, msglen);
+}
+
+void hkds_kmac_512x4(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t outlen,
+	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3, size_t keylen,
+	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3, size_t cstlen,
+	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3, size_t msglen)
+{
+	HKDS_ASSERT(key0 != NULL);
+	HKDS_ASSERT(key1 != NULL);
+	HKDS_ASSERT(key2 != NULL);
+	HKDS_ASSERT(key3 != NULL);
+	HKDS_ASSERT(msg0 != NULL);
+	HKDS_ASSERT(msg1 != NULL);
+	HKDS_ASSERT(msg2 != NULL);
+	HKDS_ASSERT(msg3 != NULL);
+	HKDS_ASSERT(out0 != NULL);
+	HKDS_ASSERT(out1 != NULL);
+	HKDS_ASSERT(out2 != NULL);
+	HKDS_ASSERT(out3 != NULL);
+	HKDS_ASSERT(keylen != 0U);
+	HKDS_ASSERT(msglen != 0U);
+	HKDS_ASSERT(outlen != 0U);
+
+	keccak_dispatch->kmac512x4(out0, out1, out2, out3, outlen,
+		key0, key1, key2, key3, keylen,
+		cst0, cst1, cst2, cst3, cstlen,
+		msg0, msg1, msg2, msg3, msglen);
+}
+
+void hkds_kmac_128x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3,
+	const uint8_t* key4, const uint8_t* key5, const uint8_t* key6, const uint8_t* key7, size_t keylen,
+	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3,
+	const uint8_t* cst4, const uint8_t* cst5, const uint8_t* cst6, const uint8_t* cst7, size_t cstlen,
+	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3,
+	const uint8_t* msg4, const uint8_t* msg5, const uint8_t* msg6, const uint8_t* msg7, size_t msglen)
+{
+	HKDS_ASSERT(key0 != NULL);
+	HKDS_ASSERT(key1 != NULL);
+	HKDS_ASSERT(key2 != NULL);
+	HKDS_ASSERT(key3 != NULL);
+	HKDS_ASSERT(key4 != NULL);
+	HKDS_ASSERT(key5 != NULL);
+	HKDS_ASSERT(key6 != NULL);
+	HKDS_ASSERT(key7 != NULL);
+	HKDS_ASSERT(msg0 != NULL);
+	HKDS_ASSERT(msg1 != NULL);
+	HKDS_ASSERT(msg2 != NULL);
+	HKDS_ASSERT(msg3 != NULL);
+	HKDS_ASSERT(msg4 != NULL);
+	HKDS_ASSERT(msg5 != NULL);
+	HKDS_ASSERT(msg6 != NULL);
+	HKDS_ASSERT(msg7 != NULL);
+	HKDS_ASSERT(out0 != NULL);
+	HKDS_ASSERT(out1 != NULL);
+	HKDS_ASSERT(out2 != NULL);
+	HKDS_ASSERT(out3 != NULL);
+	HKDS_ASSERT(out4 != NULL);
+	HKDS_ASSERT(out5 != NULL);
+	HKDS_ASSERT(out6 != NULL);
+	HKDS_ASSERT(out7 != NULL);
+	HKDS_ASSERT(keylen != 0U);
+	HKDS_ASSERT(msglen != 0U);
+	HKDS_ASSERT(outlen != 0U);
+
+	keccak_dispatch->kmac128x8(out0, out1, out2, out3,
+		out4, out5, out6, out7, outlen,
+		key0, key1, key2, key3,
+		key4, key5, key6, key7, keylen,
+		cst0, cst1, cst2, cst3,
+		cst4, cst5, cst6, cst7, cstlen,
+		msg0, msg1, msg2, msg3,
+		msg4, msg5, msg6, msg7, msglen);
+}
+
+void hkds_kmac_256x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3,
+	const uint8_t* key4, const uint8_t* key5, const uint8_t* key6, const uint8_t* key7, size_t keylen,
+	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3,
+	const uint8_t* cst4, const uint8_t* cst5, const uint8_t* cst6, const uint8_t* cst7, size_t cstlen,
+	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3,
+	const uint8_t* msg4, const uint8_t* msg5, const uint8_t* msg6, const uint8_t* msg7, size_t msglen)
+{
+	HKDS_ASSERT(key0 != NULL);
+	HKDS_ASSERT(key1 != NULL);
+	HKDS_ASSERT(key2 != NULL);
+	HKDS_ASSERT(key3 != NULL);
+	HKDS_ASSERT(key4 != NULL);
+	HKDS_ASSERT(key5 != NULL);
+	HKDS_ASSERT(key6 != NULL);
+	HKDS_ASSERT(key7 != NULL);
+	HKDS_ASSERT(msg0 != NULL);
+	HKDS_ASSERT(msg1 != NULL);
+	HKDS_ASSERT(msg2 != NULL);
+	HKDS_ASSERT(msg3 != NULL);
+	HKDS_ASSERT(msg4 != NULL);
+	HKDS_ASSERT(msg5 != NULL);
+	HKDS_ASSERT(msg6 != NULL);
+	HKDS_ASSERT(msg7 != NULL);
+	HKDS_ASSERT(out0 != NULL);
+	HKDS_ASSERT(out1 != NULL);
+	HKDS_ASSERT(out2 != NULL);
+	HKDS_ASSERT(out3 != NULL);
+	HKDS_ASSERT(out4 != NULL);
+	HKDS_ASSERT(out5 != NULL);
+	HKDS_ASSERT(out6 != NULL);
+	HKDS_ASSERT(out7 != NULL);
+	HKDS_ASSERT(keylen != 0U);
+	HKDS_ASSERT(msglen != 0U);
+	HKDS_ASSERT(outlen != 0U);
+
+	keccak_dispatch->kmac256x8(out0, out1, out2, out3,
+		out4, out5, out6, out7, outlen,
+		key0, key1, key2, key3,
+		key4, key5, key6, key7, keylen,
+		cst0, cst1, cst2, cst3,
+		cst4, cst5, cst6, cst7, cstlen,
+		msg0, msg1, msg2, msg3,
+		msg4, msg5, msg6, msg7, msglen);
+}
+
+void hkds_kmac_512x8(uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3,
+	uint8_t* out4, uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t outlen,
+	const uint8_t* key0, const uint8_t* key1, const uint8_t* key2, const uint8_t* key3,
+	const uint8_t* key4, const uint8_t* key5, const uint8_t* key6, const uint8_t* key7, size_t keylen,
+	const uint8_t* cst0, const uint8_t* cst1, const uint8_t* cst2, const uint8_t* cst3,
+	const uint8_t* cst4, const uint8_t* cst5, const uint8_t* cst6, const uint8_t* cst7, size_t cstlen,
+	const uint8_t* msg0, const uint8_t* msg1, const uint8_t* msg2, const uint8_t* msg3,
+	const uint8_t* msg4, const uint8_t* msg5, const uint8_t* msg6, const uint8_t* msg7, size_t msglen)
+{
+	HKDS_ASSERT(key0 != NULL);
+	HKDS_ASSERT(key1 != NULL);
+	HKDS_ASSERT(key2 != NULL);
+	HKDS_ASSERT(key3 != NULL);
+	HKDS_ASSERT(key4 != NULL);
+	HKDS_ASSERT(key5 != NULL);
+	HKDS_ASSERT(key6 != NULL);
+	HKDS_ASSERT(key7 != NULL);
+	HKDS_ASSERT(msg0 != NULL);
+	HKDS_ASSERT(msg1 != NULL);
+	HKDS_ASSERT(msg2 != NULL);
+	HKDS_ASSERT(msg3 != NULL);
+	HKDS_ASSERT(msg4 != NULL);
+	HKDS_ASSERT(msg5 != NULL);
+	HKDS_ASSERT(msg6 != NULL);
+	HKDS_ASSERT(msg7 != NULL);
+	HKDS_ASSERT(out0 != NULL);
+	HKDS_ASSERT(out1 != NULL);
+	HKDS_ASSERT(out2 != NULL);
+	HKDS_ASSERT(out3 != NULL);
+	HKDS_ASSERT(out4 != NULL);
+	HKDS_ASSERT(out5 != NULL);
+	HKDS_ASSERT(out6 != NULL);
+	HKDS_ASSERT(out7 != NULL);
+	HKDS_ASSERT(keylen != 0U);
+	HKDS_ASSERT(msglen != 0U);
+	HKDS_ASSERT(outlen != 0U);
+
+	keccak_dispatch->kmac512x8(out0, out1, out2, out3,
+		out4, out5, out6, out7, outlen,
+		key0, key1, key2, key3,
+		key4, key5, key6, key7, keylen,
+		cst0, cst1, cst2, cst3,
+		cst4, cst5, cst6, cst7, cstlen,
+		msg0, msg1, msg2, msg3,
+		msg4, msg5, msg6, msg7, msglen);
+}
+
+void hkds_shake_chain_x8(hkds_keccak_rate rate, uint8_t* const output[HKDS_KECCAK_CHAIN_LANES], size_t outlen,
+	const uint8_t* const first[HKDS_KECCAK_CHAIN_LANES], size_t firstlen, size_t firstout,
+	const uint8_t* const second[HKDS_KECCAK_CHAIN_LANES], size_t secondlen, size_t secondout)
+{
+	HKDS_ASSERT(output != NULL);
+	HKDS_ASSERT(first != NULL);
+	HKDS_ASSERT(second != NULL);
+	HKDS_ASSERT(outlen != 0U);
+	HKDS_ASSERT(firstout % sizeof(uint64_t) == 0U && firstout <= (size_t)rate);
+	HKDS_ASSERT(secondout % sizeof(uint64_t) == 0U && secondout <= (size_t)rate);
+
+	if (output != NULL && first != NULL && second != NULL && outlen != 0U &&
+		firstout % sizeof(uint64_t) == 0U && firstout <= (size_t)rate &&
+		secondout % sizeof(uint64_t) == 0U && secondout <= (size_t)rate)
+	{
+		keccak_dispatch->shakechainx8(rate, output, outlen, first, firstlen, firstout, second, secondlen, secondout);
+	}
 }
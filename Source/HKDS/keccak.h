@@ -207,12 +207,6 @@
 */
 #define HKDS_KECCAK_512_RATE 72U
 
-/*!
-* \def HKDS_KECCAK_STATE_SIZE
-* \brief The Keccak SHA3 uint64 state array size
-*/
-#define HKDS_KECCAK_STATE_SIZE 25U
-
 /*!
 * \def HKDS_KECCAK_STATE_BYTE_SIZE
 * \brief The Keccak SHA3 state size in bytes
@@ -280,6 +274,17 @@ HKDS_EXPORT_API typedef struct hkds_keccak_state
 	size_t position;												/*!< The buffer position  */
 } hkds_keccak_state;
 
+/*!
+* \enum hkds_keccak_simd_level
+* \brief The instruction set used by the parallel SHAKE and KMAC functions
+*/
+typedef enum hkds_keccak_simd_level
+{
+	hkds_keccak_simd_none = 0x00U,						/*!< Sequential scalar permutations  */
+	hkds_keccak_simd_avx2 = 0x01U,						/*!< 4-lane AVX2 permutations  */
+	hkds_keccak_simd_avx512 = 0x02U,					/*!< 8-lane AVX512 permutations  */
+} hkds_keccak_simd_level;
+
 /*!
 * \enum hkds_keccak_rate
 * \brief The Keccak rate; determines which security strength is used by the function, 128, 256, or 512-bit
@@ -335,6 +340,15 @@ HKDS_EXPORT_API void hkds_keccak_finalize(hkds_keccak_state* ctx, hkds_keccak_ra
 */
 HKDS_EXPORT_API void hkds_keccak_permute(hkds_keccak_state* ctx, size_t rounds);
 
+/**
+* \brief The Keccak permute function for a bare lane array.
+* Internal function: Permutes a state array that is held outside of a Keccak state structure.
+*
+* \param state: The state array of \c HKDS_KECCAK_STATE_SIZE lanes
+* \param rounds: The number of permutation rounds, the default and maximum is 24
+*/
+HKDS_EXPORT_API void hkds_keccak_permute_lanes(uint64_t* state, size_t rounds);
+
 /**
 * \brief The Keccak squeeze function.
 *
@@ -528,15 +542,65 @@ HKDS_EXPORT_API void hkds_kmac_finalize(hkds_keccak_state* ctx, hkds_keccak_rate
 */
 HKDS_EXPORT_API void hkds_kmac_initialize(hkds_keccak_state* ctx, hkds_keccak_rate rate, const uint8_t* key, size_t keylen, const uint8_t* custom, size_t custlen);
 
+/* parallel kernel selection */
+
+/*!
+* \def HKDS_KECCAK_AVX2_KERNELS
+* \brief Defined when the 4-lane AVX2 kernels are compiled, either for the target or for run-time selection
+*/
+#if defined(HKDS_SYSTEM_HAS_AVX2) || defined(HKDS_SYSTEM_RUNTIME_DISPATCH)
+#	define HKDS_KECCAK_AVX2_KERNELS
+#endif
+
+/*!
+* \def HKDS_KECCAK_AVX512_KERNELS
+* \brief Defined when the 8-lane AVX512 kernels are compiled, either for the target or for run-time selection
+*/
+#if defined(HKDS_SYSTEM_HAS_AVX512) || defined(HKDS_SYSTEM_RUNTIME_DISPATCH)
+#	define HKDS_KECCAK_AVX512_KERNELS
+#endif
+
+/**
+* \brief Get the instruction set used by the parallel SHAKE and KMAC functions.
+*
+* \return The active kernel level
+*/
+HKDS_EXPORT_API hkds_keccak_simd_level hkds_keccak_simd_get_level(void);
+
+/**
+* \brief Get the widest instruction set available to the parallel SHAKE and KMAC functions.
+*
+* \details
+* When run-time dispatch is enabled, this is the widest kernel set supported by both the library
+* and the processor, as read from cpuid once at load time; otherwise it is the compile-time instruction set.
+*
+* \return The supported kernel level
+*/
+HKDS_EXPORT_API hkds_keccak_simd_level hkds_keccak_simd_get_supported(void);
+
+/**
+* \brief Select the instruction set used by the parallel SHAKE and KMAC functions.
+*
+* \details
+* The widest supported level is selected at load time; a narrower level can be set for testing and benchmarking.
+* The output of the functions is identical at every level.
+*
+* \warning This function is not thread-safe; it must not be called while another thread is using the parallel functions.
+*
+* \param level: The kernel level
+* \return Returns false if the level is not supported by this library or processor
+*/
+HKDS_EXPORT_API bool hkds_keccak_simd_set_level(hkds_keccak_simd_level level);
+
 /* parallel Keccak x4 */
 
-#if defined(HKDS_SYSTEM_HAS_AVX2)
+#if defined(HKDS_KECCAK_AVX2_KERNELS)
 
 /**
 * \brief Absorb 4 Keccak instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays muct be of the same length.
-* This function requires the AVX2 instruction set.
+* This function requires the AVX2 instruction set; with run-time dispatch, check hkds_keccak_simd_get_supported() first.
 *
 * \param state: The Keccak state array
 * \param rate: The shake rate
@@ -547,14 +611,14 @@ HKDS_EXPORT_API void hkds_kmac_initialize(hkds_keccak_state* ctx, hkds_keccak_ra
 * \param inplen: The length of the input key arrays
 * \param domain
 */
-void hkds_keccakx4_absorb(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
+HKDS_TARGET_AVX2 void hkds_keccakx4_absorb(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
 	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3, size_t inplen, uint8_t domain);
 
 /**
 * \brief Squeeze 4 Keccak instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays must be of the same length.
-* This function requires the AVX2 instruction set.
+* This function requires the AVX2 instruction set; with run-time dispatch, check hkds_keccak_simd_get_supported() first.
 *
 * \param state: The Keccak state array
 * \param rate: The Keccak rate
@@ -564,20 +628,20 @@ void hkds_keccakx4_absorb(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rat
 * \param out3: The 4th output array
 * \param nblocks: The number of output blocks
 */
-void hkds_keccakx4_squeezeblocks(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
+HKDS_TARGET_AVX2 void hkds_keccakx4_squeezeblocks(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
 	uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, size_t nblocks);
 
 #endif
 
 /* parallel Keccak x8 */
 
-#if defined(HKDS_SYSTEM_HAS_AVX512)
+#if defined(HKDS_KECCAK_AVX512_KERNELS)
 
 /**
-* \brief Absorb 4 Keccak instances simultaneously using SIMD instructions.
+* \brief Absorb 8 Keccak instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays must be of the same length.
-* This function requires the AVX2 instruction set.
+* This function requires the AVX512 instruction set; with run-time dispatch, check hkds_keccak_simd_get_supported() first.
 *
 * \param state: The Keccak state array
 * \param rate: The shake rate
@@ -590,17 +654,17 @@ void hkds_keccakx4_squeezeblocks(__m256i state[HKDS_KECCAK_STATE_SIZE], hkds_kec
 * \param inp6: [const] The 7th input key array
 * \param inp7: [const] The 8th input key array
 * \param inplen: The length of the input key arrays
-* \param domain
+* \param domain: The function domain id
 */
-void hkds_keccakx8_absorb(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
+HKDS_TARGET_AVX512 void hkds_keccakx8_absorb(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
 	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
 	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7, size_t inplen, uint8_t domain);
 
 /**
-* \brief Squeeze 4 Keccak instances simultaneously using SIMD instructions.
+* \brief Squeeze 8 Keccak instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays must be of the same length.
-* This function requires the AVX2 instruction set.
+* This function requires the AVX512 instruction set; with run-time dispatch, check hkds_keccak_simd_get_supported() first.
 *
 * \param state: The Keccak state array
 * \param rate: The Keccak rate
@@ -608,9 +672,13 @@ void hkds_keccakx8_absorb(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rat
 * \param out1: The 2nd output array
 * \param out2: The 3rd output array
 * \param out3: The 4th output array
+* \param out4: The 5th output array
+* \param out5: The 6th output array
+* \param out6: The 7th output array
+* \param out7: The 8th output array
 * \param nblocks: The number of output blocks
 */
-void hkds_keccakx8_squeezeblocks(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
+HKDS_TARGET_AVX512 void hkds_keccakx8_squeezeblocks(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_keccak_rate rate,
 	uint8_t* out0, uint8_t* out1, uint8_t* out2, uint8_t* out3, uint8_t* out4,
 	uint8_t* out5, uint8_t* out6, uint8_t* out7, size_t nblocks);
 
@@ -622,7 +690,7 @@ void hkds_keccakx8_squeezeblocks(__m512i state[HKDS_KECCAK_STATE_SIZE], hkds_kec
 * \brief Process 4 SHAKE-128 instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays must be of the same length.
-* This function requires the AVX2 instruction set.
+* The lanes are processed with the kernel set selected by hkds_keccak_simd_get_level().
 *
 * \param out0: The 1st output array
 * \param out1: The 2nd output array
@@ -642,7 +710,7 @@ HKDS_EXPORT_API void hkds_shake_128x4(uint8_t* out0, uint8_t* out1, uint8_t* out
 * \brief Process 4 SHAKE-256 instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays must be of the same length.
-* This function requires the AVX2 instruction set.
+* The lanes are processed with the kernel set selected by hkds_keccak_simd_get_level().
 *
 * \param out0: The 1st output array
 * \param out1: The 2nd output array
@@ -662,7 +730,7 @@ HKDS_EXPORT_API void hkds_shake_256x4(uint8_t* out0, uint8_t* out1, uint8_t* out
 * \brief Process 4 SHAKE-512 instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays must be of the same length.
-* This function requires the AVX2 instruction set.
+* The lanes are processed with the kernel set selected by hkds_keccak_simd_get_level().
 *
 * \param out0: The 1st output array
 * \param out1: The 2nd output array
@@ -684,7 +752,7 @@ HKDS_EXPORT_API void hkds_shake_512x4(uint8_t* out0, uint8_t* out1, uint8_t* out
 * \brief Process 8 SHAKE-128 instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays must be of the same length.
-* This function requires the AVX512 instruction set.
+* The lanes are processed with the kernel set selected by hkds_keccak_simd_get_level().
 *
 * \param out0: The 1st output array
 * \param out1: The 2nd output array
@@ -714,7 +782,7 @@ HKDS_EXPORT_API void hkds_shake_128x8(uint8_t* out0, uint8_t* out1, uint8_t* out
 * \brief Process 8 SHAKE-256 instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays must be of the same length.
-* This function requires the AVX512 instruction set.
+* The lanes are processed with the kernel set selected by hkds_keccak_simd_get_level().
 *
 * \param out0: The 1st output array
 * \param out1: The 2nd output array
@@ -744,7 +812,7 @@ HKDS_EXPORT_API void hkds_shake_256x8(uint8_t* out0, uint8_t* out1, uint8_t* out
 * \brief Process 8 SHAKE-512 instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays must be of the same length.
-* This function requires the AVX512 instruction set.
+* The lanes are processed with the kernel set selected by hkds_keccak_simd_get_level().
 *
 * \param out0: The 1st output array
 * \param out1: The 2nd output array
@@ -770,13 +838,46 @@ HKDS_EXPORT_API void hkds_shake_512x8(uint8_t* out0, uint8_t* out1, uint8_t* out
 	const uint8_t* inp0, const uint8_t* inp1, const uint8_t* inp2, const uint8_t* inp3,
 	const uint8_t* inp4, const uint8_t* inp5, const uint8_t* inp6, const uint8_t* inp7, size_t inplen);
 
+/* chained SHAKE x8 */
+
+/*!
+* \def HKDS_KECCAK_CHAIN_LANES
+* \brief The number of lanes processed by the chained SHAKE function
+*/
+#define HKDS_KECCAK_CHAIN_LANES 8U
+
+/**
+* \brief Process 8 chained SHAKE instances, where each output is the SHAKE of the outputs of two inner SHAKE instances.
+*
+* \details
+* For each lane: output = SHAKE(SHAKE(first)[0..firstout) || SHAKE(second)[0..secondout)). \n
+* The inner outputs are absorbed into the outer instance directly from the lane registers,
+* so the intermediate keys are never de-interleaved to byte arrays.
+* The lanes are processed with the kernel set selected by hkds_keccak_simd_get_level().
+*
+* \warning The inner output lengths must be multiples of 8 bytes, and no longer than the rate.
+*
+* \param rate: The Keccak rate of all three instances
+* \param output: The 8 output arrays
+* \param outlen: The length of each output array
+* \param first: [const] The 8 input arrays of the first inner instance
+* \param firstlen: The length of each first input array
+* \param firstout: The number of first inner output bytes that begin the outer input
+* \param second: [const] The 8 input arrays of the second inner instance
+* \param secondlen: The length of each second input array
+* \param secondout: The number of second inner output bytes that complete the outer input
+*/
+HKDS_EXPORT_API void hkds_shake_chain_x8(hkds_keccak_rate rate, uint8_t* const output[HKDS_KECCAK_CHAIN_LANES], size_t outlen,
+	const uint8_t* const first[HKDS_KECCAK_CHAIN_LANES], size_t firstlen, size_t firstout,
+	const uint8_t* const second[HKDS_KECCAK_CHAIN_LANES], size_t secondlen, size_t secondout);
+
 /* parallel kmac x4 */
 
 /**
 * \brief Process 4 KMAC-128 instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays must be of the same length.
-* This function requires the AVX2 instruction set.
+* The lanes are processed with the kernel set selected by hkds_keccak_simd_get_level().
 *
 * \param out0: The 1st output array
 * \param out1: The 2nd output array
@@ -808,7 +909,7 @@ HKDS_EXPORT_API void hkds_kmac_128x4(uint8_t* out0, uint8_t* out1, uint8_t* out2
 * \brief Process 4 KMAC-256 instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays must be of the same length.
-* This function requires the AVX2 instruction set.
+* The lanes are processed with the kernel set selected by hkds_keccak_simd_get_level().
 *
 * \param out0: The 1st output array
 * \param out1: The 2nd output array
@@ -840,7 +941,7 @@ HKDS_EXPORT_API void hkds_kmac_256x4(uint8_t* out0, uint8_t* out1, uint8_t* out2
 * \brief Process 4 KMAC-512 instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays must be of the same length.
-* This function requires the AVX2 instruction set.
+* The lanes are processed with the kernel set selected by hkds_keccak_simd_get_level().
 *
 * \param out0: The 1st output array
 * \param out1: The 2nd output array
@@ -874,7 +975,7 @@ HKDS_EXPORT_API void hkds_kmac_512x4(uint8_t* out0, uint8_t* out1, uint8_t* out2
 * \brief Process 8 KMAC-128 instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays must be of the same length.
-* This function requires the AVX512 instruction set.
+* The lanes are processed with the kernel set selected by hkds_keccak_simd_get_level().
 *
 * \param out0: The 1st output array
 * \param out1: The 2nd output array
@@ -926,7 +1027,7 @@ HKDS_EXPORT_API void hkds_kmac_128x8(uint8_t* out0, uint8_t* out1, uint8_t* out2
 * \brief Process 8 KMAC-256 instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays must be of the same length.
-* This function requires the AVX512 instruction set.
+* The lanes are processed with the kernel set selected by hkds_keccak_simd_get_level().
 *
 * \param out0: The 1st output array
 * \param out1: The 2nd output array
@@ -978,7 +1079,7 @@ HKDS_EXPORT_API void hkds_kmac_256x8(uint8_t* out0, uint8_t* out1, uint8_t* out2
 * \brief Process 8 KMAC-512 instances simultaneously using SIMD instructions.
 *
 * \warning The input and output arrays must be of the same length.
-* This function requires the AVX512 instruction set.
+* The lanes are processed with the kernel set selected by hkds_keccak_simd_get_level().
 *
 * \param out0: The 1st output array
 * \param out1: The 2nd output array
@@ -1,3 +1,7 @@
+#if !defined(_POSIX_C_SOURCE) && !defined(_WIN32)
+	/* required for clock_gettime in strict C11 builds */
+#	define _POSIX_C_SOURCE 200809L
+#endif
 #include "utils.h"
 #include <ctype.h>
 #include <stdio.h>
@@ -251,6 +255,31 @@ uint64_t utils_stopwatch_elapsed(uint64_t start)
 	return msec;
 }
 
+uint64_t utils_time_monotonic(void)
+{
+	uint64_t usec;
+
+#if defined(HKDS_SYSTEM_OS_WINDOWS)
+	LARGE_INTEGER freq;
+	LARGE_INTEGER ctr;
+
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&ctr);
+	usec = ((uint64_t)(ctr.QuadPart / freq.QuadPart) * 1000000ULL) + (((uint64_t)(ctr.QuadPart % freq.QuadPart) * 1000000ULL) / (uint64_t)freq.QuadPart);
+#else
+	struct timespec ts;
+
+	usec = 0U;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+	{
+		usec = ((uint64_t)ts.tv_sec * 1000000ULL) + ((uint64_t)ts.tv_nsec / 1000U);
+	}
+#endif
+
+	return usec;
+}
+
 int64_t utils_find_string(const char* source, const char* token)
 {
 	HKDS_ASSERT(source != NULL);
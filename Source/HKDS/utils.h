@@ -118,6 +118,17 @@ HKDS_EXPORT_API uint64_t utils_stopwatch_start(void);
 */
 HKDS_EXPORT_API uint64_t utils_stopwatch_elapsed(uint64_t start);
 
+/**
+* \brief Returns the value of a monotonic clock in microseconds
+*
+* \details
+* The clock is unaffected by changes to the system time, and has an arbitrary epoch;
+* it is only meaningful when compared with another value returned by this function.
+*
+* \return The monotonic clock time in microseconds
+*/
+HKDS_EXPORT_API uint64_t utils_time_monotonic(void);
+
 /* string functions */
 
 /**
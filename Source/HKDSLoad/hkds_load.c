@@ -0,0 +1,543 @@
+#if !defined(_GNU_SOURCE)
+	/* required for clock_gettime and MSG_NOSIGNAL in strict C11 builds */
+#	define _GNU_SOURCE
+#endif
+#include "hkds_factory.h"
+#include "hkds_fleet.h"
+#include "hkds_framer.h"
+#include "utils.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOAD_DEFAULT_ADDRESS "127.0.0.1"
+#define LOAD_DEFAULT_PORT 7480U
+#define LOAD_DEFAULT_DEVICES 10000U
+#define LOAD_DEFAULT_SECONDS 10U
+#define LOAD_MAX_THREADS 64U
+#define LOAD_MAX_CONNECTIONS 1024U
+#define LOAD_GENERATE_DEPTH 256U
+#define LOAD_READ_SIZE 16384U
+
+typedef struct
+{
+	const char* address;		/* the IPv4 address of the server */
+	const char* unixpath;		/* the [optional] Unix socket path of the server */
+	hkds_master_key* mdk;		/* the master key set of the server */
+	size_t devices;				/* the number of simulated devices */
+	size_t connections;			/* the number of connections */
+	size_t threads;				/* the number of generator threads */
+	double rate;				/* the request rate of the fleet, or zero for no limit */
+	uint32_t seconds;			/* the length of the run */
+	uint16_t port;				/* the TCP port of the server */
+	bool authenticated;			/* message requests carry an authentication tag */
+} load_config;
+
+typedef struct
+{
+	hkds_framer_state framer;	/* reassembles the responses */
+	uint8_t* output;			/* the queued requests */
+	size_t outhead;				/* the first unsent byte */
+	size_t outtail;				/* the end of the queued requests */
+	size_t* fifo;				/* the devices awaiting a response, in request order */
+	size_t fifohead;			/* the oldest outstanding request */
+	size_t fifocount;			/* the number of outstanding requests */
+	size_t capacity;			/* the most requests a connection can have outstanding */
+	int fd;						/* the connection socket */
+} load_connection;
+
+typedef struct
+{
+	hkds_fleet_state fleet;		/* the simulated devices of the thread */
+	load_connection* conns;		/* the connections of the thread */
+	const load_config* config;	/* the run configuration */
+	size_t conncount;			/* the number of connections */
+	size_t devices;				/* the number of devices */
+	uint32_t first;				/* the device number of the first device */
+	double rate;				/* the request rate of the thread, or zero */
+	uint64_t requests;			/* the number of sent requests */
+	bool closed;				/* the server closed a connection */
+} load_worker;
+
+static void print_usage(void)
+{
+	printf("usage: hkds_load [-l address] [-p port] [-u unixpath] [-n devices] [-c connections] [-r rate] [-s seconds] [-t threads] -k keyfile [-a]\n");
+	printf("  -l  the IPv4 address of the server; default %s\n", LOAD_DEFAULT_ADDRESS);
+	printf("  -p  the TCP port of the server; default %u\n", (unsigned)LOAD_DEFAULT_PORT);
+	printf("  -u  the Unix socket path of the server, used instead of TCP\n");
+	printf("  -n  the number of simulated terminals; default %u\n", (unsigned)LOAD_DEFAULT_DEVICES);
+	printf("  -c  the number of connections; default one per thread\n");
+	printf("  -r  the requests per second of the whole fleet; default no limit\n");
+	printf("  -s  the length of the run in seconds; default %u\n", (unsigned)LOAD_DEFAULT_SECONDS);
+	printf("  -t  the number of generator threads; default one\n");
+	printf("  -k  the master key file of the server\n");
+	printf("  -a  message requests carry an authentication tag\n");
+}
+
+static double load_elapsed(const struct timespec* start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (double)(now.tv_sec - start->tv_sec) + ((double)(now.tv_nsec - start->tv_nsec) / 1000000000.0);
+}
+
+static int load_connect(const load_config* config)
+{
+	struct sockaddr_un su = { 0 };
+	struct sockaddr_in sa = { 0 };
+	int one;
+	int fd;
+
+	one = 1;
+
+	if (config->unixpath != NULL)
+	{
+		su.sun_family = AF_UNIX;
+		strncpy(su.sun_path, config->unixpath, sizeof(su.sun_path) - 1U);
+		fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+		if (fd >= 0 && connect(fd, (struct sockaddr*)&su, sizeof(su)) != 0)
+		{
+			close(fd);
+			fd = -1;
+		}
+	}
+	else
+	{
+		sa.sin_family = AF_INET;
+		sa.sin_port = htons(config->port);
+		fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+		if (fd >= 0 && (inet_pton(AF_INET, config->address, &sa.sin_addr) != 1 || connect(fd, (struct sockaddr*)&sa, sizeof(sa)) != 0 ||
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) != 0))
+		{
+			close(fd);
+			fd = -1;
+		}
+	}
+
+	if (fd >= 0 && fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0)
+	{
+		close(fd);
+		fd = -1;
+	}
+
+	return fd;
+}
+
+static bool load_worker_open(load_worker* worker)
+{
+	load_connection* conn;
+	bool res;
+
+	res = false;
+	worker->conns = (load_connection*)calloc(worker->conncount, sizeof(load_connection));
+
+	if (worker->conns != NULL && hkds_fleet_initialize(&worker->fleet, worker->devices, worker->config->authenticated) == true)
+	{
+		res = true;
+
+		/* device i is served by connection i mod the connection count, so a connection holds a fixed share of the fleet */
+		for (size_t i = 0U; i < worker->conncount && res == true; ++i)
+		{
+			conn = &worker->conns[i];
+			conn->capacity = (worker->devices + worker->conncount - 1U) / worker->conncount;
+			conn->output = (uint8_t*)malloc(conn->capacity * HKDS_CLIENT_MESSAGE_REQUEST_SIZE);
+			conn->fifo = (size_t*)malloc(conn->capacity * sizeof(size_t));
+			conn->fd = load_connect(worker->config);
+			res = (conn->output != NULL && conn->fifo != NULL && conn->fd >= 0 &&
+				hkds_framer_initialize(&conn->framer, NULL, LOAD_READ_SIZE) == true);
+		}
+	}
+
+	return res;
+}
+
+static void load_worker_close(load_worker* worker)
+{
+	if (worker->conns != NULL)
+	{
+		for (size_t i = 0U; i < worker->conncount; ++i)
+		{
+			if (worker->conns[i].fd > 0)
+			{
+				close(worker->conns[i].fd);
+			}
+
+			hkds_framer_destroy(&worker->conns[i].framer);
+			free(worker->conns[i].output);
+			free(worker->conns[i].fifo);
+		}
+
+		free(worker->conns);
+		worker->conns = NULL;
+	}
+
+	hkds_fleet_dispose(&worker->fleet);
+}
+
+static void load_queue(load_worker* worker, const uint8_t* packets, size_t plen, const size_t* devices, size_t count)
+{
+	load_connection* conn;
+	size_t flen;
+	size_t pos;
+
+	pos = 0U;
+
+	for (size_t i = 0U; i < count && pos < plen; ++i)
+	{
+		/* a device has one request outstanding, so its connection always has room for it */
+		conn = &worker->conns[devices[i] % worker->conncount];
+		flen = hkds_factory_extract_packet_size(packets + pos);
+
+		if (conn->outhead == conn->outtail)
+		{
+			conn->outhead = 0U;
+			conn->outtail = 0U;
+		}
+		else if (conn->outhead != 0U)
+		{
+			memmove(conn->output, conn->output + conn->outhead, conn->outtail - conn->outhead);
+			conn->outtail -= conn->outhead;
+			conn->outhead = 0U;
+		}
+
+		memcpy(conn->output + conn->outtail, packets + pos, flen);
+		conn->outtail += flen;
+		conn->fifo[(conn->fifohead + conn->fifocount) % conn->capacity] = devices[i];
+		++conn->fifocount;
+		pos += flen;
+	}
+}
+
+static void load_receive(load_worker* worker, load_connection* conn)
+{
+	uint8_t buf[LOAD_READ_SIZE];
+	hkds_frame frame;
+	size_t wlen;
+	size_t wpos;
+	ssize_t rlen;
+
+	rlen = recv(conn->fd, buf, sizeof(buf), MSG_DONTWAIT);
+
+	if (rlen > 0)
+	{
+		wpos = 0U;
+		wlen = 1U;
+
+		/* the responses of a connection arrive in request order */
+		while (wpos < (size_t)rlen && wlen != 0U)
+		{
+			wlen = hkds_framer_write(&conn->framer, buf + wpos, (size_t)rlen - wpos);
+			wpos += wlen;
+
+			while (hkds_framer_next(&conn->framer, &frame) == true && conn->fifocount != 0U)
+			{
+				hkds_fleet_receive(&worker->fleet, conn->fifo[conn->fifohead], frame.packet, frame.length);
+				conn->fifohead = (conn->fifohead + 1U) % conn->capacity;
+				--conn->fifocount;
+			}
+		}
+
+		/* a malformed stream, or a response that no request is waiting for */
+		worker->closed = (wpos != (size_t)rlen);
+	}
+	else if (rlen == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+	{
+		worker->closed = true;
+	}
+}
+
+static void* load_run(void* context)
+{
+	uint8_t packets[LOAD_GENERATE_DEPTH * HKDS_CLIENT_MESSAGE_REQUEST_SIZE];
+	size_t devices[LOAD_GENERATE_DEPTH];
+	struct pollfd pfd[LOAD_MAX_CONNECTIONS];
+	const load_config* config;
+	load_connection* conn;
+	load_worker* worker;
+	struct timespec start;
+	double elapsed;
+	size_t budget;
+	size_t count;
+	size_t plen;
+	ssize_t slen;
+
+	worker = (load_worker*)context;
+	config = worker->config;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	elapsed = 0.0;
+
+	while (elapsed < (double)config->seconds && worker->closed == false)
+	{
+		/* the requests are paced to the rate, and a device that is still waiting is skipped */
+		budget = LOAD_GENERATE_DEPTH;
+
+		if (worker->rate > 0.0)
+		{
+			budget = ((double)worker->requests < worker->rate * elapsed) ? (size_t)((worker->rate * elapsed) - (double)worker->requests) + 1U : 0U;
+			budget = (budget > LOAD_GENERATE_DEPTH) ? LOAD_GENERATE_DEPTH : budget;
+		}
+
+		if (budget != 0U)
+		{
+			plen = hkds_fleet_generate(&worker->fleet, packets, sizeof(packets), devices, budget, &count);
+			load_queue(worker, packets, plen, devices, count);
+			worker->requests += count;
+		}
+
+		for (size_t i = 0U; i < worker->conncount; ++i)
+		{
+			conn = &worker->conns[i];
+
+			if (conn->outtail != conn->outhead)
+			{
+				slen = send(conn->fd, conn->output + conn->outhead, conn->outtail - conn->outhead, MSG_DONTWAIT | MSG_NOSIGNAL);
+				conn->outhead += (slen > 0) ? (size_t)slen : 0U;
+			}
+
+			pfd[i].fd = conn->fd;
+			pfd[i].events = (short)((conn->outtail != conn->outhead) ? (POLLIN | POLLOUT) : POLLIN);
+			pfd[i].revents = 0;
+		}
+
+		if (poll(pfd, (nfds_t)worker->conncount, 1) > 0)
+		{
+			for (size_t i = 0U; i < worker->conncount; ++i)
+			{
+				if ((pfd[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0)
+				{
+					load_receive(worker, &worker->conns[i]);
+				}
+			}
+		}
+
+		/* the caches of a partial group of refreshed devices are regenerated at the end of the pass */
+		hkds_fleet_refresh(&worker->fleet);
+		elapsed = load_elapsed(&start);
+	}
+
+	return NULL;
+}
+
+static bool load_master_key(const char* path, hkds_master_key* mdk)
+{
+	FILE* fp;
+	bool res;
+
+	res = false;
+	fp = (path != NULL) ? fopen(path, "rb") : NULL;
+
+	if (fp != NULL)
+	{
+		/* the key file of the daemon; the base derivation key, the secret token key, and the key identity */
+		res = (fread(mdk, 1U, sizeof(hkds_master_key), fp) == sizeof(hkds_master_key));
+		fclose(fp);
+	}
+
+	return res;
+}
+
+static void load_fleet(const load_config* config)
+{
+#if defined(HKDS_SHAKE_128)
+	const uint8_t PRFMODE = 0x09U;
+#elif defined(HKDS_SHAKE_256)
+	const uint8_t PRFMODE = 0x0AU;
+#else
+	const uint8_t PRFMODE = 0x0BU;
+#endif
+	uint8_t did[HKDS_DID_SIZE] = { 0x00U, 0x00U, 0x00U, 0x00U, 0x10U, PRFMODE, 0x01U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U };
+	load_worker workers[LOAD_MAX_THREADS] = { 0 };
+	pthread_t threads[LOAD_MAX_THREADS];
+	struct timespec start;
+	uint64_t requests;
+	uint64_t messages;
+	uint64_t tokens;
+	uint64_t epochs;
+	uint64_t failures;
+	double elapsed;
+	size_t started;
+	size_t opened;
+	bool closed;
+
+	utils_memory_copy(did, config->mdk->kid, HKDS_KID_SIZE);
+	opened = 0U;
+	started = 0U;
+
+	/* each thread has its own share of the fleet and the connections, and a distinct range of device numbers */
+	for (size_t i = 0U; i < config->threads; ++i)
+	{
+		workers[i].config = config;
+		workers[i].devices = (config->devices * (i + 1U) / config->threads) - (config->devices * i / config->threads);
+		workers[i].first = (uint32_t)(config->devices * i / config->threads) + 1U;
+		workers[i].conncount = (config->connections * (i + 1U) / config->threads) - (config->connections * i / config->threads);
+		workers[i].rate = config->rate / (double)config->threads;
+
+		if (load_worker_open(&workers[i]) == true)
+		{
+			hkds_fleet_provision(&workers[i].fleet, config->mdk, did, workers[i].first);
+			++opened;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	if (opened == config->threads)
+	{
+		printf("hkds_load: %zu terminals on %zu connections, %zu threads%s; provisioned, running for %u seconds.\n", config->devices,
+			config->connections, config->threads, (config->authenticated == true) ? ", authenticated" : "", (unsigned)config->seconds);
+		fflush(stdout);
+		clock_gettime(CLOCK_MONOTONIC, &start);
+
+		for (size_t i = 0U; i < config->threads; ++i)
+		{
+			if (pthread_create(&threads[i], NULL, &load_run, &workers[i]) == 0)
+			{
+				++started;
+			}
+		}
+
+		requests = 0U;
+		messages = 0U;
+		tokens = 0U;
+		epochs = 0U;
+		failures = 0U;
+		closed = false;
+
+		for (size_t i = 0U; i < started; ++i)
+		{
+			pthread_join(threads[i], NULL);
+			requests += workers[i].requests;
+			messages += workers[i].fleet.messages;
+			tokens += workers[i].fleet.tokens;
+			epochs += workers[i].fleet.epochs;
+			failures += workers[i].fleet.failures;
+			closed = (closed == true || workers[i].closed == true);
+		}
+
+		elapsed = load_elapsed(&start);
+		printf("hkds_load: %llu requests sent, %llu messages and %llu tokens answered in %.1f seconds: %.0f responses per second.\n",
+			(unsigned long long)requests, (unsigned long long)messages, (unsigned long long)tokens, elapsed,
+			(double)(messages + tokens) / elapsed);
+		printf("hkds_load: %llu epochs rolled over, %llu failed responses.\n", (unsigned long long)epochs, (unsigned long long)failures);
+
+		if (closed == true)
+		{
+			printf("hkds_load: the server closed a connection, and the run was cut short.\n");
+		}
+	}
+	else
+	{
+		fprintf(stderr, "hkds_load: the fleet could not be allocated, or the server could not be reached.\n");
+	}
+
+	for (size_t i = 0U; i < config->threads; ++i)
+	{
+		load_worker_close(&workers[i]);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	load_config config = { 0 };
+	hkds_master_key mdk;
+	const char* keypath;
+	bool valid;
+	int ret;
+
+	config.address = LOAD_DEFAULT_ADDRESS;
+	config.port = (uint16_t)LOAD_DEFAULT_PORT;
+	config.devices = LOAD_DEFAULT_DEVICES;
+	config.seconds = LOAD_DEFAULT_SECONDS;
+	config.threads = 1U;
+	keypath = NULL;
+	valid = true;
+	ret = EXIT_FAILURE;
+
+	for (int i = 1; i < argc && valid == true; ++i)
+	{
+		if (strcmp(argv[i], "-a") == 0)
+		{
+			config.authenticated = true;
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-l") == 0)
+		{
+			config.address = argv[++i];
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-p") == 0)
+		{
+			config.port = (uint16_t)strtoul(argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-u") == 0)
+		{
+			config.unixpath = argv[++i];
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-n") == 0)
+		{
+			config.devices = (size_t)strtoul(argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-c") == 0)
+		{
+			config.connections = (size_t)strtoul(argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-r") == 0)
+		{
+			config.rate = strtod(argv[++i], NULL);
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-s") == 0)
+		{
+			config.seconds = (uint32_t)strtoul(argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-t") == 0)
+		{
+			config.threads = (size_t)strtoul(argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-k") == 0)
+		{
+			keypath = argv[++i];
+		}
+		else
+		{
+			valid = false;
+		}
+	}
+
+	config.connections = (config.connections == 0U) ? config.threads : config.connections;
+	valid = (valid == true && keypath != NULL && config.seconds != 0U && config.rate >= 0.0 && config.threads != 0U &&
+		config.threads <= LOAD_MAX_THREADS && config.connections >= config.threads &&
+		config.connections <= config.threads * LOAD_MAX_CONNECTIONS && config.devices >= config.connections);
+
+	if (valid == false)
+	{
+		print_usage();
+	}
+	else if (load_master_key(keypath, &mdk) == false)
+	{
+		fprintf(stderr, "hkds_load: the master key file could not be read.\n");
+	}
+	else
+	{
+		config.mdk = &mdk;
+		load_fleet(&config);
+		utils_memory_secure_erase((uint8_t*)&mdk, sizeof(mdk));
+		ret = EXIT_SUCCESS;
+	}
+
+	return ret;
+}
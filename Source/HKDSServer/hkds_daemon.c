@@ -0,0 +1,1927 @@
+#if !defined(_GNU_SOURCE)
+	/* required for accept4, epoll, eventfd, prctl, and SO_REUSEPORT in strict C11 builds */
+#	define _GNU_SOURCE
+#endif
+#include "hkds_daemon.h"
+#include "hkds_factory.h"
+#include "hkds_framer.h"
+#include "hkds_ipc.h"
+#if defined(HKDS_DAEMON_URING)
+#	include "hkds_uring.h"
+#endif
+#include "utils.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+typedef struct hkds_daemon_connection
+{
+	hkds_framer_state framer;						/* reassembles the received packets */
+	uint8_t* output;								/* the send buffer */
+	size_t outhead;									/* the first unsent byte */
+	size_t outtail;									/* the end of the queued responses */
+	size_t pending;									/* the number of reserved responses awaiting decryption */
+	size_t sending;									/* the byte count of the io_uring send in flight */
+	size_t heldfirst;								/* the first held receive buffer */
+	size_t heldcount;								/* the number of held receive buffers */
+	uint32_t heldoffset[HKDS_DAEMON_URING_BUFFERS];	/* the first unread byte of each held buffer */
+	uint32_t heldlength[HKDS_DAEMON_URING_BUFFERS];	/* the received length of each held buffer */
+	uint16_t heldid[HKDS_DAEMON_URING_BUFFERS];		/* the receive buffers kept while the connection is blocked */
+	uint32_t events;								/* the registered epoll interest */
+	uint32_t operations;							/* the io_uring requests in flight */
+	uint32_t notices;								/* the outstanding zero-copy send notifications */
+	uint32_t index;									/* the io_uring slot, and fixed buffer index */
+	int fd;											/* the connection socket */
+	bool blocked;									/* reading is paused until the send buffer drains */
+	bool closing;									/* the connection is closed at the end of the pass */
+	bool receiving;									/* an io_uring multishot receive is armed */
+	bool cancelling;								/* the multishot receive is being cancelled */
+	bool shut;										/* the socket has been shut down */
+	bool copying;									/* the socket has no zero-copy support */
+	bool starved;									/* the receive ended with no free buffer, and waits for a recycle */
+	bool touched;									/* the connection is on the io_uring pass list */
+	struct hkds_daemon_connection* prev;			/* the previous connection of the loop */
+	struct hkds_daemon_connection* next;			/* the next connection of the loop */
+} hkds_daemon_connection;
+
+struct hkds_daemon_loop
+{
+	const uint8_t* ksn[HKDS_DAEMON_BATCH_DEPTH];	/* the KSNs of the collected requests, in the framer buffers */
+	const uint8_t* cpt[HKDS_DAEMON_BATCH_DEPTH];	/* the cipher-text of the collected requests, or NULL for a token request */
+	uint8_t* pln[HKDS_DAEMON_BATCH_DEPTH];			/* the response slots receiving the plaintext or token */
+	uint8_t* slot[HKDS_DAEMON_BATCH_DEPTH];			/* the response packet of a single request, or NULL for an envelope record */
+	hkds_daemon_connection* owner[HKDS_DAEMON_BATCH_DEPTH]; /* the connection of each request */
+	bool valid[HKDS_DAEMON_BATCH_DEPTH];			/* the verification status of each request */
+	size_t count;									/* the number of collected requests */
+	hkds_server_x8_state tss;						/* the template state of the batch functions */
+	hkds_daemon_connection* connections;			/* the open connections */
+	const hkds_daemon_state* daemon;				/* the owning daemon */
+#if defined(HKDS_DAEMON_URING)
+	hkds_uring_state uring;							/* the io_uring ring */
+	hkds_uring_buffers receive;						/* the provided receive buffers */
+#endif
+	uint8_t* slab;									/* the registered send buffers of the io_uring connections */
+	hkds_daemon_connection* slots[HKDS_DAEMON_URING_SLOTS]; /* the io_uring connections by slot */
+	hkds_daemon_connection* touch[HKDS_DAEMON_URING_SLOTS]; /* the io_uring connections served in this pass */
+	size_t touchcount;								/* the number of served io_uring connections */
+	bool recycled;									/* receive buffers were returned in this pass */
+	hkds_ipc_channel channel;						/* the shared-memory channel to the key worker, in isolated mode */
+	pid_t worker;									/* the key worker process, or zero */
+	uint32_t generation;							/* the worker batch number, which tags the worker requests */
+	uint8_t dgin[HKDS_DAEMON_DATAGRAM_BATCH][HKDS_DAEMON_DATAGRAM_SIZE];	/* the received datagrams */
+	uint8_t dgout[HKDS_DAEMON_DATAGRAM_BATCH][HKDS_DAEMON_DATAGRAM_SIZE];	/* the datagram responses */
+	struct sockaddr_storage dgpeer[HKDS_DAEMON_DATAGRAM_BATCH];		/* the datagram source addresses */
+	struct iovec dginv[HKDS_DAEMON_DATAGRAM_BATCH];					/* the receive vectors */
+	struct iovec dgoutv[HKDS_DAEMON_DATAGRAM_BATCH];				/* the send vectors */
+	struct mmsghdr dgrecv[HKDS_DAEMON_DATAGRAM_BATCH];				/* the recvmmsg headers */
+	struct mmsghdr dgsend[HKDS_DAEMON_DATAGRAM_BATCH];				/* the sendmmsg headers */
+	pthread_t thread;								/* the loop thread */
+	int epfd;										/* the epoll instance */
+	int listenfd;									/* the TCP listening socket, or -1 */
+	int udpfd;										/* the UDP socket, or -1 */
+	int wakefd;										/* the stop event */
+	bool started;									/* the thread is running */
+	atomic_uint_fast64_t connectioncount;			/* the statistics counters */
+	atomic_uint_fast64_t messages;
+	atomic_uint_fast64_t tokens;
+	atomic_uint_fast64_t envelopes;
+	atomic_uint_fast64_t batches;
+	atomic_uint_fast64_t failures;
+	atomic_uint_fast64_t datagrams;
+	atomic_uint_fast64_t malformed;
+};
+
+static void hkds_daemon_count(atomic_uint_fast64_t* counter, uint64_t value)
+{
+	atomic_fetch_add_explicit(counter, value, memory_order_relaxed);
+}
+
+/* connections */
+
+static hkds_daemon_connection* hkds_daemon_connection_create(hkds_daemon_loop* loop, int fd, uint32_t index)
+{
+	hkds_daemon_connection* conn;
+	bool res;
+
+	res = false;
+	conn = (hkds_daemon_connection*)malloc(sizeof(hkds_daemon_connection));
+
+	if (conn != NULL)
+	{
+		utils_memory_clear((uint8_t*)conn, sizeof(hkds_daemon_connection));
+		conn->fd = fd;
+		conn->index = index;
+
+		if (loop->slab != NULL)
+		{
+			/* an io_uring connection sends from its slice of the registered slab */
+			conn->output = loop->slab + ((size_t)index * HKDS_DAEMON_SEND_SIZE);
+		}
+		else
+		{
+			conn->output = (uint8_t*)utils_memory_aligned_alloc(HKDS_SIMD_ALIGNMENT, HKDS_DAEMON_SEND_SIZE);
+		}
+
+		if (conn->output != NULL && hkds_framer_initialize(&conn->framer, NULL, HKDS_FRAMER_MAX_SIZE) == true)
+		{
+			conn->next = loop->connections;
+
+			if (loop->connections != NULL)
+			{
+				loop->connections->prev = conn;
+			}
+
+			loop->connections = conn;
+			hkds_daemon_count(&loop->connectioncount, 1U);
+			res = true;
+		}
+
+		if (res == false)
+		{
+			hkds_framer_destroy(&conn->framer);
+
+			if (conn->output != NULL && loop->slab == NULL)
+			{
+				utils_memory_aligned_free(conn->output);
+			}
+
+			free(conn);
+			conn = NULL;
+		}
+	}
+
+	return conn;
+}
+
+static void hkds_daemon_connection_release(hkds_daemon_loop* loop, hkds_daemon_connection* conn)
+{
+	close(conn->fd);
+
+	if (conn->prev != NULL)
+	{
+		conn->prev->next = conn->next;
+	}
+	else
+	{
+		loop->connections = conn->next;
+	}
+
+	if (conn->next != NULL)
+	{
+		conn->next->prev = conn->prev;
+	}
+
+	hkds_framer_destroy(&conn->framer);
+	utils_memory_secure_erase(conn->output, HKDS_DAEMON_SEND_SIZE);
+
+	if (loop->slab != NULL)
+	{
+		loop->slots[conn->index] = NULL;
+	}
+	else
+	{
+		utils_memory_aligned_free(conn->output);
+	}
+
+	free(conn);
+}
+
+static void hkds_daemon_connection_close(hkds_daemon_loop* loop, hkds_daemon_connection* conn)
+{
+	epoll_ctl(loop->epfd, EPOLL_CTL_DEL, conn->fd, NULL);
+	hkds_daemon_connection_release(loop, conn);
+}
+
+static void hkds_daemon_connection_open(hkds_daemon_loop* loop, int fd)
+{
+	struct epoll_event ev = { 0 };
+	hkds_daemon_connection* conn;
+
+	conn = hkds_daemon_connection_create(loop, fd, 0U);
+
+	if (conn != NULL)
+	{
+		conn->events = EPOLLIN | EPOLLRDHUP;
+		ev.events = conn->events;
+		ev.data.ptr = conn;
+
+		if (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, fd, &ev) != 0)
+		{
+			hkds_daemon_connection_release(loop, conn);
+		}
+	}
+	else
+	{
+		close(fd);
+	}
+}
+
+static void hkds_daemon_accept(hkds_daemon_loop* loop, int listenfd, bool tcp)
+{
+	int fd;
+	int one;
+
+	one = 1;
+	fd = accept4(listenfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+	while (fd >= 0)
+	{
+		if (tcp == true)
+		{
+			/* responses are written in one send per pass, so Nagle would only add latency */
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		}
+
+		hkds_daemon_connection_open(loop, fd);
+		fd = accept4(listenfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	}
+}
+
+static void hkds_daemon_update_interest(hkds_daemon_loop* loop, hkds_daemon_connection* conn)
+{
+	struct epoll_event ev = { 0 };
+	uint32_t want;
+
+	want = 0U;
+
+	if (conn->blocked == false)
+	{
+		want |= EPOLLIN | EPOLLRDHUP;
+	}
+
+	/* a blocked connection keeps its write interest, so the pass after the buffer drains resumes it */
+	if (conn->outhead != conn->outtail || conn->blocked == true)
+	{
+		want |= EPOLLOUT;
+	}
+
+	if (want != conn->events)
+	{
+		ev.events = want;
+		ev.data.ptr = conn;
+
+		if (epoll_ctl(loop->epfd, EPOLL_CTL_MOD, conn->fd, &ev) == 0)
+		{
+			conn->events = want;
+		}
+	}
+}
+
+static void hkds_daemon_send(hkds_daemon_connection* conn)
+{
+	ssize_t slen;
+
+	while (conn->outhead != conn->outtail)
+	{
+		slen = send(conn->fd, conn->output + conn->outhead, conn->outtail - conn->outhead, MSG_NOSIGNAL);
+
+		if (slen > 0)
+		{
+			conn->outhead += (size_t)slen;
+		}
+		else
+		{
+			if (slen < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			{
+				conn->closing = true;
+				conn->outhead = conn->outtail;
+			}
+
+			break;
+		}
+	}
+
+	if (conn->outhead == conn->outtail)
+	{
+		conn->outhead = 0U;
+		conn->outtail = 0U;
+	}
+}
+
+/* batch decryption */
+
+static void hkds_daemon_flush_worker(hkds_daemon_loop* loop)
+{
+	const hkds_ipc_slot* rsp;
+	size_t avail;
+	size_t done;
+	size_t idx;
+	bool queued;
+
+	done = 0U;
+	++loop->generation;
+
+	/* the generation tags each request, so a late response to an abandoned batch is discarded */
+	for (size_t i = 0U; i < loop->count; ++i)
+	{
+		loop->valid[i] = false;
+
+		if (loop->cpt[i] != NULL)
+		{
+			queued = hkds_ipc_enqueue_message(&loop->channel, ((uint64_t)loop->generation << 32U) | i, loop->ksn[i], loop->cpt[i],
+				(loop->daemon->config.authenticated == true) ? loop->cpt[i] + HKDS_MESSAGE_SIZE : NULL);
+		}
+		else
+		{
+			queued = hkds_ipc_enqueue_token(&loop->channel, ((uint64_t)loop->generation << 32U) | i, loop->ksn[i]);
+		}
+
+		if (queued == false)
+		{
+			++done;
+		}
+	}
+
+	hkds_ipc_submit(&loop->channel);
+
+	/* the batch is answered synchronously and blocks the loop; requests the worker does not answer in time fail */
+	while (done < loop->count && hkds_ipc_wait(&loop->channel.responses, HKDS_DAEMON_WORKER_TIMEOUT) == true)
+	{
+		avail = hkds_ipc_available(&loop->channel.responses);
+
+		for (size_t i = 0U; i < avail; ++i)
+		{
+			rsp = hkds_ipc_front(&loop->channel.responses, i);
+			idx = (size_t)(rsp->tag & 0xFFFFFFFFULL);
+
+			if ((uint32_t)(rsp->tag >> 32U) == loop->generation && idx < loop->count)
+			{
+				if (rsp->packet[HKDS_PACKET_FLAG_OFFSET] == (uint8_t)packet_message_response && loop->cpt[idx] != NULL)
+				{
+					utils_memory_copy(loop->pln[idx], rsp->packet + HKDS_HEADER_SIZE, HKDS_MESSAGE_SIZE);
+					loop->valid[idx] = true;
+				}
+				else if (rsp->packet[HKDS_PACKET_FLAG_OFFSET] == (uint8_t)packet_token_response && loop->cpt[idx] == NULL)
+				{
+					utils_memory_copy(loop->pln[idx], rsp->packet + HKDS_HEADER_SIZE, HKDS_ETOK_SIZE);
+					loop->valid[idx] = true;
+				}
+
+				++done;
+			}
+		}
+
+		hkds_ipc_release(&loop->channel.responses, avail);
+	}
+}
+
+static void hkds_daemon_flush(hkds_daemon_loop* loop)
+{
+	hkds_error_message err;
+	uint8_t emsg[HKDS_ERROR_SIZE] = { 0 };
+	size_t mcount;
+
+	if (loop->count != 0U)
+	{
+		mcount = loop->count;
+
+		if (loop->worker != 0)
+		{
+			/* the key worker decrypts the batch, and answers the deferred token requests */
+			hkds_daemon_flush_worker(loop);
+		}
+		else if (loop->daemon->config.authenticated == true)
+		{
+			/* the KSN pointers stand in for the additional data, which has zero length */
+			hkds_server_decrypt_verify_batch(&loop->tss, loop->count, loop->ksn, loop->cpt, loop->ksn, 0U, loop->pln, loop->valid);
+		}
+		else
+		{
+			hkds_server_decrypt_batch(&loop->tss, loop->count, loop->ksn, loop->cpt, loop->pln);
+
+			for (size_t i = 0U; i < loop->count; ++i)
+			{
+				loop->valid[i] = true;
+			}
+		}
+
+		for (size_t i = 0U; i < loop->count; ++i)
+		{
+			if (loop->cpt[i] == NULL)
+			{
+				--mcount;
+			}
+
+			if (loop->valid[i] == false)
+			{
+				hkds_daemon_count(&loop->failures, 1U);
+
+				if (loop->cpt[i] == NULL)
+				{
+					utils_memory_clear(loop->pln[i], HKDS_ETOK_SIZE);
+				}
+				else if (loop->slot[i] != NULL)
+				{
+					/* an error message is the same size as a message response */
+					err = hkds_factory_create_error_message(emsg, error_general_failure);
+					err.header.sequence = loop->slot[i][HKDS_PACKET_SEQUENCE_OFFSET];
+					hkds_factory_serialize_error_message(loop->slot[i], &err);
+				}
+				else
+				{
+					utils_memory_clear(loop->pln[i], HKDS_MESSAGE_SIZE);
+				}
+			}
+
+			if (loop->owner[i] != NULL)
+			{
+				loop->owner[i]->pending = 0U;
+			}
+		}
+
+		hkds_daemon_count(&loop->messages, mcount);
+		hkds_daemon_count(&loop->batches, 1U);
+		loop->count = 0U;
+	}
+}
+
+static void hkds_daemon_collect(hkds_daemon_loop* loop, hkds_daemon_connection* conn, const uint8_t* ksn, const uint8_t* ciphertext,
+	uint8_t* plaintext, uint8_t* slot)
+{
+	if (loop->count == HKDS_DAEMON_BATCH_DEPTH)
+	{
+		hkds_daemon_flush(loop);
+	}
+
+	loop->ksn[loop->count] = ksn;
+	loop->cpt[loop->count] = ciphertext;
+	loop->pln[loop->count] = plaintext;
+	loop->slot[loop->count] = slot;
+	loop->owner[loop->count] = conn;
+	++loop->count;
+
+	if (conn != NULL)
+	{
+		++conn->pending;
+	}
+}
+
+/* request handling */
+
+static uint8_t* hkds_daemon_reserve(hkds_daemon_loop* loop, hkds_daemon_connection* conn, size_t length)
+{
+	uint8_t* res;
+	size_t rem;
+
+	res = NULL;
+
+	/* the buffer is only compacted while the kernel holds no reference to it */
+	if (HKDS_DAEMON_SEND_SIZE - conn->outtail < length && conn->outhead != 0U && conn->sending == 0U && conn->notices == 0U)
+	{
+		if (conn->pending != 0U)
+		{
+			/* the reserved slots are filled before the unsent responses are moved */
+			hkds_daemon_flush(loop);
+		}
+
+		rem = conn->outtail - conn->outhead;
+		memmove(conn->output, conn->output + conn->outhead, rem);
+		conn->outhead = 0U;
+		conn->outtail = rem;
+	}
+
+	if (HKDS_DAEMON_SEND_SIZE - conn->outtail >= length)
+	{
+		res = conn->output + conn->outtail;
+		conn->outtail += length;
+	}
+
+	return res;
+}
+
+static void hkds_daemon_token(hkds_daemon_loop* loop, hkds_daemon_connection* conn, const uint8_t* ksn, uint8_t* etok)
+{
+	hkds_server_state ss;
+
+	if (loop->worker != 0)
+	{
+		/* the token is encrypted by the key worker with the next batch */
+		hkds_daemon_collect(loop, conn, ksn, NULL, etok, NULL);
+	}
+	else
+	{
+		hkds_server_initialize_state(&ss, loop->tss.mdk, ksn);
+		hkds_server_encrypt_token(&ss, etok);
+		utils_memory_secure_erase((uint8_t*)&ss, sizeof(ss));
+	}
+
+	hkds_daemon_count(&loop->tokens, 1U);
+}
+
+static void hkds_daemon_error(hkds_daemon_loop* loop, hkds_daemon_connection* conn, hkds_error_type code)
+{
+	hkds_error_message err;
+	uint8_t emsg[HKDS_ERROR_SIZE] = { 0 };
+	uint8_t* slot;
+
+	slot = hkds_daemon_reserve(loop, conn, HKDS_ERROR_MESSAGE_SIZE);
+
+	if (slot != NULL)
+	{
+		err = hkds_factory_create_error_message(emsg, code);
+		hkds_factory_serialize_error_message(slot, &err);
+	}
+
+	hkds_daemon_count(&loop->malformed, 1U);
+	conn->closing = true;
+}
+
+static size_t hkds_daemon_envelope(hkds_daemon_loop* loop, hkds_daemon_connection* conn, const hkds_batch_view* bv)
+{
+	hkds_packet_type rtype;
+	uint8_t* slot;
+	size_t rlen;
+	size_t res;
+
+	res = 0U;
+	rtype = (bv->rectype == packet_message_request) ? packet_message_response : packet_token_response;
+	rlen = hkds_factory_batch_record_size(rtype);
+	slot = hkds_daemon_reserve(loop, conn, HKDS_BATCH_HEADER_SIZE + (bv->count * rlen));
+
+	if (slot != NULL)
+	{
+		hkds_factory_serialize_batch_response(slot, HKDS_BATCH_HEADER_SIZE + (bv->count * rlen), rtype, NULL, bv->count, bv->sequence);
+
+		for (size_t i = 0U; i < bv->count; ++i)
+		{
+			if (bv->rectype == packet_message_request)
+			{
+				hkds_daemon_collect(loop, conn, bv->records + (i * bv->stride), bv->records + (i * bv->stride) + HKDS_KSN_SIZE,
+					slot + HKDS_BATCH_HEADER_SIZE + (i * rlen), NULL);
+			}
+			else
+			{
+				hkds_daemon_token(loop, conn, bv->records + (i * bv->stride), slot + HKDS_BATCH_HEADER_SIZE + (i * rlen));
+			}
+		}
+
+		hkds_daemon_count(&loop->envelopes, 1U);
+		res = bv->length;
+	}
+
+	return res;
+}
+
+static size_t hkds_daemon_response_size(hkds_packet_type type)
+{
+	size_t res;
+
+	if (type == packet_message_request)
+	{
+		res = HKDS_SERVER_MESSAGE_RESPONSE_SIZE;
+	}
+	else if (type == packet_token_request)
+	{
+		res = HKDS_SERVER_TOKEN_RESPONSE_SIZE;
+	}
+	else
+	{
+		res = 0U;
+	}
+
+	return res;
+}
+
+static void hkds_daemon_answer(hkds_daemon_loop* loop, hkds_daemon_connection* conn, const hkds_packet_view* pv, uint8_t* slot)
+{
+	uint8_t etok[HKDS_ETOK_SIZE] = { 0 };
+	uint8_t zero[HKDS_MESSAGE_SIZE] = { 0 };
+	hkds_server_message_response rsp;
+	hkds_server_token_response trsp;
+
+	if (pv->type == packet_message_request)
+	{
+		/* the header is written now, and the message is decrypted into the slot with the batch */
+		rsp = hkds_factory_create_server_message_response(zero);
+		rsp.header.sequence = pv->sequence;
+		hkds_factory_serialize_server_message(slot, &rsp);
+		hkds_daemon_collect(loop, conn, pv->ksn, pv->message, slot + HKDS_HEADER_SIZE, slot);
+	}
+	else
+	{
+		/* the header is written with a zero token, and the token is encrypted into the slot */
+		trsp = hkds_factory_create_server_token_reponse(etok);
+		trsp.header.sequence = pv->sequence;
+		hkds_factory_serialize_server_token(slot, &trsp);
+		hkds_daemon_token(loop, conn, pv->ksn, slot + HKDS_HEADER_SIZE);
+	}
+}
+
+static size_t hkds_daemon_packet(hkds_daemon_loop* loop, hkds_daemon_connection* conn, const hkds_packet_view* pv)
+{
+	uint8_t* slot;
+	size_t res;
+
+	res = 0U;
+
+	if (pv->type == packet_message_request || pv->type == packet_token_request)
+	{
+		slot = hkds_daemon_reserve(loop, conn, hkds_daemon_response_size(pv->type));
+
+		if (slot != NULL)
+		{
+			hkds_daemon_answer(loop, conn, pv, slot);
+			res = pv->length;
+		}
+	}
+	else if (pv->type == packet_administrative_message)
+	{
+		/* administrative messages are accepted without a response */
+		res = pv->length;
+	}
+	else
+	{
+		/* a response or an error from the client ends the session */
+		hkds_daemon_error(loop, conn, error_invalid_format);
+	}
+
+	return res;
+}
+
+static size_t hkds_daemon_process(hkds_daemon_loop* loop, hkds_daemon_connection* conn, const uint8_t* run, size_t rlen)
+{
+	hkds_batch_view bv;
+	hkds_packet_view pv;
+	size_t flen;
+	size_t pos;
+
+	pos = 0U;
+
+	/* the frames are viewed in place, and the collected requests refer to them until the batch is decrypted */
+	while (pos < rlen && conn->blocked == false && conn->closing == false)
+	{
+		if (run[pos + HKDS_PACKET_FLAG_OFFSET] == (uint8_t)packet_batch_request && hkds_factory_view_batch(&bv, run + pos, rlen - pos) == true)
+		{
+			flen = hkds_daemon_envelope(loop, conn, &bv);
+		}
+		else if (hkds_factory_view_packet(&pv, run + pos, rlen - pos) == true)
+		{
+			flen = hkds_daemon_packet(loop, conn, &pv);
+		}
+		else
+		{
+			/* a batch response envelope from the client */
+			hkds_daemon_error(loop, conn, error_invalid_format);
+			flen = 0U;
+		}
+
+		if (flen != 0U)
+		{
+			pos += flen;
+		}
+		else if (conn->closing == false)
+		{
+			/* the send buffer is full; reading resumes when the peer drains it */
+			conn->blocked = true;
+		}
+	}
+
+	return pos;
+}
+
+static void hkds_daemon_drain(hkds_daemon_loop* loop, hkds_daemon_connection* conn)
+{
+	const uint8_t* run;
+	size_t pos;
+	size_t rlen;
+
+	rlen = hkds_framer_complete(&conn->framer, &run);
+	pos = hkds_daemon_process(loop, conn, run, rlen);
+
+	/* the frames are taken after they are answered */
+	hkds_framer_consume(&conn->framer, pos);
+
+	if (conn->framer.malformed == true && conn->blocked == false && conn->closing == false)
+	{
+		hkds_daemon_error(loop, conn, error_invalid_format);
+	}
+}
+
+static void hkds_daemon_receive(hkds_daemon_loop* loop, hkds_daemon_connection* conn)
+{
+	uint8_t buf[HKDS_DAEMON_READ_SIZE];
+	ssize_t blen;
+	size_t space;
+
+	/* the read is limited to the free framer space, so the framer accepts all of it */
+	space = conn->framer.capacity - hkds_framer_pending(&conn->framer);
+	space = (space < sizeof(buf)) ? space : sizeof(buf);
+
+	if (space != 0U)
+	{
+		blen = recv(conn->fd, buf, space, 0);
+
+		if (blen > 0)
+		{
+			if (conn->pending != 0U)
+			{
+				/* the collected requests refer to the framer buffer, which the write may move */
+				hkds_daemon_flush(loop);
+			}
+
+			hkds_framer_write(&conn->framer, buf, (size_t)blen);
+		}
+		else if (blen == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+		{
+			conn->closing = true;
+		}
+	}
+
+	if (conn->closing == false)
+	{
+		hkds_daemon_drain(loop, conn);
+	}
+}
+
+/* datagrams */
+
+static void hkds_daemon_datagrams(hkds_daemon_loop* loop)
+{
+	hkds_packet_view pv;
+	size_t count;
+	size_t dlen;
+	size_t round;
+	int rcnt;
+	int scnt;
+	int slen;
+	bool valid;
+
+	round = 0U;
+	rcnt = (int)HKDS_DAEMON_DATAGRAM_BATCH;
+
+	/* full batches are read again, up to the round limit; the socket is still readable if more are queued */
+	while (round < HKDS_DAEMON_DATAGRAM_ROUNDS && rcnt == (int)HKDS_DAEMON_DATAGRAM_BATCH)
+	{
+		for (size_t i = 0U; i < HKDS_DAEMON_DATAGRAM_BATCH; ++i)
+		{
+			loop->dgrecv[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+		}
+
+		rcnt = recvmmsg(loop->udpfd, loop->dgrecv, HKDS_DAEMON_DATAGRAM_BATCH, MSG_DONTWAIT, NULL);
+		count = 0U;
+
+		for (int i = 0; i < rcnt; ++i)
+		{
+			dlen = loop->dgrecv[i].msg_len;
+			valid = ((loop->dgrecv[i].msg_hdr.msg_flags & MSG_TRUNC) == 0 && hkds_factory_view_packet(&pv, loop->dgin[i], dlen) == true &&
+				pv.length == dlen);
+
+			if (valid == true && (pv.type == packet_message_request || pv.type == packet_token_request))
+			{
+				/* the requests are decrypted in place, into the response of the same index */
+				hkds_daemon_answer(loop, NULL, &pv, loop->dgout[count]);
+				loop->dgoutv[count].iov_len = hkds_daemon_response_size(pv.type);
+				loop->dgsend[count].msg_hdr.msg_name = &loop->dgpeer[i];
+				loop->dgsend[count].msg_hdr.msg_namelen = loop->dgrecv[i].msg_hdr.msg_namelen;
+				++count;
+			}
+			else if (valid == false || pv.type != packet_administrative_message)
+			{
+				hkds_daemon_count(&loop->malformed, 1U);
+			}
+			else
+			{
+				/* administrative messages are accepted without a response */
+			}
+		}
+
+		if (count != 0U)
+		{
+			hkds_daemon_flush(loop);
+			scnt = 0;
+
+			slen = 1;
+
+			/* the socket buffer is full when nothing more is sent, and the remaining responses are dropped like lost datagrams */
+			while (scnt < (int)count && slen > 0)
+			{
+				slen = sendmmsg(loop->udpfd, loop->dgsend + scnt, (unsigned int)(count - (size_t)scnt), MSG_DONTWAIT);
+				scnt += (slen > 0) ? slen : 0;
+			}
+
+			hkds_daemon_count(&loop->datagrams, (uint64_t)scnt);
+		}
+
+		++round;
+	}
+}
+
+/* event loop */
+
+static void* hkds_daemon_run(void* context)
+{
+	struct epoll_event events[HKDS_DAEMON_MAX_EVENTS];
+	hkds_daemon_loop* loop;
+	hkds_daemon_connection* conn;
+	const void* unixtag;
+	int ecnt;
+	bool running;
+
+	loop = (hkds_daemon_loop*)context;
+	unixtag = &loop->daemon->unixfd;
+	running = true;
+
+	while (running == true)
+	{
+		ecnt = epoll_wait(loop->epfd, events, (int)HKDS_DAEMON_MAX_EVENTS, -1);
+
+		for (int i = 0; i < ecnt; ++i)
+		{
+			if (events[i].data.ptr == &loop->wakefd)
+			{
+				running = false;
+			}
+			else if (events[i].data.ptr == &loop->listenfd)
+			{
+				hkds_daemon_accept(loop, loop->listenfd, true);
+			}
+			else if (events[i].data.ptr == unixtag)
+			{
+				hkds_daemon_accept(loop, loop->daemon->unixfd, false);
+			}
+			else if (events[i].data.ptr == &loop->udpfd)
+			{
+				hkds_daemon_datagrams(loop);
+			}
+			else
+			{
+				conn = (hkds_daemon_connection*)events[i].data.ptr;
+
+				if ((events[i].events & EPOLLOUT) != 0U)
+				{
+					hkds_daemon_send(conn);
+
+					if (conn->blocked == true && conn->outhead == conn->outtail)
+					{
+						conn->blocked = false;
+						hkds_daemon_drain(loop, conn);
+					}
+				}
+
+				if ((events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0U && conn->blocked == false && conn->closing == false)
+				{
+					hkds_daemon_receive(loop, conn);
+				}
+			}
+		}
+
+		/* the requests of every connection served in this pass are decrypted together */
+		hkds_daemon_flush(loop);
+
+		for (int i = 0; i < ecnt; ++i)
+		{
+			if (events[i].data.ptr != &loop->wakefd && events[i].data.ptr != &loop->listenfd && events[i].data.ptr != unixtag &&
+				events[i].data.ptr != &loop->udpfd)
+			{
+				conn = (hkds_daemon_connection*)events[i].data.ptr;
+				hkds_daemon_send(conn);
+
+				if (conn->closing == true)
+				{
+					hkds_daemon_connection_close(loop, conn);
+				}
+				else
+				{
+					hkds_daemon_update_interest(loop, conn);
+				}
+			}
+		}
+	}
+
+	return NULL;
+}
+
+#if defined(HKDS_DAEMON_URING)
+
+/* io_uring event loop */
+
+typedef enum
+{
+	hkds_daemon_uring_wake = 0x01U,
+	hkds_daemon_uring_accept = 0x02U,
+	hkds_daemon_uring_receive = 0x03U,
+	hkds_daemon_uring_send = 0x04U,
+	hkds_daemon_uring_cancel = 0x05U,
+	hkds_daemon_uring_datagram = 0x06U
+} hkds_daemon_uring_operation;
+
+static uint64_t hkds_daemon_uring_tag(hkds_daemon_uring_operation op, uint32_t index)
+{
+	/* the operation is in the high word of the completion tag, and the connection slot in the low word */
+	return ((uint64_t)op << 32U) | (uint64_t)index;
+}
+
+static struct io_uring_sqe* hkds_daemon_uring_entry(hkds_daemon_loop* loop)
+{
+	struct io_uring_sqe* sqe;
+
+	sqe = hkds_uring_get_sqe(&loop->uring);
+
+	if (sqe == NULL)
+	{
+		/* the submission queue is full; it is submitted early to make room */
+		hkds_uring_submit(&loop->uring, 0U);
+		sqe = hkds_uring_get_sqe(&loop->uring);
+	}
+
+	return sqe;
+}
+
+static bool hkds_daemon_uring_arm_accept(hkds_daemon_loop* loop, int fd, uint32_t index)
+{
+	struct io_uring_sqe* sqe;
+	bool res;
+
+	res = false;
+	sqe = hkds_daemon_uring_entry(loop);
+
+	if (sqe != NULL)
+	{
+		hkds_uring_prep_accept(sqe, fd, hkds_daemon_uring_tag(hkds_daemon_uring_accept, index));
+		res = true;
+	}
+
+	return res;
+}
+
+static bool hkds_daemon_uring_arm_datagrams(hkds_daemon_loop* loop)
+{
+	struct io_uring_sqe* sqe;
+	bool res;
+
+	res = false;
+	sqe = hkds_daemon_uring_entry(loop);
+
+	if (sqe != NULL)
+	{
+		/* datagrams are small and stateless, so the socket is polled and read with recvmmsg */
+		hkds_uring_prep_poll(sqe, loop->udpfd, hkds_daemon_uring_tag(hkds_daemon_uring_datagram, 0U));
+		res = true;
+	}
+
+	return res;
+}
+
+static void hkds_daemon_uring_arm_receive(hkds_daemon_loop* loop, hkds_daemon_connection* conn)
+{
+	struct io_uring_sqe* sqe;
+
+	sqe = hkds_daemon_uring_entry(loop);
+
+	if (sqe != NULL)
+	{
+		hkds_uring_prep_recv(sqe, conn->fd, loop->receive.group, hkds_daemon_uring_tag(hkds_daemon_uring_receive, conn->index));
+		conn->receiving = true;
+		++conn->operations;
+	}
+	else
+	{
+		conn->closing = true;
+	}
+}
+
+static void hkds_daemon_uring_disarm_receive(hkds_daemon_loop* loop, hkds_daemon_connection* conn)
+{
+	struct io_uring_sqe* sqe;
+
+	if (conn->receiving == true && conn->cancelling == false)
+	{
+		sqe = hkds_daemon_uring_entry(loop);
+
+		if (sqe != NULL)
+		{
+			hkds_uring_prep_cancel(sqe, hkds_daemon_uring_tag(hkds_daemon_uring_receive, conn->index),
+				hkds_daemon_uring_tag(hkds_daemon_uring_cancel, conn->index));
+			conn->cancelling = true;
+			++conn->operations;
+		}
+	}
+}
+
+static void hkds_daemon_uring_send_pending(hkds_daemon_loop* loop, hkds_daemon_connection* conn)
+{
+	struct io_uring_sqe* sqe;
+
+	if (conn->sending == 0U && conn->outhead != conn->outtail && conn->shut == false)
+	{
+		sqe = hkds_daemon_uring_entry(loop);
+
+		if (sqe != NULL)
+		{
+			conn->sending = conn->outtail - conn->outhead;
+			hkds_uring_prep_send(sqe, conn->fd, conn->output + conn->outhead, conn->sending, (uint16_t)conn->index,
+				(conn->copying == false), hkds_daemon_uring_tag(hkds_daemon_uring_send, conn->index));
+			++conn->operations;
+		}
+		else
+		{
+			conn->closing = true;
+			conn->outhead = conn->outtail;
+		}
+	}
+}
+
+static void hkds_daemon_uring_touch(hkds_daemon_loop* loop, hkds_daemon_connection* conn)
+{
+	if (conn->touched == false)
+	{
+		conn->touched = true;
+		loop->touch[loop->touchcount] = conn;
+		++loop->touchcount;
+	}
+}
+
+static void hkds_daemon_uring_recycle(hkds_daemon_loop* loop, uint16_t bid)
+{
+	/* the buffer is returned now, and published to the kernel after the batch is decrypted */
+	hkds_uring_buffers_recycle(&loop->receive, bid);
+	loop->recycled = true;
+}
+
+static void hkds_daemon_uring_hold(hkds_daemon_connection* conn, uint16_t bid, size_t offset, size_t length)
+{
+	size_t pos;
+
+	/* a connection cannot hold more buffers than the ring has */
+	pos = (conn->heldfirst + conn->heldcount) & (HKDS_DAEMON_URING_BUFFERS - 1U);
+	conn->heldid[pos] = bid;
+	conn->heldoffset[pos] = (uint32_t)offset;
+	conn->heldlength[pos] = (uint32_t)length;
+	++conn->heldcount;
+}
+
+static void hkds_daemon_uring_release_held(hkds_daemon_loop* loop, hkds_daemon_connection* conn)
+{
+	while (conn->heldcount != 0U)
+	{
+		hkds_daemon_uring_recycle(loop, conn->heldid[conn->heldfirst]);
+		conn->heldfirst = (conn->heldfirst + 1U) & (HKDS_DAEMON_URING_BUFFERS - 1U);
+		--conn->heldcount;
+	}
+}
+
+static size_t hkds_daemon_uring_frame(hkds_daemon_loop* loop, hkds_daemon_connection* conn, const uint8_t* input, size_t inplen)
+{
+	size_t acc;
+	size_t need;
+	size_t pos;
+	size_t rlen;
+	bool malformed;
+
+	pos = 0U;
+	malformed = false;
+
+	/* a frame split across receives is completed in the framer first */
+	while (pos < inplen && conn->blocked == false && conn->closing == false && hkds_framer_pending(&conn->framer) != 0U)
+	{
+		need = hkds_framer_needed(&conn->framer);
+		need = (need == 0U || need > inplen - pos) ? inplen - pos : need;
+
+		if (conn->pending != 0U)
+		{
+			/* the collected requests refer to the framer buffer, which the write may move */
+			hkds_daemon_flush(loop);
+		}
+
+		acc = hkds_framer_write(&conn->framer, input + pos, need);
+		pos += acc;
+
+		if (acc != need)
+		{
+			conn->closing = true;
+		}
+		else
+		{
+			hkds_daemon_drain(loop, conn);
+		}
+	}
+
+	if (pos < inplen && conn->blocked == false && conn->closing == false)
+	{
+		/* the complete frames are answered in the receive buffer, where the kernel placed them */
+		rlen = hkds_framer_scan(input + pos, inplen - pos, conn->framer.capacity, &malformed);
+		acc = hkds_daemon_process(loop, conn, input + pos, rlen);
+		pos += acc;
+
+		if (malformed == true && acc == rlen && conn->blocked == false && conn->closing == false)
+		{
+			hkds_daemon_error(loop, conn, error_invalid_format);
+		}
+		else if (pos < inplen && conn->blocked == false && conn->closing == false)
+		{
+			if (conn->pending != 0U)
+			{
+				hkds_daemon_flush(loop);
+			}
+
+			/* only the trailing split frame is copied */
+			if (hkds_framer_write(&conn->framer, input + pos, inplen - pos) == inplen - pos)
+			{
+				pos = inplen;
+			}
+			else
+			{
+				conn->closing = true;
+			}
+		}
+	}
+
+	return pos;
+}
+
+static void hkds_daemon_uring_settle(hkds_daemon_loop* loop, hkds_daemon_connection* conn)
+{
+	size_t used;
+	size_t first;
+
+	if (conn->sending == 0U && conn->notices == 0U)
+	{
+		if (conn->outhead == conn->outtail)
+		{
+			conn->outhead = 0U;
+			conn->outtail = 0U;
+		}
+
+		if (conn->blocked == true && conn->closing == false)
+		{
+			/* with the buffer released by the kernel, it can be compacted and the framed requests answered */
+			conn->blocked = false;
+			hkds_daemon_drain(loop, conn);
+		}
+
+		/* the buffers received while the connection was blocked are read in order */
+		while (conn->heldcount != 0U && conn->blocked == false && conn->closing == false)
+		{
+			first = conn->heldfirst;
+			used = hkds_daemon_uring_frame(loop, conn, hkds_uring_buffers_address(&loop->receive, conn->heldid[first]) +
+				conn->heldoffset[first], conn->heldlength[first] - conn->heldoffset[first]);
+			conn->heldoffset[first] += (uint32_t)used;
+
+			if (conn->heldoffset[first] == conn->heldlength[first])
+			{
+				hkds_daemon_uring_recycle(loop, conn->heldid[first]);
+				conn->heldfirst = (first + 1U) & (HKDS_DAEMON_URING_BUFFERS - 1U);
+				--conn->heldcount;
+			}
+		}
+	}
+
+	if (conn->blocked == false && conn->closing == false && conn->receiving == false && conn->starved == false && conn->heldcount == 0U)
+	{
+		hkds_daemon_uring_arm_receive(loop, conn);
+	}
+
+	hkds_daemon_uring_touch(loop, conn);
+}
+
+static void hkds_daemon_uring_accepted(hkds_daemon_loop* loop, int fd, bool tcp)
+{
+	hkds_daemon_connection* conn;
+	uint32_t index;
+	int one;
+
+	one = 1;
+	index = 0U;
+
+	while (index < HKDS_DAEMON_URING_SLOTS && loop->slots[index] != NULL)
+	{
+		++index;
+	}
+
+	conn = NULL;
+
+	if (index < HKDS_DAEMON_URING_SLOTS)
+	{
+		conn = hkds_daemon_connection_create(loop, fd, index);
+	}
+
+	if (conn != NULL)
+	{
+		if (tcp == true)
+		{
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		}
+		else
+		{
+			/* Unix sockets copy the sent bytes */
+			conn->copying = true;
+		}
+
+		loop->slots[index] = conn;
+		hkds_daemon_uring_arm_receive(loop, conn);
+		hkds_daemon_uring_touch(loop, conn);
+	}
+	else
+	{
+		/* every slot of the loop is in use */
+		close(fd);
+	}
+}
+
+static bool hkds_daemon_uring_complete(hkds_daemon_loop* loop, const struct io_uring_cqe* cqe)
+{
+	hkds_daemon_connection* conn;
+	hkds_daemon_uring_operation op;
+	size_t used;
+	uint32_t index;
+	uint16_t bid;
+	bool more;
+	bool res;
+
+	res = true;
+	op = (hkds_daemon_uring_operation)(cqe->user_data >> 32U);
+	index = (uint32_t)(cqe->user_data & 0xFFFFFFFFULL);
+	more = ((cqe->flags & IORING_CQE_F_MORE) != 0U);
+	conn = (index < HKDS_DAEMON_URING_SLOTS) ? loop->slots[index] : NULL;
+
+	if (op == hkds_daemon_uring_wake)
+	{
+		res = false;
+	}
+	else if (op == hkds_daemon_uring_accept)
+	{
+		if (cqe->res >= 0)
+		{
+			hkds_daemon_uring_accepted(loop, cqe->res, (index == 0U));
+		}
+
+		if (more == false)
+		{
+			hkds_daemon_uring_arm_accept(loop, (index == 0U) ? loop->listenfd : loop->daemon->unixfd, index);
+		}
+	}
+	else if (op == hkds_daemon_uring_datagram)
+	{
+		hkds_daemon_datagrams(loop);
+		hkds_daemon_uring_arm_datagrams(loop);
+	}
+	else if (conn != NULL && op == hkds_daemon_uring_receive)
+	{
+		if ((cqe->flags & IORING_CQE_F_BUFFER) != 0U)
+		{
+			bid = (uint16_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+			used = 0U;
+
+			if (cqe->res > 0 && conn->closing == false && conn->blocked == false && conn->heldcount == 0U)
+			{
+				used = hkds_daemon_uring_frame(loop, conn, hkds_uring_buffers_address(&loop->receive, bid), (size_t)cqe->res);
+			}
+
+			if (cqe->res > 0 && conn->closing == false && used < (size_t)cqe->res)
+			{
+				/* the unread bytes of a blocked connection stay in the receive buffer until it resumes */
+				hkds_daemon_uring_hold(conn, bid, used, (size_t)cqe->res);
+			}
+			else
+			{
+				hkds_daemon_uring_recycle(loop, bid);
+			}
+		}
+
+		if (more == false)
+		{
+			conn->receiving = false;
+			conn->cancelling = false;
+			--conn->operations;
+
+			if (cqe->res == -ENOBUFS)
+			{
+				/* every buffer is in use; the receive is re-armed after buffers are recycled */
+				conn->starved = true;
+			}
+			else if (cqe->res == 0 || (cqe->res < 0 && cqe->res != -ECANCELED))
+			{
+				conn->closing = true;
+			}
+			else
+			{
+				/* a cancelled receive is re-armed when the connection resumes */
+			}
+		}
+
+		if (conn->blocked == true)
+		{
+			hkds_daemon_uring_disarm_receive(loop, conn);
+		}
+
+		hkds_daemon_uring_settle(loop, conn);
+	}
+	else if (conn != NULL && op == hkds_daemon_uring_send)
+	{
+		if ((cqe->flags & IORING_CQE_F_NOTIF) != 0U)
+		{
+			--conn->notices;
+			--conn->operations;
+		}
+		else
+		{
+			conn->sending = 0U;
+
+			if (more == true)
+			{
+				/* the operation stays in flight until the notification arrives */
+				++conn->notices;
+			}
+			else
+			{
+				--conn->operations;
+			}
+
+			if (cqe->res > 0)
+			{
+				conn->outhead += (size_t)cqe->res;
+			}
+			else if (cqe->res == -EOPNOTSUPP && conn->copying == false)
+			{
+				/* the socket has no zero-copy support, and the responses are sent again with a copying send */
+				conn->copying = true;
+			}
+			else
+			{
+				conn->closing = true;
+				conn->outhead = conn->outtail;
+			}
+		}
+
+		hkds_daemon_uring_settle(loop, conn);
+	}
+	else if (conn != NULL && op == hkds_daemon_uring_cancel)
+	{
+		--conn->operations;
+		hkds_daemon_uring_touch(loop, conn);
+	}
+	else
+	{
+		/* a completion without a connection */
+	}
+
+	return res;
+}
+
+static void hkds_daemon_uring_pass(hkds_daemon_loop* loop)
+{
+	hkds_daemon_connection* conn;
+
+	/* the requests of every connection served in this pass are decrypted together */
+	hkds_daemon_flush(loop);
+
+	for (size_t i = 0U; i < loop->touchcount; ++i)
+	{
+		conn = loop->touch[i];
+		conn->touched = false;
+		hkds_daemon_uring_send_pending(loop, conn);
+
+		if (conn->closing == true)
+		{
+			hkds_daemon_uring_release_held(loop, conn);
+
+			/* the last responses are sent, then the socket is shut down, and released when nothing is in flight */
+			if (conn->shut == false && conn->sending == 0U)
+			{
+				shutdown(conn->fd, SHUT_RDWR);
+				conn->shut = true;
+				hkds_daemon_uring_disarm_receive(loop, conn);
+			}
+
+			if (conn->shut == true && conn->operations == 0U)
+			{
+				hkds_daemon_connection_release(loop, conn);
+			}
+		}
+	}
+
+	loop->touchcount = 0U;
+
+	if (loop->recycled == true)
+	{
+		hkds_uring_buffers_publish(&loop->receive);
+		loop->recycled = false;
+
+		for (size_t i = 0U; i < HKDS_DAEMON_URING_SLOTS; ++i)
+		{
+			conn = loop->slots[i];
+
+			if (conn != NULL && conn->starved == true)
+			{
+				/* a blocked connection is re-armed when it resumes */
+				conn->starved = false;
+
+				if (conn->blocked == false && conn->closing == false && conn->receiving == false && conn->heldcount == 0U)
+				{
+					hkds_daemon_uring_arm_receive(loop, conn);
+				}
+			}
+		}
+	}
+}
+
+static void* hkds_daemon_uring_run(void* context)
+{
+	struct io_uring_cqe* cqe;
+	hkds_daemon_loop* loop;
+	bool running;
+
+	loop = (hkds_daemon_loop*)context;
+	running = hkds_uring_enable(&loop->uring);
+
+	while (running == true)
+	{
+		hkds_uring_submit(&loop->uring, 1U);
+		cqe = hkds_uring_peek(&loop->uring);
+
+		while (cqe != NULL)
+		{
+			if (hkds_daemon_uring_complete(loop, cqe) == false)
+			{
+				running = false;
+			}
+
+			hkds_uring_advance(&loop->uring);
+			cqe = hkds_uring_peek(&loop->uring);
+		}
+
+		hkds_daemon_uring_pass(loop);
+	}
+
+	return NULL;
+}
+
+#endif
+
+/* sockets */
+
+static int hkds_daemon_listen_tcp(const hkds_daemon_config* config)
+{
+	struct sockaddr_in sa = { 0 };
+	int fd;
+	int one;
+
+	one = 1;
+	fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+	if (fd >= 0)
+	{
+		sa.sin_family = AF_INET;
+		sa.sin_port = htons(config->port);
+
+		/* every loop binds its own socket to the port, and the kernel balances the connections across them */
+		if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+			setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0 ||
+			inet_pton(AF_INET, config->address, &sa.sin_addr) != 1 ||
+			bind(fd, (struct sockaddr*)&sa, sizeof(sa)) != 0 ||
+			listen(fd, SOMAXCONN) != 0)
+		{
+			close(fd);
+			fd = -1;
+		}
+	}
+
+	return fd;
+}
+
+static int hkds_daemon_listen_udp(const hkds_daemon_config* config)
+{
+	struct sockaddr_in sa = { 0 };
+	int fd;
+	int one;
+
+	one = 1;
+	fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+	if (fd >= 0)
+	{
+		sa.sin_family = AF_INET;
+		sa.sin_port = htons(config->udpport);
+
+		/* the kernel spreads the datagrams of different sources across the sockets of the loops */
+		if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+			setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0 ||
+			inet_pton(AF_INET, config->address, &sa.sin_addr) != 1 ||
+			bind(fd, (struct sockaddr*)&sa, sizeof(sa)) != 0)
+		{
+			close(fd);
+			fd = -1;
+		}
+	}
+
+	return fd;
+}
+
+static int hkds_daemon_listen_unix(const hkds_daemon_config* config)
+{
+	struct sockaddr_un sa = { 0 };
+	int fd;
+
+	fd = -1;
+
+	if (strlen(config->unixpath) < sizeof(sa.sun_path))
+	{
+		fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+		if (fd >= 0)
+		{
+			sa.sun_family = AF_UNIX;
+			memcpy(sa.sun_path, config->unixpath, strlen(config->unixpath));
+			unlink(config->unixpath);
+
+			if (bind(fd, (struct sockaddr*)&sa, sizeof(sa)) != 0 || listen(fd, SOMAXCONN) != 0)
+			{
+				close(fd);
+				fd = -1;
+			}
+		}
+	}
+
+	return fd;
+}
+
+static bool hkds_daemon_loop_register(hkds_daemon_loop* loop, int fd, void* tag, uint32_t flags)
+{
+	struct epoll_event ev = { 0 };
+
+	ev.events = EPOLLIN | flags;
+	ev.data.ptr = tag;
+
+	return (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, fd, &ev) == 0);
+}
+
+static bool hkds_daemon_epoll_start(hkds_daemon_loop* loop)
+{
+	bool res;
+
+	loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+	res = (loop->epfd >= 0 && hkds_daemon_loop_register(loop, loop->wakefd, &loop->wakefd, 0U) == true);
+
+	if (res == true && loop->listenfd >= 0)
+	{
+		res = hkds_daemon_loop_register(loop, loop->listenfd, &loop->listenfd, 0U);
+	}
+
+	if (res == true && loop->udpfd >= 0)
+	{
+		res = hkds_daemon_loop_register(loop, loop->udpfd, &loop->udpfd, 0U);
+	}
+
+	if (res == true && loop->daemon->unixfd >= 0)
+	{
+		/* exclusive wakeups, so one loop accepts each Unix connection */
+		res = hkds_daemon_loop_register(loop, loop->daemon->unixfd, (void*)&loop->daemon->unixfd, EPOLLEXCLUSIVE);
+	}
+
+	return res;
+}
+
+#if defined(HKDS_DAEMON_URING)
+static bool hkds_daemon_uring_start(hkds_daemon_loop* loop)
+{
+	struct iovec iov[HKDS_DAEMON_URING_SLOTS];
+	struct io_uring_sqe* sqe;
+	bool res;
+
+	res = false;
+
+	if (hkds_uring_initialize(&loop->uring, HKDS_DAEMON_URING_ENTRIES) == true)
+	{
+		loop->slab = (uint8_t*)utils_memory_aligned_alloc(HKDS_SIMD_ALIGNMENT, HKDS_DAEMON_URING_SLOTS * HKDS_DAEMON_SEND_SIZE);
+
+		if (loop->slab != NULL)
+		{
+			/* each connection slot sends from its own registered slice of the slab */
+			for (size_t i = 0U; i < HKDS_DAEMON_URING_SLOTS; ++i)
+			{
+				iov[i].iov_base = loop->slab + (i * HKDS_DAEMON_SEND_SIZE);
+				iov[i].iov_len = HKDS_DAEMON_SEND_SIZE;
+			}
+
+			res = (hkds_uring_register_buffers(&loop->uring, iov, HKDS_DAEMON_URING_SLOTS) == true &&
+				hkds_uring_buffers_initialize(&loop->uring, &loop->receive, 0U, HKDS_DAEMON_URING_BUFFERS, HKDS_DAEMON_URING_BUFFER_SIZE) == true);
+		}
+
+		if (res == true)
+		{
+			sqe = hkds_uring_get_sqe(&loop->uring);
+			res = (sqe != NULL);
+
+			if (res == true)
+			{
+				hkds_uring_prep_poll(sqe, loop->wakefd, hkds_daemon_uring_tag(hkds_daemon_uring_wake, 0U));
+			}
+		}
+
+		if (res == true && loop->listenfd >= 0)
+		{
+			res = hkds_daemon_uring_arm_accept(loop, loop->listenfd, 0U);
+		}
+
+		if (res == true && loop->udpfd >= 0)
+		{
+			res = hkds_daemon_uring_arm_datagrams(loop);
+		}
+
+		if (res == true && loop->daemon->unixfd >= 0)
+		{
+			/* every loop accepts from the shared Unix socket, and the kernel completes each connection on one of them */
+			res = hkds_daemon_uring_arm_accept(loop, loop->daemon->unixfd, 1U);
+		}
+	}
+
+	return res;
+}
+#endif
+
+static bool hkds_daemon_loop_start(hkds_daemon_state* daemon, hkds_daemon_loop* loop)
+{
+	bool res;
+
+	res = false;
+	loop->daemon = daemon;
+	/* an isolated loop never reads the master key set */
+	loop->tss.mdk = (daemon->config.isolated == true) ? NULL : daemon->config.mdk;
+	loop->listenfd = -1;
+	loop->udpfd = -1;
+	loop->epfd = -1;
+#if defined(HKDS_DAEMON_URING)
+	loop->uring.fd = -1;
+#endif
+	loop->wakefd = eventfd(0U, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if (loop->wakefd >= 0)
+	{
+		res = true;
+
+		if (daemon->config.port != 0U)
+		{
+			loop->listenfd = hkds_daemon_listen_tcp(&daemon->config);
+			res = (loop->listenfd >= 0);
+		}
+
+		if (res == true && daemon->config.udpport != 0U)
+		{
+			loop->udpfd = hkds_daemon_listen_udp(&daemon->config);
+			res = (loop->udpfd >= 0);
+
+			for (size_t i = 0U; i < HKDS_DAEMON_DATAGRAM_BATCH; ++i)
+			{
+				loop->dginv[i].iov_base = loop->dgin[i];
+				loop->dginv[i].iov_len = HKDS_DAEMON_DATAGRAM_SIZE;
+				loop->dgrecv[i].msg_hdr.msg_name = &loop->dgpeer[i];
+				loop->dgrecv[i].msg_hdr.msg_iov = &loop->dginv[i];
+				loop->dgrecv[i].msg_hdr.msg_iovlen = 1U;
+				loop->dgoutv[i].iov_base = loop->dgout[i];
+				loop->dgsend[i].msg_hdr.msg_iov = &loop->dgoutv[i];
+				loop->dgsend[i].msg_hdr.msg_iovlen = 1U;
+			}
+		}
+
+#if defined(HKDS_DAEMON_URING)
+		if (res == true)
+		{
+			res = (daemon->config.engine == hkds_daemon_engine_uring) ? hkds_daemon_uring_start(loop) : hkds_daemon_epoll_start(loop);
+		}
+
+		if (res == true)
+		{
+			res = (pthread_create(&loop->thread, NULL, (daemon->config.engine == hkds_daemon_engine_uring) ?
+				&hkds_daemon_uring_run : &hkds_daemon_run, loop) == 0);
+			loop->started = res;
+		}
+#else
+		/* the io_uring engine is not compiled into this build */
+		if (res == true)
+		{
+			res = (daemon->config.engine == hkds_daemon_engine_epoll && hkds_daemon_epoll_start(loop) == true);
+		}
+
+		if (res == true)
+		{
+			res = (pthread_create(&loop->thread, NULL, &hkds_daemon_run, loop) == 0);
+			loop->started = res;
+		}
+#endif
+	}
+
+	return res;
+}
+
+static void hkds_daemon_loop_stop(hkds_daemon_loop* loop)
+{
+	uint64_t one;
+
+	one = 1U;
+
+	if (loop->started == true)
+	{
+		if (write(loop->wakefd, &one, sizeof(one)) == (ssize_t)sizeof(one))
+		{
+			pthread_join(loop->thread, NULL);
+		}
+
+		loop->started = false;
+	}
+
+#if defined(HKDS_DAEMON_URING)
+	if (loop->uring.fd >= 0)
+	{
+		/* closing the ring cancels the requests in flight, before their memory is released */
+		hkds_uring_destroy(&loop->uring);
+		hkds_uring_buffers_destroy(&loop->uring, &loop->receive);
+	}
+#endif
+
+	while (loop->connections != NULL)
+	{
+		hkds_daemon_connection_release(loop, loop->connections);
+	}
+
+	if (loop->slab != NULL)
+	{
+		utils_memory_aligned_free(loop->slab);
+		loop->slab = NULL;
+	}
+
+	if (loop->listenfd >= 0)
+	{
+		close(loop->listenfd);
+	}
+
+	if (loop->udpfd >= 0)
+	{
+		close(loop->udpfd);
+	}
+
+	if (loop->wakefd >= 0)
+	{
+		close(loop->wakefd);
+	}
+
+	if (loop->epfd >= 0)
+	{
+		close(loop->epfd);
+	}
+}
+
+static bool hkds_daemon_worker_start(const hkds_daemon_config* config, hkds_daemon_loop* loop)
+{
+	pid_t parent;
+	pid_t pid;
+	bool res;
+
+	res = false;
+	parent = getpid();
+
+	if (hkds_ipc_create(&loop->channel, HKDS_DAEMON_WORKER_DEPTH) == true)
+	{
+		pid = fork();
+
+		if (pid == 0)
+		{
+			/* the worker is killed with the daemon, and only serves its channel */
+			if (prctl(PR_SET_PDEATHSIG, SIGKILL) == 0 && getppid() == parent)
+			{
+				hkds_ipc_worker_run(&loop->channel, config->mdk, config->authenticated);
+			}
+
+			_exit(0);
+		}
+		else if (pid > 0)
+		{
+			loop->worker = pid;
+			res = true;
+		}
+		else
+		{
+			hkds_ipc_destroy(&loop->channel);
+		}
+	}
+
+	return res;
+}
+
+static void hkds_daemon_worker_stop(hkds_daemon_loop* loop)
+{
+	if (loop->worker != 0)
+	{
+		hkds_ipc_close(&loop->channel);
+		(void)waitpid(loop->worker, NULL, 0);
+		hkds_ipc_destroy(&loop->channel);
+		loop->worker = 0;
+	}
+}
+
+bool hkds_daemon_start(hkds_daemon_state* daemon, const hkds_daemon_config* config)
+{
+	HKDS_ASSERT(daemon != NULL);
+	HKDS_ASSERT(config != NULL);
+
+	bool res;
+
+	res = false;
+
+	if (daemon != NULL && config != NULL && config->mdk != NULL && config->address != NULL && config->loops != 0U &&
+		config->loops <= HKDS_DAEMON_MAX_LOOPS && (config->port != 0U || config->unixpath != NULL || config->udpport != 0U))
+	{
+		daemon->config = *config;
+		daemon->count = 0U;
+		daemon->unixfd = -1;
+		daemon->loops = (hkds_daemon_loop*)utils_memory_aligned_alloc(HKDS_SIMD_ALIGNMENT, config->loops * sizeof(hkds_daemon_loop));
+
+		if (daemon->loops != NULL)
+		{
+			utils_memory_clear((uint8_t*)daemon->loops, config->loops * sizeof(hkds_daemon_loop));
+			res = true;
+
+			/* the workers are forked before any socket is opened, so they hold no network descriptor */
+			for (size_t i = 0U; config->isolated == true && res == true && i < config->loops; ++i)
+			{
+				res = hkds_daemon_worker_start(config, &daemon->loops[i]);
+			}
+
+			if (res == true && config->unixpath != NULL)
+			{
+				daemon->unixfd = hkds_daemon_listen_unix(config);
+				res = (daemon->unixfd >= 0);
+			}
+
+			while (res == true && daemon->count < config->loops)
+			{
+				res = hkds_daemon_loop_start(daemon, &daemon->loops[daemon->count]);
+				++daemon->count;
+			}
+
+			if (res == false)
+			{
+				hkds_daemon_stop(daemon);
+			}
+		}
+	}
+
+	return res;
+}
+
+void hkds_daemon_stop(hkds_daemon_state* daemon)
+{
+	HKDS_ASSERT(daemon != NULL);
+
+	if (daemon != NULL && daemon->loops != NULL)
+	{
+		for (size_t i = 0U; i < daemon->count; ++i)
+		{
+			hkds_daemon_loop_stop(&daemon->loops[i]);
+		}
+
+		for (size_t i = 0U; i < daemon->config.loops; ++i)
+		{
+			hkds_daemon_worker_stop(&daemon->loops[i]);
+		}
+
+		if (daemon->unixfd >= 0)
+		{
+			close(daemon->unixfd);
+			unlink(daemon->config.unixpath);
+			daemon->unixfd = -1;
+		}
+
+		utils_memory_secure_erase((uint8_t*)daemon->loops, daemon->config.loops * sizeof(hkds_daemon_loop));
+		utils_memory_aligned_free(daemon->loops);
+		daemon->loops = NULL;
+		daemon->count = 0U;
+	}
+}
+
+void hkds_daemon_get_statistics(const hkds_daemon_state* daemon, hkds_daemon_statistics* stats)
+{
+	HKDS_ASSERT(daemon != NULL);
+	HKDS_ASSERT(stats != NULL);
+
+	hkds_daemon_loop* loop;
+
+	if (daemon != NULL && stats != NULL)
+	{
+		utils_memory_clear((uint8_t*)stats, sizeof(hkds_daemon_statistics));
+
+		for (size_t i = 0U; i < daemon->count; ++i)
+		{
+			loop = &daemon->loops[i];
+			stats->connections += atomic_load_explicit(&loop->connectioncount, memory_order_relaxed);
+			stats->messages += atomic_load_explicit(&loop->messages, memory_order_relaxed);
+			stats->tokens += atomic_load_explicit(&loop->tokens, memory_order_relaxed);
+			stats->envelopes += atomic_load_explicit(&loop->envelopes, memory_order_relaxed);
+			stats->batches += atomic_load_explicit(&loop->batches, memory_order_relaxed);
+			stats->failures += atomic_load_explicit(&loop->failures, memory_order_relaxed);
+			stats->datagrams += atomic_load_explicit(&loop->datagrams, memory_order_relaxed);
+			stats->malformed += atomic_load_explicit(&loop->malformed, memory_order_relaxed);
+		}
+	}
+}
@@ -0,0 +1,293 @@
+/* 2021-2026 Quantum Resistant Cryptographic Solutions Corporation
+ * All Rights Reserved.
+ *
+ * NOTICE:
+ * This software and all accompanying materials are the exclusive property of
+ * Quantum Resistant Cryptographic Solutions Corporation (QRCS). The intellectual
+ * and technical concepts contained herein are proprietary to QRCS and are
+ * protected under applicable Canadian, U.S., and international copyright,
+ * patent, and trade secret laws.
+ *
+ * CRYPTOGRAPHIC ALGORITHMS AND IMPLEMENTATIONS:
+ * - This software includes implementations of cryptographic primitives and
+ *   algorithms that are standardized or in the public domain, such as AES
+ *   and SHA-3, which are not proprietary to QRCS.
+ * - This software also includes cryptographic primitives, constructions, and
+ *   algorithms designed by QRCS, including but not limited to RCS, SCB, CSX, QMAC, and
+ *   related components, which are proprietary to QRCS.
+ * - All source code, implementations, protocol compositions, optimizations,
+ *   parameter selections, and engineering work contained in this software are
+ *   original works of QRCS and are protected under this license.
+ *
+ * LICENSE AND USE RESTRICTIONS:
+ * - This software is licensed under the Quantum Resistant Cryptographic Solutions
+ *   Public Research and Evaluation License (QRCS-PREL), 2025-2026.
+ * - Permission is granted solely for non-commercial evaluation, academic research,
+ *   cryptographic analysis, interoperability testing, and feasibility assessment.
+ * - Commercial use, production deployment, commercial redistribution, or
+ *   integration into products or services is strictly prohibited without a
+ *   separate written license agreement executed with QRCS.
+ * - Licensing and authorized distribution are solely at the discretion of QRCS.
+ *
+ * EXPERIMENTAL CRYPTOGRAPHY NOTICE:
+ * Portions of this software may include experimental, novel, or evolving
+ * cryptographic designs. Use of this software is entirely at the user's risk.
+ *
+ * DISCLAIMER:
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE, SECURITY, OR NON-INFRINGEMENT. QRCS DISCLAIMS ALL
+ * LIABILITY FOR ANY DIRECT, INDIRECT, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING FROM THE USE OR MISUSE OF THIS SOFTWARE.
+ *
+ * FULL LICENSE:
+ * This software is subject to the Quantum Resistant Cryptographic Solutions
+ * Public Research and Evaluation License (QRCS-PREL), 2025-2026. The complete license terms
+ * are provided in the accompanying LICENSE file or at https://www.qrcscorp.ca.
+ *
+ * Written by: John G. Underhill
+ * Contact: contact@qrcscorp.ca
+ */
+
+#ifndef HKDS_DAEMON_H
+#define HKDS_DAEMON_H
+
+#include "hkds_config.h"
+#include "hkds_server.h"
+#include <stdatomic.h>
+
+/**
+ * \file hkds_daemon.h
+ * \brief The HKDS reference server daemon definitions.
+ *
+ * \details
+ * The daemon serves HKDS clients over TCP and Unix stream sockets on Linux, and is the reference for building a
+ * transaction server on the library. It runs one event loop thread per core:
+ * - Each loop owns an epoll instance and, for TCP, its own listening socket bound with \c SO_REUSEPORT, so the kernel
+ *   spreads incoming connections across the loops without a shared accept lock. A Unix socket has no port balancing,
+ *   so its single listening socket is added to every loop with \c EPOLLEXCLUSIVE.
+ * - The sockets are non-blocking; the received bytes of each connection are reassembled into packets and batch
+ *   envelopes by a stream framer, and viewed in place with the packet factory.
+ * - The message requests of every connection served in one pass of the loop are collected, and decrypted together
+ *   with the batch function, which groups them by device epoch and runs the x8 kernels. A response slot is reserved in
+ *   the connection's send buffer when a request is parsed, and the plaintext is decrypted directly into it, so the
+ *   responses of a connection are sent in request order without copying.
+ * - Token requests are answered immediately with the scalar token encryption; they occur once per device epoch.
+ * - A connection whose send buffer is full stops being read until the peer drains it.
+ *
+ * A single message request is answered with a message response carrying the decrypted message, and a batch request
+ * envelope with a batch response envelope; this echo is the reference behaviour, for throughput and latency testing,
+ * and a transaction server would replace it with its own message handling. In authenticated mode the message requests
+ * carry a KMAC tag over the cipher-text, with no additional data, and a request that fails verification is answered
+ * with an error message, or a cleared record in an envelope. A malformed stream is answered with an error message, and
+ * the connection is closed.
+ *
+ * Stateless terminals can send single packets as UDP datagrams. Every loop binds its own UDP socket to the port with
+ * \c SO_REUSEPORT, reads up to \ref HKDS_DAEMON_DATAGRAM_BATCH datagrams with one \c recvmmsg, decrypts their message
+ * requests together with the batch function, and answers them with one \c sendmmsg; a datagram holds exactly one
+ * packet, and a malformed datagram is dropped.
+ *
+ * The loops can instead run on io_uring, selected with the engine field of the configuration:
+ * - Connections are accepted with a multishot accept, and read with a multishot receive that picks its buffers from a
+ *   provided buffer ring; the received bytes land in memory registered with the kernel once, and the complete frames
+ *   are viewed and batch decrypted in that buffer. Only a frame split across two receives is copied into the framer.
+ * - The send buffers of the connections are slices of one slab registered as fixed buffers, and the responses are
+ *   built into them by the packet factory and sent with fixed-buffer zero-copy sends.
+ * - A loop serves at most \ref HKDS_DAEMON_URING_SLOTS connections, and the registered memory counts against
+ *   \c RLIMIT_MEMLOCK; the engine requires Linux 6.0 or later.
+ * - The engine is compiled only when \c HKDS_DAEMON_URING is defined; the CMake build defines it when the kernel
+ *   headers provide \c IORING_SETUP_DEFER_TASKRUN, and without it a daemon started on io_uring fails to start.
+ *
+ * In isolated mode the master key set is held only by key worker processes, one per loop, forked before any socket is
+ * opened; the network process can then erase its copy. Each loop sends its collected message and token requests to its
+ * worker through a shared-memory channel, see \ref hkds_ipc.h, and waits for the answers before sending the responses,
+ * so the privilege split costs no socket hop or kernel copy per message. A worker dies with the daemon.
+ * The wait is synchronous, so a loop neither receives nor answers on any of its connections until its worker has
+ * answered the batch; a stalled worker holds the loop for up to \ref HKDS_DAEMON_WORKER_TIMEOUT per wait, and the
+ * requests it leaves unanswered fail.
+ */
+
+/*!
+ * \def HKDS_DAEMON_DEFAULT_ADDRESS
+ * \brief The default TCP listening address; the loopback interface.
+ */
+#define HKDS_DAEMON_DEFAULT_ADDRESS "127.0.0.1"
+
+/*!
+ * \def HKDS_DAEMON_DEFAULT_PORT
+ * \brief The default TCP listening port.
+ */
+#define HKDS_DAEMON_DEFAULT_PORT 7480U
+
+/*!
+ * \def HKDS_DAEMON_MAX_LOOPS
+ * \brief The maximum number of event loop threads.
+ */
+#define HKDS_DAEMON_MAX_LOOPS 64U
+
+/*!
+ * \def HKDS_DAEMON_MAX_EVENTS
+ * \brief The maximum number of socket events handled in one pass of an event loop.
+ */
+#define HKDS_DAEMON_MAX_EVENTS 256U
+
+/*!
+ * \def HKDS_DAEMON_BATCH_DEPTH
+ * \brief The maximum number of message requests decrypted in one batch.
+ */
+#define HKDS_DAEMON_BATCH_DEPTH 512U
+
+/*!
+ * \def HKDS_DAEMON_READ_SIZE
+ * \brief The largest single read from a connection.
+ */
+#define HKDS_DAEMON_READ_SIZE 16384U
+
+/*!
+ * \def HKDS_DAEMON_SEND_SIZE
+ * \brief The send buffer size of a connection; twice the largest response envelope.
+ */
+#define HKDS_DAEMON_SEND_SIZE (2U * (HKDS_BATCH_HEADER_SIZE + (HKDS_BATCH_MAX_RECORDS * HKDS_ETOK_SIZE)))
+
+/*!
+ * \def HKDS_DAEMON_DATAGRAM_BATCH
+ * \brief The maximum number of datagrams received with one recvmmsg and answered with one sendmmsg; eight x8 groups.
+ */
+#define HKDS_DAEMON_DATAGRAM_BATCH HKDS_CACHX64_SIZE
+
+/*!
+ * \def HKDS_DAEMON_DATAGRAM_ROUNDS
+ * \brief The maximum number of datagram batches read in one pass of a loop, so the stream connections are not starved.
+ */
+#define HKDS_DAEMON_DATAGRAM_ROUNDS 8U
+
+/*!
+ * \def HKDS_DAEMON_DATAGRAM_SIZE
+ * \brief The buffer size of a datagram and of its response; a longer datagram is dropped.
+ */
+#define HKDS_DAEMON_DATAGRAM_SIZE 128U
+
+/*!
+ * \def HKDS_DAEMON_URING_ENTRIES
+ * \brief The submission queue depth of an io_uring loop.
+ */
+#define HKDS_DAEMON_URING_ENTRIES 512U
+
+/*!
+ * \def HKDS_DAEMON_URING_SLOTS
+ * \brief The maximum number of connections of an io_uring loop; each has a registered send buffer.
+ */
+#define HKDS_DAEMON_URING_SLOTS 64U
+
+/*!
+ * \def HKDS_DAEMON_URING_BUFFERS
+ * \brief The number of provided receive buffers of an io_uring loop; a power of two.
+ */
+#define HKDS_DAEMON_URING_BUFFERS 256U
+
+/*!
+ * \def HKDS_DAEMON_URING_BUFFER_SIZE
+ * \brief The size of a provided receive buffer.
+ */
+#define HKDS_DAEMON_URING_BUFFER_SIZE HKDS_DAEMON_READ_SIZE
+
+/*!
+ * \def HKDS_DAEMON_WORKER_DEPTH
+ * \brief The slot count of each ring of a key worker channel; twice the batch depth.
+ */
+#define HKDS_DAEMON_WORKER_DEPTH (2U * HKDS_DAEMON_BATCH_DEPTH)
+
+/*!
+ * \def HKDS_DAEMON_WORKER_TIMEOUT
+ * \brief The longest wait for the next key worker response, in milliseconds; the unanswered requests fail.
+ * The loop is blocked while it waits, so the timeout is kept short; a healthy worker answers a batch in microseconds.
+ */
+#define HKDS_DAEMON_WORKER_TIMEOUT 20U
+
+/*!
+ * \enum hkds_daemon_engine
+ * \brief The event loop implementation.
+ */
+typedef enum hkds_daemon_engine
+{
+    hkds_daemon_engine_epoll = 0x00U,   /*!< Non-blocking sockets with epoll readiness */
+    hkds_daemon_engine_uring = 0x01U    /*!< io_uring multishot receives and zero-copy sends */
+} hkds_daemon_engine;
+
+/*!
+ * \struct hkds_daemon_config
+ * \brief The daemon configuration.
+ */
+typedef struct
+{
+    const char* address;        /*!< The IPv4 TCP listening address */
+    const char* unixpath;       /*!< The [optional] Unix socket path */
+    hkds_master_key* mdk;       /*!< The master key set */
+    size_t loops;               /*!< The number of event loop threads */
+    hkds_daemon_engine engine;  /*!< The event loop implementation */
+    uint16_t port;              /*!< The TCP listening port; zero disables TCP */
+    uint16_t udpport;           /*!< The UDP listening port; zero disables UDP */
+    bool authenticated;         /*!< Message requests carry an authentication tag */
+    bool isolated;              /*!< The master key set is held by forked key worker processes */
+} hkds_daemon_config;
+
+/*!
+ * \struct hkds_daemon_statistics
+ * \brief The daemon counters, summed across the event loops.
+ */
+typedef struct
+{
+    uint64_t connections;       /*!< The number of accepted connections */
+    uint64_t messages;          /*!< The number of decrypted message requests */
+    uint64_t tokens;            /*!< The number of answered token requests */
+    uint64_t envelopes;         /*!< The number of batch request envelopes */
+    uint64_t batches;           /*!< The number of batch decryptions */
+    uint64_t failures;          /*!< The number of message requests that failed authentication */
+    uint64_t datagrams;         /*!< The number of answered datagrams */
+    uint64_t malformed;         /*!< The number of connections closed for a malformed stream, and dropped datagrams */
+} hkds_daemon_statistics;
+
+/*!
+ * \struct hkds_daemon_loop
+ * \brief The opaque event loop state.
+ */
+typedef struct hkds_daemon_loop hkds_daemon_loop;
+
+/*!
+ * \struct hkds_daemon_state
+ * \brief Contains the daemon state.
+ */
+typedef struct
+{
+    hkds_daemon_config config;  /*!< A copy of the daemon configuration */
+    hkds_daemon_loop* loops;    /*!< The event loops */
+    size_t count;               /*!< The number of running event loops */
+    int unixfd;                 /*!< The Unix listening socket, or -1 */
+} hkds_daemon_state;
+
+/**
+ * \brief Open the listening sockets and start the event loop threads.
+ *
+ * \param daemon [out] Pointer to the daemon state.
+ * \param config [in] The daemon configuration; the master key set must remain valid until the daemon is stopped, or
+ * in isolated mode until this function returns.
+ * \return Returns false if a socket could not be opened, or a loop could not be started; nothing is left running.
+ */
+bool hkds_daemon_start(hkds_daemon_state* daemon, const hkds_daemon_config* config);
+
+/**
+ * \brief Stop the event loops, close every connection and listening socket, and release the daemon memory.
+ *
+ * \param daemon [in,out] Pointer to the daemon state.
+ */
+void hkds_daemon_stop(hkds_daemon_state* daemon);
+
+/**
+ * \brief Read the daemon counters; safe to call while the daemon is running.
+ *
+ * \param daemon [in] Pointer to the daemon state.
+ * \param stats [out] Receives the counters.
+ */
+void hkds_daemon_get_statistics(const hkds_daemon_state* daemon, hkds_daemon_statistics* stats);
+
+#endif
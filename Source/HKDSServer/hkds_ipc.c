@@ -0,0 +1,536 @@
+#if !defined(_GNU_SOURCE)
+	/* required for memfd_create, file sealing, and syscall in strict C11 builds */
+#	define _GNU_SOURCE
+#endif
+#include "hkds_ipc.h"
+#include "hkds_factory.h"
+#include "utils.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/* the two processes share the ring indices, which are read and written with acquire and release ordering */
+#define hkds_ipc_load_acquire(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define hkds_ipc_store_release(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+typedef struct
+{
+	uint32_t magic;									/* the channel magic value */
+	uint32_t depth;									/* the number of slots of each ring */
+	uint32_t closed;								/* set when the front end closes the channel */
+	uint8_t padding[52];							/* pads the header to a cache line */
+} hkds_ipc_header;
+
+static size_t hkds_ipc_map_size(uint32_t depth)
+{
+	return sizeof(hkds_ipc_header) + (2U * sizeof(hkds_ipc_control)) + (2U * (size_t)depth * sizeof(hkds_ipc_slot));
+}
+
+static void hkds_ipc_bind(hkds_ipc_channel* channel, uint32_t depth)
+{
+	uint8_t* map;
+
+	/* the header, the request and response controls, then the request and response slots */
+	map = (uint8_t*)channel->map;
+	channel->closed = &((hkds_ipc_header*)map)->closed;
+	map += sizeof(hkds_ipc_header);
+	channel->requests.control = (hkds_ipc_control*)map;
+	channel->responses.control = (hkds_ipc_control*)(map + sizeof(hkds_ipc_control));
+	map += 2U * sizeof(hkds_ipc_control);
+	channel->requests.slots = (hkds_ipc_slot*)map;
+	channel->responses.slots = (hkds_ipc_slot*)(map + ((size_t)depth * sizeof(hkds_ipc_slot)));
+	channel->requests.mask = depth - 1U;
+	channel->responses.mask = depth - 1U;
+	channel->requests.local = 0U;
+	channel->responses.local = 0U;
+}
+
+static void hkds_ipc_futex_wake(uint32_t* word, int count)
+{
+	/* the futex is shared between processes, so the private flag is not set */
+	(void)syscall(SYS_futex, word, FUTEX_WAKE, count, NULL, NULL, 0);
+}
+
+static void hkds_ipc_futex_wait(uint32_t* word, uint32_t expected, uint32_t timeout)
+{
+	struct timespec ts;
+
+	ts.tv_sec = (time_t)(timeout / 1000U);
+	ts.tv_nsec = (long)(timeout % 1000U) * 1000000L;
+	(void)syscall(SYS_futex, word, FUTEX_WAIT, expected, &ts, NULL, 0);
+}
+
+bool hkds_ipc_create(hkds_ipc_channel* channel, uint32_t depth)
+{
+	HKDS_ASSERT(channel != NULL);
+	HKDS_ASSERT(depth != 0U && (depth & (depth - 1U)) == 0U);
+
+	hkds_ipc_header* hdr;
+	bool res;
+
+	res = false;
+
+	if (channel != NULL && depth != 0U && (depth & (depth - 1U)) == 0U)
+	{
+		utils_memory_clear((uint8_t*)channel, sizeof(hkds_ipc_channel));
+		channel->maplen = hkds_ipc_map_size(depth);
+		channel->map = MAP_FAILED;
+		channel->fd = memfd_create("hkds_ipc", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+		if (channel->fd >= 0 && ftruncate(channel->fd, (off_t)channel->maplen) == 0)
+		{
+			/* the size is sealed, so an attaching process can trust the mapping length */
+			(void)fcntl(channel->fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+			channel->map = mmap(NULL, channel->maplen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, channel->fd, 0);
+		}
+
+		if (channel->map != MAP_FAILED)
+		{
+			/* a new memfd is zero filled, so the indices and the closed flag start cleared */
+			hdr = (hkds_ipc_header*)channel->map;
+			hdr->depth = depth;
+			hdr->magic = HKDS_IPC_MAGIC;
+			hkds_ipc_bind(channel, depth);
+			res = true;
+		}
+		else
+		{
+			hkds_ipc_destroy(channel);
+		}
+	}
+
+	return res;
+}
+
+bool hkds_ipc_attach(hkds_ipc_channel* channel, int fd)
+{
+	HKDS_ASSERT(channel != NULL);
+	HKDS_ASSERT(fd >= 0);
+
+	const hkds_ipc_header* hdr;
+	struct stat st;
+	uint32_t depth;
+	bool res;
+
+	res = false;
+
+	if (channel != NULL && fd >= 0)
+	{
+		utils_memory_clear((uint8_t*)channel, sizeof(hkds_ipc_channel));
+		channel->fd = fd;
+		channel->map = MAP_FAILED;
+
+		if (fstat(fd, &st) == 0 && (size_t)st.st_size >= hkds_ipc_map_size(1U))
+		{
+			channel->maplen = (size_t)st.st_size;
+			channel->map = mmap(NULL, channel->maplen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+		}
+
+		if (channel->map != MAP_FAILED)
+		{
+			hdr = (const hkds_ipc_header*)channel->map;
+			depth = hdr->depth;
+
+			if (hdr->magic == HKDS_IPC_MAGIC && depth != 0U && (depth & (depth - 1U)) == 0U && hkds_ipc_map_size(depth) == channel->maplen)
+			{
+				hkds_ipc_bind(channel, depth);
+				channel->requests.local = hkds_ipc_load_acquire(&channel->requests.control->head);
+				channel->responses.local = hkds_ipc_load_acquire(&channel->responses.control->tail);
+				res = true;
+			}
+		}
+
+		if (res == false)
+		{
+			hkds_ipc_destroy(channel);
+		}
+	}
+
+	return res;
+}
+
+void hkds_ipc_destroy(hkds_ipc_channel* channel)
+{
+	HKDS_ASSERT(channel != NULL);
+
+	if (channel != NULL)
+	{
+		if (channel->map != NULL && channel->map != MAP_FAILED)
+		{
+			munmap(channel->map, channel->maplen);
+		}
+
+		if (channel->fd >= 0)
+		{
+			close(channel->fd);
+		}
+
+		utils_memory_clear((uint8_t*)channel, sizeof(hkds_ipc_channel));
+		channel->fd = -1;
+	}
+}
+
+void hkds_ipc_close(hkds_ipc_channel* channel)
+{
+	HKDS_ASSERT(channel != NULL);
+
+	if (channel != NULL && channel->closed != NULL)
+	{
+		__atomic_store_n(channel->closed, 1U, __ATOMIC_SEQ_CST);
+		hkds_ipc_futex_wake(&channel->requests.control->tail, INT_MAX);
+		hkds_ipc_futex_wake(&channel->responses.control->tail, INT_MAX);
+	}
+}
+
+bool hkds_ipc_is_closed(const hkds_ipc_channel* channel)
+{
+	HKDS_ASSERT(channel != NULL);
+
+	bool res;
+
+	res = true;
+
+	if (channel != NULL && channel->closed != NULL)
+	{
+		res = (hkds_ipc_load_acquire(channel->closed) != 0U);
+	}
+
+	return res;
+}
+
+hkds_ipc_slot* hkds_ipc_reserve(hkds_ipc_ring* ring)
+{
+	HKDS_ASSERT(ring != NULL);
+
+	hkds_ipc_slot* res;
+
+	res = NULL;
+
+	if (ring != NULL && ring->local - hkds_ipc_load_acquire(&ring->control->head) <= ring->mask)
+	{
+		res = &ring->slots[ring->local & ring->mask];
+		++ring->local;
+	}
+
+	return res;
+}
+
+void hkds_ipc_commit(hkds_ipc_ring* ring)
+{
+	HKDS_ASSERT(ring != NULL);
+
+	if (ring != NULL && ring->local != ring->control->tail)
+	{
+		hkds_ipc_store_release(&ring->control->tail, ring->local);
+
+		/* orders the tail store before the waiting load; pairs with the fence of the consumer in hkds_ipc_wait */
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+		if (__atomic_load_n(&ring->control->waiting, __ATOMIC_RELAXED) != 0U)
+		{
+			hkds_ipc_futex_wake(&ring->control->tail, 1);
+		}
+	}
+}
+
+size_t hkds_ipc_available(const hkds_ipc_ring* ring)
+{
+	HKDS_ASSERT(ring != NULL);
+
+	size_t res;
+
+	res = 0U;
+
+	if (ring != NULL)
+	{
+		res = (size_t)(uint32_t)(hkds_ipc_load_acquire(&ring->control->tail) - ring->local);
+	}
+
+	return res;
+}
+
+hkds_ipc_slot* hkds_ipc_front(const hkds_ipc_ring* ring, size_t index)
+{
+	HKDS_ASSERT(ring != NULL);
+
+	hkds_ipc_slot* res;
+
+	res = NULL;
+
+	if (ring != NULL)
+	{
+		res = &ring->slots[(ring->local + (uint32_t)index) & ring->mask];
+	}
+
+	return res;
+}
+
+void hkds_ipc_release(hkds_ipc_ring* ring, size_t count)
+{
+	HKDS_ASSERT(ring != NULL);
+
+	if (ring != NULL && count != 0U)
+	{
+		/* the read slots may hold key material; erase them before the producer can reuse them */
+		for (size_t i = 0U; i < count; ++i)
+		{
+			utils_memory_secure_erase((uint8_t*)&ring->slots[(ring->local + (uint32_t)i) & ring->mask], sizeof(hkds_ipc_slot));
+		}
+
+		ring->local += (uint32_t)count;
+		hkds_ipc_store_release(&ring->control->head, ring->local);
+	}
+}
+
+bool hkds_ipc_wait(hkds_ipc_ring* ring, uint32_t timeout)
+{
+	HKDS_ASSERT(ring != NULL);
+
+	uint32_t tail;
+	bool res;
+
+	res = false;
+
+	if (ring != NULL)
+	{
+		res = (hkds_ipc_available(ring) != 0U);
+
+		if (res == false)
+		{
+			/* the waiting flag is published before the tail is checked again, so a commit in between wakes the futex */
+			__atomic_store_n(&ring->control->waiting, 1U, __ATOMIC_RELAXED);
+			__atomic_thread_fence(__ATOMIC_SEQ_CST);
+			tail = hkds_ipc_load_acquire(&ring->control->tail);
+
+			if (tail == ring->local)
+			{
+				hkds_ipc_futex_wait(&ring->control->tail, tail, timeout);
+			}
+
+			__atomic_store_n(&ring->control->waiting, 0U, __ATOMIC_RELAXED);
+			res = (hkds_ipc_available(ring) != 0U);
+		}
+	}
+
+	return res;
+}
+
+bool hkds_ipc_enqueue_message(hkds_ipc_channel* channel, uint64_t tag, const uint8_t* ksn, const uint8_t* ciphertext, const uint8_t* mtag)
+{
+	HKDS_ASSERT(channel != NULL);
+	HKDS_ASSERT(ksn != NULL);
+	HKDS_ASSERT(ciphertext != NULL);
+
+	hkds_client_message_request req;
+	hkds_ipc_slot* slot;
+	bool res;
+
+	res = false;
+
+	if (channel != NULL && ksn != NULL && ciphertext != NULL)
+	{
+		slot = hkds_ipc_reserve(&channel->requests);
+
+		if (slot != NULL)
+		{
+			req = hkds_factory_create_client_message_request(ciphertext, ksn, mtag);
+			hkds_factory_serialize_client_message(slot->packet, &req);
+			slot->tag = tag;
+			slot->length = HKDS_CLIENT_MESSAGE_REQUEST_SIZE;
+			res = true;
+		}
+	}
+
+	return res;
+}
+
+bool hkds_ipc_enqueue_token(hkds_ipc_channel* channel, uint64_t tag, const uint8_t* ksn)
+{
+	HKDS_ASSERT(channel != NULL);
+	HKDS_ASSERT(ksn != NULL);
+
+	hkds_client_token_request req;
+	hkds_ipc_slot* slot;
+	bool res;
+
+	res = false;
+
+	if (channel != NULL && ksn != NULL)
+	{
+		slot = hkds_ipc_reserve(&channel->requests);
+
+		if (slot != NULL)
+		{
+			req = hkds_factory_create_client_token_request(ksn);
+			hkds_factory_serialize_client_token(slot->packet, &req);
+			slot->tag = tag;
+			slot->length = HKDS_CLIENT_TOKEN_REQUEST_SIZE;
+			res = true;
+		}
+	}
+
+	return res;
+}
+
+void hkds_ipc_submit(hkds_ipc_channel* channel)
+{
+	HKDS_ASSERT(channel != NULL);
+
+	if (channel != NULL)
+	{
+		hkds_ipc_commit(&channel->requests);
+	}
+}
+
+static void hkds_ipc_error(hkds_ipc_slot* slot, hkds_error_type code)
+{
+	hkds_error_message err;
+	uint8_t emsg[HKDS_ERROR_SIZE] = { 0 };
+
+	err = hkds_factory_create_error_message(emsg, code);
+	hkds_factory_serialize_error_message(slot->packet, &err);
+	slot->length = HKDS_ERROR_MESSAGE_SIZE;
+}
+
+static void hkds_ipc_token(const hkds_server_x8_state* state, const uint8_t* ksn, hkds_ipc_slot* slot)
+{
+	uint8_t etok[HKDS_ETOK_SIZE] = { 0 };
+	hkds_server_token_response trsp;
+	hkds_server_state ss;
+
+	/* the header is written with a zero token, and the token is encrypted in place */
+	trsp = hkds_factory_create_server_token_reponse(etok);
+	hkds_factory_serialize_server_token(slot->packet, &trsp);
+	slot->length = HKDS_SERVER_TOKEN_RESPONSE_SIZE;
+	hkds_server_initialize_state(&ss, state->mdk, ksn);
+	hkds_server_encrypt_token(&ss, slot->packet + HKDS_HEADER_SIZE);
+	utils_memory_secure_erase((uint8_t*)&ss, sizeof(ss));
+}
+
+size_t hkds_ipc_serve(hkds_ipc_channel* channel, const hkds_server_x8_state* state, bool authenticated)
+{
+	HKDS_ASSERT(channel != NULL);
+	HKDS_ASSERT(state != NULL);
+
+	const uint8_t* ksn[HKDS_IPC_BATCH_DEPTH];
+	const uint8_t* cpt[HKDS_IPC_BATCH_DEPTH];
+	uint8_t* pln[HKDS_IPC_BATCH_DEPTH];
+	hkds_ipc_slot* out[HKDS_IPC_BATCH_DEPTH];
+	bool valid[HKDS_IPC_BATCH_DEPTH];
+	uint8_t zero[HKDS_MESSAGE_SIZE] = { 0 };
+	hkds_server_message_response rsp;
+	hkds_packet_view pv;
+	hkds_ipc_slot* req;
+	hkds_ipc_slot* slot;
+	size_t avail;
+	size_t mcount;
+	size_t res;
+	bool ok;
+
+	res = 0U;
+	mcount = 0U;
+
+	if (channel != NULL && state != NULL)
+	{
+		avail = hkds_ipc_available(&channel->requests);
+		avail = (avail > HKDS_IPC_BATCH_DEPTH) ? HKDS_IPC_BATCH_DEPTH : avail;
+
+		while (res < avail)
+		{
+			slot = hkds_ipc_reserve(&channel->responses);
+
+			if (slot == NULL)
+			{
+				/* the response ring is full; the remaining requests are answered in the next pass */
+				break;
+			}
+
+			/* the requests stay in the request ring, and are read in place until the batch is decrypted */
+			req = hkds_ipc_front(&channel->requests, res);
+			slot->tag = req->tag;
+			ok = (req->length <= HKDS_IPC_PACKET_SIZE && hkds_factory_view_packet(&pv, req->packet, req->length) == true &&
+				pv.length == req->length);
+
+			if (ok == true && pv.type == packet_message_request)
+			{
+				rsp = hkds_factory_create_server_message_response(zero);
+				hkds_factory_serialize_server_message(slot->packet, &rsp);
+				slot->length = HKDS_SERVER_MESSAGE_RESPONSE_SIZE;
+				ksn[mcount] = pv.ksn;
+				cpt[mcount] = pv.message;
+				pln[mcount] = slot->packet + HKDS_HEADER_SIZE;
+				out[mcount] = slot;
+				++mcount;
+			}
+			else if (ok == true && pv.type == packet_token_request)
+			{
+				hkds_ipc_token(state, pv.ksn, slot);
+			}
+			else
+			{
+				hkds_ipc_error(slot, error_invalid_format);
+			}
+
+			++res;
+		}
+
+		if (mcount != 0U)
+		{
+			if (authenticated == true)
+			{
+				/* the KSN pointers stand in for the additional data, which has zero length */
+				hkds_server_decrypt_verify_batch(state, mcount, ksn, cpt, ksn, 0U, pln, valid);
+			}
+			else
+			{
+				hkds_server_decrypt_batch(state, mcount, ksn, cpt, pln);
+
+				for (size_t i = 0U; i < mcount; ++i)
+				{
+					valid[i] = true;
+				}
+			}
+
+			for (size_t i = 0U; i < mcount; ++i)
+			{
+				if (valid[i] == false)
+				{
+					hkds_ipc_error(out[i], error_general_failure);
+				}
+			}
+		}
+
+		hkds_ipc_release(&channel->requests, res);
+		hkds_ipc_commit(&channel->responses);
+	}
+
+	return res;
+}
+
+void hkds_ipc_worker_run(hkds_ipc_channel* channel, hkds_master_key* mdk, bool authenticated)
+{
+	HKDS_ASSERT(channel != NULL);
+	HKDS_ASSERT(mdk != NULL);
+
+	hkds_server_x8_state tss = { 0 };
+
+	if (channel != NULL && mdk != NULL)
+	{
+		tss.mdk = mdk;
+
+		while (hkds_ipc_is_closed(channel) == false)
+		{
+			if (hkds_ipc_wait(&channel->requests, HKDS_IPC_WAIT_TIMEOUT) == true)
+			{
+				(void)hkds_ipc_serve(channel, &tss, authenticated);
+			}
+		}
+
+		utils_memory_secure_erase((uint8_t*)&tss, sizeof(tss));
+	}
+}
@@ -0,0 +1,292 @@
+/* 2021-2026 Quantum Resistant Cryptographic Solutions Corporation
+ * All Rights Reserved.
+ *
+ * NOTICE:
+ * This software and all accompanying materials are the exclusive property of
+ * Quantum Resistant Cryptographic Solutions Corporation (QRCS). The intellectual
+ * and technical concepts contained herein are proprietary to QRCS and are
+ * protected under applicable Canadian, U.S., and international copyright,
+ * patent, and trade secret laws.
+ *
+ * CRYPTOGRAPHIC ALGORITHMS AND IMPLEMENTATIONS:
+ * - This software includes implementations of cryptographic primitives and
+ *   algorithms that are standardized or in the public domain, such as AES
+ *   and SHA-3, which are not proprietary to QRCS.
+ * - This software also includes cryptographic primitives, constructions, and
+ *   algorithms designed by QRCS, including but not limited to RCS, SCB, CSX, QMAC, and
+ *   related components, which are proprietary to QRCS.
+ * - All source code, implementations, protocol compositions, optimizations,
+ *   parameter selections, and engineering work contained in this software are
+ *   original works of QRCS and are protected under this license.
+ *
+ * LICENSE AND USE RESTRICTIONS:
+ * - This software is licensed under the Quantum Resistant Cryptographic Solutions
+ *   Public Research and Evaluation License (QRCS-PREL), 2025-2026.
+ * - Permission is granted solely for non-commercial evaluation, academic research,
+ *   cryptographic analysis, interoperability testing, and feasibility assessment.
+ * - Commercial use, production deployment, commercial redistribution, or
+ *   integration into products or services is strictly prohibited without a
+ *   separate written license agreement executed with QRCS.
+ * - Licensing and authorized distribution are solely at the discretion of QRCS.
+ *
+ * EXPERIMENTAL CRYPTOGRAPHY NOTICE:
+ * Portions of this software may include experimental, novel, or evolving
+ * cryptographic designs. Use of this software is entirely at the user's risk.
+ *
+ * DISCLAIMER:
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE, SECURITY, OR NON-INFRINGEMENT. QRCS DISCLAIMS ALL
+ * LIABILITY FOR ANY DIRECT, INDIRECT, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING FROM THE USE OR MISUSE OF THIS SOFTWARE.
+ *
+ * FULL LICENSE:
+ * This software is subject to the Quantum Resistant Cryptographic Solutions
+ * Public Research and Evaluation License (QRCS-PREL), 2025-2026. The complete license terms
+ * are provided in the accompanying LICENSE file or at https://www.qrcscorp.ca.
+ *
+ * Written by: John G. Underhill
+ * Contact: contact@qrcscorp.ca
+ */
+
+#ifndef HKDS_IPC_H
+#define HKDS_IPC_H
+
+#include "hkds_config.h"
+#include "hkds_server.h"
+
+/**
+ * \file hkds_ipc.h
+ * \brief A shared-memory request channel between a network front end and a key-holding worker process.
+ *
+ * \details
+ * The channel separates the process that touches the network from the process that holds the master key set, without
+ * a socket hop or a kernel copy per message:
+ * - The channel is one memfd-backed shared mapping holding two single-producer, single-consumer rings of fixed-size
+ *   packet slots; the front end produces requests and consumes responses, and the worker does the reverse. The memfd
+ *   is inherited by a forked worker, or passed to another process with \c SCM_RIGHTS and attached there.
+ * - The ring indices are shared 32-bit words, read and written with acquire and release ordering, each on its own
+ *   cache line. A consumer with nothing to read sleeps on a process-shared futex on the producer index, and the
+ *   producer only makes the wake system call when the consumer has announced that it is sleeping.
+ * - Slots are reserved and filled in place, and published together by one commit, so a batch costs one wakeup.
+ * - The worker answers each request slot in its response slot of the same order: message requests are decrypted
+ *   together with the batch server functions directly into the response slots, token requests are answered with the
+ *   scalar token encryption, and any other packet with an error message.
+ *
+ * Each slot carries an opaque tag the front end uses to route the response. Authenticated message requests are
+ * verified with no additional data, as in the daemon.
+ */
+
+/*!
+ * \def HKDS_IPC_MAGIC
+ * \brief The channel header magic value.
+ */
+#define HKDS_IPC_MAGIC 0x53444B48UL
+
+/*!
+ * \def HKDS_IPC_PACKET_SIZE
+ * \brief The packet capacity of a slot; the largest single request or response.
+ */
+#define HKDS_IPC_PACKET_SIZE 112U
+
+/*!
+ * \def HKDS_IPC_BATCH_DEPTH
+ * \brief The maximum number of requests the worker answers with one batch.
+ */
+#define HKDS_IPC_BATCH_DEPTH 512U
+
+/*!
+ * \def HKDS_IPC_WAIT_TIMEOUT
+ * \brief The longest single futex wait of the worker, in milliseconds, after which it checks the channel state.
+ */
+#define HKDS_IPC_WAIT_TIMEOUT 1000U
+
+/*!
+ * \struct hkds_ipc_slot
+ * \brief A request or response slot; two cache lines.
+ */
+typedef struct
+{
+    uint64_t tag;                               /*!< The front end request identifier, returned with the response */
+    uint32_t length;                            /*!< The packet length */
+    uint32_t reserved;                          /*!< Reserved */
+    uint8_t packet[HKDS_IPC_PACKET_SIZE];       /*!< The serialized packet */
+} hkds_ipc_slot;
+
+/*!
+ * \struct hkds_ipc_control
+ * \brief The shared indices of a ring, with the producer and consumer words on separate cache lines.
+ */
+typedef struct
+{
+    uint32_t tail;                              /*!< The producer index, and the futex word */
+    uint32_t waiting;                           /*!< Set while the consumer sleeps */
+    uint8_t padding1[56];                       /*!< Separates the producer and consumer lines */
+    uint32_t head;                              /*!< The consumer index */
+    uint8_t padding2[60];                       /*!< Pads the consumer line */
+} hkds_ipc_control;
+
+/*!
+ * \struct hkds_ipc_ring
+ * \brief The process-local view of one ring, used by either its producer or its consumer.
+ */
+typedef struct
+{
+    hkds_ipc_control* control;                  /*!< The shared indices */
+    hkds_ipc_slot* slots;                       /*!< The shared slots */
+    uint32_t mask;                              /*!< The slot index mask */
+    uint32_t local;                             /*!< The unpublished tail of the producer, or the head of the consumer */
+} hkds_ipc_ring;
+
+/*!
+ * \struct hkds_ipc_channel
+ * \brief Contains a mapped channel.
+ */
+typedef struct
+{
+    hkds_ipc_ring requests;                     /*!< The requests, from the front end to the worker */
+    hkds_ipc_ring responses;                    /*!< The responses, from the worker to the front end */
+    uint32_t* closed;                           /*!< The shared closed flag */
+    void* map;                                  /*!< The shared mapping */
+    size_t maplen;                              /*!< The byte length of the mapping */
+    int fd;                                     /*!< The memfd */
+} hkds_ipc_channel;
+
+/**
+ * \brief Create a channel in a new memfd, and map it.
+ *
+ * \param channel [out] Pointer to the channel.
+ * \param depth [in] The number of slots of each ring; a power of two.
+ * \return Returns false if the memfd could not be created or mapped.
+ */
+bool hkds_ipc_create(hkds_ipc_channel* channel, uint32_t depth);
+
+/**
+ * \brief Map a channel from a memfd received from the creating process.
+ *
+ * \param channel [out] Pointer to the channel.
+ * \param fd [in] The memfd; the channel takes ownership of it.
+ * \return Returns false if the mapping failed, or the memfd does not hold a channel.
+ */
+bool hkds_ipc_attach(hkds_ipc_channel* channel, int fd);
+
+/**
+ * \brief Unmap the channel and close its memfd.
+ *
+ * \param channel [in,out] Pointer to the channel.
+ */
+void hkds_ipc_destroy(hkds_ipc_channel* channel);
+
+/**
+ * \brief Mark the channel closed, and wake the worker so it exits.
+ *
+ * \param channel [in,out] Pointer to the channel.
+ */
+void hkds_ipc_close(hkds_ipc_channel* channel);
+
+/**
+ * \brief Test whether the channel has been closed.
+ *
+ * \param channel [in] Pointer to the channel.
+ * \return Returns true if the channel is closed.
+ */
+bool hkds_ipc_is_closed(const hkds_ipc_channel* channel);
+
+/**
+ * \brief Reserve the next slot of a ring as its producer.
+ *
+ * \param ring [in,out] Pointer to the ring.
+ * \return The slot, or NULL if the ring is full; the slot is published with \ref hkds_ipc_commit.
+ */
+hkds_ipc_slot* hkds_ipc_reserve(hkds_ipc_ring* ring);
+
+/**
+ * \brief Publish the reserved slots of a ring, and wake its consumer if it sleeps.
+ *
+ * \param ring [in,out] Pointer to the ring.
+ */
+void hkds_ipc_commit(hkds_ipc_ring* ring);
+
+/**
+ * \brief Get the number of published slots a consumer can read.
+ *
+ * \param ring [in] Pointer to the ring.
+ * \return The number of readable slots.
+ */
+size_t hkds_ipc_available(const hkds_ipc_ring* ring);
+
+/**
+ * \brief Get a readable slot of a ring as its consumer.
+ *
+ * \param ring [in] Pointer to the ring.
+ * \param index [in] The slot index from the read position; less than the available count.
+ * \return The slot.
+ */
+hkds_ipc_slot* hkds_ipc_front(const hkds_ipc_ring* ring, size_t index);
+
+/**
+ * \brief Securely erase read slots and return them to the producer of a ring.
+ *
+ * \param ring [in,out] Pointer to the ring.
+ * \param count [in] The number of slots read.
+ */
+void hkds_ipc_release(hkds_ipc_ring* ring, size_t count);
+
+/**
+ * \brief Wait as the consumer of a ring until a slot is readable.
+ *
+ * \param ring [in,out] Pointer to the ring.
+ * \param timeout [in] The longest wait in milliseconds.
+ * \return Returns true if a slot is readable.
+ */
+bool hkds_ipc_wait(hkds_ipc_ring* ring, uint32_t timeout);
+
+/**
+ * \brief Queue a message request as the front end; published with \ref hkds_ipc_submit.
+ *
+ * \param channel [in,out] Pointer to the channel.
+ * \param tag [in] The request identifier, returned with the response.
+ * \param ksn [in] The client's key serial number.
+ * \param ciphertext [in] The encrypted message.
+ * \param mtag [in] The [optional] authentication tag; NULL in unauthenticated mode.
+ * \return Returns false if the request ring is full.
+ */
+bool hkds_ipc_enqueue_message(hkds_ipc_channel* channel, uint64_t tag, const uint8_t* ksn, const uint8_t* ciphertext, const uint8_t* mtag);
+
+/**
+ * \brief Queue a token request as the front end; published with \ref hkds_ipc_submit.
+ *
+ * \param channel [in,out] Pointer to the channel.
+ * \param tag [in] The request identifier, returned with the response.
+ * \param ksn [in] The client's key serial number.
+ * \return Returns false if the request ring is full.
+ */
+bool hkds_ipc_enqueue_token(hkds_ipc_channel* channel, uint64_t tag, const uint8_t* ksn);
+
+/**
+ * \brief Publish the queued requests to the worker.
+ *
+ * \param channel [in,out] Pointer to the channel.
+ */
+void hkds_ipc_submit(hkds_ipc_channel* channel);
+
+/**
+ * \brief Answer the readable requests as the worker, up to one batch.
+ *
+ * \param channel [in,out] Pointer to the channel.
+ * \param state [in] The batch template state, holding the master key set.
+ * \param authenticated [in] Message requests carry an authentication tag.
+ * \return The number of requests answered; fewer than are readable if the response ring is full.
+ */
+size_t hkds_ipc_serve(hkds_ipc_channel* channel, const hkds_server_x8_state* state, bool authenticated);
+
+/**
+ * \brief Serve the channel as the worker until it is closed.
+ *
+ * \param channel [in,out] Pointer to the channel.
+ * \param mdk [in] The master key set.
+ * \param authenticated [in] Message requests carry an authentication tag.
+ */
+void hkds_ipc_worker_run(hkds_ipc_channel* channel, hkds_master_key* mdk, bool authenticated);
+
+#endif
@@ -0,0 +1,431 @@
+#if !defined(_GNU_SOURCE)
+	/* required for sigtimedwait and sysconf in strict C11 builds */
+#	define _GNU_SOURCE
+#endif
+#include "hkds_daemon.h"
+#include "hkds_client.h"
+#include "hkds_factory.h"
+#include "utils.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct
+{
+	const uint8_t* requests;	/* the message request datagrams */
+	const char* address;		/* the listening address of the daemon */
+	uint64_t answered;			/* the number of received message responses */
+	uint64_t failed;			/* the number of received error responses */
+	struct timespec deadline;	/* the end of the run */
+	uint16_t port;				/* the UDP port of the daemon */
+} benchmark_client;
+
+static void print_usage(void)
+{
+	printf("usage: hkds_daemon [-l address] [-p port] [-d port] [-u unixpath] [-t loops] [-k keyfile] [-a] [-i] [-w] [-b seconds]\n");
+	printf("  -l  the IPv4 listening address; default %s\n", HKDS_DAEMON_DEFAULT_ADDRESS);
+	printf("  -p  the TCP listening port, or 0 to disable TCP; default %u\n", (unsigned)HKDS_DAEMON_DEFAULT_PORT);
+	printf("  -d  the UDP listening port; UDP is disabled by default\n");
+	printf("  -u  the Unix socket path\n");
+	printf("  -t  the number of event loop threads; default one per core\n");
+	printf("  -k  the master key file; created with a new key set if it does not exist\n");
+	printf("  -a  message requests carry an authentication tag\n");
+	printf("  -i  run the event loops on io_uring; requires Linux 6.0 or later\n");
+	printf("  -w  hold the master key set in key worker processes, and erase it from the network process\n");
+	printf("  -b  run a loopback UDP benchmark for the given number of seconds, and report the packets per second\n");
+}
+
+static bool load_master_key(const char* path, hkds_master_key* mdk)
+{
+	const uint8_t kid[HKDS_KID_SIZE] = { 0x01U, 0x02U, 0x03U, 0x04U };
+	FILE* fp;
+	bool res;
+
+	res = false;
+	fp = (path != NULL) ? fopen(path, "rb") : NULL;
+
+	if (fp != NULL)
+	{
+		/* the key file is the base derivation key, the secret token key, and the key identity */
+		res = (fread(mdk, 1U, sizeof(hkds_master_key), fp) == sizeof(hkds_master_key));
+		fclose(fp);
+	}
+	else if (hkds_server_generate_mdk(&utils_seed_generate, mdk, kid) == true)
+	{
+		res = true;
+
+		if (path != NULL)
+		{
+			/* the client tools derive their device keys from the stored key set */
+			umask(077);
+			fp = fopen(path, "wb");
+			res = (fp != NULL && fwrite(mdk, 1U, sizeof(hkds_master_key), fp) == sizeof(hkds_master_key));
+
+			if (fp != NULL)
+			{
+				fclose(fp);
+			}
+		}
+	}
+
+	return res;
+}
+
+static void benchmark_requests(hkds_master_key* mdk, bool authenticated, uint8_t* requests)
+{
+#if defined(HKDS_SHAKE_128)
+	const uint8_t PRFMODE = 0x09U;
+#elif defined(HKDS_SHAKE_256)
+	const uint8_t PRFMODE = 0x0AU;
+#else
+	const uint8_t PRFMODE = 0x0BU;
+#endif
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01U, 0x00U, 0x00U, 0x00U, 0x10U, PRFMODE, 0x01U, 0x00U, 0x01U, 0x00U, 0x00U, 0x00U };
+	uint8_t cpt[HKDS_MESSAGE_SIZE + HKDS_TAG_SIZE] = { 0 };
+	uint8_t edk[HKDS_EDK_SIZE] = { 0 };
+	uint8_t etok[HKDS_ETOK_SIZE] = { 0 };
+	uint8_t ksn[HKDS_KSN_SIZE] = { 0 };
+	uint8_t msg[HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t tok[HKDS_STK_SIZE] = { 0 };
+	hkds_client_message_request req;
+	hkds_client_state cs;
+	hkds_server_state ss;
+
+	hkds_server_generate_edk(mdk->bdk, did, edk);
+	hkds_client_initialize_state(&cs, edk, did);
+
+	/* one batch of valid requests, which the clients send repeatedly; the server keeps no per-device state */
+	for (size_t i = 0U; i < HKDS_DAEMON_DATAGRAM_BATCH; ++i)
+	{
+		if (i == 0U || cs.cache_empty == true)
+		{
+			/* the token exchange of a new epoch; an authenticated message uses two keys of the cache */
+			hkds_server_initialize_state(&ss, mdk, cs.ksn);
+			hkds_server_encrypt_token(&ss, etok);
+			hkds_client_decrypt_token(&cs, etok, tok);
+			hkds_client_generate_cache(&cs, tok);
+		}
+
+		utils_memory_copy(ksn, cs.ksn, HKDS_KSN_SIZE);
+		utils_seed_generate(msg, sizeof(msg));
+
+		if (authenticated == true)
+		{
+			/* the daemon verifies the tag with no additional data */
+			hkds_client_encrypt_authenticate_message(&cs, msg, ksn, 0U, cpt);
+		}
+		else
+		{
+			hkds_client_encrypt_message(&cs, msg, cpt);
+		}
+
+		req = hkds_factory_create_client_message_request(cpt, ksn, cpt + HKDS_MESSAGE_SIZE);
+		req.header.sequence = (uint8_t)i;
+		hkds_factory_serialize_client_message(requests + (i * HKDS_CLIENT_MESSAGE_REQUEST_SIZE), &req);
+	}
+
+	utils_memory_secure_erase((uint8_t*)&cs, sizeof(cs));
+	utils_memory_secure_erase((uint8_t*)&ss, sizeof(ss));
+	utils_memory_secure_erase(tok, sizeof(tok));
+}
+
+static bool benchmark_expired(const struct timespec* deadline)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec > deadline->tv_sec || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec));
+}
+
+static void* benchmark_run(void* context)
+{
+	uint8_t responses[HKDS_DAEMON_DATAGRAM_BATCH][HKDS_DAEMON_DATAGRAM_SIZE];
+	struct iovec riov[HKDS_DAEMON_DATAGRAM_BATCH];
+	struct iovec siov[HKDS_DAEMON_DATAGRAM_BATCH];
+	struct mmsghdr rmsg[HKDS_DAEMON_DATAGRAM_BATCH];
+	struct mmsghdr smsg[HKDS_DAEMON_DATAGRAM_BATCH];
+	struct sockaddr_in sa = { 0 };
+	struct timeval tv = { 0 };
+	benchmark_client* client;
+	size_t got;
+	int rcnt;
+	int fd;
+
+	client = (benchmark_client*)context;
+	utils_memory_clear((uint8_t*)rmsg, sizeof(rmsg));
+	utils_memory_clear((uint8_t*)smsg, sizeof(smsg));
+
+	for (size_t i = 0U; i < HKDS_DAEMON_DATAGRAM_BATCH; ++i)
+	{
+		siov[i].iov_base = (void*)(client->requests + (i * HKDS_CLIENT_MESSAGE_REQUEST_SIZE));
+		siov[i].iov_len = HKDS_CLIENT_MESSAGE_REQUEST_SIZE;
+		smsg[i].msg_hdr.msg_iov = &siov[i];
+		smsg[i].msg_hdr.msg_iovlen = 1U;
+		riov[i].iov_base = responses[i];
+		riov[i].iov_len = sizeof(responses[i]);
+		rmsg[i].msg_hdr.msg_iov = &riov[i];
+		rmsg[i].msg_hdr.msg_iovlen = 1U;
+	}
+
+	sa.sin_family = AF_INET;
+	sa.sin_port = htons(client->port);
+	tv.tv_usec = 100000;
+	fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+	if (fd >= 0 && inet_pton(AF_INET, client->address, &sa.sin_addr) == 1 && connect(fd, (struct sockaddr*)&sa, sizeof(sa)) == 0 && setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) == 0)
+	{
+		/* one batch is in flight at a time; a response lost to a full socket buffer ends the wait with the timeout */
+		while (benchmark_expired(&client->deadline) == false)
+		{
+			if (sendmmsg(fd, smsg, HKDS_DAEMON_DATAGRAM_BATCH, 0) > 0)
+			{
+				got = 0U;
+				rcnt = 1;
+
+				while (got < HKDS_DAEMON_DATAGRAM_BATCH && rcnt > 0)
+				{
+					rcnt = recvmmsg(fd, rmsg, (unsigned int)(HKDS_DAEMON_DATAGRAM_BATCH - got), MSG_WAITFORONE, NULL);
+
+					for (int j = 0; j < rcnt; ++j)
+					{
+						if (responses[j][HKDS_PACKET_FLAG_OFFSET] == (uint8_t)packet_message_response)
+						{
+							++client->answered;
+						}
+						else
+						{
+							++client->failed;
+						}
+					}
+
+					got += (rcnt > 0) ? (size_t)rcnt : 0U;
+				}
+			}
+		}
+	}
+
+	if (fd >= 0)
+	{
+		close(fd);
+	}
+
+	return NULL;
+}
+
+static void benchmark(hkds_daemon_config* config, hkds_master_key* mdk, uint32_t seconds)
+{
+	uint8_t requests[HKDS_DAEMON_DATAGRAM_BATCH * HKDS_CLIENT_MESSAGE_REQUEST_SIZE] = { 0 };
+	benchmark_client clients[HKDS_DAEMON_MAX_LOOPS] = { 0 };
+	pthread_t threads[HKDS_DAEMON_MAX_LOOPS];
+	hkds_daemon_state daemon = { 0 };
+	struct timespec deadline;
+	uint64_t answered;
+	uint64_t failed;
+	size_t started;
+
+	/* the benchmark serves UDP only, with one client thread per event loop */
+	config->port = 0U;
+	config->unixpath = NULL;
+	config->udpport = (config->udpport != 0U) ? config->udpport : (uint16_t)HKDS_DAEMON_DEFAULT_PORT;
+	config->mdk = mdk;
+	benchmark_requests(mdk, config->authenticated, requests);
+	started = 0U;
+	answered = 0U;
+	failed = 0U;
+
+	if (hkds_daemon_start(&daemon, config) == true)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += (time_t)seconds;
+
+		for (size_t i = 0U; i < config->loops; ++i)
+		{
+			clients[i].requests = requests;
+			clients[i].address = config->address;
+			clients[i].deadline = deadline;
+			clients[i].port = config->udpport;
+
+			if (pthread_create(&threads[i], NULL, &benchmark_run, &clients[i]) == 0)
+			{
+				++started;
+			}
+		}
+
+		for (size_t i = 0U; i < started; ++i)
+		{
+			pthread_join(threads[i], NULL);
+			answered += clients[i].answered;
+			failed += clients[i].failed;
+		}
+
+		hkds_daemon_stop(&daemon);
+		printf("hkds_daemon: %llu datagrams answered in %u seconds by %zu %s event loops%s%s: %.0f packets per second, %.0f per loop.\n",
+			(unsigned long long)answered, (unsigned)seconds, config->loops, (config->engine == hkds_daemon_engine_uring) ? "io_uring" : "epoll",
+			(config->authenticated == true) ? ", authenticated" : "", (config->isolated == true) ? ", isolated key workers" : "",
+			(double)answered / (double)seconds,
+			(double)answered / (double)seconds / (double)config->loops);
+
+		if (failed != 0U)
+		{
+			printf("hkds_daemon: %llu datagrams were answered with an error.\n", (unsigned long long)failed);
+		}
+	}
+	else
+	{
+		fprintf(stderr, "hkds_daemon: the benchmark UDP sockets could not be opened.\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	hkds_daemon_config config = { 0 };
+	hkds_daemon_statistics stats;
+	hkds_daemon_state daemon = { 0 };
+	hkds_master_key mdk;
+	struct timespec period;
+	const char* keypath;
+	sigset_t sigs;
+	uint32_t seconds;
+	long cores;
+	int ret;
+	int sig;
+	bool valid;
+
+	config.address = HKDS_DAEMON_DEFAULT_ADDRESS;
+	config.port = (uint16_t)HKDS_DAEMON_DEFAULT_PORT;
+	cores = sysconf(_SC_NPROCESSORS_ONLN);
+	config.loops = (cores > 0) ? (size_t)cores : 1U;
+	config.loops = (config.loops <= HKDS_DAEMON_MAX_LOOPS) ? config.loops : HKDS_DAEMON_MAX_LOOPS;
+	keypath = NULL;
+	seconds = 0U;
+	valid = true;
+	ret = EXIT_FAILURE;
+
+	for (int i = 1; i < argc && valid == true; ++i)
+	{
+		if (strcmp(argv[i], "-a") == 0)
+		{
+			config.authenticated = true;
+		}
+		else if (strcmp(argv[i], "-i") == 0)
+		{
+#if defined(HKDS_DAEMON_URING)
+			config.engine = hkds_daemon_engine_uring;
+#else
+			fprintf(stderr, "hkds_daemon: this build has no io_uring engine; the kernel headers lack IORING_SETUP_DEFER_TASKRUN.\n");
+			valid = false;
+#endif
+		}
+		else if (strcmp(argv[i], "-w") == 0)
+		{
+			config.isolated = true;
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-l") == 0)
+		{
+			config.address = argv[++i];
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-p") == 0)
+		{
+			config.port = (uint16_t)strtoul(argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-d") == 0)
+		{
+			config.udpport = (uint16_t)strtoul(argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-b") == 0)
+		{
+			seconds = (uint32_t)strtoul(argv[++i], NULL, 10);
+			valid = (seconds != 0U);
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-u") == 0)
+		{
+			config.unixpath = argv[++i];
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-t") == 0)
+		{
+			config.loops = (size_t)strtoul(argv[++i], NULL, 10);
+		}
+		else if (i + 1 < argc && strcmp(argv[i], "-k") == 0)
+		{
+			keypath = argv[++i];
+		}
+		else
+		{
+			valid = false;
+		}
+	}
+
+	if (valid == false)
+	{
+		print_usage();
+	}
+	else if (load_master_key(keypath, &mdk) == false)
+	{
+		fprintf(stderr, "hkds_daemon: the master key file could not be read or written.\n");
+	}
+	else if (seconds != 0U)
+	{
+		benchmark(&config, &mdk, seconds);
+		utils_memory_secure_erase((uint8_t*)&mdk, sizeof(mdk));
+		ret = EXIT_SUCCESS;
+	}
+	else
+	{
+		/* the signals are blocked before the loops start, so only this thread receives them */
+		sigemptyset(&sigs);
+		sigaddset(&sigs, SIGINT);
+		sigaddset(&sigs, SIGTERM);
+		pthread_sigmask(SIG_BLOCK, &sigs, NULL);
+		config.mdk = &mdk;
+
+		if (hkds_daemon_start(&daemon, &config) == true)
+		{
+			if (config.isolated == true)
+			{
+				/* the key workers hold their own copies */
+				utils_memory_secure_erase((uint8_t*)&mdk, sizeof(mdk));
+			}
+
+			printf("hkds_daemon: serving on %s, TCP port %u, UDP port %u%s%s with %zu %s event loops%s%s.\n", config.address,
+				(unsigned)config.port, (unsigned)config.udpport, (config.unixpath != NULL) ? " and " : "",
+				(config.unixpath != NULL) ? config.unixpath : "", config.loops,
+				(config.engine == hkds_daemon_engine_uring) ? "io_uring" : "epoll", (config.authenticated == true) ? ", authenticated" : "",
+				(config.isolated == true) ? ", isolated key workers" : "");
+			fflush(stdout);
+			period.tv_sec = 10;
+			period.tv_nsec = 0;
+			sig = -1;
+
+			while (sig != SIGINT && sig != SIGTERM)
+			{
+				sig = sigtimedwait(&sigs, NULL, &period);
+				hkds_daemon_get_statistics(&daemon, &stats);
+				printf("connections %llu, messages %llu, tokens %llu, envelopes %llu, batches %llu, datagrams %llu, failures %llu, malformed %llu\n",
+					(unsigned long long)stats.connections, (unsigned long long)stats.messages, (unsigned long long)stats.tokens,
+					(unsigned long long)stats.envelopes, (unsigned long long)stats.batches, (unsigned long long)stats.datagrams,
+					(unsigned long long)stats.failures, (unsigned long long)stats.malformed);
+				fflush(stdout);
+			}
+
+			hkds_daemon_stop(&daemon);
+			ret = EXIT_SUCCESS;
+		}
+		else
+		{
+			fprintf(stderr, "hkds_daemon: the listening sockets or event loops could not be opened.\n");
+		}
+
+		utils_memory_secure_erase((uint8_t*)&mdk, sizeof(mdk));
+	}
+
+	return ret;
+}
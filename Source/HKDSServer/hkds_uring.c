@@ -0,0 +1,439 @@
+#if !defined(_GNU_SOURCE)
+	/* required for syscall and mmap flags in strict C11 builds */
+#	define _GNU_SOURCE
+#endif
+#include "hkds_uring.h"
+#include "utils.h"
+#include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* the kernel and the daemon share the ring indices, which are read and written with acquire and release ordering */
+#define hkds_uring_load_acquire(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define hkds_uring_store_release(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+static int hkds_uring_setup(uint32_t entries, struct io_uring_params* params)
+{
+	return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int hkds_uring_enter(int fd, uint32_t submit, uint32_t wait, uint32_t flags)
+{
+	return (int)syscall(__NR_io_uring_enter, fd, submit, wait, flags, NULL, 0U);
+}
+
+static int hkds_uring_register(int fd, uint32_t opcode, const void* arg, uint32_t count)
+{
+	return (int)syscall(__NR_io_uring_register, fd, opcode, arg, count);
+}
+
+static bool hkds_uring_map(hkds_uring_state* ring, const struct io_uring_params* params)
+{
+	uint8_t* sq;
+	uint8_t* cq;
+	bool res;
+
+	res = false;
+	ring->sqmaplen = params->sq_off.array + (params->sq_entries * sizeof(uint32_t));
+	ring->cqmaplen = params->cq_off.cqes + (params->cq_entries * sizeof(struct io_uring_cqe));
+	ring->sqeslen = params->sq_entries * sizeof(struct io_uring_sqe);
+	ring->cqmap = NULL;
+
+	if ((params->features & IORING_FEAT_SINGLE_MMAP) != 0U)
+	{
+		/* the submission and completion rings share one mapping */
+		ring->sqmaplen = (ring->cqmaplen > ring->sqmaplen) ? ring->cqmaplen : ring->sqmaplen;
+	}
+
+	ring->sqmap = mmap(NULL, ring->sqmaplen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, (off_t)IORING_OFF_SQ_RING);
+
+	if (ring->sqmap != MAP_FAILED)
+	{
+		sq = (uint8_t*)ring->sqmap;
+		cq = sq;
+
+		if ((params->features & IORING_FEAT_SINGLE_MMAP) == 0U)
+		{
+			ring->cqmap = mmap(NULL, ring->cqmaplen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, (off_t)IORING_OFF_CQ_RING);
+			cq = (ring->cqmap != MAP_FAILED) ? (uint8_t*)ring->cqmap : NULL;
+		}
+
+		ring->sqes = (struct io_uring_sqe*)mmap(NULL, ring->sqeslen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, (off_t)IORING_OFF_SQES);
+
+		if (cq != NULL && ring->sqes != MAP_FAILED)
+		{
+			ring->sqhead = (uint32_t*)(sq + params->sq_off.head);
+			ring->sqtail = (uint32_t*)(sq + params->sq_off.tail);
+			ring->sqarray = (uint32_t*)(sq + params->sq_off.array);
+			ring->sqmask = *(uint32_t*)(sq + params->sq_off.ring_mask);
+			ring->sqentries = params->sq_entries;
+			ring->cqhead = (uint32_t*)(cq + params->cq_off.head);
+			ring->cqtail = (uint32_t*)(cq + params->cq_off.tail);
+			ring->cqmask = *(uint32_t*)(cq + params->cq_off.ring_mask);
+			ring->cqes = (struct io_uring_cqe*)(cq + params->cq_off.cqes);
+			ring->local = *ring->sqtail;
+
+			/* the index array is the identity, so entry i is always submitted from slot i */
+			for (uint32_t i = 0U; i < ring->sqentries; ++i)
+			{
+				ring->sqarray[i] = i;
+			}
+
+			res = true;
+		}
+	}
+
+	return res;
+}
+
+bool hkds_uring_initialize(hkds_uring_state* ring, uint32_t entries)
+{
+	HKDS_ASSERT(ring != NULL);
+	HKDS_ASSERT(entries != 0U);
+
+	struct io_uring_params params;
+	bool res;
+
+	res = false;
+
+	if (ring != NULL && entries != 0U)
+	{
+		utils_memory_clear((uint8_t*)ring, sizeof(hkds_uring_state));
+		utils_memory_clear((uint8_t*)&params, sizeof(params));
+		/* the ring is created disabled, so the thread that enables it becomes the single issuer */
+		params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN |
+			IORING_SETUP_R_DISABLED;
+		params.cq_entries = entries * 4U;
+		ring->fd = hkds_uring_setup(entries, &params);
+
+		if (ring->fd < 0)
+		{
+			/* an older kernel without single issuer task running */
+			utils_memory_clear((uint8_t*)&params, sizeof(params));
+			params.flags = IORING_SETUP_CQSIZE;
+			params.cq_entries = entries * 4U;
+			ring->fd = hkds_uring_setup(entries, &params);
+		}
+
+		if (ring->fd >= 0)
+		{
+			ring->flags = params.flags;
+			ring->sqmap = MAP_FAILED;
+			ring->sqes = (struct io_uring_sqe*)MAP_FAILED;
+			res = hkds_uring_map(ring, &params);
+
+			if (res == false)
+			{
+				hkds_uring_destroy(ring);
+			}
+		}
+	}
+
+	return res;
+}
+
+void hkds_uring_destroy(hkds_uring_state* ring)
+{
+	HKDS_ASSERT(ring != NULL);
+
+	if (ring != NULL && ring->fd >= 0)
+	{
+		if (ring->sqes != NULL && ring->sqes != MAP_FAILED)
+		{
+			munmap(ring->sqes, ring->sqeslen);
+		}
+
+		if (ring->cqmap != NULL && ring->cqmap != MAP_FAILED)
+		{
+			munmap(ring->cqmap, ring->cqmaplen);
+		}
+
+		if (ring->sqmap != NULL && ring->sqmap != MAP_FAILED)
+		{
+			munmap(ring->sqmap, ring->sqmaplen);
+		}
+
+		close(ring->fd);
+		utils_memory_clear((uint8_t*)ring, sizeof(hkds_uring_state));
+		ring->fd = -1;
+	}
+}
+
+bool hkds_uring_enable(const hkds_uring_state* ring)
+{
+	HKDS_ASSERT(ring != NULL);
+
+	bool res;
+
+	res = false;
+
+	if (ring != NULL)
+	{
+		res = ((ring->flags & IORING_SETUP_R_DISABLED) == 0U || hkds_uring_register(ring->fd, IORING_REGISTER_ENABLE_RINGS, NULL, 0U) == 0);
+	}
+
+	return res;
+}
+
+struct io_uring_sqe* hkds_uring_get_sqe(hkds_uring_state* ring)
+{
+	HKDS_ASSERT(ring != NULL);
+
+	struct io_uring_sqe* res;
+
+	res = NULL;
+
+	if (ring != NULL && ring->local - hkds_uring_load_acquire(ring->sqhead) < ring->sqentries)
+	{
+		res = &ring->sqes[ring->local & ring->sqmask];
+		utils_memory_clear((uint8_t*)res, sizeof(struct io_uring_sqe));
+		++ring->local;
+	}
+
+	return res;
+}
+
+int hkds_uring_submit(hkds_uring_state* ring, uint32_t wait)
+{
+	HKDS_ASSERT(ring != NULL);
+
+	uint32_t count;
+	int res;
+
+	res = -EINVAL;
+
+	if (ring != NULL)
+	{
+		count = ring->local - *ring->sqtail;
+		hkds_uring_store_release(ring->sqtail, ring->local);
+		res = 0;
+
+		if (count != 0U || wait != 0U)
+		{
+			res = hkds_uring_enter(ring->fd, count, wait, (wait != 0U) ? IORING_ENTER_GETEVENTS : 0U);
+		}
+
+		if (res < 0)
+		{
+			res = -errno;
+		}
+	}
+
+	return res;
+}
+
+struct io_uring_cqe* hkds_uring_peek(const hkds_uring_state* ring)
+{
+	HKDS_ASSERT(ring != NULL);
+
+	struct io_uring_cqe* res;
+	uint32_t head;
+
+	res = NULL;
+
+	if (ring != NULL)
+	{
+		head = *ring->cqhead;
+
+		if (head != hkds_uring_load_acquire(ring->cqtail))
+		{
+			res = &ring->cqes[head & ring->cqmask];
+		}
+	}
+
+	return res;
+}
+
+void hkds_uring_advance(hkds_uring_state* ring)
+{
+	HKDS_ASSERT(ring != NULL);
+
+	if (ring != NULL)
+	{
+		hkds_uring_store_release(ring->cqhead, *ring->cqhead + 1U);
+	}
+}
+
+bool hkds_uring_register_buffers(const hkds_uring_state* ring, const struct iovec* iov, uint32_t count)
+{
+	HKDS_ASSERT(ring != NULL);
+	HKDS_ASSERT(iov != NULL);
+
+	return (ring != NULL && iov != NULL && hkds_uring_register(ring->fd, IORING_REGISTER_BUFFERS, iov, count) == 0);
+}
+
+bool hkds_uring_buffers_initialize(const hkds_uring_state* ring, hkds_uring_buffers* buffers, uint16_t group, uint16_t entries, size_t buflen)
+{
+	HKDS_ASSERT(ring != NULL);
+	HKDS_ASSERT(buffers != NULL);
+	HKDS_ASSERT(entries != 0U && (entries & (entries - 1U)) == 0U);
+
+	struct io_uring_buf_reg reg;
+	void* map;
+	bool res;
+
+	res = false;
+
+	if (ring != NULL && buffers != NULL && entries != 0U && (entries & (entries - 1U)) == 0U && entries <= 32768U)
+	{
+		utils_memory_clear((uint8_t*)buffers, sizeof(hkds_uring_buffers));
+		buffers->ringlen = (size_t)entries * sizeof(struct io_uring_buf);
+		map = mmap(NULL, buffers->ringlen, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		buffers->memory = (uint8_t*)utils_memory_aligned_alloc(HKDS_SIMD_ALIGNMENT, (size_t)entries * buflen);
+
+		if (map != MAP_FAILED)
+		{
+			buffers->ring = (struct io_uring_buf_ring*)map;
+		}
+
+		if (buffers->ring != NULL && buffers->memory != NULL)
+		{
+			utils_memory_clear((uint8_t*)&reg, sizeof(reg));
+			reg.ring_addr = (uint64_t)(uintptr_t)buffers->ring;
+			reg.ring_entries = entries;
+			reg.bgid = group;
+			buffers->entries = entries;
+			buffers->mask = (uint16_t)(entries - 1U);
+			buffers->group = group;
+			buffers->buflen = buflen;
+
+			if (hkds_uring_register(ring->fd, IORING_REGISTER_PBUF_RING, &reg, 1U) == 0)
+			{
+				for (uint16_t i = 0U; i < entries; ++i)
+				{
+					hkds_uring_buffers_recycle(buffers, i);
+				}
+
+				hkds_uring_buffers_publish(buffers);
+				res = true;
+			}
+		}
+
+		if (res == false)
+		{
+			if (buffers->ring != NULL)
+			{
+				munmap(buffers->ring, buffers->ringlen);
+			}
+
+			if (buffers->memory != NULL)
+			{
+				utils_memory_aligned_free(buffers->memory);
+			}
+
+			utils_memory_clear((uint8_t*)buffers, sizeof(hkds_uring_buffers));
+		}
+	}
+
+	return res;
+}
+
+void hkds_uring_buffers_destroy(const hkds_uring_state* ring, hkds_uring_buffers* buffers)
+{
+	HKDS_ASSERT(ring != NULL);
+	HKDS_ASSERT(buffers != NULL);
+
+	struct io_uring_buf_reg reg;
+
+	if (ring != NULL && buffers != NULL && buffers->ring != NULL)
+	{
+		utils_memory_clear((uint8_t*)&reg, sizeof(reg));
+		reg.bgid = buffers->group;
+
+		if (ring->fd >= 0)
+		{
+			hkds_uring_register(ring->fd, IORING_UNREGISTER_PBUF_RING, &reg, 1U);
+		}
+
+		munmap(buffers->ring, buffers->ringlen);
+		utils_memory_secure_erase(buffers->memory, (size_t)buffers->entries * buffers->buflen);
+		utils_memory_aligned_free(buffers->memory);
+		utils_memory_clear((uint8_t*)buffers, sizeof(hkds_uring_buffers));
+	}
+}
+
+uint8_t* hkds_uring_buffers_address(const hkds_uring_buffers* buffers, uint16_t id)
+{
+	HKDS_ASSERT(buffers != NULL);
+
+	return buffers->memory + ((size_t)(id & buffers->mask) * buffers->buflen);
+}
+
+void hkds_uring_buffers_recycle(hkds_uring_buffers* buffers, uint16_t id)
+{
+	HKDS_ASSERT(buffers != NULL);
+
+	struct io_uring_buf* buf;
+
+	buf = &buffers->ring->bufs[buffers->tail & buffers->mask];
+	buf->addr = (uint64_t)(uintptr_t)hkds_uring_buffers_address(buffers, id);
+	buf->len = (uint32_t)buffers->buflen;
+	buf->bid = id;
+	++buffers->tail;
+}
+
+void hkds_uring_buffers_publish(hkds_uring_buffers* buffers)
+{
+	HKDS_ASSERT(buffers != NULL);
+
+	hkds_uring_store_release(&buffers->ring->tail, buffers->tail);
+}
+
+void hkds_uring_prep_accept(struct io_uring_sqe* sqe, int fd, uint64_t user)
+{
+	sqe->opcode = IORING_OP_ACCEPT;
+	sqe->fd = fd;
+	sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+	sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+	sqe->user_data = user;
+}
+
+void hkds_uring_prep_recv(struct io_uring_sqe* sqe, int fd, uint16_t group, uint64_t user)
+{
+	sqe->opcode = IORING_OP_RECV;
+	sqe->fd = fd;
+	sqe->ioprio = IORING_RECV_MULTISHOT;
+	sqe->flags = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = group;
+	sqe->user_data = user;
+}
+
+void hkds_uring_prep_send(struct io_uring_sqe* sqe, int fd, const uint8_t* data, size_t length, uint16_t index, bool zerocopy, uint64_t user)
+{
+	sqe->fd = fd;
+	sqe->addr = (uint64_t)(uintptr_t)data;
+	sqe->len = (uint32_t)length;
+	sqe->msg_flags = MSG_NOSIGNAL;
+	sqe->user_data = user;
+
+	if (zerocopy == true)
+	{
+		sqe->opcode = IORING_OP_SEND_ZC;
+		sqe->ioprio = IORING_RECVSEND_FIXED_BUF;
+		sqe->buf_index = index;
+	}
+	else
+	{
+		/* a fixed-buffer copying send needs Linux 6.10, so the buffer is passed by address */
+		sqe->opcode = IORING_OP_SEND;
+	}
+}
+
+void hkds_uring_prep_poll(struct io_uring_sqe* sqe, int fd, uint64_t user)
+{
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = fd;
+	sqe->poll32_events = POLLIN;
+	sqe->user_data = user;
+}
+
+void hkds_uring_prep_cancel(struct io_uring_sqe* sqe, uint64_t target, uint64_t user)
+{
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->addr = target;
+	sqe->user_data = user;
+}
@@ -0,0 +1,290 @@
+/* 2021-2026 Quantum Resistant Cryptographic Solutions Corporation
+ * All Rights Reserved.
+ *
+ * NOTICE:
+ * This software and all accompanying materials are the exclusive property of
+ * Quantum Resistant Cryptographic Solutions Corporation (QRCS). The intellectual
+ * and technical concepts contained herein are proprietary to QRCS and are
+ * protected under applicable Canadian, U.S., and international copyright,
+ * patent, and trade secret laws.
+ *
+ * CRYPTOGRAPHIC ALGORITHMS AND IMPLEMENTATIONS:
+ * - This software includes implementations of cryptographic primitives and
+ *   algorithms that are standardized or in the public domain, such as AES
+ *   and SHA-3, which are not proprietary to QRCS.
+ * - This software also includes cryptographic primitives, constructions, and
+ *   algorithms designed by QRCS, including but not limited to RCS, SCB, CSX, QMAC, and
+ *   related components, which are proprietary to QRCS.
+ * - All source code, implementations, protocol compositions, optimizations,
+ *   parameter selections, and engineering work contained in this software are
+ *   original works of QRCS and are protected under this license.
+ *
+ * LICENSE AND USE RESTRICTIONS:
+ * - This software is licensed under the Quantum Resistant Cryptographic Solutions
+ *   Public Research and Evaluation License (QRCS-PREL), 2025-2026.
+ * - Permission is granted solely for non-commercial evaluation, academic research,
+ *   cryptographic analysis, interoperability testing, and feasibility assessment.
+ * - Commercial use, production deployment, commercial redistribution, or
+ *   integration into products or services is strictly prohibited without a
+ *   separate written license agreement executed with QRCS.
+ * - Licensing and authorized distribution are solely at the discretion of QRCS.
+ *
+ * EXPERIMENTAL CRYPTOGRAPHY NOTICE:
+ * Portions of this software may include experimental, novel, or evolving
+ * cryptographic designs. Use of this software is entirely at the user's risk.
+ *
+ * DISCLAIMER:
+ * THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE, SECURITY, OR NON-INFRINGEMENT. QRCS DISCLAIMS ALL
+ * LIABILITY FOR ANY DIRECT, INDIRECT, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING FROM THE USE OR MISUSE OF THIS SOFTWARE.
+ *
+ * FULL LICENSE:
+ * This software is subject to the Quantum Resistant Cryptographic Solutions
+ * Public Research and Evaluation License (QRCS-PREL), 2025-2026. The complete license terms
+ * are provided in the accompanying LICENSE file or at https://www.qrcscorp.ca.
+ *
+ * Written by: John G. Underhill
+ * Contact: contact@qrcscorp.ca
+ */
+
+#ifndef HKDS_URING_H
+#define HKDS_URING_H
+
+#include "hkds_config.h"
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+
+/**
+ * \file hkds_uring.h
+ * \brief A minimal io_uring interface for the HKDS server daemon.
+ *
+ * \details
+ * This header defines the small part of io_uring the daemon uses, implemented directly on the io_uring system calls,
+ * so the daemon has no dependency beyond the kernel headers:
+ * - A submission and completion ring pair, set up with a single issuer and deferred task running where the kernel
+ *   supports it, so completions are only processed when the loop asks for them.
+ * - Provided buffer rings, from which multishot receives pick their buffers; the received bytes land in memory the
+ *   daemon allocated and registered once, and are read there in place.
+ * - Registered fixed buffers, which zero-copy sends reference by index.
+ * - Preparation functions for the multishot accept and receive, zero-copy or copying send, poll, and cancel requests.
+ *
+ * The ring is used by a single thread. Multishot receives and zero-copy sends require Linux 6.0 or later.
+ */
+
+/*!
+ * \struct hkds_uring_state
+ * \brief Contains the io_uring ring state.
+ */
+typedef struct
+{
+    uint32_t* sqhead;                   /*!< The kernel submission queue head */
+    uint32_t* sqtail;                   /*!< The submission queue tail */
+    uint32_t* sqarray;                  /*!< The submission queue index array */
+    struct io_uring_sqe* sqes;          /*!< The submission queue entries */
+    uint32_t* cqhead;                   /*!< The completion queue head */
+    uint32_t* cqtail;                   /*!< The kernel completion queue tail */
+    struct io_uring_cqe* cqes;          /*!< The completion queue entries */
+    void* sqmap;                        /*!< The mapped submission ring */
+    void* cqmap;                        /*!< The mapped completion ring, or NULL if shared with the submission ring */
+    size_t sqmaplen;                    /*!< The byte length of the submission ring mapping */
+    size_t cqmaplen;                    /*!< The byte length of the completion ring mapping */
+    size_t sqeslen;                     /*!< The byte length of the entry mapping */
+    uint32_t sqmask;                    /*!< The submission ring mask */
+    uint32_t cqmask;                    /*!< The completion ring mask */
+    uint32_t sqentries;                 /*!< The number of submission entries */
+    uint32_t local;                     /*!< The local submission tail, published on submit */
+    uint32_t flags;                     /*!< The ring setup flags */
+    int fd;                             /*!< The ring file descriptor */
+} hkds_uring_state;
+
+/*!
+ * \struct hkds_uring_buffers
+ * \brief Contains a provided buffer ring and its buffers.
+ */
+typedef struct
+{
+    struct io_uring_buf_ring* ring;     /*!< The shared buffer ring */
+    uint8_t* memory;                    /*!< The buffer memory */
+    size_t ringlen;                     /*!< The byte length of the ring mapping */
+    size_t buflen;                      /*!< The size of each buffer */
+    uint16_t entries;                   /*!< The number of buffers; a power of two */
+    uint16_t mask;                      /*!< The ring mask */
+    uint16_t group;                     /*!< The buffer group identifier */
+    uint16_t tail;                      /*!< The local ring tail, published with \ref hkds_uring_buffers_publish */
+} hkds_uring_buffers;
+
+/**
+ * \brief Set up an io_uring ring.
+ *
+ * \param ring [out] Pointer to the ring state.
+ * \param entries [in] The number of submission entries; the completion queue is four times deeper.
+ * \return Returns false if io_uring is unavailable or the ring could not be mapped.
+ */
+bool hkds_uring_initialize(hkds_uring_state* ring, uint32_t entries);
+
+/**
+ * \brief Unmap and close the ring; the kernel cancels every pending request.
+ *
+ * \param ring [in,out] Pointer to the ring state.
+ */
+void hkds_uring_destroy(hkds_uring_state* ring);
+
+/**
+ * \brief Enable a ring that was created disabled; called from the thread that submits to it.
+ *
+ * \details
+ * A ring set up for a single issuer is created disabled, so its buffers can be registered and its first entries
+ * prepared by the thread that creates it; the thread that enables it becomes the issuer.
+ *
+ * \param ring [in] Pointer to the ring state.
+ * \return Returns false if the ring could not be enabled.
+ */
+bool hkds_uring_enable(const hkds_uring_state* ring);
+
+/**
+ * \brief Get a cleared submission entry.
+ *
+ * \param ring [in,out] Pointer to the ring state.
+ * \return The entry, or NULL if the submission queue is full.
+ */
+struct io_uring_sqe* hkds_uring_get_sqe(hkds_uring_state* ring);
+
+/**
+ * \brief Submit the prepared entries, and wait for completions.
+ *
+ * \param ring [in,out] Pointer to the ring state.
+ * \param wait [in] The number of completions to wait for; zero only submits.
+ * \return The number of entries submitted, or a negative error code.
+ */
+int hkds_uring_submit(hkds_uring_state* ring, uint32_t wait);
+
+/**
+ * \brief Get the next completion without removing it.
+ *
+ * \param ring [in] Pointer to the ring state.
+ * \return The completion, or NULL if the completion queue is empty.
+ */
+struct io_uring_cqe* hkds_uring_peek(const hkds_uring_state* ring);
+
+/**
+ * \brief Remove the completion returned by the last peek.
+ *
+ * \param ring [in,out] Pointer to the ring state.
+ */
+void hkds_uring_advance(hkds_uring_state* ring);
+
+/**
+ * \brief Register fixed buffers, referenced by index from fixed-buffer sends.
+ *
+ * \param ring [in] Pointer to the ring state.
+ * \param iov [in] The buffer array.
+ * \param count [in] The number of buffers.
+ * \return Returns false if the buffers could not be registered; the memory is locked, and counts against \c RLIMIT_MEMLOCK.
+ */
+bool hkds_uring_register_buffers(const hkds_uring_state* ring, const struct iovec* iov, uint32_t count);
+
+/**
+ * \brief Allocate a provided buffer ring with its buffers, register it, and provide every buffer.
+ *
+ * \param ring [in] Pointer to the ring state.
+ * \param buffers [out] Pointer to the buffer ring state.
+ * \param group [in] The buffer group identifier.
+ * \param entries [in] The number of buffers; a power of two, at most 32768.
+ * \param buflen [in] The size of each buffer.
+ * \return Returns false if the memory could not be allocated or the ring could not be registered.
+ */
+bool hkds_uring_buffers_initialize(const hkds_uring_state* ring, hkds_uring_buffers* buffers, uint16_t group, uint16_t entries, size_t buflen);
+
+/**
+ * \brief Unregister the buffer ring and release its memory.
+ *
+ * \details
+ * The ring may already be destroyed, which releases the registration with it.
+ *
+ * \param ring [in] Pointer to the ring state.
+ * \param buffers [in,out] Pointer to the buffer ring state.
+ */
+void hkds_uring_buffers_destroy(const hkds_uring_state* ring, hkds_uring_buffers* buffers);
+
+/**
+ * \brief Get the address of a buffer.
+ *
+ * \param buffers [in] Pointer to the buffer ring state.
+ * \param id [in] The buffer identifier from the completion flags.
+ * \return The buffer address.
+ */
+uint8_t* hkds_uring_buffers_address(const hkds_uring_buffers* buffers, uint16_t id);
+
+/**
+ * \brief Return a buffer to the ring; it is visible to the kernel after the next publish.
+ *
+ * \param buffers [in,out] Pointer to the buffer ring state.
+ * \param id [in] The buffer identifier.
+ */
+void hkds_uring_buffers_recycle(hkds_uring_buffers* buffers, uint16_t id);
+
+/**
+ * \brief Publish the recycled buffers to the kernel.
+ *
+ * \param buffers [in,out] Pointer to the buffer ring state.
+ */
+void hkds_uring_buffers_publish(hkds_uring_buffers* buffers);
+
+/**
+ * \brief Prepare a multishot accept; each connection completes with the new socket.
+ *
+ * \param sqe [out] The submission entry.
+ * \param fd [in] The listening socket.
+ * \param user [in] The completion tag.
+ */
+void hkds_uring_prep_accept(struct io_uring_sqe* sqe, int fd, uint64_t user);
+
+/**
+ * \brief Prepare a multishot receive into buffers picked from a provided buffer ring.
+ *
+ * \param sqe [out] The submission entry.
+ * \param fd [in] The connected socket.
+ * \param group [in] The buffer group identifier.
+ * \param user [in] The completion tag.
+ */
+void hkds_uring_prep_recv(struct io_uring_sqe* sqe, int fd, uint16_t group, uint64_t user);
+
+/**
+ * \brief Prepare a send from a registered fixed buffer.
+ *
+ * \details
+ * A zero-copy send completes twice: with the byte count, and, once the kernel no longer references the buffer, with a
+ * notification; the buffer must not be changed before the notification. Sockets without zero-copy support, such as
+ * Unix sockets, fail a zero-copy send with \c EOPNOTSUPP, and use a copying send, which completes once.
+ *
+ * \param sqe [out] The submission entry.
+ * \param fd [in] The connected socket.
+ * \param data [in] The first byte to send, inside the fixed buffer.
+ * \param length [in] The number of bytes to send.
+ * \param index [in] The fixed buffer index.
+ * \param zerocopy [in] Send without copying the buffer.
+ * \param user [in] The completion tag.
+ */
+void hkds_uring_prep_send(struct io_uring_sqe* sqe, int fd, const uint8_t* data, size_t length, uint16_t index, bool zerocopy, uint64_t user);
+
+/**
+ * \brief Prepare a single poll for readability.
+ *
+ * \param sqe [out] The submission entry.
+ * \param fd [in] The file descriptor.
+ * \param user [in] The completion tag.
+ */
+void hkds_uring_prep_poll(struct io_uring_sqe* sqe, int fd, uint64_t user);
+
+/**
+ * \brief Prepare the cancellation of a pending request.
+ *
+ * \param sqe [out] The submission entry.
+ * \param target [in] The completion tag of the request to cancel.
+ * \param user [in] The completion tag of the cancellation.
+ */
+void hkds_uring_prep_cancel(struct io_uring_sqe* sqe, uint64_t target, uint64_t user);
+
+#endif
@@ -10,6 +10,7 @@
 #define SAMPLE_COUNT 1000000
 #define ONE_GIGABYTE 1024000000
 #define TEST_CYCLES 1000000
+#define CACHE_CYCLES 100000
 
 static void kmac128_benchmark(void)
 {
@@ -625,6 +626,77 @@ static void hkdstest_benchmark_client_encrypt_authenticate_run(void)
 	hkdstest_print_line(" seconds");
 }
 
+static void hkdstest_benchmark_client_cache_run(void)
+{
+	uint8_t edk[HKDS_EDK_SIZE] = { 0 };
+	uint8_t did[HKDS_DID_SIZE] = { 0 };
+	uint8_t tokd[HKDS_STK_SIZE] = { 0 };
+	hkds_client_state cs;
+	uint64_t start;
+	uint64_t elapsed;
+
+	hkds_client_initialize_state(&cs, edk, did);
+
+	start = utils_stopwatch_start();
+
+	for (size_t i = 0; i < CACHE_CYCLES; ++i)
+	{
+		/* client derives the transaction key-set */
+		hkds_client_generate_cache(&cs, tokd);
+	}
+
+	elapsed = utils_stopwatch_elapsed(start);
+
+#if defined(HKDS_SHAKE_128)
+	hkdstest_print_safe("HKDS-128 Client generated 100 thousand key caches in ");
+#elif defined(HKDS_SHAKE_256)
+	hkdstest_print_safe("HKDS-256 Client generated 100 thousand key caches in ");
+#else
+	hkdstest_print_safe("HKDS-512 Client generated 100 thousand key caches in ");
+#endif
+
+	hkdstest_print_double((double)elapsed / 1000.0);
+	hkdstest_print_line(" seconds");
+}
+
+static void hkdstest_benchmark_client_cache_x8_run(void)
+{
+	uint8_t edk[HKDS_EDK_SIZE] = { 0 };
+	uint8_t did[HKDS_DID_SIZE] = { 0 };
+	uint8_t tokdp[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE] = { 0 };
+	hkds_client_state csp[HKDS_CACHX8_DEPTH];
+	hkds_client_state* pcs[HKDS_CACHX8_DEPTH];
+	uint64_t start;
+	uint64_t elapsed;
+
+	for (size_t i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		hkds_client_initialize_state(&csp[i], edk, did);
+		pcs[i] = &csp[i];
+	}
+
+	start = utils_stopwatch_start();
+
+	for (size_t i = 0; i < CACHE_CYCLES / HKDS_CACHX8_DEPTH; ++i)
+	{
+		/* eight clients derive their transaction key-sets */
+		hkds_client_generate_cache_x8(pcs, (const uint8_t (*)[HKDS_STK_SIZE])tokdp);
+	}
+
+	elapsed = utils_stopwatch_elapsed(start);
+
+#if defined(HKDS_SHAKE_128)
+	hkdstest_print_safe("HKDS-128 SIMD Client generated 100 thousand key caches in ");
+#elif defined(HKDS_SHAKE_256)
+	hkdstest_print_safe("HKDS-256 SIMD Client generated 100 thousand key caches in ");
+#else
+	hkdstest_print_safe("HKDS-512 SIMD Client generated 100 thousand key caches in ");
+#endif
+
+	hkdstest_print_double((double)elapsed / 1000.0);
+	hkdstest_print_line(" seconds");
+}
+
 static void hkdstest_benchmark_server_decrypt_run(void)
 {
 	const uint8_t kid[HKDS_KID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
@@ -888,6 +960,8 @@ void hkdstest_benchmark_hkds_client_run()
 {
 	hkdstest_benchmark_client_encrypt_run();
 	hkdstest_benchmark_client_encrypt_authenticate_run();
+	hkdstest_benchmark_client_cache_run();
+	hkdstest_benchmark_client_cache_x8_run();
 }
 
 void hkdstest_benchmark_kmac_run()
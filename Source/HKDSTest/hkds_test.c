@@ -1,7 +1,16 @@
 #include "hkds_test.h"
 #include "testutils.h"
+#include "hkds_async.h"
+#include "hkds_batcher.h"
+#include "hkds_cache.h"
 #include "hkds_client.h"
+#include "hkds_factory.h"
+#include "hkds_fleet.h"
+#include "hkds_framer.h"
+#include "hkds_pool.h"
+#include "hkds_queue.h"
 #include "hkds_server.h"
+#include "keccak.h"
 #include "utils.h"
 
 #define HKDSTEST_CYCLES_COUNT 1000
@@ -445,6 +454,2465 @@ bool hkdstest_stress_test()
 	return res;
 }
 
+bool hkdstest_keystream_cache_test()
+{
+	/* master key id */
+	const uint8_t kid[HKDS_KID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
+	const uint8_t xid[HKDS_KID_SIZE] = { 0x04, 0x03, 0x02, 0x01 };
+	/* device id						|		BKD ID			| PID | Mode |	MID	     |			DID		     | */
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01, 0x00, 0x00, 0x00, 0x10, HKDSTEST_PRF_MODE, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	uint8_t cpt[HKDS_MESSAGE_SIZE + HKDS_TAG_SIZE] = { 0 };
+	uint8_t dec[HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t edk[HKDS_EDK_SIZE] = { 0 };
+	uint8_t msg[HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t tokd[HKDS_STK_SIZE] = { 0 };
+	uint8_t toke[HKDS_STK_SIZE + HKDS_TAG_SIZE] = { 0 };
+	uint8_t tdid[4][HKDS_DID_SIZE] = { 0 };
+	hkds_client_state cs[4];
+	hkds_keystream_cache kc;
+	hkds_master_key mdk;
+	hkds_master_key xdk;
+	hkds_server_state ss;
+	uint64_t lookups;
+	size_t d;
+	bool auth;
+	bool res;
+
+	hkdstest_hex_to_bin("000102030405060708090A0B0C0D0E0F", msg, sizeof(msg));
+	res = true;
+
+	/* generate the master derivation key {BDK, BTK, MID} */
+	hkds_server_generate_mdk(&utils_seed_generate, &mdk, kid);
+
+	/* initialize four clients, the odd numbered devices use KMAC authentication */
+	for (size_t i = 0; i < 4U; ++i)
+	{
+		utils_memory_copy(tdid[i], did, HKDS_DID_SIZE);
+		tdid[i][4U] = (i % 2U == 0U) ? 0x10 : 0x11;
+		tdid[i][HKDS_DID_SIZE - 1U] = (uint8_t)i;
+		hkds_server_generate_edk(mdk.bdk, tdid[i], edk);
+		hkds_client_initialize_state(&cs[i], edk, tdid[i]);
+	}
+
+	/* a two entry cache, forcing evictions across the four devices */
+	if (hkds_keystream_cache_initialize(&kc, kid, (2U * sizeof(hkds_keystream_entry)) + (4U * sizeof(uint32_t))) == false || kc.capacity != 2U)
+	{
+		hkdstest_print_line("hkds_keystream_cache_test: cache initialization failure! -HKC1");
+		res = false;
+	}
+
+	for (size_t i = 0; i < 2U * HKDSTEST_CYCLES_COUNT && res == true; ++i)
+	{
+		/* device zero is used on every second message, the others in rotation */
+		d = (i % 2U == 0U) ? 0U : 1U + ((i / 2U) % 3U);
+		auth = (tdid[d][4U] == 0x11);
+
+		/* initialize the server with the client-ksn and attach the cache */
+		hkds_server_initialize_state(&ss, &mdk, cs[d].ksn);
+		hkds_server_set_keystream_cache(&ss, &kc);
+
+		if (cs[d].cache_empty == true)
+		{
+			/* client requests the token key from server */
+			hkds_server_encrypt_token(&ss, toke);
+
+			if (hkds_client_decrypt_token(&cs[d], toke, tokd) == false)
+			{
+				hkdstest_print_line("hkds_keystream_cache_test: token authentication failure! -HKC2");
+				res = false;
+				break;
+			}
+
+			hkds_client_generate_cache(&cs[d], tokd);
+		}
+
+		if (auth == true && hkds_client_encrypt_authenticate_message(&cs[d], msg, kid, sizeof(kid), cpt) == true)
+		{
+			if (hkds_server_decrypt_verify_message(&ss, cpt, kid, sizeof(kid), dec) == false)
+			{
+				hkdstest_print_line("hkds_keystream_cache_test: decryption authentication failure! -HKC3");
+				res = false;
+				break;
+			}
+		}
+		else
+		{
+			/* the last key of an epoch can not be used for authentication */
+			hkds_client_encrypt_message(&cs[d], msg, cpt);
+			hkds_server_decrypt_message(&ss, cpt, dec);
+		}
+
+		if (utils_memory_are_equal(msg, dec, sizeof(msg)) == false)
+		{
+			hkdstest_print_line("hkds_keystream_cache_test: decrypted output does not match expected answer! -HKC4");
+			res = false;
+			break;
+		}
+	}
+
+	if (res == true && kc.hits == 0U)
+	{
+		hkdstest_print_line("hkds_keystream_cache_test: the cache was never used! -HKC5");
+		res = false;
+	}
+
+	if (res == true)
+	{
+		/* a device of the same identity under a different master key set must not be served from the cache */
+		hkds_server_generate_mdk(&utils_seed_generate, &xdk, xid);
+		hkds_server_generate_edk(xdk.bdk, tdid[0U], edk);
+		hkds_client_initialize_state(&cs[0U], edk, tdid[0U]);
+		hkds_server_initialize_state(&ss, &xdk, cs[0U].ksn);
+		hkds_server_set_keystream_cache(&ss, &kc);
+		hkds_server_encrypt_token(&ss, toke);
+		hkds_client_decrypt_token(&cs[0U], toke, tokd);
+		hkds_client_generate_cache(&cs[0U], tokd);
+		hkds_client_encrypt_message(&cs[0U], msg, cpt);
+		lookups = kc.hits + kc.misses;
+		hkds_server_decrypt_message(&ss, cpt, dec);
+
+		if (utils_memory_are_equal(msg, dec, sizeof(msg)) == false || kc.hits + kc.misses != lookups)
+		{
+			hkdstest_print_line("hkds_keystream_cache_test: a cache of another key set was used! -HKC6");
+			res = false;
+		}
+
+		utils_memory_secure_erase((uint8_t*)&xdk, sizeof(xdk));
+	}
+
+	hkds_keystream_cache_destroy(&kc);
+
+	return res;
+}
+
+bool hkdstest_edk_table_test()
+{
+	const uint8_t kid[HKDS_KID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
+	const uint8_t xid[HKDS_KID_SIZE] = { 0x04, 0x03, 0x02, 0x01 };
+	/* device id						|		BKD ID			| PID | Mode |	MID	     |			DID		     | */
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01, 0x00, 0x00, 0x00, 0x10, HKDSTEST_PRF_MODE, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	uint8_t fleet[19U][HKDS_DID_SIZE] = { 0 };
+	uint8_t cptp[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t decp[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t edkp[HKDS_CACHX8_DEPTH][HKDS_EDK_SIZE] = { 0 };
+	uint8_t ksnp[HKDS_CACHX8_DEPTH][HKDS_KSN_SIZE] = { 0 };
+	uint8_t msgp[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t tokdp[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE] = { 0 };
+	uint8_t tokep[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE + HKDS_TAG_SIZE] = { 0 };
+	hkds_client_state csp[HKDS_CACHX8_DEPTH];
+	hkds_edk_table et;
+	hkds_edk_table xt;
+	hkds_master_key mdk;
+	hkds_server_state ss;
+	hkds_server_x8_state ssp;
+	const uint8_t* tedk;
+	size_t i;
+	bool res;
+
+	res = true;
+	hkds_server_generate_mdk(&utils_seed_generate, &mdk, kid);
+
+	/* a fleet of nineteen devices, the last is left out of the bulk load */
+	for (i = 0; i < 19U; ++i)
+	{
+		utils_memory_copy(fleet[i], did, HKDS_DID_SIZE);
+		fleet[i][HKDS_DID_SIZE - 2U] = (uint8_t)i;
+	}
+
+	if (hkds_edk_table_initialize(&et, kid, 32U) == false || hkds_edk_table_initialize(&xt, xid, 32U) == false)
+	{
+		hkdstest_print_line("hkds_edk_table_test: table initialization failure! -HET1");
+		res = false;
+	}
+
+	if (res == true && (hkds_server_load_edk_table(&et, &mdk, (const uint8_t (*)[HKDS_DID_SIZE])fleet, 18U) == false ||
+		et.count != 18U || hkds_server_load_edk_table(&xt, &mdk, (const uint8_t (*)[HKDS_DID_SIZE])fleet, 18U) == true))
+	{
+		hkdstest_print_line("hkds_edk_table_test: bulk load failure! -HET2");
+		res = false;
+	}
+
+	/* the bulk loaded keys must match the scalar derivation */
+	for (i = 0; i < 18U && res == true; ++i)
+	{
+		hkds_server_generate_edk(mdk.bdk, fleet[i], edkp[0U]);
+		tedk = hkds_edk_table_find(&et, fleet[i]);
+
+		if (tedk == NULL || utils_memory_are_equal(tedk, edkp[0U], HKDS_EDK_SIZE) == false)
+		{
+			hkdstest_print_line("hkds_edk_table_test: table key does not match expected answer! -HET3");
+			res = false;
+		}
+	}
+
+	if (res == true)
+	{
+		/* an unknown device is derived on demand and added to the table, a foreign key set's table is ignored */
+		hkds_server_generate_edk(mdk.bdk, fleet[18U], edkp[0U]);
+		hkds_client_initialize_state(&csp[0U], edkp[0U], fleet[18U]);
+		hkds_server_initialize_state(&ss, &mdk, csp[0U].ksn);
+		hkds_server_set_edk_table(&ss, &xt);
+		hkds_server_encrypt_token(&ss, tokep[0U]);
+		hkds_server_set_edk_table(&ss, &et);
+
+		if (hkds_client_decrypt_token(&csp[0U], tokep[0U], tokdp[0U]) == false)
+		{
+			hkdstest_print_line("hkds_edk_table_test: token authentication failure! -HET4");
+			res = false;
+		}
+
+		hkds_client_generate_cache(&csp[0U], tokdp[0U]);
+		utils_seed_generate(msgp[0U], HKDS_MESSAGE_SIZE);
+		hkds_client_encrypt_message(&csp[0U], msgp[0U], cptp[0U]);
+		hkds_server_decrypt_message(&ss, cptp[0U], decp[0U]);
+
+		if (utils_memory_are_equal(msgp[0U], decp[0U], HKDS_MESSAGE_SIZE) == false || et.count != 19U || xt.count != 0U)
+		{
+			hkdstest_print_line("hkds_edk_table_test: sequential message decryption failure! -HET5");
+			res = false;
+		}
+	}
+
+	if (res == true)
+	{
+		/* the x8 token and decryption paths, with one lane missing from the table */
+		hkds_edk_table_clear(&et);
+		hkds_server_load_edk_table(&et, &mdk, (const uint8_t (*)[HKDS_DID_SIZE])fleet, HKDS_CACHX8_DEPTH - 1U);
+
+		for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			hkds_server_generate_edk(mdk.bdk, fleet[i], edkp[i]);
+			hkds_client_initialize_state(&csp[i], edkp[i], fleet[i]);
+			utils_memory_copy(ksnp[i], csp[i].ksn, HKDS_KSN_SIZE);
+			utils_seed_generate(msgp[i], HKDS_MESSAGE_SIZE);
+		}
+
+		hkds_server_initialize_state_x8(&ssp, &mdk, ksnp);
+		hkds_server_set_edk_table_x8(&ssp, &et);
+		hkds_server_encrypt_token_x8(&ssp, tokep);
+
+		for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			if (hkds_client_decrypt_token(&csp[i], tokep[i], tokdp[i]) == false)
+			{
+				hkdstest_print_line("hkds_edk_table_test: parallel token authentication failure! -HET6");
+				res = false;
+				break;
+			}
+
+			hkds_client_generate_cache(&csp[i], tokdp[i]);
+			hkds_client_encrypt_message(&csp[i], msgp[i], cptp[i]);
+		}
+
+		hkds_server_decrypt_message_x8(&ssp, cptp, decp);
+
+		for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			if (utils_memory_are_equal(msgp[i], decp[i], HKDS_MESSAGE_SIZE) == false || et.count != HKDS_CACHX8_DEPTH)
+			{
+				hkdstest_print_line("hkds_edk_table_test: parallel message decryption failure! -HET7");
+				res = false;
+				break;
+			}
+		}
+	}
+
+	hkds_edk_table_destroy(&et);
+	hkds_edk_table_destroy(&xt);
+
+	return res;
+}
+
+bool hkdstest_token_memo_test()
+{
+	const uint8_t kid[HKDS_KID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
+	/* device id						|		BKD ID			| PID | Mode |	MID	     |			DID		     | */
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01, 0x00, 0x00, 0x00, 0x10, HKDSTEST_PRF_MODE, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	uint8_t cptp[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t decp[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t didp[HKDS_CACHX8_DEPTH][HKDS_DID_SIZE] = { 0 };
+	uint8_t edkp[HKDS_CACHX8_DEPTH][HKDS_EDK_SIZE] = { 0 };
+	uint8_t ksnp[HKDS_CACHX8_DEPTH][HKDS_KSN_SIZE] = { 0 };
+	uint8_t msgp[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t tokdp[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE] = { 0 };
+	uint8_t tokep[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE + HKDS_TAG_SIZE] = { 0 };
+	uint8_t tok[HKDS_STK_SIZE] = { 0 };
+	hkds_client_state csp[HKDS_CACHX8_DEPTH];
+	hkds_master_key mdk;
+	hkds_server_state ss;
+	hkds_server_x8_state ssp;
+	hkds_token_memo tm;
+	uint64_t start;
+	size_t i;
+	bool res;
+
+	res = true;
+	hkds_server_generate_mdk(&utils_seed_generate, &mdk, kid);
+
+	for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		utils_memory_copy(didp[i], did, HKDS_DID_SIZE);
+		didp[i][HKDS_DID_SIZE - 2U] = (uint8_t)i;
+		hkds_server_generate_edk(mdk.bdk, didp[i], edkp[i]);
+		hkds_client_initialize_state(&csp[i], edkp[i], didp[i]);
+		utils_seed_generate(msgp[i], HKDS_MESSAGE_SIZE);
+	}
+
+	if (hkds_token_memo_initialize(&tm, kid, HKDS_CACHX8_DEPTH, 0U) == false)
+	{
+		hkdstest_print_line("hkds_token_memo_test: memo initialization failure! -HTM1");
+		res = false;
+	}
+
+	if (res == true)
+	{
+		/* the scalar token issued to the first client is used by the message decryption */
+		hkds_server_initialize_state(&ss, &mdk, csp[0U].ksn);
+		hkds_server_set_token_memo(&ss, &tm);
+		hkds_server_encrypt_token(&ss, tokep[0U]);
+
+		if (tm.count != 1U || hkds_client_decrypt_token(&csp[0U], tokep[0U], tokdp[0U]) == false)
+		{
+			hkdstest_print_line("hkds_token_memo_test: token issuance failure! -HTM2");
+			res = false;
+		}
+
+		hkds_client_generate_cache(&csp[0U], tokdp[0U]);
+		hkds_client_encrypt_message(&csp[0U], msgp[0U], cptp[0U]);
+		hkds_server_decrypt_message(&ss, cptp[0U], decp[0U]);
+
+		if (utils_memory_are_equal(msgp[0U], decp[0U], HKDS_MESSAGE_SIZE) == false || tm.hits != 1U)
+		{
+			hkdstest_print_line("hkds_token_memo_test: sequential message decryption failure! -HTM3");
+			res = false;
+		}
+	}
+
+	if (res == true)
+	{
+		/* the x8 tokens refresh the memo; the full ring replaces the oldest entry */
+		hkds_client_initialize_state(&csp[0U], edkp[0U], didp[0U]);
+
+		for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			utils_memory_copy(ksnp[i], csp[i].ksn, HKDS_KSN_SIZE);
+		}
+
+		hkds_server_initialize_state_x8(&ssp, &mdk, ksnp);
+		hkds_server_set_token_memo_x8(&ssp, &tm);
+		hkds_server_encrypt_token_x8(&ssp, tokep);
+
+		for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			if (hkds_client_decrypt_token(&csp[i], tokep[i], tokdp[i]) == false)
+			{
+				hkdstest_print_line("hkds_token_memo_test: parallel token authentication failure! -HTM4");
+				res = false;
+				break;
+			}
+
+			hkds_client_generate_cache(&csp[i], tokdp[i]);
+			hkds_client_encrypt_message(&csp[i], msgp[i], cptp[i]);
+		}
+
+		hkds_server_decrypt_message_x8(&ssp, cptp, decp);
+
+		for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			if (utils_memory_are_equal(msgp[i], decp[i], HKDS_MESSAGE_SIZE) == false || tm.count != HKDS_CACHX8_DEPTH || tm.hits != 1U + HKDS_CACHX8_DEPTH)
+			{
+				hkdstest_print_line("hkds_token_memo_test: parallel message decryption failure! -HTM5");
+				res = false;
+				break;
+			}
+		}
+
+		hkds_token_memo_insert(&tm, didp[0U], 1U, tokdp[0U]);
+
+		if (tm.count != HKDS_CACHX8_DEPTH || hkds_token_memo_find(&tm, didp[0U], 0U, tok) == true || hkds_token_memo_find(&tm, didp[1U], 0U, tok) == false)
+		{
+			hkdstest_print_line("hkds_token_memo_test: ring replacement failure! -HTM6");
+			res = false;
+		}
+	}
+
+	hkds_token_memo_destroy(&tm);
+
+	if (res == true)
+	{
+		/* a one millisecond lifetime; expired tokens are erased by lookup and purge */
+		hkds_token_memo_initialize(&tm, kid, HKDS_CACHX8_DEPTH, 1U);
+		hkds_token_memo_insert(&tm, didp[0U], 0U, tokdp[0U]);
+		hkds_token_memo_insert(&tm, didp[1U], 0U, tokdp[1U]);
+		start = utils_time_monotonic();
+
+		while (utils_time_monotonic() - start < 2000U)
+		{
+		}
+
+		if (hkds_token_memo_find(&tm, didp[0U], 0U, tok) == true || tm.count != 1U || hkds_token_memo_purge(&tm) != 1U || tm.count != 0U)
+		{
+			hkdstest_print_line("hkds_token_memo_test: token expiry failure! -HTM7");
+			res = false;
+		}
+
+		hkds_token_memo_destroy(&tm);
+	}
+
+	return res;
+}
+
+bool hkdstest_batch_decrypt_test()
+{
+	const uint8_t kid[HKDS_KID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
+	/* device id						|		BKD ID			| PID | Mode |	MID	     |			DID		     | */
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01, 0x00, 0x00, 0x00, 0x11, HKDSTEST_PRF_MODE, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	uint8_t cpt[19U][HKDS_MESSAGE_SIZE + HKDS_TAG_SIZE] = { 0 };
+	uint8_t dec[19U][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t ksn[19U][HKDS_KSN_SIZE] = { 0 };
+	uint8_t msg[19U][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t tdid[HKDS_DID_SIZE] = { 0 };
+	uint8_t edk[HKDS_EDK_SIZE] = { 0 };
+	uint8_t tokd[HKDS_STK_SIZE] = { 0 };
+	uint8_t toke[HKDS_STK_SIZE + HKDS_TAG_SIZE] = { 0 };
+	const uint8_t* pksn[19U];
+	const uint8_t* pcpt[19U];
+	const uint8_t* pdata[19U];
+	uint8_t* pdec[19U];
+	bool valid[19U] = { false };
+	hkds_client_state cs;
+	hkds_master_key mdk;
+	hkds_server_state ss;
+	hkds_server_x8_state tss = { 0 };
+	size_t i;
+	bool res;
+
+	res = true;
+	hkds_server_generate_mdk(&utils_seed_generate, &mdk, kid);
+	tss.mdk = &mdk;
+
+	/* nineteen requests, two full groups and a partial group, from five devices */
+	for (i = 0; i < 19U; ++i)
+	{
+		if (i % 4U == 0U)
+		{
+			utils_memory_copy(tdid, did, HKDS_DID_SIZE);
+			tdid[HKDS_DID_SIZE - 2U] = (uint8_t)i;
+			hkds_server_generate_edk(mdk.bdk, tdid, edk);
+			hkds_client_initialize_state(&cs, edk, tdid);
+			hkds_server_initialize_state(&ss, &mdk, cs.ksn);
+			hkds_server_encrypt_token(&ss, toke);
+			hkds_client_decrypt_token(&cs, toke, tokd);
+			hkds_client_generate_cache(&cs, tokd);
+		}
+
+		utils_seed_generate(msg[i], HKDS_MESSAGE_SIZE);
+		utils_memory_copy(ksn[i], cs.ksn, HKDS_KSN_SIZE);
+		hkds_client_encrypt_authenticate_message(&cs, msg[i], kid, sizeof(kid), cpt[i]);
+		pksn[i] = ksn[i];
+		pcpt[i] = cpt[i];
+		pdata[i] = kid;
+		pdec[i] = dec[i];
+	}
+
+	/* tamper with one tag */
+	cpt[17U][HKDS_MESSAGE_SIZE] ^= 0x01U;
+
+	hkds_server_decrypt_verify_batch(&tss, 19U, pksn, pcpt, pdata, sizeof(kid), pdec, valid);
+
+	for (i = 0; i < 19U; ++i)
+	{
+		if (valid[i] != (i != 17U) || (i != 17U && utils_memory_are_equal(msg[i], dec[i], HKDS_MESSAGE_SIZE) == false))
+		{
+			hkdstest_print_line("hkds_batch_decrypt_test: batch verification failure! -HBD1");
+			res = false;
+			break;
+		}
+	}
+
+	/* the unauthenticated batch decrypts the same cipher-text with the first key of each pair */
+	utils_memory_clear(dec, sizeof(dec));
+	hkds_server_decrypt_batch(&tss, 19U, pksn, pcpt, pdec);
+
+	for (i = 0; i < 19U; ++i)
+	{
+		if (utils_memory_are_equal(msg[i], dec[i], HKDS_MESSAGE_SIZE) == false)
+		{
+			hkdstest_print_line("hkds_batch_decrypt_test: batch decryption failure! -HBD2");
+			res = false;
+			break;
+		}
+	}
+
+	/* a single request is a partial group */
+	utils_memory_clear(dec, sizeof(dec));
+	hkds_server_decrypt_batch(&tss, 1U, pksn + 5U, pcpt + 5U, pdec);
+
+	if (utils_memory_are_equal(msg[5U], dec[0U], HKDS_MESSAGE_SIZE) == false)
+	{
+		hkdstest_print_line("hkds_batch_decrypt_test: single request decryption failure! -HBD3");
+		res = false;
+	}
+
+	/* one device across epoch boundaries, in a batch larger than the stack plan, submitted in reverse order, so its runs interleave */
+	if (res == true)
+	{
+		uint8_t ecpt[HKDS_CACHX64_SIZE + 3U][HKDS_MESSAGE_SIZE] = { 0 };
+		uint8_t edec[HKDS_CACHX64_SIZE + 3U][HKDS_MESSAGE_SIZE] = { 0 };
+		uint8_t eksn[HKDS_CACHX64_SIZE + 3U][HKDS_KSN_SIZE] = { 0 };
+		uint8_t emsg[HKDS_CACHX64_SIZE + 3U][HKDS_MESSAGE_SIZE] = { 0 };
+		const uint8_t* peksn[HKDS_CACHX64_SIZE + 3U];
+		const uint8_t* pecpt[HKDS_CACHX64_SIZE + 3U];
+		uint8_t* pedec[HKDS_CACHX64_SIZE + 3U];
+		size_t r;
+
+		hkds_server_generate_edk(mdk.bdk, did, edk);
+		hkds_client_initialize_state(&cs, edk, did);
+
+		for (i = 0; i < HKDS_CACHX64_SIZE + 3U; ++i)
+		{
+			if (cs.cache_empty == true)
+			{
+				hkds_server_initialize_state(&ss, &mdk, cs.ksn);
+				hkds_server_encrypt_token(&ss, toke);
+				hkds_client_decrypt_token(&cs, toke, tokd);
+				hkds_client_generate_cache(&cs, tokd);
+			}
+
+			r = HKDS_CACHX64_SIZE + 2U - i;
+			utils_seed_generate(emsg[r], HKDS_MESSAGE_SIZE);
+			utils_memory_copy(eksn[r], cs.ksn, HKDS_KSN_SIZE);
+			hkds_client_encrypt_message(&cs, emsg[r], ecpt[r]);
+			peksn[r] = eksn[r];
+			pecpt[r] = ecpt[r];
+			pedec[r] = edec[r];
+		}
+
+		if (hkds_server_decrypt_batch(&tss, HKDS_CACHX64_SIZE + 3U, peksn, pecpt, pedec) == false)
+		{
+			hkdstest_print_line("hkds_batch_decrypt_test: multiple epoch batch failure! -HBD4");
+			res = false;
+		}
+
+		for (i = 0; i < HKDS_CACHX64_SIZE + 3U; ++i)
+		{
+			if (utils_memory_are_equal(emsg[i], edec[i], HKDS_MESSAGE_SIZE) == false)
+			{
+				hkdstest_print_line("hkds_batch_decrypt_test: multiple epoch decryption failure! -HBD5");
+				res = false;
+				break;
+			}
+		}
+	}
+
+	return res;
+}
+
+bool hkdstest_squeeze_depth_test()
+{
+	const uint8_t kid[HKDS_KID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
+	/* device id						|		BKD ID			| PID | Mode |	MID	     |			DID		     | */
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01, 0x00, 0x00, 0x00, 0x12, HKDSTEST_PRF_MODE, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	uint8_t cpt[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t cpta[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE + HKDS_TAG_SIZE] = { 0 };
+	uint8_t dec[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t deca[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t ksn[HKDS_CACHX8_DEPTH][HKDS_KSN_SIZE] = { 0 };
+	uint8_t ksna[HKDS_CACHX8_DEPTH][HKDS_KSN_SIZE] = { 0 };
+	uint8_t msg[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t tdid[HKDS_DID_SIZE] = { 0 };
+	uint8_t edk[HKDS_EDK_SIZE] = { 0 };
+	uint8_t tokd[HKDS_STK_SIZE] = { 0 };
+	uint8_t toke[HKDS_STK_SIZE + HKDS_TAG_SIZE] = { 0 };
+	uint8_t tmp[HKDS_MESSAGE_SIZE] = { 0 };
+	const uint8_t* pksn[HKDS_CACHX8_DEPTH];
+	const uint8_t* pksna[HKDS_CACHX8_DEPTH];
+	const uint8_t* pcpt[HKDS_CACHX8_DEPTH];
+	const uint8_t* pcpta[HKDS_CACHX8_DEPTH];
+	const uint8_t* pdata[HKDS_CACHX8_DEPTH];
+	uint8_t* pdec[HKDS_CACHX8_DEPTH];
+	uint8_t* pdeca[HKDS_CACHX8_DEPTH];
+	bool valid[HKDS_CACHX8_DEPTH] = { false };
+	hkds_client_state cs;
+	hkds_master_key mdk;
+	hkds_server_state ss;
+	hkds_server_x8_state tss = { 0 };
+	size_t depth;
+	size_t i;
+	size_t j;
+	bool res;
+
+	res = true;
+	hkds_server_generate_mdk(&utils_seed_generate, &mdk, kid);
+	tss.mdk = &mdk;
+
+	/* spread the lanes from the first key to the last key of the epoch key-stream */
+	for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		depth = (i * (HKDS_CACHE_SIZE - 3U)) / (HKDS_CACHX8_DEPTH - 1U);
+		utils_memory_copy(tdid, did, HKDS_DID_SIZE);
+		tdid[HKDS_DID_SIZE - 2U] = (uint8_t)i;
+		hkds_server_generate_edk(mdk.bdk, tdid, edk);
+		hkds_client_initialize_state(&cs, edk, tdid);
+		hkds_server_initialize_state(&ss, &mdk, cs.ksn);
+		hkds_server_encrypt_token(&ss, toke);
+		hkds_client_decrypt_token(&cs, toke, tokd);
+		hkds_client_generate_cache(&cs, tokd);
+
+		for (j = 0; j < depth; ++j)
+		{
+			hkds_client_encrypt_message(&cs, msg[i], tmp);
+		}
+
+		utils_seed_generate(msg[i], HKDS_MESSAGE_SIZE);
+		utils_memory_copy(ksn[i], cs.ksn, HKDS_KSN_SIZE);
+		hkds_client_encrypt_message(&cs, msg[i], cpt[i]);
+		utils_memory_copy(ksna[i], cs.ksn, HKDS_KSN_SIZE);
+		hkds_client_encrypt_authenticate_message(&cs, msg[i], kid, sizeof(kid), cpta[i]);
+
+		pksn[i] = ksn[i];
+		pksna[i] = ksna[i];
+		pcpt[i] = cpt[i];
+		pcpta[i] = cpta[i];
+		pdata[i] = kid;
+		pdec[i] = dec[i];
+		pdeca[i] = deca[i];
+	}
+
+	hkds_server_decrypt_batch(&tss, HKDS_CACHX8_DEPTH, pksn, pcpt, pdec);
+
+	for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		if (utils_memory_are_equal(msg[i], dec[i], HKDS_MESSAGE_SIZE) == false)
+		{
+			hkdstest_print_line("hkds_squeeze_depth_test: mixed depth decryption failure! -HSD1");
+			res = false;
+			break;
+		}
+	}
+
+	hkds_server_decrypt_verify_batch(&tss, HKDS_CACHX8_DEPTH, pksna, pcpta, pdata, sizeof(kid), pdeca, valid);
+
+	for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		if (valid[i] == false || utils_memory_are_equal(msg[i], deca[i], HKDS_MESSAGE_SIZE) == false)
+		{
+			hkdstest_print_line("hkds_squeeze_depth_test: mixed depth verification failure! -HSD2");
+			res = false;
+			break;
+		}
+	}
+
+	return res;
+}
+
+static void hkdstest_thread_pool_mark(void* context, size_t index)
+{
+	uint8_t* marks = (uint8_t*)context;
+
+	++marks[index];
+}
+
+bool hkdstest_thread_pool_test()
+{
+	const uint8_t kid[HKDS_KID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
+	/* device id						|		BKD ID			| PID | Mode |	MID	     |			DID		     | */
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01, 0x00, 0x00, 0x00, 0x13, HKDSTEST_PRF_MODE, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	uint8_t cpt[HKDS_PARALLEL_DEPTH][HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t dec[HKDS_PARALLEL_DEPTH][HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t decb[HKDS_PARALLEL_DEPTH][HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t ksn[HKDS_PARALLEL_DEPTH][HKDS_CACHX8_DEPTH][HKDS_KSN_SIZE] = { 0 };
+	uint8_t msg[HKDS_PARALLEL_DEPTH][HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t marks[1000U] = { 0 };
+	uint8_t edk[HKDS_EDK_SIZE] = { 0 };
+	uint8_t tokd[HKDS_STK_SIZE] = { 0 };
+	uint8_t toke[HKDS_STK_SIZE + HKDS_TAG_SIZE] = { 0 };
+	const uint8_t* pksn[HKDS_PARALLEL_DEPTH * HKDS_CACHX8_DEPTH];
+	const uint8_t* pcpt[HKDS_PARALLEL_DEPTH * HKDS_CACHX8_DEPTH];
+	uint8_t* pdec[HKDS_PARALLEL_DEPTH * HKDS_CACHX8_DEPTH];
+	hkds_client_state cs[HKDS_CACHX8_DEPTH];
+	hkds_master_key mdk[HKDS_PARALLEL_DEPTH];
+	hkds_server_state ss;
+	hkds_server_x8_state ssp[HKDS_PARALLEL_DEPTH];
+	hkds_server_x8_state tss = { 0 };
+	hkds_edk_table et;
+	hkds_token_memo tm;
+	hkds_thread_pool pool;
+	size_t i;
+	size_t j;
+	bool res;
+
+	res = hkds_pool_initialize(&pool, 4U);
+
+	if (res == false)
+	{
+		hkdstest_print_line("hkds_thread_pool_test: pool initialization failure! -HTP1");
+	}
+	else
+	{
+		/* every index of a parallel loop is visited exactly once */
+		hkds_pool_parallel_for(&pool, sizeof(marks), &hkdstest_thread_pool_mark, marks);
+
+		for (i = 0; i < sizeof(marks); ++i)
+		{
+			if (marks[i] != 1U)
+			{
+				hkdstest_print_line("hkds_thread_pool_test: parallel loop failure! -HTP2");
+				res = false;
+				break;
+			}
+		}
+
+		/* eight devices each encrypt eight messages; set i of the x64 request holds the i-th message of every device */
+		hkds_server_generate_mdk(&utils_seed_generate, &mdk[0U], kid);
+
+		for (j = 0; j < HKDS_CACHX8_DEPTH; ++j)
+		{
+			uint8_t tdid[HKDS_DID_SIZE];
+
+			utils_memory_copy(tdid, did, HKDS_DID_SIZE);
+			tdid[HKDS_DID_SIZE - 2U] = (uint8_t)j;
+			hkds_server_generate_edk(mdk[0U].bdk, tdid, edk);
+			hkds_client_initialize_state(&cs[j], edk, tdid);
+			hkds_server_initialize_state(&ss, &mdk[0U], cs[j].ksn);
+			hkds_server_encrypt_token(&ss, toke);
+			hkds_client_decrypt_token(&cs[j], toke, tokd);
+			hkds_client_generate_cache(&cs[j], tokd);
+		}
+
+		for (i = 0; i < HKDS_PARALLEL_DEPTH; ++i)
+		{
+			mdk[i] = mdk[0U];
+
+			for (j = 0; j < HKDS_CACHX8_DEPTH; ++j)
+			{
+				utils_seed_generate(msg[i][j], HKDS_MESSAGE_SIZE);
+				utils_memory_copy(ksn[i][j], cs[j].ksn, HKDS_KSN_SIZE);
+				hkds_client_encrypt_message(&cs[j], msg[i][j], cpt[i][j]);
+				pksn[(i * HKDS_CACHX8_DEPTH) + j] = ksn[i][j];
+				pcpt[(i * HKDS_CACHX8_DEPTH) + j] = cpt[i][j];
+				pdec[(i * HKDS_CACHX8_DEPTH) + j] = decb[i][j];
+			}
+		}
+
+		hkds_server_initialize_state_x64(ssp, mdk, (const uint8_t (*)[HKDS_CACHX8_DEPTH][HKDS_KSN_SIZE])ksn);
+		hkds_server_set_thread_pool_x8(&ssp[0U], &pool);
+		hkds_server_decrypt_message_x64(ssp, (const uint8_t (*)[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE])cpt, dec);
+
+		if (utils_memory_are_equal((const uint8_t*)msg, (const uint8_t*)dec, sizeof(msg)) == false)
+		{
+			hkdstest_print_line("hkds_thread_pool_test: x64 pool decryption failure! -HTP3");
+			res = false;
+		}
+
+		/* the same requests as a batch, with the pool attached to the template state */
+		tss.mdk = &mdk[0U];
+		hkds_server_set_thread_pool_x8(&tss, &pool);
+
+		if (hkds_server_decrypt_batch(&tss, HKDS_PARALLEL_DEPTH * HKDS_CACHX8_DEPTH, pksn, pcpt, pdec) == false ||
+			utils_memory_are_equal((const uint8_t*)msg, (const uint8_t*)decb, sizeof(msg)) == false)
+		{
+			hkdstest_print_line("hkds_thread_pool_test: batch pool decryption failure! -HTP4");
+			res = false;
+		}
+
+		/* with the derivation caches attached, the lookups and inserts stay on the calling thread while the lanes run on the pool */
+		if (hkds_edk_table_initialize(&et, kid, HKDS_CACHX8_DEPTH) == true && hkds_token_memo_initialize(&tm, kid, HKDS_CACHX8_DEPTH, 0U) == true)
+		{
+			hkds_server_set_edk_table_x8(&tss, &et);
+			hkds_server_set_token_memo_x8(&tss, &tm);
+
+			for (i = 0; i < HKDS_PARALLEL_DEPTH; ++i)
+			{
+				hkds_server_set_edk_table_x8(&ssp[i], &et);
+				hkds_server_set_token_memo_x8(&ssp[i], &tm);
+			}
+
+			/* a cold pass fills the caches, and a warm pass is served from them */
+			for (j = 0; j < 2U; ++j)
+			{
+				utils_memory_clear((uint8_t*)dec, sizeof(dec));
+				utils_memory_clear((uint8_t*)decb, sizeof(decb));
+				hkds_server_decrypt_message_x64(ssp, (const uint8_t (*)[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE])cpt, dec);
+
+				if (hkds_server_decrypt_batch(&tss, HKDS_PARALLEL_DEPTH * HKDS_CACHX8_DEPTH, pksn, pcpt, pdec) == false ||
+					utils_memory_are_equal((const uint8_t*)msg, (const uint8_t*)decb, sizeof(msg)) == false ||
+					utils_memory_are_equal((const uint8_t*)msg, (const uint8_t*)dec, sizeof(msg)) == false ||
+					et.count != HKDS_CACHX8_DEPTH || tm.count != HKDS_CACHX8_DEPTH)
+				{
+					hkdstest_print_line("hkds_thread_pool_test: cached pool decryption failure! -HTP5");
+					res = false;
+					break;
+				}
+			}
+
+			hkds_token_memo_destroy(&tm);
+			hkds_edk_table_destroy(&et);
+		}
+		else
+		{
+			hkdstest_print_line("hkds_thread_pool_test: cache initialization failure! -HTP5");
+			res = false;
+		}
+
+		hkds_pool_destroy(&pool);
+	}
+
+	return res;
+}
+
+bool hkdstest_async_engine_test()
+{
+	const uint8_t kid[HKDS_KID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
+	/* device id						|		BKD ID			| PID | Mode |	MID	     |			DID		     | */
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01, 0x00, 0x00, 0x00, 0x14, HKDSTEST_PRF_MODE, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	uint8_t exp[23U][HKDS_ASYNC_OUTPUT_SIZE] = { 0 };
+	uint8_t tdid[HKDS_DID_SIZE] = { 0 };
+	uint8_t edk[HKDS_EDK_SIZE] = { 0 };
+	uint8_t tokd[HKDS_STK_SIZE] = { 0 };
+	uint8_t toke[HKDS_STK_SIZE + HKDS_TAG_SIZE] = { 0 };
+	bool seen[23U] = { false };
+	hkds_async_request req[23U];
+	hkds_async_completion cmp[HKDS_CACHX8_DEPTH];
+	hkds_async_engine engine;
+	hkds_client_state cs;
+	hkds_master_key mdk;
+	hkds_server_state ss;
+	uint64_t start;
+	size_t count;
+	size_t done;
+	size_t i;
+	size_t j;
+	bool res;
+
+	hkds_server_generate_mdk(&utils_seed_generate, &mdk, kid);
+	utils_memory_clear(req, sizeof(req));
+	res = hkds_async_initialize(&engine, &mdk, 32U, 2U, sizeof(kid));
+
+	if (res == false)
+	{
+		hkdstest_print_line("hkds_async_engine_test: engine initialization failure! -HAE1");
+	}
+	else
+	{
+		/* twenty-three mixed requests from six devices; the operations interleave, so each ring fills at its own pace */
+		for (i = 0; i < 23U; ++i)
+		{
+			if (i % 4U == 0U)
+			{
+				utils_memory_copy(tdid, did, HKDS_DID_SIZE);
+				tdid[HKDS_DID_SIZE - 2U] = (uint8_t)i;
+				hkds_server_generate_edk(mdk.bdk, tdid, edk);
+				hkds_client_initialize_state(&cs, edk, tdid);
+				hkds_server_initialize_state(&ss, &mdk, cs.ksn);
+				hkds_server_encrypt_token(&ss, toke);
+				hkds_client_decrypt_token(&cs, toke, tokd);
+				hkds_client_generate_cache(&cs, tokd);
+			}
+
+			req[i].cookie = 0x1000U + i;
+			req[i].operation = (hkds_async_operation)(i % 3U);
+			utils_memory_copy(req[i].ksn, cs.ksn, HKDS_KSN_SIZE);
+
+			if (req[i].operation == hkds_async_decrypt)
+			{
+				utils_seed_generate(exp[i], HKDS_MESSAGE_SIZE);
+				hkds_client_encrypt_message(&cs, exp[i], req[i].message);
+			}
+			else if (req[i].operation == hkds_async_decrypt_verify)
+			{
+				utils_seed_generate(exp[i], HKDS_MESSAGE_SIZE);
+				utils_memory_copy(req[i].data, kid, sizeof(kid));
+				hkds_client_encrypt_authenticate_message(&cs, exp[i], kid, sizeof(kid), req[i].message);
+			}
+			else
+			{
+				hkds_server_initialize_state(&ss, &mdk, cs.ksn);
+				hkds_server_encrypt_token(&ss, exp[i]);
+			}
+		}
+
+		/* tamper with one tag */
+		req[19U].message[HKDS_MESSAGE_SIZE] ^= 0x01U;
+
+		for (i = 0; i < 23U; ++i)
+		{
+			if (hkds_async_submit(&engine, &req[i]) == false)
+			{
+				hkdstest_print_line("hkds_async_engine_test: request submission failure! -HAE2");
+				res = false;
+				break;
+			}
+		}
+
+		/* dispatch the partial groups, then collect the completions within a time limit */
+		hkds_async_flush(&engine);
+		start = utils_time_monotonic();
+		done = 0U;
+
+		while (res == true && done < 23U && utils_time_monotonic() - start < 10000000U)
+		{
+			count = hkds_async_complete(&engine, cmp, HKDS_CACHX8_DEPTH);
+
+			for (j = 0; j < count; ++j)
+			{
+				i = (size_t)(cmp[j].cookie - 0x1000U);
+
+				if (i >= 23U || seen[i] == true || cmp[j].operation != req[i].operation ||
+					cmp[j].valid != (i != 19U) ||
+					(i != 19U && utils_memory_are_equal(cmp[j].output, exp[i], cmp[j].outlen) == false) ||
+					(i != 19U && cmp[j].outlen != ((req[i].operation == hkds_async_encrypt_token) ? HKDS_STK_SIZE + HKDS_TAG_SIZE : HKDS_MESSAGE_SIZE)))
+				{
+					hkdstest_print_line("hkds_async_engine_test: completion mismatch! -HAE3");
+					res = false;
+					break;
+				}
+
+				seen[i] = true;
+				++done;
+			}
+		}
+
+		if (res == true && (done != 23U || hkds_async_inflight(&engine) != 0U))
+		{
+			hkdstest_print_line("hkds_async_engine_test: missing completions! -HAE4");
+			res = false;
+		}
+
+		hkds_async_destroy(&engine);
+	}
+
+	return res;
+}
+
+bool hkdstest_simd_dispatch_test()
+{
+	uint8_t cst[HKDS_CACHX8_DEPTH][16U] = { 0 };
+	uint8_t exp[HKDS_CACHX8_DEPTH][300U] = { 0 };
+	uint8_t inp[HKDS_CACHX8_DEPTH][200U] = { 0 };
+	uint8_t key[HKDS_CACHX8_DEPTH][32U] = { 0 };
+	uint8_t out[HKDS_CACHX8_DEPTH][300U] = { 0 };
+	const uint8_t* pinp[HKDS_CACHX8_DEPTH];
+	const uint8_t* pkey[HKDS_CACHX8_DEPTH];
+	uint8_t* pout[HKDS_CACHX8_DEPTH];
+	hkds_keccak_simd_level level;
+	hkds_keccak_simd_level supported;
+	size_t i;
+	size_t j;
+	bool res;
+
+	res = true;
+	supported = hkds_keccak_simd_get_supported();
+
+	for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		utils_seed_generate(cst[i], sizeof(cst[i]));
+		utils_seed_generate(inp[i], sizeof(inp[i]));
+		utils_seed_generate(key[i], sizeof(key[i]));
+		pinp[i] = inp[i];
+		pkey[i] = key[i];
+		pout[i] = out[i];
+	}
+
+	/* every kernel set up to the widest supported one must match the sequential functions, including a partial output block */
+	for (j = 0; j <= (size_t)supported && res == true; ++j)
+	{
+		level = (hkds_keccak_simd_level)j;
+
+		if (hkds_keccak_simd_set_level(level) == false || hkds_keccak_simd_get_level() != level)
+		{
+			hkdstest_print_line("hkds_simd_dispatch_test: kernel selection failure! -HSL1");
+			res = false;
+			break;
+		}
+
+		utils_memory_clear(out, sizeof(out));
+		hkds_shake_256x8(out[0U], out[1U], out[2U], out[3U], out[4U], out[5U], out[6U], out[7U], sizeof(out[0U]),
+			inp[0U], inp[1U], inp[2U], inp[3U], inp[4U], inp[5U], inp[6U], inp[7U], sizeof(inp[0U]));
+
+		for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			hkds_shake256_compute(exp[i], sizeof(exp[i]), inp[i], sizeof(inp[i]));
+
+			if (utils_memory_are_equal(exp[i], out[i], sizeof(exp[i])) == false)
+			{
+				hkdstest_print_line("hkds_simd_dispatch_test: shake x8 output mismatch! -HSL2");
+				res = false;
+				break;
+			}
+		}
+
+		utils_memory_clear(out, sizeof(out));
+		hkds_kmac_256x8(out[0U], out[1U], out[2U], out[3U], out[4U], out[5U], out[6U], out[7U], HKDS_TAG_SIZE,
+			key[0U], key[1U], key[2U], key[3U], key[4U], key[5U], key[6U], key[7U], sizeof(key[0U]),
+			cst[0U], cst[1U], cst[2U], cst[3U], cst[4U], cst[5U], cst[6U], cst[7U], sizeof(cst[0U]),
+			inp[0U], inp[1U], inp[2U], inp[3U], inp[4U], inp[5U], inp[6U], inp[7U], sizeof(inp[0U]));
+
+		for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			hkds_kmac256_compute(exp[i], HKDS_TAG_SIZE, inp[i], sizeof(inp[i]), key[i], sizeof(key[i]), cst[i], sizeof(cst[i]));
+
+			if (utils_memory_are_equal(exp[i], out[i], HKDS_TAG_SIZE) == false)
+			{
+				hkdstest_print_line("hkds_simd_dispatch_test: kmac x8 output mismatch! -HSL3");
+				res = false;
+				break;
+			}
+		}
+
+		utils_memory_clear(out, sizeof(out));
+		hkds_shake_128x4(out[0U], out[1U], out[2U], out[3U], sizeof(out[0U]), inp[0U], inp[1U], inp[2U], inp[3U], sizeof(inp[0U]));
+
+		for (i = 0; i < HKDS_CACHX8_DEPTH / 2U; ++i)
+		{
+			hkds_shake128_compute(exp[i], sizeof(exp[i]), inp[i], sizeof(inp[i]));
+
+			if (utils_memory_are_equal(exp[i], out[i], sizeof(exp[i])) == false)
+			{
+				hkdstest_print_line("hkds_simd_dispatch_test: shake x4 output mismatch! -HSL4");
+				res = false;
+				break;
+			}
+		}
+
+		/* the chained kernel matches the three sequential stages; the outer input spans two blocks at the SHAKE-512 rate */
+		utils_memory_clear(out, sizeof(out));
+		hkds_shake_chain_x8(hkds_keccak_rate_512, pout, sizeof(out[0U]), pinp, sizeof(inp[0U]), 64U, pkey, sizeof(key[0U]), 64U);
+
+		for (i = 0; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			uint8_t tmpk[128U] = { 0 };
+
+			hkds_shake512_compute(tmpk, 64U, inp[i], sizeof(inp[i]));
+			hkds_shake512_compute(tmpk + 64U, 64U, key[i], sizeof(key[i]));
+			hkds_shake512_compute(exp[i], sizeof(exp[i]), tmpk, sizeof(tmpk));
+
+			if (utils_memory_are_equal(exp[i], out[i], sizeof(exp[i])) == false)
+			{
+				hkdstest_print_line("hkds_simd_dispatch_test: chained shake output mismatch! -HSL5");
+				res = false;
+				break;
+			}
+		}
+	}
+
+	/* a level beyond the processor or the build is refused, and the widest level is restored */
+	if (supported != hkds_keccak_simd_avx512 && hkds_keccak_simd_set_level(hkds_keccak_simd_avx512) == true)
+	{
+		hkdstest_print_line("hkds_simd_dispatch_test: unsupported kernel accepted! -HSL6");
+		res = false;
+	}
+
+	hkds_keccak_simd_set_level(supported);
+
+	return res;
+}
+
+#define HKDSTEST_QUEUE_DEPTH 64U
+#define HKDSTEST_QUEUE_TASKS 1000U
+
+typedef struct
+{
+	hkds_message_queue_state* queue;
+	uint32_t taken[HKDSTEST_QUEUE_TASKS];
+} hkdstest_queue_context;
+
+static void hkdstest_message_queue_task(void* context, size_t index)
+{
+	hkdstest_queue_context* ctx = (hkdstest_queue_context*)context;
+	uint8_t msg[HKDS_MESSAGE_SIZE] = { 0 };
+
+	/* every task pushes one item before it pops one, so a pop always has an item to wait for */
+	utils_integer_be32to8(msg, (uint32_t)index);
+
+	while (hkds_message_queue_push(ctx->queue, msg, sizeof(msg)) == false)
+	{
+	}
+
+	while (hkds_message_queue_pop(ctx->queue, msg, sizeof(msg)) == false)
+	{
+	}
+
+	ctx->taken[index] = utils_integer_be8to32(msg);
+}
+
+bool hkdstest_message_queue_test()
+{
+	uint8_t blk[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t blk64[HKDS_PARALLEL_DEPTH][HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t marks[HKDSTEST_QUEUE_TASKS] = { 0 };
+	uint8_t msg[HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t tag[HKDS_MESSAGE_QUEUE_TAG_SIZE] = { 0 };
+	hkdstest_queue_context tctx;
+	HKDS_ALIGN(HKDS_QUEUE_ALIGNMENT) uint8_t buf[HKDSTEST_QUEUE_DEPTH * (HKDS_MESSAGE_SIZE + sizeof(uint64_t))] = { 0 };
+	hkds_message_queue_state queue;
+	hkds_thread_pool pool;
+	size_t i;
+	size_t j;
+	bool res;
+
+	/* the single producer queue is built in a caller buffer */
+	res = (hkds_message_queue_buffer_size(48U, HKDS_MESSAGE_SIZE, hkds_queue_mode_spsc) == sizeof(buf) &&
+		hkds_message_queue_initialize_ex(&queue, 48U, HKDS_MESSAGE_SIZE, tag, hkds_queue_mode_spsc, buf + 1U, sizeof(buf) - 1U) == false &&
+		hkds_message_queue_initialize_ex(&queue, 48U, HKDS_MESSAGE_SIZE, tag, hkds_queue_mode_spsc, buf, sizeof(buf)));
+
+	if (res == false || queue.state.depth != HKDSTEST_QUEUE_DEPTH)
+	{
+		hkdstest_print_line("hkds_message_queue_test: queue initialization failure! -HMQ1");
+		res = false;
+	}
+	else
+	{
+		/* items leave in the order they arrive, across several laps of the ring; the later blocks straddle the wrap point */
+		for (i = 0U; i < (3U * HKDSTEST_QUEUE_DEPTH) + 5U; ++i)
+		{
+			msg[0U] = (uint8_t)i;
+
+			if (hkds_message_queue_push(&queue, msg, sizeof(msg)) == false ||
+				hkds_message_queue_pop(&queue, msg, sizeof(msg)) == false || msg[0U] != (uint8_t)i)
+			{
+				hkdstest_print_line("hkds_message_queue_test: queue ordering failure! -HMQ2");
+				res = false;
+				break;
+			}
+		}
+
+		/* a full queue rejects a push, and an empty queue rejects a pop */
+		for (i = 0U; i < HKDSTEST_QUEUE_DEPTH; ++i)
+		{
+			msg[0U] = (uint8_t)i;
+			hkds_message_queue_push(&queue, msg, sizeof(msg));
+		}
+
+		if (hkds_message_queue_full(&queue) == false || hkds_message_queue_push(&queue, msg, sizeof(msg)) == true)
+		{
+			hkdstest_print_line("hkds_message_queue_test: queue full failure! -HMQ3");
+			res = false;
+		}
+
+		/* a block is extracted in order, and a short queue yields nothing */
+		if (hkds_message_queue_extract_block_x64(&queue, blk64) != HKDS_CACHX64_SIZE ||
+			hkds_message_queue_empty(&queue) == false ||
+			hkds_message_queue_pop(&queue, msg, sizeof(msg)) == true)
+		{
+			hkdstest_print_line("hkds_message_queue_test: block extraction failure! -HMQ4");
+			res = false;
+		}
+
+		for (i = 0U; i < HKDS_PARALLEL_DEPTH; ++i)
+		{
+			for (j = 0U; j < HKDS_CACHX8_DEPTH; ++j)
+			{
+				if (blk64[i][j][0U] != (uint8_t)((i * HKDS_CACHX8_DEPTH) + j))
+				{
+					hkdstest_print_line("hkds_message_queue_test: block order failure! -HMQ5");
+					res = false;
+					i = HKDS_PARALLEL_DEPTH;
+					break;
+				}
+			}
+		}
+
+		for (i = 0U; i < HKDS_CACHX8_DEPTH - 1U; ++i)
+		{
+			msg[0U] = (uint8_t)i;
+			hkds_message_queue_push(&queue, msg, sizeof(msg));
+		}
+
+		if (hkds_message_queue_extract_block_x8(&queue, blk) != 0U || hkds_message_queue_count(&queue) != HKDS_CACHX8_DEPTH - 1U)
+		{
+			hkdstest_print_line("hkds_message_queue_test: short block failure! -HMQ6");
+			res = false;
+		}
+
+		hkds_message_queue_destroy(&queue);
+	}
+
+	if (res == true)
+	{
+		/* the multiple producer queue is allocated, and deeper than the tasks */
+		res = hkds_message_queue_initialize(&queue, HKDSTEST_QUEUE_TASKS, HKDS_MESSAGE_SIZE, tag);
+
+		if (res == true)
+		{
+			res = hkds_pool_initialize(&pool, 4U);
+
+			if (res == true)
+			{
+				/* concurrent producers and consumers; every item is taken exactly once */
+				tctx.queue = &queue;
+				hkds_pool_parallel_for(&pool, HKDSTEST_QUEUE_TASKS, &hkdstest_message_queue_task, &tctx);
+
+				for (i = 0U; i < HKDSTEST_QUEUE_TASKS; ++i)
+				{
+					if (tctx.taken[i] < HKDSTEST_QUEUE_TASKS)
+					{
+						++marks[tctx.taken[i]];
+					}
+				}
+
+				for (i = 0U; i < HKDSTEST_QUEUE_TASKS; ++i)
+				{
+					if (marks[i] != 1U)
+					{
+						hkdstest_print_line("hkds_message_queue_test: concurrent queue failure! -HMQ7");
+						res = false;
+						break;
+					}
+				}
+
+				hkds_pool_destroy(&pool);
+			}
+
+			if (hkds_message_queue_empty(&queue) == false)
+			{
+				res = false;
+			}
+
+			hkds_message_queue_destroy(&queue);
+		}
+
+		if (res == false)
+		{
+			hkdstest_print_line("hkds_message_queue_test: multiple producer queue failure! -HMQ8");
+		}
+	}
+
+	return res;
+}
+
+bool hkdstest_queue_view_test()
+{
+	const uint8_t kid[HKDS_KID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
+	/* device id						|		BKD ID			| PID | Mode |	MID	     |			DID		     | */
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01, 0x00, 0x00, 0x00, 0x13, HKDSTEST_PRF_MODE, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	uint8_t msg[HKDS_CACHX64_SIZE][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t dec[HKDS_CACHX64_SIZE][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t item[HKDS_KSN_SIZE + HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t edk[HKDS_EDK_SIZE] = { 0 };
+	uint8_t tokd[HKDS_STK_SIZE] = { 0 };
+	uint8_t toke[HKDS_STK_SIZE + HKDS_TAG_SIZE] = { 0 };
+	const uint8_t* pksn[HKDS_CACHX64_SIZE];
+	const uint8_t* pcpt[HKDS_CACHX64_SIZE];
+	uint8_t* pdec[HKDS_CACHX64_SIZE];
+	hkds_client_state cs[HKDS_CACHX8_DEPTH];
+	hkds_master_key mdk;
+	hkds_server_state ss;
+	hkds_server_x8_state tss = { 0 };
+	hkds_message_queue_state queue;
+	hkds_queue_view view;
+	uint8_t* slot;
+	size_t i;
+	bool res;
+
+	hkds_server_generate_mdk(&utils_seed_generate, &mdk, kid);
+
+	for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		uint8_t tdid[HKDS_DID_SIZE];
+
+		utils_memory_copy(tdid, did, HKDS_DID_SIZE);
+		tdid[HKDS_DID_SIZE - 2U] = (uint8_t)i;
+		hkds_server_generate_edk(mdk.bdk, tdid, edk);
+		hkds_client_initialize_state(&cs[i], edk, tdid);
+		hkds_server_initialize_state(&ss, &mdk, cs[i].ksn);
+		hkds_server_encrypt_token(&ss, toke);
+		hkds_client_decrypt_token(&cs[i], toke, tokd);
+		hkds_client_generate_cache(&cs[i], tokd);
+	}
+
+	/* each item is a client request; the key serial number followed by the ciphertext */
+	res = hkds_message_queue_initialize(&queue, HKDS_CACHX64_SIZE, sizeof(item), NULL);
+
+	if (res == false)
+	{
+		hkdstest_print_line("hkds_queue_view_test: queue initialization failure! -HQV1");
+	}
+	else
+	{
+		/* offset the ring so the views straddle the wrap point */
+		for (i = 0U; i < HKDS_CACHX8_DEPTH - 3U; ++i)
+		{
+			hkds_message_queue_push(&queue, item, sizeof(item));
+			hkds_message_queue_pop(&queue, item, sizeof(item));
+		}
+
+		/* the producer encrypts directly into the reserved slots */
+		if (hkds_message_queue_reserve(&queue, &view, HKDS_CACHX64_SIZE) == false || view.second == NULL ||
+			hkds_message_queue_reserve(&queue, &view, 1U) == true)
+		{
+			hkdstest_print_line("hkds_queue_view_test: slot reservation failure! -HQV2");
+			res = false;
+		}
+		else
+		{
+			for (i = 0U; i < HKDS_CACHX64_SIZE; ++i)
+			{
+				slot = hkds_message_queue_view_item(&view, i);
+				utils_seed_generate(msg[i], HKDS_MESSAGE_SIZE);
+				utils_memory_copy(slot, cs[i % HKDS_CACHX8_DEPTH].ksn, HKDS_KSN_SIZE);
+				hkds_client_encrypt_message(&cs[i % HKDS_CACHX8_DEPTH], msg[i], slot + HKDS_KSN_SIZE);
+				pdec[i] = dec[i];
+			}
+
+			hkds_message_queue_commit(&queue, &view);
+		}
+
+		/* the consumer decrypts the batch in place and releases the slots */
+		if (res == true && hkds_message_queue_acquire(&queue, &view, HKDS_CACHX64_SIZE) == true)
+		{
+			hkds_message_queue_view_pointers(&view, 0U, pksn);
+			hkds_message_queue_view_pointers(&view, HKDS_KSN_SIZE, pcpt);
+			tss.mdk = &mdk;
+			slot = view.first;
+
+			if (hkds_server_decrypt_batch(&tss, HKDS_CACHX64_SIZE, pksn, pcpt, pdec) == false ||
+				utils_memory_are_equal((const uint8_t*)msg, (const uint8_t*)dec, sizeof(msg)) == false)
+			{
+				hkdstest_print_line("hkds_queue_view_test: in-place batch decryption failure! -HQV3");
+				res = false;
+			}
+
+			hkds_message_queue_release(&queue, &view);
+
+			if (utils_memory_are_equal(slot, item, sizeof(item)) == false || hkds_message_queue_empty(&queue) == false)
+			{
+				hkdstest_print_line("hkds_queue_view_test: view release failure! -HQV4");
+				res = false;
+			}
+		}
+		else if (res == true)
+		{
+			hkdstest_print_line("hkds_queue_view_test: view acquisition failure! -HQV5");
+			res = false;
+		}
+
+		hkds_message_queue_destroy(&queue);
+	}
+
+	return res;
+}
+
+#define HKDSTEST_BATCHER_REQUESTS 85U
+
+typedef struct
+{
+	uint8_t ksn[HKDSTEST_BATCHER_REQUESTS][HKDS_KSN_SIZE];
+	uint8_t msg[HKDSTEST_BATCHER_REQUESTS][HKDS_MESSAGE_SIZE];
+	size_t count;
+	size_t done;
+	bool valid;
+} hkdstest_batcher_context;
+
+static void hkdstest_batcher_complete(void* context, const uint8_t* const* ksn, const uint8_t plaintext[][HKDS_MESSAGE_SIZE], size_t count)
+{
+	hkdstest_batcher_context* ctx = (hkdstest_batcher_context*)context;
+	size_t j;
+
+	/* match each completion to its request by key serial number */
+	for (size_t i = 0U; i < count; ++i)
+	{
+		for (j = 0U; j < ctx->count; ++j)
+		{
+			if (utils_memory_are_equal(ctx->ksn[j], ksn[i], HKDS_KSN_SIZE) == true)
+			{
+				break;
+			}
+		}
+
+		if (j == ctx->count || utils_memory_are_equal(ctx->msg[j], plaintext[i], HKDS_MESSAGE_SIZE) == false)
+		{
+			ctx->valid = false;
+		}
+
+		++ctx->done;
+	}
+}
+
+static void hkdstest_batcher_submit(hkds_batcher_state* batcher, hkdstest_batcher_context* ctx, hkds_client_state* cs, size_t count, uint64_t now)
+{
+	uint8_t cpt[HKDS_MESSAGE_SIZE];
+	hkds_client_state* client;
+
+	for (size_t i = 0U; i < count; ++i)
+	{
+		client = &cs[ctx->count % HKDS_CACHX8_DEPTH];
+		utils_seed_generate(ctx->msg[ctx->count], HKDS_MESSAGE_SIZE);
+		utils_memory_copy(ctx->ksn[ctx->count], client->ksn, HKDS_KSN_SIZE);
+		hkds_client_encrypt_message(client, ctx->msg[ctx->count], cpt);
+
+		if (hkds_batcher_submit(batcher, ctx->ksn[ctx->count], cpt, now) == false)
+		{
+			ctx->valid = false;
+		}
+
+		++ctx->count;
+	}
+}
+
+bool hkdstest_batcher_test()
+{
+	const uint8_t kid[HKDS_KID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
+	/* device id						|		BKD ID			| PID | Mode |	MID	     |			DID		     | */
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01, 0x00, 0x00, 0x00, 0x13, HKDSTEST_PRF_MODE, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	uint8_t edk[HKDS_EDK_SIZE] = { 0 };
+	uint8_t tokd[HKDS_STK_SIZE] = { 0 };
+	uint8_t toke[HKDS_STK_SIZE + HKDS_TAG_SIZE] = { 0 };
+	hkdstest_batcher_context tctx = { 0 };
+	hkds_client_state cs[HKDS_CACHX8_DEPTH];
+	hkds_master_key mdk;
+	hkds_server_state ss;
+	hkds_server_x8_state tss = { 0 };
+	hkds_message_queue_state queue;
+	hkds_batcher_state batcher;
+	size_t i;
+	bool res;
+
+	hkds_server_generate_mdk(&utils_seed_generate, &mdk, kid);
+
+	for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		uint8_t tdid[HKDS_DID_SIZE];
+
+		utils_memory_copy(tdid, did, HKDS_DID_SIZE);
+		tdid[HKDS_DID_SIZE - 2U] = (uint8_t)i;
+		hkds_server_generate_edk(mdk.bdk, tdid, edk);
+		hkds_client_initialize_state(&cs[i], edk, tdid);
+		hkds_server_initialize_state(&ss, &mdk, cs[i].ksn);
+		hkds_server_encrypt_token(&ss, toke);
+		hkds_client_decrypt_token(&cs[i], toke, tokd);
+		hkds_client_generate_cache(&cs[i], tokd);
+	}
+
+	tss.mdk = &mdk;
+	tctx.valid = true;
+	res = (hkds_message_queue_initialize(&queue, 2U * HKDS_CACHX64_SIZE, HKDS_BATCHER_ITEM_SIZE, NULL) == true &&
+		hkds_batcher_initialize(&batcher, &queue, &tss, &hkdstest_batcher_complete, &tctx) == true);
+
+	if (res == false)
+	{
+		hkdstest_print_line("hkds_batcher_test: scheduler initialization failure! -HBS1");
+	}
+	else
+	{
+		hkds_batcher_set_budget(&batcher, 1000U, 2U);
+
+		/* a partial group waits for the budget, then runs on the masked x8 path */
+		hkdstest_batcher_submit(&batcher, &tctx, cs, 3U, 0U);
+
+		if (hkds_batcher_poll(&batcher, 500U) != 0U || hkds_batcher_deadline(&batcher, 500U) != 500U ||
+			hkds_batcher_poll(&batcher, 1000U) != 3U || batcher.dispatches[hkds_batcher_path_partial] != 1U)
+		{
+			hkdstest_print_line("hkds_batcher_test: partial group deadline failure! -HBS2");
+			res = false;
+		}
+
+		/* a group within the scalar limit is decrypted one request at a time */
+		hkdstest_batcher_submit(&batcher, &tctx, cs, 2U, 2000U);
+
+		if (hkds_batcher_poll(&batcher, 2999U) != 0U || hkds_batcher_poll(&batcher, 3000U) != 2U ||
+			batcher.dispatches[hkds_batcher_path_scalar] != 1U)
+		{
+			hkdstest_print_line("hkds_batcher_test: scalar group failure! -HBS3");
+			res = false;
+		}
+
+		/* full groups are dispatched at once, and the remainder waits */
+		hkdstest_batcher_submit(&batcher, &tctx, cs, 70U, 4000U);
+
+		if (hkds_batcher_poll(&batcher, 4000U) != HKDS_CACHX64_SIZE || batcher.dispatches[hkds_batcher_path_x64] != 1U ||
+			hkds_batcher_deadline(&batcher, 4000U) != 1000U)
+		{
+			hkdstest_print_line("hkds_batcher_test: full group dispatch failure! -HBS4");
+			res = false;
+		}
+
+		hkdstest_batcher_submit(&batcher, &tctx, cs, 10U, 4500U);
+
+		if (hkds_batcher_deadline(&batcher, 4500U) != 0U || hkds_batcher_poll(&batcher, 4500U) != 2U * HKDS_CACHX8_DEPTH ||
+			batcher.dispatches[hkds_batcher_path_x8] != 1U || hkds_message_queue_empty(&queue) == false)
+		{
+			hkdstest_print_line("hkds_batcher_test: x8 group dispatch failure! -HBS5");
+			res = false;
+		}
+
+		if (tctx.valid == false || tctx.done != HKDSTEST_BATCHER_REQUESTS)
+		{
+			hkdstest_print_line("hkds_batcher_test: completion failure! -HBS6");
+			res = false;
+		}
+
+		hkds_message_queue_destroy(&queue);
+	}
+
+	return res;
+}
+
+bool hkdstest_packet_view_test()
+{
+	const uint8_t kid[HKDS_KID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
+	/* device id						|		BKD ID			| PID | Mode |	MID	     |			DID		     | */
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01, 0x00, 0x00, 0x00, 0x13, HKDSTEST_PRF_MODE, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	uint8_t pkt[HKDS_CLIENT_MESSAGE_REQUEST_SIZE + 8U] = { 0 };
+	uint8_t tpkt[HKDS_SERVER_TOKEN_RESPONSE_SIZE] = { 0 };
+	uint8_t cpt[HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t dec[HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t msg[HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t tag[HKDS_TAG_SIZE] = { 0 };
+	uint8_t edk[HKDS_EDK_SIZE] = { 0 };
+	uint8_t tokd[HKDS_STK_SIZE] = { 0 };
+	uint8_t toke[HKDS_STK_SIZE + HKDS_TAG_SIZE] = { 0 };
+	hkds_client_message_request req;
+	hkds_client_message_request ereq;
+	hkds_server_token_response tres;
+	hkds_packet_view view;
+	hkds_client_state cs;
+	hkds_master_key mdk;
+	hkds_server_state ss;
+	bool res;
+
+	res = true;
+	hkds_server_generate_mdk(&utils_seed_generate, &mdk, kid);
+	hkds_server_generate_edk(mdk.bdk, did, edk);
+	hkds_client_initialize_state(&cs, edk, did);
+	hkds_server_initialize_state(&ss, &mdk, cs.ksn);
+	hkds_server_encrypt_token(&ss, toke);
+	hkds_client_decrypt_token(&cs, toke, tokd);
+	hkds_client_generate_cache(&cs, tokd);
+	utils_seed_generate(msg, sizeof(msg));
+	utils_seed_generate(tag, sizeof(tag));
+	hkds_client_encrypt_message(&cs, msg, cpt);
+
+	/* the serialized header is the four byte wire header */
+	req = hkds_factory_create_client_message_request(cpt, ss.ksn, tag);
+	hkds_factory_serialize_client_message(pkt, &req);
+
+	if (pkt[HKDS_PACKET_FLAG_OFFSET] != (uint8_t)packet_message_request || pkt[HKDS_PACKET_PROTOCOL_OFFSET] != (uint8_t)HKDS_PROTOCOL_TYPE ||
+		pkt[HKDS_PACKET_LENGTH_OFFSET] != HKDS_CLIENT_MESSAGE_REQUEST_SIZE ||
+		utils_memory_are_equal(pkt + HKDS_PACKET_KSN_OFFSET, ss.ksn, HKDS_KSN_SIZE) == false ||
+		utils_memory_are_equal(pkt + HKDS_PACKET_MESSAGE_OFFSET, cpt, HKDS_MESSAGE_SIZE) == false ||
+		utils_memory_are_equal(pkt + HKDS_PACKET_TAG_OFFSET, tag, HKDS_TAG_SIZE) == false)
+	{
+		hkdstest_print_line("hkds_packet_view_test: wire serialization failure! -HPV1");
+		res = false;
+	}
+
+	ereq = hkds_factory_extract_client_message(pkt);
+
+	if (ereq.header.flag != packet_message_request || ereq.header.protocol != HKDS_PROTOCOL_TYPE ||
+		ereq.header.length != HKDS_CLIENT_MESSAGE_REQUEST_SIZE || utils_memory_are_equal(ereq.message, cpt, HKDS_MESSAGE_SIZE) == false)
+	{
+		hkdstest_print_line("hkds_packet_view_test: wire extraction failure! -HPV2");
+		res = false;
+	}
+
+	/* the view points into the receive buffer, and the server decrypts from it in place */
+	if (hkds_factory_view_packet(&view, pkt, sizeof(pkt)) == false || view.ksn != pkt + HKDS_PACKET_KSN_OFFSET ||
+		view.message != pkt + HKDS_PACKET_MESSAGE_OFFSET || view.tag != pkt + HKDS_PACKET_TAG_OFFSET || view.etok != NULL)
+	{
+		hkdstest_print_line("hkds_packet_view_test: packet view failure! -HPV3");
+		res = false;
+	}
+	else
+	{
+		hkds_server_initialize_state(&ss, &mdk, view.ksn);
+		hkds_server_decrypt_message(&ss, view.message, dec);
+
+		if (utils_memory_are_equal(dec, msg, sizeof(msg)) == false)
+		{
+			hkdstest_print_line("hkds_packet_view_test: in-place decryption failure! -HPV4");
+			res = false;
+		}
+	}
+
+	/* a truncated packet, a wrong length field, and a foreign protocol are rejected */
+	if (hkds_factory_view_packet(&view, pkt, HKDS_CLIENT_MESSAGE_REQUEST_SIZE - 1U) == true || view.packet != NULL)
+	{
+		res = false;
+	}
+
+	pkt[HKDS_PACKET_LENGTH_OFFSET] = HKDS_CLIENT_TOKEN_REQUEST_SIZE;
+
+	if (hkds_factory_view_packet(&view, pkt, sizeof(pkt)) == true)
+	{
+		res = false;
+	}
+
+	pkt[HKDS_PACKET_LENGTH_OFFSET] = HKDS_CLIENT_MESSAGE_REQUEST_SIZE;
+	pkt[HKDS_PACKET_PROTOCOL_OFFSET] ^= 0x0FU;
+
+	if (hkds_factory_view_packet(&view, pkt, sizeof(pkt)) == true)
+	{
+		res = false;
+	}
+
+	if (res == false)
+	{
+		hkdstest_print_line("hkds_packet_view_test: packet validation failure! -HPV5");
+	}
+
+	tres = hkds_factory_create_server_token_reponse(toke);
+	hkds_factory_serialize_server_token(tpkt, &tres);
+
+	if (hkds_factory_view_packet(&view, tpkt, sizeof(tpkt)) == false || view.type != packet_token_response ||
+		view.etok != tpkt + HKDS_HEADER_SIZE || view.ksn != NULL)
+	{
+		hkdstest_print_line("hkds_packet_view_test: token response view failure! -HPV6");
+		res = false;
+	}
+
+	return res;
+}
+
+#define HKDSTEST_PARSE_MESSAGES 20U
+#define HKDSTEST_PARSE_TOKENS 3U
+
+bool hkdstest_packet_parse_test()
+{
+	const uint8_t kid[HKDS_KID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
+	/* device id						|		BKD ID			| PID | Mode |	MID	     |			DID		     | */
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01, 0x00, 0x00, 0x00, 0x13, HKDSTEST_PRF_MODE, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	uint8_t buf[((HKDSTEST_PARSE_MESSAGES + 1U) * HKDS_CLIENT_MESSAGE_REQUEST_SIZE) + (HKDSTEST_PARSE_TOKENS * HKDS_CLIENT_TOKEN_REQUEST_SIZE) +
+		HKDS_SERVER_MESSAGE_RESPONSE_SIZE] = { 0 };
+	uint8_t msg[HKDSTEST_PARSE_MESSAGES + 1U][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t dec[HKDS_CACHX8_DEPTH][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t cpt[HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t tksn[HKDS_KSN_SIZE] = { 0 };
+	uint8_t tag[HKDS_TAG_SIZE] = { 0 };
+	uint8_t edk[HKDS_EDK_SIZE] = { 0 };
+	uint8_t tokd[HKDS_STK_SIZE] = { 0 };
+	uint8_t toke[HKDS_STK_SIZE + HKDS_TAG_SIZE] = { 0 };
+	hkds_client_message_request req;
+	hkds_client_token_request treq;
+	hkds_server_message_response rsp;
+	hkds_packet_batch* batch;
+	hkds_client_state cs[HKDS_CACHX8_DEPTH];
+	hkds_master_key mdk;
+	hkds_server_state ss;
+	hkds_server_x8_state xss;
+	size_t blen;
+	size_t cnt;
+	size_t i;
+	bool res;
+
+	res = true;
+	hkds_server_generate_mdk(&utils_seed_generate, &mdk, kid);
+
+	for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		uint8_t tdid[HKDS_DID_SIZE];
+
+		utils_memory_copy(tdid, did, HKDS_DID_SIZE);
+		tdid[HKDS_DID_SIZE - 2U] = (uint8_t)i;
+		hkds_server_generate_edk(mdk.bdk, tdid, edk);
+		hkds_client_initialize_state(&cs[i], edk, tdid);
+		hkds_server_initialize_state(&ss, &mdk, cs[i].ksn);
+		hkds_server_encrypt_token(&ss, toke);
+		hkds_client_decrypt_token(&cs[i], toke, tokd);
+		hkds_client_generate_cache(&cs[i], tokd);
+	}
+
+	/* message requests from eight devices, interleaved with token requests and a response, with a trailing partial packet */
+	blen = 0U;
+	utils_seed_generate(tag, sizeof(tag));
+
+	for (i = 0U; i < HKDSTEST_PARSE_MESSAGES + 1U; ++i)
+	{
+		utils_seed_generate(msg[i], HKDS_MESSAGE_SIZE);
+		req = hkds_factory_create_client_message_request(cpt, cs[i % HKDS_CACHX8_DEPTH].ksn, tag);
+		hkds_client_encrypt_message(&cs[i % HKDS_CACHX8_DEPTH], msg[i], cpt);
+		utils_memory_copy(req.message, cpt, HKDS_MESSAGE_SIZE);
+		req.header.sequence = (uint8_t)i;
+		hkds_factory_serialize_client_message(buf + blen, &req);
+		blen += HKDS_CLIENT_MESSAGE_REQUEST_SIZE;
+
+		if (i < HKDSTEST_PARSE_TOKENS)
+		{
+			utils_memory_copy(tksn, cs[i].ksn, HKDS_KSN_SIZE);
+			treq = hkds_factory_create_client_token_request(tksn);
+			hkds_factory_serialize_client_token(buf + blen, &treq);
+			blen += HKDS_CLIENT_TOKEN_REQUEST_SIZE;
+		}
+
+		if (i == HKDSTEST_PARSE_TOKENS)
+		{
+			rsp = hkds_factory_create_server_message_response(msg[i]);
+			hkds_factory_serialize_server_message(buf + blen, &rsp);
+			blen += HKDS_SERVER_MESSAGE_RESPONSE_SIZE;
+		}
+	}
+
+	batch = (hkds_packet_batch*)utils_memory_aligned_alloc(HKDS_SIMD_ALIGNMENT, sizeof(hkds_packet_batch));
+
+	if (batch == NULL)
+	{
+		hkdstest_print_line("hkds_packet_parse_test: memory allocation failure! -HPP1");
+		res = false;
+	}
+	else
+	{
+		hkds_factory_reset_batch(batch, false);
+		cnt = hkds_factory_parse_packets(batch, buf, blen - 5U);
+
+		if (cnt != blen - HKDS_CLIENT_MESSAGE_REQUEST_SIZE || batch->messages != HKDSTEST_PARSE_MESSAGES ||
+			batch->tokens != HKDSTEST_PARSE_TOKENS || batch->rejected != 1U || batch->malformed == true ||
+			utils_memory_are_equal(batch->tokksn[0U][HKDSTEST_PARSE_TOKENS - 1U], tksn, HKDS_KSN_SIZE) == false)
+		{
+			hkdstest_print_line("hkds_packet_parse_test: packet sorting failure! -HPP2");
+			res = false;
+		}
+
+		/* the remainder completes the partial packet */
+		cnt += hkds_factory_parse_packets(batch, buf + cnt, blen - cnt);
+
+		if (cnt != blen || batch->messages != HKDSTEST_PARSE_MESSAGES + 1U)
+		{
+			hkdstest_print_line("hkds_packet_parse_test: partial packet failure! -HPP3");
+			res = false;
+		}
+
+		/* each full group is the input of an x8 decryption */
+		for (i = 0U; i < batch->messages / HKDS_CACHX8_DEPTH; ++i)
+		{
+			hkds_server_initialize_state_x8(&xss, &mdk, (const uint8_t (*)[HKDS_KSN_SIZE])batch->msgksn[i]);
+			hkds_server_decrypt_message_x8(&xss, (const uint8_t (*)[HKDS_MESSAGE_SIZE])batch->message[i], dec);
+
+			if (utils_memory_are_equal((const uint8_t*)dec, msg[i * HKDS_CACHX8_DEPTH], sizeof(dec)) == false)
+			{
+				hkdstest_print_line("hkds_packet_parse_test: x8 group decryption failure! -HPP4");
+				res = false;
+			}
+		}
+
+		/* authenticated batches keep the tag with the cipher-text; a short length field stops the parse */
+		hkds_factory_reset_batch(batch, true);
+		buf[HKDS_CLIENT_MESSAGE_REQUEST_SIZE + HKDS_PACKET_LENGTH_OFFSET] = 0x02U;
+		cnt = hkds_factory_parse_packets(batch, buf, blen);
+
+		if (cnt != HKDS_CLIENT_MESSAGE_REQUEST_SIZE || batch->messages != 1U || batch->malformed == false ||
+			utils_memory_are_equal(batch->authmessage[0U][0U] + HKDS_MESSAGE_SIZE, tag, HKDS_TAG_SIZE) == false)
+		{
+			hkdstest_print_line("hkds_packet_parse_test: authenticated batch failure! -HPP5");
+			res = false;
+		}
+
+		utils_memory_aligned_free(batch);
+	}
+
+	return res;
+}
+
+#define HKDSTEST_ENVELOPE_RECORDS 20U
+
+bool hkdstest_batch_envelope_test()
+{
+	const uint8_t kid[HKDS_KID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
+	/* device id						|		BKD ID			| PID | Mode |	MID	     |			DID		     | */
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01, 0x00, 0x00, 0x00, 0x13, HKDSTEST_PRF_MODE, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	uint8_t env[HKDS_BATCH_HEADER_SIZE + (HKDSTEST_ENVELOPE_RECORDS * (HKDS_CLIENT_MESSAGE_REQUEST_SIZE - HKDS_HEADER_SIZE))] = { 0 };
+	uint8_t renv[HKDS_BATCH_HEADER_SIZE + (HKDSTEST_ENVELOPE_RECORDS * HKDS_MESSAGE_SIZE)] = { 0 };
+	uint8_t ksn[HKDSTEST_ENVELOPE_RECORDS][HKDS_KSN_SIZE] = { 0 };
+	uint8_t cpt[HKDSTEST_ENVELOPE_RECORDS][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t dec[HKDSTEST_ENVELOPE_RECORDS][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t msg[HKDSTEST_ENVELOPE_RECORDS][HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t edk[HKDS_EDK_SIZE] = { 0 };
+	uint8_t tokd[HKDS_STK_SIZE] = { 0 };
+	uint8_t toke[HKDS_STK_SIZE + HKDS_TAG_SIZE] = { 0 };
+	const uint8_t* pksn[HKDSTEST_ENVELOPE_RECORDS];
+	const uint8_t* pcpt[HKDSTEST_ENVELOPE_RECORDS];
+	const uint8_t* pdec[HKDSTEST_ENVELOPE_RECORDS];
+	uint8_t* ppln[HKDSTEST_ENVELOPE_RECORDS];
+	hkds_packet_batch* pbatch;
+	hkds_batch_view view;
+	hkds_client_state cs[HKDS_CACHX8_DEPTH];
+	hkds_master_key mdk;
+	hkds_server_state ss;
+	hkds_server_x8_state tss = { 0 };
+	size_t elen;
+	size_t i;
+	bool res;
+
+	res = true;
+	hkds_server_generate_mdk(&utils_seed_generate, &mdk, kid);
+
+	for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		uint8_t tdid[HKDS_DID_SIZE];
+
+		utils_memory_copy(tdid, did, HKDS_DID_SIZE);
+		tdid[HKDS_DID_SIZE - 2U] = (uint8_t)i;
+		hkds_server_generate_edk(mdk.bdk, tdid, edk);
+		hkds_client_initialize_state(&cs[i], edk, tdid);
+		hkds_server_initialize_state(&ss, &mdk, cs[i].ksn);
+		hkds_server_encrypt_token(&ss, toke);
+		hkds_client_decrypt_token(&cs[i], toke, tokd);
+		hkds_client_generate_cache(&cs[i], tokd);
+	}
+
+	/* a concentrator packs the requests of several terminals into one envelope */
+	for (i = 0U; i < HKDSTEST_ENVELOPE_RECORDS; ++i)
+	{
+		utils_seed_generate(msg[i], HKDS_MESSAGE_SIZE);
+		utils_memory_copy(ksn[i], cs[i % HKDS_CACHX8_DEPTH].ksn, HKDS_KSN_SIZE);
+		hkds_client_encrypt_message(&cs[i % HKDS_CACHX8_DEPTH], msg[i], cpt[i]);
+		pksn[i] = ksn[i];
+		pcpt[i] = cpt[i];
+	}
+
+	elen = hkds_factory_serialize_batch_request(env, sizeof(env), packet_message_request, pksn, pcpt, NULL, HKDSTEST_ENVELOPE_RECORDS, 0x01U);
+
+	if (elen != sizeof(env) || hkds_factory_extract_batch_size(env) != sizeof(env) ||
+		hkds_factory_serialize_batch_request(env, sizeof(env) - 1U, packet_message_request, pksn, pcpt, NULL, HKDSTEST_ENVELOPE_RECORDS, 0x01U) != 0U)
+	{
+		hkdstest_print_line("hkds_batch_envelope_test: envelope serialization failure! -HBE1");
+		res = false;
+	}
+
+	/* the server views the envelope and decrypts the records in place with the batch function */
+	if (hkds_factory_view_batch(&view, env, sizeof(env) - 1U) == true || hkds_factory_view_batch(&view, env, sizeof(env)) == false ||
+		view.count != HKDSTEST_ENVELOPE_RECORDS || view.rectype != packet_message_request)
+	{
+		hkdstest_print_line("hkds_batch_envelope_test: envelope view failure! -HBE2");
+		res = false;
+	}
+	else
+	{
+		hkds_factory_batch_pointers(&view, 0U, pksn);
+		hkds_factory_batch_pointers(&view, HKDS_KSN_SIZE, pcpt);
+
+		for (i = 0U; i < HKDSTEST_ENVELOPE_RECORDS; ++i)
+		{
+			ppln[i] = dec[i];
+		}
+
+		tss.mdk = &mdk;
+
+		if (pksn[1U] != env + HKDS_BATCH_HEADER_SIZE + view.stride ||
+			hkds_server_decrypt_batch(&tss, view.count, pksn, pcpt, ppln) == false ||
+			utils_memory_are_equal((const uint8_t*)dec, (const uint8_t*)msg, sizeof(msg)) == false)
+		{
+			hkdstest_print_line("hkds_batch_envelope_test: envelope decryption failure! -HBE3");
+			res = false;
+		}
+	}
+
+	/* the responses return in one envelope, in request order */
+	for (i = 0U; i < HKDSTEST_ENVELOPE_RECORDS; ++i)
+	{
+		pdec[i] = dec[i];
+	}
+
+	if (hkds_factory_serialize_batch_response(renv, sizeof(renv), packet_message_response, pdec, HKDSTEST_ENVELOPE_RECORDS, 0x02U) != sizeof(renv) ||
+		hkds_factory_view_batch(&view, renv, sizeof(renv)) == false || view.type != packet_batch_response ||
+		utils_memory_are_equal(view.records + (5U * view.stride), msg[5U], HKDS_MESSAGE_SIZE) == false)
+	{
+		hkdstest_print_line("hkds_batch_envelope_test: response envelope failure! -HBE4");
+		res = false;
+	}
+
+	/* a request envelope cannot carry response records, and the packet parser skips envelopes whole */
+	env[HKDS_HEADER_SIZE + 2U] = (uint8_t)packet_message_response;
+
+	if (hkds_factory_view_batch(&view, env, sizeof(env)) == true)
+	{
+		hkdstest_print_line("hkds_batch_envelope_test: record type validation failure! -HBE5");
+		res = false;
+	}
+
+	pbatch = (hkds_packet_batch*)utils_memory_aligned_alloc(HKDS_SIMD_ALIGNMENT, sizeof(hkds_packet_batch));
+
+	if (pbatch != NULL)
+	{
+		hkds_factory_reset_batch(pbatch, false);
+
+		if (hkds_factory_parse_packets(pbatch, renv, sizeof(renv)) != sizeof(renv) || pbatch->rejected != 1U || pbatch->malformed == true)
+		{
+			hkdstest_print_line("hkds_batch_envelope_test: envelope skipping failure! -HBE6");
+			res = false;
+		}
+
+		utils_memory_aligned_free(pbatch);
+	}
+
+	return res;
+}
+
+#define HKDSTEST_FRAMER_PACKETS 40U
+#define HKDSTEST_FRAMER_RECORDS 4U
+#define HKDSTEST_FRAMER_ROUNDS 64U
+
+static size_t hkdstest_framer_feed(hkds_framer_state* framer, const uint8_t* stream, size_t slen, const size_t* offsets, const size_t* lengths, size_t count)
+{
+	uint8_t rnd[HKDSTEST_FRAMER_PACKETS * 8U] = { 0 };
+	hkds_frame frame;
+	size_t clen;
+	size_t idx;
+	size_t pos;
+	size_t r;
+	size_t wlen;
+
+	idx = 0U;
+	pos = 0U;
+	r = 0U;
+	utils_seed_generate(rnd, sizeof(rnd));
+
+	while (pos < slen)
+	{
+		/* random split points; mostly short reads, with an occasional read spanning several packets */
+		clen = ((rnd[r % sizeof(rnd)] & 0x07U) == 0U) ? (size_t)rnd[(r + 1U) % sizeof(rnd)] + 1U : (size_t)(rnd[r % sizeof(rnd)] & 0x3FU) + 1U;
+		clen = (clen <= slen - pos) ? clen : slen - pos;
+		r += 2U;
+		wlen = hkds_framer_write(framer, stream + pos, clen);
+		pos += wlen;
+
+		while (hkds_framer_next(framer, &frame) == true)
+		{
+			if (idx < count && frame.length == lengths[idx] && utils_memory_are_equal(frame.packet, stream + offsets[idx], frame.length) == true)
+			{
+				++idx;
+			}
+			else
+			{
+				/* a frame out of order or corrupted; stop the feed */
+				pos = slen;
+				idx = 0U;
+				break;
+			}
+		}
+
+		if (wlen == 0U)
+		{
+			/* the framer is malformed or stalled */
+			break;
+		}
+	}
+
+	return idx;
+}
+
+bool hkdstest_stream_framer_test()
+{
+	uint8_t stream[HKDSTEST_FRAMER_PACKETS * HKDS_FRAMER_MIN_SIZE] = { 0 };
+	uint8_t rec[HKDSTEST_FRAMER_RECORDS][HKDS_KSN_SIZE + HKDS_MESSAGE_SIZE + HKDS_TAG_SIZE] = { 0 };
+	uint8_t sbuf[HKDS_FRAMER_MIN_SIZE] = { 0 };
+	uint8_t etok[HKDS_ETOK_SIZE] = { 0 };
+	uint8_t ksn[HKDS_KSN_SIZE] = { 0 };
+	uint8_t msg[HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t tag[HKDS_TAG_SIZE] = { 0 };
+	size_t offsets[HKDSTEST_FRAMER_PACKETS] = { 0 };
+	size_t lengths[HKDSTEST_FRAMER_PACKETS] = { 0 };
+	const uint8_t* pksn[HKDSTEST_FRAMER_RECORDS];
+	const uint8_t* pmsg[HKDSTEST_FRAMER_RECORDS];
+	const uint8_t* ptag[HKDSTEST_FRAMER_RECORDS];
+	const uint8_t* prun;
+	hkds_client_message_request req;
+	hkds_client_token_request treq;
+	hkds_server_message_response rsp;
+	hkds_server_token_response trsp;
+	hkds_error_message err;
+	hkds_packet_batch* batch;
+	hkds_framer_state framer;
+	hkds_frame frame;
+	size_t expmsg;
+	size_t exptok;
+	size_t plen;
+	size_t rlen;
+	size_t slen;
+	size_t i;
+	bool mal;
+	bool res;
+
+	res = true;
+	mal = false;
+	slen = 0U;
+	expmsg = 0U;
+	exptok = 0U;
+
+	for (i = 0U; i < HKDSTEST_FRAMER_RECORDS; ++i)
+	{
+		utils_seed_generate(rec[i], sizeof(rec[i]));
+		pksn[i] = rec[i];
+		pmsg[i] = rec[i] + HKDS_KSN_SIZE;
+		ptag[i] = rec[i] + HKDS_KSN_SIZE + HKDS_MESSAGE_SIZE;
+	}
+
+	/* a stream of every packet type the client and the server exchange, with batch envelopes */
+	for (i = 0U; i < HKDSTEST_FRAMER_PACKETS; ++i)
+	{
+		utils_seed_generate(ksn, sizeof(ksn));
+		utils_seed_generate(msg, sizeof(msg));
+		utils_seed_generate(tag, sizeof(tag));
+		offsets[i] = slen;
+
+		switch (i % 6U)
+		{
+			case 0U:
+			{
+				req = hkds_factory_create_client_message_request(msg, ksn, tag);
+				hkds_factory_serialize_client_message(stream + slen, &req);
+				plen = HKDS_CLIENT_MESSAGE_REQUEST_SIZE;
+				++expmsg;
+				break;
+			}
+			case 1U:
+			{
+				treq = hkds_factory_create_client_token_request(ksn);
+				hkds_factory_serialize_client_token(stream + slen, &treq);
+				plen = HKDS_CLIENT_TOKEN_REQUEST_SIZE;
+				++exptok;
+				break;
+			}
+			case 2U:
+			{
+				rsp = hkds_factory_create_server_message_response(msg);
+				hkds_factory_serialize_server_message(stream + slen, &rsp);
+				plen = HKDS_SERVER_MESSAGE_RESPONSE_SIZE;
+				break;
+			}
+			case 3U:
+			{
+				utils_seed_generate(etok, sizeof(etok));
+				trsp = hkds_factory_create_server_token_reponse(etok);
+				hkds_factory_serialize_server_token(stream + slen, &trsp);
+				plen = HKDS_SERVER_TOKEN_RESPONSE_SIZE;
+				break;
+			}
+			case 4U:
+			{
+				plen = hkds_factory_serialize_batch_request(stream + slen, sizeof(stream) - slen, packet_message_request, pksn, pmsg, ptag,
+					HKDSTEST_FRAMER_RECORDS, (uint8_t)i);
+				break;
+			}
+			default:
+			{
+				err = hkds_factory_create_error_message(msg, error_invalid_format);
+				hkds_factory_serialize_error_message(stream + slen, &err);
+				plen = HKDS_ERROR_MESSAGE_SIZE;
+			}
+		}
+
+		lengths[i] = plen;
+		slen += plen;
+	}
+
+	/* the smallest framer, in a caller buffer, reassembles the stream split at random points */
+	if (hkds_framer_initialize(&framer, sbuf, sizeof(sbuf) - 1U) == true || hkds_framer_initialize(&framer, sbuf, sizeof(sbuf)) == false)
+	{
+		hkdstest_print_line("hkds_stream_framer_test: framer initialization failure! -HSF1");
+		res = false;
+	}
+	else
+	{
+		for (i = 0U; i < HKDSTEST_FRAMER_ROUNDS; ++i)
+		{
+			if (hkdstest_framer_feed(&framer, stream, slen, offsets, lengths, HKDSTEST_FRAMER_PACKETS) != HKDSTEST_FRAMER_PACKETS ||
+				hkds_framer_pending(&framer) != 0U)
+			{
+				hkdstest_print_line("hkds_stream_framer_test: randomized reassembly failure! -HSF2");
+				res = false;
+				break;
+			}
+		}
+
+		/* an envelope larger than the buffer cannot be framed */
+		hkds_framer_reset(&framer);
+		stream[offsets[4U] + HKDS_HEADER_SIZE + 1U] = (uint8_t)(HKDS_BATCH_MAX_RECORDS & 0xFFU);
+		stream[offsets[4U] + HKDS_HEADER_SIZE] = (uint8_t)(HKDS_BATCH_MAX_RECORDS >> 8U);
+
+		if (hkdstest_framer_feed(&framer, stream, slen, offsets, lengths, HKDSTEST_FRAMER_PACKETS) != 4U || framer.malformed == false)
+		{
+			hkdstest_print_line("hkds_stream_framer_test: envelope size validation failure! -HSF3");
+			res = false;
+		}
+
+		stream[offsets[4U] + HKDS_HEADER_SIZE] = 0x00U;
+		stream[offsets[4U] + HKDS_HEADER_SIZE + 1U] = (uint8_t)HKDSTEST_FRAMER_RECORDS;
+		hkds_framer_destroy(&framer);
+	}
+
+	/* a length field that does not match the packet type leaves the framer malformed until it is reset */
+	if (hkds_framer_initialize(&framer, NULL, HKDS_FRAMER_MAX_SIZE) == true)
+	{
+		stream[offsets[7U] + HKDS_PACKET_LENGTH_OFFSET] += 1U;
+
+		if (hkdstest_framer_feed(&framer, stream, slen, offsets, lengths, HKDSTEST_FRAMER_PACKETS) != 7U || framer.malformed == false ||
+			hkds_framer_write(&framer, stream, HKDS_HEADER_SIZE) != 0U || hkds_framer_next(&framer, &frame) == true)
+		{
+			hkdstest_print_line("hkds_stream_framer_test: header validation failure! -HSF4");
+			res = false;
+		}
+
+		stream[offsets[7U] + HKDS_PACKET_LENGTH_OFFSET] -= 1U;
+		hkds_framer_reset(&framer);
+
+		/* the server feeds the whole run of complete frames to the packet parser, and skips the envelopes and responses */
+		batch = (hkds_packet_batch*)utils_memory_aligned_alloc(HKDS_SIMD_ALIGNMENT, sizeof(hkds_packet_batch));
+
+		if (batch != NULL)
+		{
+			hkds_factory_reset_batch(batch, true);
+
+			if (hkds_framer_write(&framer, stream, slen - 1U) != slen - 1U)
+			{
+				res = false;
+			}
+
+			rlen = hkds_framer_complete(&framer, &prun);
+
+			if (rlen != offsets[HKDSTEST_FRAMER_PACKETS - 1U] || prun != framer.buffer)
+			{
+				res = false;
+			}
+
+			hkds_framer_consume(&framer, hkds_factory_parse_packets(batch, prun, rlen));
+			hkds_framer_write(&framer, stream + slen - 1U, 1U);
+			rlen = hkds_framer_complete(&framer, &prun);
+			hkds_framer_consume(&framer, hkds_factory_parse_packets(batch, prun, rlen));
+
+			if (res == false || batch->messages != expmsg || batch->tokens != exptok || batch->malformed == true || hkds_framer_pending(&framer) != 0U)
+			{
+				hkdstest_print_line("hkds_stream_framer_test: bulk frame parsing failure! -HSF5");
+				res = false;
+			}
+
+			utils_memory_aligned_free(batch);
+		}
+
+		/* a transport with its own receive buffers reads the complete frames in place, and completes a split frame in the framer */
+		rlen = hkds_framer_scan(stream, offsets[1U] + 2U, HKDS_FRAMER_MAX_SIZE, &mal);
+		hkds_framer_write(&framer, stream + rlen, 2U);
+		plen = hkds_framer_needed(&framer);
+		hkds_framer_write(&framer, stream + rlen + 2U, plen);
+		slen = hkds_framer_needed(&framer);
+		hkds_framer_write(&framer, stream + rlen + 2U + plen, slen);
+
+		if (rlen != offsets[1U] || mal == true || plen != HKDS_HEADER_SIZE - 2U || slen != lengths[1U] - HKDS_HEADER_SIZE ||
+			hkds_framer_needed(&framer) != 0U || hkds_framer_next(&framer, &frame) == false || frame.length != lengths[1U])
+		{
+			hkdstest_print_line("hkds_stream_framer_test: in-place frame scan failure! -HSF6");
+			res = false;
+		}
+
+		stream[offsets[7U] + HKDS_PACKET_LENGTH_OFFSET] += 1U;
+
+		if (res == true && (hkds_framer_scan(stream, sizeof(stream), HKDS_FRAMER_MAX_SIZE, &mal) != offsets[7U] || mal == false))
+		{
+			hkdstest_print_line("hkds_stream_framer_test: in-place header validation failure! -HSF6");
+			res = false;
+		}
+
+		stream[offsets[7U] + HKDS_PACKET_LENGTH_OFFSET] -= 1U;
+		hkds_framer_destroy(&framer);
+	}
+
+	return res;
+}
+
+#define HKDSTEST_FLEET_DEVICES 21U
+#define HKDSTEST_FLEET_ROUNDS (3U * HKDS_CACHE_SIZE)
+
+static bool hkdstest_fleet_answer(hkds_fleet_state* fleet, hkds_master_key* mdk, const uint8_t* packets, size_t plen,
+	const size_t* devices, size_t count, bool tamper)
+{
+	uint8_t rsp[HKDS_SERVER_TOKEN_RESPONSE_SIZE] = { 0 };
+	uint8_t etok[HKDS_ETOK_SIZE] = { 0 };
+	uint8_t pln[HKDS_MESSAGE_SIZE] = { 0 };
+	hkds_server_message_response mrsp;
+	hkds_server_token_response trsp;
+	hkds_server_state ss;
+	hkds_packet_view pv;
+	size_t pos;
+	bool res;
+
+	res = true;
+	pos = 0U;
+
+	/* the server side of an echo transaction, for each request in order */
+	for (size_t i = 0U; i < count && res == true; ++i)
+	{
+		res = hkds_factory_view_packet(&pv, packets + pos, plen - pos);
+
+		if (res == true)
+		{
+			hkds_server_initialize_state(&ss, mdk, pv.ksn);
+
+			if (pv.type == packet_token_request)
+			{
+				hkds_server_encrypt_token(&ss, etok);
+				trsp = hkds_factory_create_server_token_reponse(etok);
+				hkds_factory_serialize_server_token(rsp, &trsp);
+				res = hkds_fleet_receive(fleet, devices[i], rsp, HKDS_SERVER_TOKEN_RESPONSE_SIZE);
+			}
+			else
+			{
+				if (fleet->authenticated == true)
+				{
+					res = hkds_server_decrypt_verify_message(&ss, pv.message, pv.ksn, 0U, pln);
+				}
+				else
+				{
+					hkds_server_decrypt_message(&ss, pv.message, pln);
+				}
+
+				pln[0U] ^= (tamper == true) ? 0x01U : 0x00U;
+				mrsp = hkds_factory_create_server_message_response(pln);
+				hkds_factory_serialize_server_message(rsp, &mrsp);
+				res = (res == true && hkds_fleet_receive(fleet, devices[i], rsp, HKDS_SERVER_MESSAGE_RESPONSE_SIZE) == true);
+			}
+
+			pos += pv.length;
+		}
+	}
+
+	return (res == true && pos == plen);
+}
+
+bool hkdstest_fleet_test()
+{
+	/* master key id */
+	const uint8_t kid[HKDS_KID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
+	/* device id						|		BKD ID			| PID | Mode |	MID	     |			DID		     | */
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01, 0x00, 0x00, 0x00, 0x10, HKDSTEST_PRF_MODE, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00 };
+	uint8_t packets[HKDSTEST_FLEET_DEVICES * HKDS_CLIENT_MESSAGE_REQUEST_SIZE] = { 0 };
+	uint8_t tdid[HKDS_DID_SIZE] = { 0 };
+	uint8_t edk[HKDS_EDK_SIZE] = { 0 };
+	size_t devices[HKDSTEST_FLEET_DEVICES] = { 0 };
+	hkds_fleet_state fleet;
+	hkds_master_key mdk;
+	size_t count;
+	size_t plen;
+	bool res;
+
+	res = true;
+	hkds_server_generate_mdk(&utils_seed_generate, &mdk, kid);
+
+	for (size_t mode = 0U; mode < 2U && res == true; ++mode)
+	{
+		res = hkds_fleet_initialize(&fleet, HKDSTEST_FLEET_DEVICES, (mode == 1U));
+
+		if (res == false)
+		{
+			hkdstest_print_line("hkds_fleet_test: fleet allocation failure! -HFT1");
+		}
+		else
+		{
+			hkds_fleet_provision(&fleet, &mdk, did, 100U);
+
+			/* the x8 provisioning matches the scalar device key, including the lanes of the last partial group */
+			utils_memory_copy(tdid, did, HKDS_DID_SIZE);
+			utils_integer_be32to8(tdid + HKDS_DID_SIZE - sizeof(uint32_t), 100U + HKDSTEST_FLEET_DEVICES - 1U);
+			hkds_server_generate_edk(mdk.bdk, tdid, edk);
+
+			if (utils_memory_are_equal(edk, fleet.edk + ((HKDSTEST_FLEET_DEVICES - 1U) * HKDS_EDK_SIZE), HKDS_EDK_SIZE) == false ||
+				utils_memory_are_equal(tdid, fleet.ksn + ((HKDSTEST_FLEET_DEVICES - 1U) * HKDS_KSN_SIZE), HKDS_DID_SIZE) == false)
+			{
+				hkdstest_print_line("hkds_fleet_test: device provisioning failure! -HFT2");
+				res = false;
+			}
+
+			/* every device is answered in each round, so each is idle again in the next, through several epochs */
+			for (size_t i = 0U; i < HKDSTEST_FLEET_ROUNDS && res == true; ++i)
+			{
+				plen = hkds_fleet_generate(&fleet, packets, sizeof(packets), devices, HKDSTEST_FLEET_DEVICES, &count);
+
+				if (count != HKDSTEST_FLEET_DEVICES || hkdstest_fleet_answer(&fleet, &mdk, packets, plen, devices, count, false) == false)
+				{
+					hkdstest_print_line("hkds_fleet_test: request and response failure! -HFT3");
+					res = false;
+				}
+
+				hkds_fleet_refresh(&fleet);
+			}
+
+			if (res == true && (fleet.failures != 0U || fleet.tokens != fleet.epochs || fleet.epochs < 3U * HKDSTEST_FLEET_DEVICES ||
+				fleet.messages + fleet.tokens != HKDSTEST_FLEET_ROUNDS * HKDSTEST_FLEET_DEVICES))
+			{
+				hkdstest_print_line("hkds_fleet_test: epoch rollover failure! -HFT4");
+				res = false;
+			}
+
+			/* a response that does not echo the plaintext is a failure */
+			if (res == true)
+			{
+				plen = hkds_fleet_generate(&fleet, packets, sizeof(packets), devices, HKDSTEST_FLEET_DEVICES, &count);
+
+				if (hkdstest_fleet_answer(&fleet, &mdk, packets, plen, devices, count, true) == true || fleet.failures != 1U)
+				{
+					hkdstest_print_line("hkds_fleet_test: response verification failure! -HFT5");
+					res = false;
+				}
+			}
+
+			hkds_fleet_dispose(&fleet);
+		}
+	}
+
+	utils_memory_secure_erase((uint8_t*)&mdk, sizeof(mdk));
+
+	return res;
+}
+
+bool hkdstest_client_cache_test()
+{
+	/* device id						|		BKD ID			| PID | Mode |	MID	     |			DID		     | */
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01, 0x00, 0x00, 0x00, 0x10, HKDSTEST_PRF_MODE, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	uint8_t skey[HKDS_CACHE_SIZE * HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t tmpk[HKDS_STK_SIZE + HKDS_EDK_SIZE] = { 0 };
+	uint8_t cpt[HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t msg[HKDS_MESSAGE_SIZE] = { 0 };
+	hkds_client_state cs;
+	bool res;
+
+	res = true;
+	utils_seed_generate(tmpk, sizeof(tmpk));
+
+	/* the expected key-stream of the epoch; the token followed by the device key */
+#if defined(HKDS_SHAKE_128)
+	hkds_shake128_compute(skey, sizeof(skey), tmpk, sizeof(tmpk));
+#elif defined(HKDS_SHAKE_256)
+	hkds_shake256_compute(skey, sizeof(skey), tmpk, sizeof(tmpk));
+#else
+	hkds_shake512_compute(skey, sizeof(skey), tmpk, sizeof(tmpk));
+#endif
+
+	/* the epoch is entered at every position, so the keys that straddle blocks and the keys passed over are covered */
+	for (size_t i = 0U; i < HKDS_CACHE_SIZE && res == true; ++i)
+	{
+		hkds_client_initialize_state(&cs, tmpk + HKDS_STK_SIZE, did);
+		utils_integer_be32to8(cs.ksn + HKDS_DID_SIZE, (uint32_t)(HKDS_CACHE_SIZE + i));
+		hkds_client_generate_cache(&cs, tmpk);
+
+		/* a zero plaintext encrypts to the transaction key */
+		for (size_t j = i; j < HKDS_CACHE_SIZE; ++j)
+		{
+			if (hkds_client_encrypt_message(&cs, msg, cpt) == false ||
+				utils_memory_are_equal(cpt, skey + (j * HKDS_MESSAGE_SIZE), HKDS_MESSAGE_SIZE) == false)
+			{
+				hkdstest_print_line("hkds_client_cache_test: transaction key does not match expected answer! -HCC1");
+				res = false;
+				break;
+			}
+		}
+
+		if (res == true && (cs.cache_empty == false || hkds_client_encrypt_message(&cs, msg, cpt) == true))
+		{
+			hkdstest_print_line("hkds_client_cache_test: spent cache was not marked empty! -HCC2");
+			res = false;
+		}
+	}
+
+	utils_memory_secure_erase((uint8_t*)&cs, sizeof(cs));
+	utils_memory_secure_erase(skey, sizeof(skey));
+
+	return res;
+}
+
+bool hkdstest_client_x8_test()
+{
+	/* master key id */
+	const uint8_t kid[HKDS_KID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
+	/* device id						|		BKD ID			| PID | Mode |	MID	     |			DID		     | */
+	const uint8_t did[HKDS_DID_SIZE] = { 0x01, 0x00, 0x00, 0x00, 0x10, HKDSTEST_PRF_MODE, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00 };
+	uint8_t tdid[HKDS_DID_SIZE] = { 0 };
+	uint8_t cpt[HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t dec[HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t edk[HKDS_EDK_SIZE] = { 0 };
+	uint8_t msg[HKDS_MESSAGE_SIZE] = { 0 };
+	uint8_t tokd[HKDS_STK_SIZE] = { 0 };
+	uint8_t zero[HKDS_STK_SIZE] = { 0 };
+	uint8_t tokdp[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE] = { 0 };
+	uint8_t tokep[HKDS_CACHX8_DEPTH][HKDS_STK_SIZE + HKDS_TAG_SIZE] = { 0 };
+	hkds_client_state csp[HKDS_CACHX8_DEPTH];
+	hkds_client_state csq[HKDS_CACHX8_DEPTH];
+	hkds_client_state* pcs[HKDS_CACHX8_DEPTH];
+	bool valid[HKDS_CACHX8_DEPTH] = { false };
+	hkds_master_key mdk;
+	hkds_server_state ss;
+	size_t i;
+	bool res;
+
+	res = true;
+	hkds_server_generate_mdk(&utils_seed_generate, &mdk, kid);
+
+	/* eight devices, each in a different epoch; the copies are served by the scalar functions */
+	for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		utils_memory_copy(tdid, did, HKDS_DID_SIZE);
+		tdid[HKDS_DID_SIZE - 1U] = (uint8_t)(i + 1U);
+		hkds_server_generate_edk(mdk.bdk, tdid, edk);
+		hkds_client_initialize_state(&csp[i], edk, tdid);
+		utils_integer_be32to8(csp[i].ksn + HKDS_DID_SIZE, (uint32_t)(i * HKDS_CACHE_SIZE));
+		utils_memory_copy((uint8_t*)&csq[i], (const uint8_t*)&csp[i], sizeof(hkds_client_state));
+		pcs[i] = &csp[i];
+
+		hkds_server_initialize_state(&ss, &mdk, csp[i].ksn);
+		hkds_server_encrypt_token(&ss, tokep[i]);
+	}
+
+	/* one token is tampered with, and must fail on its own lane */
+	tokep[5U][0U] ^= 0x01U;
+	hkds_client_decrypt_token_x8(pcs, (const uint8_t (*)[HKDS_STK_SIZE + HKDS_TAG_SIZE])tokep, tokdp, valid);
+
+	for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+	{
+		if (hkds_client_decrypt_token(&csq[i], tokep[i], tokd) != valid[i] || valid[i] != (i != 5U) ||
+			utils_memory_are_equal(tokd, tokdp[i], HKDS_STK_SIZE) == false ||
+			(valid[i] == false && utils_memory_are_equal(tokdp[i], zero, HKDS_STK_SIZE) == false))
+		{
+			hkdstest_print_line("hkds_client_x8_test: token decryption does not match expected answer! -HCX1");
+			res = false;
+			break;
+		}
+	}
+
+	if (res == true)
+	{
+		hkds_client_generate_cache_x8(pcs, (const uint8_t (*)[HKDS_STK_SIZE])tokdp);
+
+		for (i = 0U; i < HKDS_CACHX8_DEPTH; ++i)
+		{
+			hkds_client_generate_cache(&csq[i], tokdp[i]);
+		}
+	}
+
+	/* the parallel caches decrypt at the server, except on the lane of the rejected token */
+	for (i = 0U; i < HKDS_CACHX8_DEPTH && res == true; ++i)
+	{
+		utils_seed_generate(msg, HKDS_MESSAGE_SIZE);
+		hkds_server_initialize_state(&ss, &mdk, csp[i].ksn);
+		hkds_client_encrypt_message(&csp[i], msg, cpt);
+		hkds_client_encrypt_message(&csq[i], msg, dec);
+		hkds_server_decrypt_message(&ss, cpt, dec);
+
+		if (csp[i].cache_empty == true || (i != 5U && utils_memory_are_equal(msg, dec, HKDS_MESSAGE_SIZE) == false))
+		{
+			hkdstest_print_line("hkds_client_x8_test: message decryption failure! -HCX2");
+			res = false;
+		}
+	}
+
+	/* the remaining keys of each epoch match the scalar cache */
+	for (i = 0U; i < HKDS_CACHX8_DEPTH && res == true; ++i)
+	{
+		for (size_t j = 1U; j < HKDS_CACHE_SIZE; ++j)
+		{
+			hkds_client_encrypt_message(&csp[i], msg, cpt);
+			hkds_client_encrypt_message(&csq[i], msg, dec);
+
+			if (utils_memory_are_equal(cpt, dec, HKDS_MESSAGE_SIZE) == false || csp[i].cache_empty != (j == HKDS_CACHE_SIZE - 1U))
+			{
+				hkdstest_print_line("hkds_client_x8_test: key cache does not match expected answer! -HCX3");
+				res = false;
+				break;
+			}
+		}
+	}
+
+	utils_memory_secure_erase((uint8_t*)&mdk, sizeof(mdk));
+
+	return res;
+}
+
 bool hkdstest_simd_encrypt_equivalence_test()
 {
 	const uint8_t PID = 0x10;
@@ -1195,6 +3663,168 @@ void hkdstest_test_run()
 		hkdstest_print_line("Failure! Failed the HKDS stress test.");
 	}
 
+	if (hkdstest_keystream_cache_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS keystream cache test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS keystream cache test.");
+	}
+
+	if (hkdstest_edk_table_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS EDK table test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS EDK table test.");
+	}
+
+	if (hkdstest_token_memo_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS token memo test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS token memo test.");
+	}
+
+	if (hkdstest_batch_decrypt_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS batch decryption test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS batch decryption test.");
+	}
+
+	if (hkdstest_squeeze_depth_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS squeeze depth test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS squeeze depth test.");
+	}
+
+	if (hkdstest_thread_pool_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS thread pool test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS thread pool test.");
+	}
+
+	if (hkdstest_async_engine_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS asynchronous engine test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS asynchronous engine test.");
+	}
+
+	if (hkdstest_simd_dispatch_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS SIMD kernel dispatch test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS SIMD kernel dispatch test.");
+	}
+
+	if (hkdstest_message_queue_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS message queue test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS message queue test.");
+	}
+
+	if (hkdstest_queue_view_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS queue view test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS queue view test.");
+	}
+
+	if (hkdstest_batcher_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS batch scheduler test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS batch scheduler test.");
+	}
+
+	if (hkdstest_packet_view_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS packet view test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS packet view test.");
+	}
+
+	if (hkdstest_packet_parse_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS bulk packet parser test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS bulk packet parser test.");
+	}
+
+	if (hkdstest_batch_envelope_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS batch envelope test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS batch envelope test.");
+	}
+
+	if (hkdstest_stream_framer_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS stream framer test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS stream framer test.");
+	}
+
+	if (hkdstest_fleet_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS terminal fleet test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS terminal fleet test.");
+	}
+
+	if (hkdstest_client_cache_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS client key cache test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS client key cache test.");
+	}
+
+	if (hkdstest_client_x8_test() == true)
+	{
+		hkdstest_print_line("Success! Passed the HKDS parallel client test.");
+	}
+	else
+	{
+		hkdstest_print_line("Failure! Failed the HKDS parallel client test.");
+	}
+
 	if (hkdstest_simd_encrypt_equivalence_test() == true)
 	{
 		hkdstest_print_line("Success! Passed the HKDS SIMD encryption equivalence test.");
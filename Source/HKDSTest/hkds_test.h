@@ -123,6 +123,214 @@ bool hkdstest_monte_carlo_test(void);
  */
 bool hkdstest_stress_test(void);
 
+/**
+ * \brief Tests the server epoch keystream cache for operational correctness.
+ *
+ * \details
+ * This test exchanges messages between several clients and a server using an undersized keystream cache,
+ * so that cache hits, misses, and evictions all occur, and verifies that every message decrypts correctly,
+ * and that a cache bound to another master key set is never used.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_keystream_cache_test(void);
+
+/**
+ * \brief Tests the server embedded device key table for operational correctness.
+ *
+ * \details
+ * This test bulk loads a device fleet into an EDK table and compares the keys with the scalar derivation,
+ * then verifies the scalar and x8 token and decryption paths with the table attached, including lazily added devices.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_edk_table_test(void);
+
+/**
+ * \brief Tests the server epoch token memo for operational correctness.
+ *
+ * \details
+ * This test issues scalar and x8 tokens with a memo attached, verifies that message decryption uses the
+ * memoized tokens, and checks ring replacement and time-to-live expiry.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_token_memo_test(void);
+
+/**
+ * \brief Tests the arbitrary length server batch decryption functions.
+ *
+ * \details
+ * This test decrypts and verifies a batch that ends in a partial x8 group, including a message with a
+ * corrupted tag, and a batch larger than 64 messages in which one device spans several epochs in interleaved order,
+ * and compares the output with the client plaintext.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_batch_decrypt_test(void);
+
+/**
+ * \brief Tests the x8 key derivation with lanes at different key-stream depths.
+ *
+ * \details
+ * This test decrypts and verifies a group whose lanes range from the first to the last key of the epoch,
+ * so the squeeze depth is set by the deepest lane rather than the full key-stream.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_squeeze_depth_test(void);
+
+/**
+ * \brief Tests the worker thread pool and the server functions that run on it.
+ *
+ * \details
+ * This test checks that a parallel loop visits every index once, then decrypts a set of x64 requests and the same
+ * requests as a batch on the pool, and compares the output with the client plaintext. The requests are decrypted
+ * again with a device key table and token memo attached, cold and then warm.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_thread_pool_test(void);
+
+/**
+ * \brief Tests the asynchronous submit and complete engine.
+ *
+ * \details
+ * This test submits an interleaved mix of decryption, verification and token requests, flushes the partial groups,
+ * and matches each completion to its request by cookie against the client plaintext and the scalar token output.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_async_engine_test(void);
+
+/**
+ * \brief Tests the run-time selection of the parallel Keccak kernels.
+ *
+ * \details
+ * This test selects each kernel set supported by the build and the processor in turn, and compares the output
+ * of the parallel SHAKE and KMAC functions, and of the chained SHAKE kernel, with the sequential functions.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_simd_dispatch_test(void);
+
+/**
+ * \brief Tests the lock-free message queue.
+ *
+ * \details
+ * This test checks the item order, the full and empty limits, and the block extraction of a single producer queue
+ * built in a caller buffer, over several laps of the ring, then runs concurrent producer and consumer tasks on an
+ * allocated multiple producer queue and checks that every item is taken exactly once.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_message_queue_test(void);
+
+/**
+ * \brief Tests the zero-copy queue views.
+ *
+ * \details
+ * This test encrypts client requests directly into reserved queue slots, then decrypts a claimed view of them
+ * in place with the batch decryption function, and checks that the release erases the slots.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_queue_view_test(void);
+
+/**
+ * \brief Tests the adaptive batch scheduler.
+ *
+ * \details
+ * This test submits requests at controlled times and checks that partial groups wait for the latency budget and
+ * take the masked or scalar path by size, that full groups are dispatched at once on the x64 and x8 paths, and that
+ * every completion matches the client plaintext.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_batcher_test(void);
+
+/**
+ * \brief Tests the packet serialization and the zero-copy packet views.
+ *
+ * \details
+ * This test checks that a serialized client message request has the four byte wire header and the field offsets,
+ * that a view of it points into the receive buffer and decrypts in place, and that truncated, mislabelled, and
+ * foreign packets are rejected.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_packet_view_test(void);
+
+/**
+ * \brief Tests the bulk packet parser.
+ *
+ * \details
+ * This test parses a buffer of interleaved message requests, token requests, and a response, split across two
+ * calls in the middle of a packet, checks the sorting and the x8 group layout by decrypting each full group, and
+ * checks the authenticated layout and the handling of a malformed length field.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_packet_parse_test(void);
+
+/**
+ * \brief Tests the batch envelope packets.
+ *
+ * \details
+ * This test packs the message requests of several devices into a batch request envelope, decrypts the records in
+ * place through a batch view, returns the plaintext in a batch response envelope, and checks the size and record type
+ * validation and that the packet parser skips an envelope whole.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_batch_envelope_test(void);
+
+/**
+ * \brief Tests the stream framer.
+ *
+ * \details
+ * This test writes a stream of every packet type, with batch envelopes, to the framer split at random points over
+ * many rounds and compares each frame with the packet sent, checks that an invalid length field or an envelope
+ * larger than the buffer marks the framer as malformed, and fills a packet batch from the run of complete frames.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_stream_framer_test(void);
+
+/**
+ * \brief Tests the terminal fleet simulator against the scalar server functions.
+ *
+ * \details
+ * This test provisions a fleet whose size is not a multiple of eight and compares a device key with the scalar
+ * derivation, answers every request of the fleet with the server functions through several epochs of each device, in
+ * unauthenticated and authenticated modes, and checks that a response which does not echo the plaintext is a failure.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_fleet_test(void);
+
+/**
+ * \brief Tests the client transaction keys against the SHAKE key-stream.
+ *
+ * \details
+ * This test enters an epoch at every position of the key cache, and compares each transaction key with the expected
+ * key-stream; it holds for the eager cache, and for the incremental cache of \c HKDS_CLIENT_LAZY_CACHE.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_client_cache_test(void);
+
+/**
+ * \brief Tests the x8 client token decryption and key cache generation.
+ *
+ * \details
+ * This test decrypts the tokens of eight devices in different epochs with the x8 client function, one of them
+ * tampered with, and compares each lane and the generated key caches with the scalar client functions.
+ *
+ * \return Returns true for test success, false otherwise.
+ */
+bool hkdstest_client_x8_test(void);
+
 /**
  * \brief Tests the SIMD server encryption for operational correctness.
  *